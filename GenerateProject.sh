@@ -0,0 +1,3 @@
+#!/bin/sh
+# makefiles for the Linux64 platform: make config=debug_linux64
+premake5 gmake2
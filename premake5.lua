@@ -31,7 +31,7 @@ newaction {
 
 workspace "Mist"
     configurations {"Debug", "Release"}
-    platforms {"Win64"}
+    platforms {"Win64", "Linux64"}
     startproject "MistTest"
     flags {"MultiProcessorCompile"}
 
@@ -40,6 +40,13 @@ workspace "Mist"
         system "Windows"
         architecture "x86_64"
 
+    filter "platforms:Linux64"
+        system "linux"
+        architecture "x86_64"
+        toolset "clang"
+        buildoptions { "-pthread" }
+        linkoptions { "-pthread", "-rdynamic" }
+
     filter "configurations:Debug"
         defines {"_DEBUG"}
         symbols "On"
@@ -116,11 +123,34 @@ workspace "Mist"
             "YamlCpp",
             "cppcoda",
             "tracy",
+        }
+
+        filter "system:windows"
+        links {
             "%{libs.vulkan}",
             "%{libs.sdl}",
         }
-        
-        filter "configurations:Debug"
+
+        -- vulkan sdk and sdl from the system packages.
+        filter "system:linux"
+        includedirs { "/usr/include/SDL2" }
+        links {
+            "vulkan",
+            "SDL2",
+            "shaderc_shared",
+            "spirv-cross-c",
+            "spirv-cross-core",
+            "spirv-cross-cpp",
+            "spirv-cross-glsl",
+            "spirv-cross-hlsl",
+            "spirv-cross-msl",
+            "spirv-cross-reflect",
+            "spirv-cross-util",
+            "glslang",
+            "dl",
+        }
+
+        filter { "system:windows", "configurations:Debug" }
         links {
                 "%{libs.spirvd}",
                 "%{libs.spirvcrossd}",
@@ -137,9 +167,11 @@ workspace "Mist"
                 "%{libs.shadercd}",
                 "%{libs.shadercutild}"
             }
+
+        filter "configurations:Debug"
             targetsuffix "d"
             
-        filter "configurations:Release"
+        filter { "system:windows", "configurations:Release" }
         links {
                 "%{libs.spirv}",
                 "%{libs.spirvcross}",
@@ -196,3 +228,56 @@ workspace "Mist"
         targetname "MistTest"
 
 
+
+    group "Tools"
+    project "MistPacker"
+        kind "ConsoleApp"
+        language "C++"
+        cppdialect "C++20"
+        
+        targetdir "%{outputdir}"
+        objdir "%{temporaldir}"
+        location "%{wks.location}/source/tools/packer"
+        
+        links { "MistEngine" }
+        files { "source/tools/packer/**.h", "source/tools/packer/**.cpp"}
+
+        defines { "MIST_VULKAN", "YAML_CPP_STATIC_DEFINE", "RBE_VK" }
+        includedirs {
+            "%{includes.mist}",
+            "%{includes.glm}",
+            "%{includes.generic}",
+            "%{includes.cppcoda}",
+            "%{includes.tracy}",
+        }
+
+        filter "configurations:Debug"
+        targetname "MistPacker_dbg"
+        filter "configurations:Release"
+        targetname "MistPacker"
+
+    project "MistRunner"
+        kind "ConsoleApp"
+        language "C++"
+        cppdialect "C++20"
+        
+        targetdir "%{outputdir}"
+        objdir "%{temporaldir}"
+        location "%{wks.location}/source/tools/runner"
+        
+        links { "MistEngine" }
+        files { "source/tools/runner/**.h", "source/tools/runner/**.cpp"}
+
+        defines { "MIST_VULKAN", "YAML_CPP_STATIC_DEFINE", "RBE_VK" }
+        includedirs {
+            "%{includes.mist}",
+            "%{includes.glm}",
+            "%{includes.generic}",
+            "%{includes.cppcoda}",
+            "%{includes.tracy}",
+        }
+
+        filter "configurations:Debug"
+        targetname "MistRunner_dbg"
+        filter "configurations:Release"
+        targetname "MistRunner"
@@ -2,7 +2,11 @@
 #include "Core/Debug.h"
 #include "Render/VulkanRenderEngine.h"
 #include "Core/Logger.h"
+#include "Core/JobSystem.h"
+#include "Core/AsyncIO.h"
+#include "Core/FileWatch.h"
 #include "Application/CmdParser.h"
+#include "Application/Benchmark.h"
 #include "Utils/FileSystem.h"
 #include "Event.h"
 #include "SDL_events.h"
@@ -16,11 +20,16 @@ namespace Mist
 	extern CIntVar CVar_ShowConsole;
 	extern CIntVar CVar_ShowStats;
 	extern CBoolVar CVar_ShowImGui;
+	extern CStrVar CVar_Archive;
 
 	CStrVar GIniFile("IniFile", "default.cfg");
 	CIntVar CVar_ResizableWindow("ResizableWindow", 0);
+	// headless runs render to offscreen images and step a fixed number of frames (benchmarks, automated runs).
+	CBoolVar CVar_Headless("Headless", false, CVarFlag_SetOnlyByCmd);
+	CIntVar CVar_BenchmarkFrames("BenchmarkFrames", 600, CVarFlag_SetOnlyByCmd);
+	CFloatVar CVar_BenchmarkDeltaTime("BenchmarkDeltaTime", 0.016f, CVarFlag_SetOnlyByCmd);
+	CStrVar CVar_BenchmarkReport("BenchmarkReport", "benchmark.json", CVarFlag_SetOnlyByCmd);
 
-	uint64_t GFrame = 0;
 	tApplication* GApp = nullptr;
 
 	SDL_WindowFlags WindowFlagsToSDL(eWindowFlags f)
@@ -99,6 +108,16 @@ namespace Mist
 		return newWindow;
 	}
 
+	Window Window::CreateHeadless(uint32_t width, uint32_t height, const char* title)
+	{
+		Window newWindow;
+		newWindow.Width = width ? width : newWindow.Width;
+		newWindow.Height = height ? height : newWindow.Height;
+		strcpy_s(newWindow.Title, title);
+		logfok("Headless window created [%4dx%4d]\n", newWindow.Width, newWindow.Height);
+		return newWindow;
+	}
+
 	void Window::CreateSurface(const Window& window, void* renderApiInstance, void* outSurface)
 	{
 		SDL_Vulkan_CreateSurface((SDL_Window*)window.WindowInstance, *((VkInstance*)renderApiInstance), (VkSurfaceKHR*)outSurface);
@@ -106,12 +125,15 @@ namespace Mist
 
 	void Window::Destroy(Window& window)
 	{
-		SDL_DestroyWindow((SDL_Window*)window.WindowInstance);
+		if (window.WindowInstance)
+			SDL_DestroyWindow((SDL_Window*)window.WindowInstance);
 		memset(&window, 0, sizeof(Window));
 	}
 
 	bool Window::IsMinimized(const Window& window)
 	{
+		if (!window.WindowInstance)
+			return false;
 		Uint32 flags = SDL_GetWindowFlags((SDL_Window*)window.WindowInstance);
 		return flags & SDL_WINDOW_MINIMIZED;
 	}
@@ -141,7 +163,7 @@ namespace Mist
 	}
 
 	tApplication::tApplication()
-		: m_windowClosed(false)
+		: m_windowClosed(false), m_windowMinimized(false)
 	{
 	}
 
@@ -191,8 +213,28 @@ namespace Mist
 			}
 		}
 
-		eWindowFlags f = fullscreen ? WindowFlags_Borderless : WindowFlags_None;
-		m_window = Window::Create(w, h, x, y, "MistEngine", f);
+		// before any asset read, archived files shadow the loose ones.
+		if (*CVar_Archive.Get() && !FileSystem::MountArchive(cAssetPath(CVar_Archive.Get())))
+			logfwarn("Archive %s not mounted, reading loose files.\n", CVar_Archive.Get());
+
+		// after cmd line and cfg file, JobWorkerCount and IOThreadCount can be set from both.
+		InitJobSystem();
+		InitAsyncIO();
+		// benchmark runs don't reload assets, a save in the middle would break determinism.
+		if (!CVar_Headless.Get())
+			InitFileWatch();
+
+		if (CVar_Headless.Get())
+		{
+			m_window = Window::CreateHeadless(w, h, "MistEngine");
+			// gpu zones resolved every frame for the report.
+			SetCVar("r_gpuProfilingRatio", "0");
+		}
+		else
+		{
+			eWindowFlags f = fullscreen ? WindowFlags_Borderless : WindowFlags_None;
+			m_window = Window::Create(w, h, x, y, "MistEngine", f);
+		}
 		m_engine = IRenderEngine::MakeInstance();
 		m_engine->Init(m_window);
 	}
@@ -203,15 +245,23 @@ namespace Mist
 		IRenderEngine::FreeRenderEngine();
 		m_engine = nullptr;
 		Window::Destroy(m_window);
+		TerminateFileWatch();
+		// completions run as jobs.
+		TerminateAsyncIO();
+		TerminateJobSystem();
+		FileSystem::UnmountArchive();
 	}
 
 	int tApplication::Run()
 	{
 		int result = 0;
+		Profiling::CpuProf_SetThreadName("Main");
+		if (CVar_Headless.Get())
+			return RunBenchmark();
 		while (!m_windowClosed)
 		{
 			PROF_FRAME_MARK("loop");
-			GFrame++;
+			AdvanceFrameCount();
 			Profiling::CpuProf_Reset();
 			CPU_PROFILE_SCOPE(CpuTime);
 
@@ -221,6 +271,8 @@ namespace Mist
 
 			// Poll window/SO events
 			ProcessAppEvents();
+			// coalesced workspace changes, listeners reload the assets affected.
+			UpdateFileWatch();
 
 			// Logic tick
 			if (m_tickTimer.CanTickAgain())
@@ -239,9 +291,49 @@ namespace Mist
 		return result;
 	}
 
+	int tApplication::RunBenchmark()
+	{
+		const uint32_t frameCount = (uint32_t)__max(CVar_BenchmarkFrames.Get(), 0);
+		const float deltaTime = CVar_BenchmarkDeltaTime.Get();
+		logfinfo("Benchmark run: %u frames, delta time %f\n", frameCount, deltaTime);
+
+		tBenchmarkReport report;
+		if (*CVar_BenchmarkReport.Get())
+			report.Open(CVar_BenchmarkReport.Get(), frameCount, deltaTime);
+
+		// every frame recorded, not only the ones sampled by r_ShowCpuProfRatio.
+		Profiling::CpuProf_SetCaptureAll(true);
+		Profiling::CpuProf_Reset();
+		int result = 0;
+		for (uint32_t i = 0; i < frameCount && !result; ++i)
+		{
+			PROF_FRAME_MARK("loop");
+			AdvanceFrameCount();
+			tTimePoint start = GetTimePoint();
+			{
+				CPU_PROFILE_SCOPE(CpuTime);
+				// simulated time, one logic tick per frame regardless of wall clock.
+				LogicProcess(deltaTime);
+				if (!m_engine->RenderProcess())
+					result = EXIT_FAILURE;
+			}
+			float cpuMs = GetMiliseconds(GetTimePoint() - start);
+			Profiling::AddCPUTime(cpuMs);
+
+			// frames don't overlap so every zone of this frame is closed when merged.
+			m_engine->WaitRenderFrame();
+			Profiling::CpuProf_Reset();
+			if (report.IsOpen())
+				report.WriteFrame(GetFrameCount(), cpuMs);
+		}
+		report.Close();
+		Profiling::CpuProf_SetCaptureAll(false);
+		return result;
+	}
+
 	uint64_t tApplication::GetFrame()
 	{
-		return GFrame;
+		return GetFrameCount();
 	}
 
 	void tApplication::ImGuiDraw()
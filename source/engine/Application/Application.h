@@ -26,6 +26,8 @@ namespace Mist
 			*Title = 0;
 		}
 		static Window Create(uint32_t width, uint32_t height, uint32_t posx, uint32_t posy, const char* title, eWindowFlags flags = WindowFlags_None);
+		// window without os window (null WindowInstance), only gives the backbuffer extent.
+		static Window CreateHeadless(uint32_t width, uint32_t height, const char* title);
 		static void CreateSurface(const Window& window, void* renderApiInstance, void* outSurface);
 		static void Destroy(Window& window);
 
@@ -53,6 +55,8 @@ namespace Mist
 	protected:
 		virtual void LogicProcess(float deltaTime);
 		void ProcessAppEvents();
+		// headless run: fixed number of frames with fixed delta time, writes the benchmark report.
+		int RunBenchmark();
 		virtual void ProcessEvent(void* e);
 		virtual void ProcessImGui() {}
 
@@ -0,0 +1,108 @@
+#include "Application/Benchmark.h"
+#include "Core/Debug.h"
+#include "Core/Logger.h"
+#include "Render/VulkanRenderEngine.h"
+#include "RenderSystem/RenderSystem.h"
+#include <stdarg.h>
+#include <float.h>
+
+namespace Mist
+{
+	bool tBenchmarkReport::Open(const char* filepath, uint32_t frameCount, float deltaTime)
+	{
+		check(!m_open);
+		if (m_file.OpenText(filepath, cFile::FileMode_Write) != cFile::Result_Ok)
+		{
+			logferror("Failed to open benchmark report file: %s\n", filepath);
+			return false;
+		}
+		m_open = true;
+		m_frameCount = 0;
+		m_cpuMin = FLT_MAX;
+		m_cpuMax = 0.f;
+		m_cpuSum = 0.0;
+		m_gpuMin = DBL_MAX;
+		m_gpuMax = 0.0;
+		m_gpuSum = 0.0;
+		Print("{\n\t\"frames\": %u,\n\t\"deltaTime\": %f,\n\t\"frameData\": [", frameCount, deltaTime);
+		return true;
+	}
+
+	void tBenchmarkReport::WriteFrame(uint64_t frame, float cpuMs)
+	{
+		check(m_open);
+		const rendersystem::RenderSystem* rs = g_render;
+		check(rs);
+		double gpuUs = rs->GetGpuTimeUs();
+		const render::CommandStats& stats = rs->GetCommandStats();
+
+		Print("%s\n\t\t{ \"frame\": %llu, \"cpuMs\": %f, \"gpuUs\": %f,", m_frameCount ? "," : "", (unsigned long long)frame, cpuMs, gpuUs);
+		Print(" \"drawCalls\": %u, \"tris\": %u, \"pipelines\": %u, \"bindingSets\": %u, \"renderTargets\": %u,",
+			stats.drawCalls, stats.tris, stats.pipelines, stats.bindingSets, stats.rts);
+
+		Print("\n\t\t\t\"cpuZones\": [");
+		m_zoneCount = 0;
+		Profiling::CpuProf_VisitLastFrame(&tBenchmarkReport::WriteCpuZone, this);
+		Print(" ],\n\t\t\t\"gpuZones\": [");
+		m_zoneCount = 0;
+		if (!rs->GetGpuQueryTree().Items.IsEmpty())
+			WriteGpuZones(0, 0);
+		Print(" ] }");
+
+		++m_frameCount;
+		m_cpuMin = __min(m_cpuMin, cpuMs);
+		m_cpuMax = __max(m_cpuMax, cpuMs);
+		m_cpuSum += cpuMs;
+		m_gpuMin = __min(m_gpuMin, gpuUs);
+		m_gpuMax = __max(m_gpuMax, gpuUs);
+		m_gpuSum += gpuUs;
+	}
+
+	void tBenchmarkReport::Close()
+	{
+		if (!m_open)
+			return;
+		double n = m_frameCount ? (double)m_frameCount : 1.0;
+		if (!m_frameCount)
+		{
+			m_cpuMin = 0.f;
+			m_gpuMin = 0.0;
+		}
+		Print("\n\t],\n\t\"summary\": { \"cpuMinMs\": %f, \"cpuMaxMs\": %f, \"cpuMeanMs\": %f, \"gpuMinUs\": %f, \"gpuMaxUs\": %f, \"gpuMeanUs\": %f }\n}\n",
+			m_cpuMin, m_cpuMax, m_cpuSum / n, m_gpuMin, m_gpuMax, m_gpuSum / n);
+		logfok("Benchmark: %u frames. Cpu %.3f ms (%.3f - %.3f). Gpu %.3f us (%.3f - %.3f)\n",
+			m_frameCount, m_cpuSum / n, m_cpuMin, m_cpuMax, m_gpuSum / n, m_gpuMin, m_gpuMax);
+		m_file.Close();
+		m_open = false;
+	}
+
+	void tBenchmarkReport::Print(const char* fmt, ...)
+	{
+		char buff[512];
+		va_list args;
+		va_start(args, fmt);
+		int len = vsprintf_s(buff, fmt, args);
+		va_end(args);
+		check(len >= 0 && len < (int)sizeof(buff));
+		m_file.Write(buff, (size_t)len);
+	}
+
+	void tBenchmarkReport::WriteCpuZone(const char* threadName, const char* zoneName, uint32_t depth, double ms, void* userData)
+	{
+		tBenchmarkReport& report = *static_cast<tBenchmarkReport*>(userData);
+		report.Print("%s\n\t\t\t\t{ \"thread\": \"%s\", \"name\": \"%s\", \"depth\": %u, \"ms\": %f }",
+			report.m_zoneCount++ ? "," : "", threadName, zoneName, depth, ms);
+	}
+
+	void tBenchmarkReport::WriteGpuZones(uint32_t itemIndex, uint32_t depth)
+	{
+		const rendersystem::GpuFrameProfiler::QueryTree& tree = g_render->GetGpuQueryTree();
+		for (uint32_t index = itemIndex; tree.IsValidIndex(index); index = tree.Items[index].Sibling)
+		{
+			const rendersystem::GpuFrameProfiler::QueryEntry& entry = tree.Data[tree.Items[index].DataIndex];
+			Print("%s\n\t\t\t\t{ \"name\": \"%s\", \"depth\": %u, \"us\": %f }",
+				m_zoneCount++ ? "," : "", entry.tag, depth, entry.value);
+			WriteGpuZones(tree.Items[index].Child, depth + 1);
+		}
+	}
+}
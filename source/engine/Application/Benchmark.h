@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Core/Types.h"
+#include "Utils/FileSystem.h"
+
+namespace Mist
+{
+	/**
+	 * Per frame timing report of a headless benchmark run, written as json:
+	 * { "frames": N, "deltaTime": dt, "frameData": [ { frame, cpuMs, gpuUs, stats, cpuZones, gpuZones }... ], "summary": {...} }
+	 * Cpu zones are the ones merged by the last CpuProf_Reset, gpu zones the last query tree resolved
+	 * by the render system, so with the render thread enabled both are one or more frames behind.
+	 */
+	class tBenchmarkReport
+	{
+	public:
+		bool Open(const char* filepath, uint32_t frameCount, float deltaTime);
+		void WriteFrame(uint64_t frame, float cpuMs);
+		void Close();
+		inline bool IsOpen() const { return m_open; }
+
+	private:
+		void Print(const char* fmt, ...);
+
+		static void WriteCpuZone(const char* threadName, const char* zoneName, uint32_t depth, double ms, void* userData);
+		void WriteGpuZones(uint32_t itemIndex, uint32_t depth);
+
+	private:
+		cFile m_file;
+		bool m_open = false;
+		uint32_t m_frameCount = 0;
+		uint32_t m_zoneCount = 0;
+		float m_cpuMin = 0.f;
+		float m_cpuMax = 0.f;
+		double m_cpuSum = 0.0;
+		double m_gpuMin = 0.0;
+		double m_gpuMax = 0.0;
+		double m_gpuSum = 0.0;
+	};
+}
@@ -1,46 +1,84 @@
 #include "Application/CmdParser.h"
 #include "Core/Debug.h"
 #include "Core/Logger.h"
+#include "Core/Console.h"
 #include "Core/Types.h"
 #include "Utils/GenericUtils.h"
+#include "Utils/TimeUtils.h"
 
 namespace Mist
 {
-#define MAX_VAR_COUNT 100
-	CVar* VarArray[MAX_VAR_COUNT];
-	uint32_t VarArrayIndex = 0;
+	struct tCVarRegistry
+	{
+		// registration order, used to list and draw cvars.
+		tDynArray<CVar*> Vars;
+		// hashed by case insensitive name.
+		tNameIndex Index;
+	};
 
+	// case insensitive name hash. Names longer than a cvar name can't match, they are hashed truncated.
+	uint64_t HashCVarName(const char* name)
+	{
+		char lower[CVar::MaxNameSize];
+		uint32_t length = 0;
+		for (; name[length] && length < sizeof(lower); ++length)
+			lower[length] = (char)tolower((uint8_t)name[length]);
+		return HashBytes(lower, length);
+	}
+
+	// cvars are registered from static constructors, so the registry is built on first use.
+	tCVarRegistry& GetCVarRegistry()
+	{
+		static tCVarRegistry registry;
+		return registry;
+	}
 
 	void NewCVar(CVar* var)
 	{
-		check(VarArrayIndex < MAX_VAR_COUNT);
 		check(var);
 		CVar* v = FindCVar(var->GetName());
 		check(!v);
 
-		VarArray[VarArrayIndex] = var;
-		++VarArrayIndex;
+		tCVarRegistry& registry = GetCVarRegistry();
+		registry.Index.Insert(var->GetNameHash(), (uint32_t)registry.Vars.size());
+		registry.Vars.push_back(var);
+	}
+
+	void RemoveCVar(CVar* var)
+	{
+		tCVarRegistry& registry = GetCVarRegistry();
+		uint32_t index = registry.Index.Find(var->GetNameHash(), [&](uint32_t i) { return registry.Vars[i] == var; });
+		check(index != tNameIndex::InvalidItem);
+		registry.Index.Remove(var->GetNameHash(), index);
+		uint32_t last = (uint32_t)registry.Vars.size() - 1;
+		if (index != last)
+		{
+			CVar* moved = registry.Vars[last];
+			registry.Vars[index] = moved;
+			registry.Index.Replace(moved->GetNameHash(), last, index);
+		}
+		registry.Vars.pop_back();
 	}
 
 	CVar** GetCVarArray()
 	{
-		return VarArray;
+		return GetCVarRegistry().Vars.data();
 	}
 
 	uint32_t GetCVarCount()
 	{
-		return VarArrayIndex;
+		return (uint32_t)GetCVarRegistry().Vars.size();
 	}
 
 	CVar* FindCVar(const char* name)
 	{
 		check(name && *name);
-		for (uint32_t i = 0; i < VarArrayIndex; ++i)
-		{
-			if (!_stricmp(name, VarArray[i]->GetName()))
-				return VarArray[i];
-		}
-		return nullptr;
+		tCVarRegistry& registry = GetCVarRegistry();
+		uint32_t index = registry.Index.Find(HashCVarName(name), [&](uint32_t i)
+			{
+				return !_stricmp(name, registry.Vars[i]->GetName());
+			});
+		return index != tNameIndex::InvalidItem ? registry.Vars[index] : nullptr;
 	}
 
 	bool SetCVar(const char* name, const char* strValue)
@@ -143,19 +181,19 @@ namespace Mist
 		if (!wildstr || !*wildstr)
 		{
 			loginfo("CVar list:\n");
-			for (uint32_t i = 0; i < VarArrayIndex; ++i)
+			for (CVar* cvar : GetCVarRegistry().Vars)
 			{
-				PrintCVar(VarArray[i]);
+				PrintCVar(cvar);
 			}
 			loginfo("**********\n");
 		}
 		else
 		{
 			logfinfo("cvarlist coincidences with \"%s\"\n", wildstr);
-			for (uint32_t i = 0; i < VarArrayIndex; ++i)
+			for (CVar* cvar : GetCVarRegistry().Vars)
 			{
-				if (WildStricmp(wildstr, VarArray[i]->GetName()))
-					PrintCVar(VarArray[i]);
+				if (WildStricmp(wildstr, cvar->GetName()))
+					PrintCVar(cvar);
 			}
 			loginfo("**********\n");
 		}
@@ -261,25 +299,76 @@ namespace Mist
 		return ret;
 	}
 
-	void ImGuiDrawCVars()
+	void BenchmarkCVarLookup()
 	{
-		uint32_t count = GetCVarCount();
-		CVar** cvarArray = GetCVarArray();
-		for (uint32_t i = 0; i < count; ++i)
+		static constexpr uint32_t BenchVarCount = 4096;
+		static constexpr uint32_t Rounds = 16;
+		CIntVar** vars = (CIntVar**)_malloc(sizeof(CIntVar*) * BenchVarCount);
+		char(*names)[64] = (char(*)[64])_malloc(64 * BenchVarCount);
+		for (uint32_t i = 0; i < BenchVarCount; ++i)
 		{
-			CVar* cvar = cvarArray[i];
-			if (!(cvar->GetFlags() & CVarFlag_Private))
-				ImGuiUtils::EditCVar(*cvar);
+			sprintf_s(names[i], 64, "bench_cvar_%04d", i);
+			vars[i] = _new CIntVar(names[i], (int32_t)i, CVarFlag_Private);
 		}
+
+		uint32_t found = 0;
+		tTimePoint start = GetTimePoint();
+		for (uint32_t r = 0; r < Rounds; ++r)
+		{
+			for (uint32_t i = 0; i < BenchVarCount; ++i)
+				found += FindCVar(names[i]) != nullptr;
+		}
+		float hashedMs = GetMiliseconds(GetTimePoint() - start);
+
+		start = GetTimePoint();
+		for (uint32_t i = 0; i < BenchVarCount; ++i)
+		{
+			CVar** cvars = GetCVarArray();
+			for (uint32_t j = 0; j < GetCVarCount(); ++j)
+			{
+				if (!_stricmp(names[i], cvars[j]->GetName()))
+				{
+					++found;
+					break;
+				}
+			}
+		}
+		float linearMs = GetMiliseconds(GetTimePoint() - start) * Rounds;
+		check(found == BenchVarCount * (Rounds + 1));
+
+		uint32_t lookups = BenchVarCount * Rounds;
+		logfinfo("CVar lookup with %d cvars: hashed %8.2f ns/lookup | linear %8.2f ns/lookup\n",
+			GetCVarCount(), hashedMs * 1e6f / lookups, linearMs * 1e6f / lookups);
+
+		for (uint32_t i = BenchVarCount - 1; i < BenchVarCount; --i)
+			delete vars[i];
+		Mist::Free(names);
+		Mist::Free(vars);
+	}
+
+	void ExecCommand_BenchmarkCVarLookup(const char* command)
+	{
+		BenchmarkCVarLookup();
+	}
+
+	void InitCVars()
+	{
+		AddConsoleCommand("c_cvarbench", &ExecCommand_BenchmarkCVarLookup);
 	}
 
 	CVar::CVar(const char* name, CVarType type, tCVarFlags flags) : Name{ 0 }, Type(type), Flags(flags)
 	{
 		check(name && *name);
 		strcpy_s(Name, name);
+		NameHash = HashCVarName(Name);
 		NewCVar(this);
 	}
 
+	CVar::~CVar()
+	{
+		RemoveCVar(this);
+	}
+
 	CIntVar::CIntVar(const char* name, int32_t defaultValue, tCVarFlags flags)
 		: CVar(name, CVarType::Int, flags)
 	{
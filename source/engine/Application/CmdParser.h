@@ -2,6 +2,7 @@
 
 #include <unordered_map>
 #include <string>
+#include "Core/Platform.h"
 
 namespace Mist
 {
@@ -19,8 +20,10 @@ namespace Mist
 	{
 	public:
 		enum class CVarType { Int, Float, Bool, String };
+		static constexpr uint32_t MaxNameSize = 64;
 	private:
-		char Name[64];
+		char Name[MaxNameSize];
+		uint64_t NameHash;
 		CVarType Type;
 		tCVarFlags Flags;
 	protected:
@@ -35,8 +38,10 @@ namespace Mist
 		uValue DefaultValue;
 	public:
 		CVar(const char* name, CVarType type, tCVarFlags flags);
+		~CVar();
 
 		inline const char* GetName() const { return Name; }
+		inline uint64_t GetNameHash() const { return NameHash; }
 		inline CVarType GetType() const { return Type; }
 		void Reset() { memcpy_s(&Value, sizeof(uValue), &DefaultValue, sizeof(uValue)); }
 		inline bool HasFlag(tCVarFlags flag) const { return Flags & flag; }
@@ -88,6 +93,9 @@ namespace Mist
 	bool ExecCommand_CVar(const char* cmd);
 	// iterate over all cvars and show the right imgui widget. Does not create a window.
 	void ImGuiDrawCVars();
+	// registers a few thousand temporary cvars and logs hashed vs linear lookup times.
+	void BenchmarkCVarLookup();
+	void InitCVars();
 
 	class CmdParser
 	{
@@ -1,6 +1,5 @@
 
 #include "Application/Event.h"
-#include <windows.h>
 #include <cstdint>
 #include <imgui/imgui.h>
 #include "SDL_scancode.h"
@@ -0,0 +1,555 @@
+#include "Core/AsyncIO.h"
+#include "Core/Types.h"
+#include "Core/Debug.h"
+#include "Core/Logger.h"
+#include "Core/Console.h"
+#include "Core/JobSystem.h"
+#include "Core/Platform.h"
+#include "Core/SystemMemory.h"
+#include "Application/CmdParser.h"
+#include "Core/TestUtils.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Mist
+{
+	CIntVar CVar_IOThreadCount("IOThreadCount", 2);
+	CIntVar CVar_IOMaxInFlightMB("IOMaxInFlightMB", 256);
+	CStrVar CVar_IOTestDirectory("IOTestDirectory", "models/sponza");
+
+	namespace asyncio
+	{
+		static constexpr uint32_t MaxThreads = 8;
+		// stride to fault in the pages of a mapped file.
+		static constexpr size_t PageSize = 4096;
+
+		struct tRequestQueue
+		{
+			tIORequest* Head = nullptr;
+			tIORequest* Tail = nullptr;
+		};
+
+		struct tAsyncIO
+		{
+			std::thread Threads[MaxThreads];
+			uint32_t ThreadCount = 0;
+			std::atomic<bool> Running = false;
+			// queues, budget and request status changes out of Queued.
+			std::mutex Mutex;
+			std::condition_variable Condition;
+			tRequestQueue Queues[IOPriority_Count];
+			uint64_t MaxInFlightBytes = 0;
+			uint64_t InFlightBytes = 0;
+			uint64_t PeakInFlightBytes = 0;
+
+			std::atomic<uint64_t> Requests = 0;
+			std::atomic<uint64_t> Failed = 0;
+			std::atomic<uint64_t> Cancelled = 0;
+			std::atomic<uint64_t> BytesRead = 0;
+			std::atomic<uint64_t> ReadUs = 0;
+		};
+
+		tAsyncIO GAsyncIO;
+
+		// queue lock held.
+		void PushRequest(tIORequest* request)
+		{
+			tRequestQueue& queue = GAsyncIO.Queues[request->Priority];
+			request->Prev = queue.Tail;
+			request->Next = nullptr;
+			if (queue.Tail)
+				queue.Tail->Next = request;
+			else
+				queue.Head = request;
+			queue.Tail = request;
+		}
+
+		// queue lock held.
+		void RemoveRequest(tIORequest* request)
+		{
+			tRequestQueue& queue = GAsyncIO.Queues[request->Priority];
+			if (request->Prev)
+				request->Prev->Next = request->Next;
+			else
+				queue.Head = request->Next;
+			if (request->Next)
+				request->Next->Prev = request->Prev;
+			else
+				queue.Tail = request->Prev;
+			request->Prev = nullptr;
+			request->Next = nullptr;
+		}
+
+		// queue lock held. Null when nothing can be read now.
+		tIORequest* PopRequest()
+		{
+			for (uint32_t i = 0; i < IOPriority_Count; ++i)
+			{
+				tIORequest* request = GAsyncIO.Queues[i].Head;
+				if (!request)
+					continue;
+				// over budget only high priority goes on. With nothing in flight one read is always allowed.
+				if (i != IOPriority_High && GAsyncIO.InFlightBytes && GAsyncIO.InFlightBytes >= GAsyncIO.MaxInFlightBytes)
+					return nullptr;
+				RemoveRequest(request);
+				request->Status.store(IOStatus_Reading, std::memory_order_release);
+				return request;
+			}
+			return nullptr;
+		}
+
+		void FinishRequest(tIORequest* request)
+		{
+			if (!request->Callback)
+			{
+				request->Finished.store(true, std::memory_order_release);
+				return;
+			}
+			RunJob([request]()
+				{
+					request->Callback(*request, request->UserData);
+					request->Finished.store(true, std::memory_order_release);
+				});
+		}
+
+		void ReadRequest(tIORequest* request)
+		{
+			Profiling::sProfilingTimer timer;
+			timer.Start();
+			bool result = request->File.Open(request->Path, cMappedFile::Access_Sequential);
+			size_t size = request->File.GetSize();
+			if (result && request->File.IsMapped() && size)
+			{
+				// mapping reads nothing yet, fault the pages in here so the decoder doesn't stall on disk.
+				request->File.Prefetch(0, size);
+				const volatile uint8_t* bytes = static_cast<const volatile uint8_t*>(request->File.GetData());
+				uint8_t touch = 0;
+				for (size_t i = 0; i < size; i += PageSize)
+					touch ^= bytes[i];
+				(void)touch;
+			}
+			double ms = timer.Stop();
+
+			if (result)
+			{
+				std::lock_guard<std::mutex> lock(GAsyncIO.Mutex);
+				request->Bytes = size;
+				GAsyncIO.InFlightBytes += size;
+				GAsyncIO.PeakInFlightBytes = __max(GAsyncIO.PeakInFlightBytes, GAsyncIO.InFlightBytes);
+			}
+			else
+			{
+				logferror("Async read failed: %s\n", request->Path);
+				GAsyncIO.Failed.fetch_add(1, std::memory_order_relaxed);
+			}
+			GAsyncIO.BytesRead.fetch_add(size, std::memory_order_relaxed);
+			GAsyncIO.ReadUs.fetch_add((uint64_t)(ms * 1000.0), std::memory_order_relaxed);
+			request->Status.store(result ? IOStatus_Done : IOStatus_Failed, std::memory_order_release);
+			FinishRequest(request);
+		}
+
+		void IOThreadMain(uint32_t index)
+		{
+			char name[32];
+			sprintf_s(name, "IO thread %d", index);
+			Profiling::CpuProf_SetThreadName(name);
+			while (true)
+			{
+				tIORequest* request = nullptr;
+				{
+					std::unique_lock<std::mutex> lock(GAsyncIO.Mutex);
+					GAsyncIO.Condition.wait(lock, [&request]()
+						{
+							request = PopRequest();
+							return request || !GAsyncIO.Running.load(std::memory_order_relaxed);
+						});
+				}
+				if (!request)
+					break;
+				ReadRequest(request);
+			}
+		}
+	}
+
+	void ExecCommand_DumpIOStats(const char* command)
+	{
+		tIOStats stats = GetIOStats();
+		loginfo("****************** Async io stats ******************\n");
+		logfinfo("Requests:	%10lld (failed %lld, cancelled %lld)\n", stats.Requests, stats.Failed, stats.Cancelled);
+		logfinfo("Read:		%10.2f MB in %.2f ms\n", (double)stats.BytesRead / (1024.0 * 1024.0), stats.ReadMs);
+		logfinfo("In flight:	%10.2f MB (peak %.2f MB)\n", (double)stats.InFlightBytes / (1024.0 * 1024.0), (double)stats.PeakInFlightBytes / (1024.0 * 1024.0));
+		loginfo("****************************************************\n");
+	}
+
+	void ExecCommand_TestAsyncIO(const char* command)
+	{
+		TestAsyncIO();
+	}
+
+	void InitAsyncIO(uint32_t threadCount)
+	{
+		using namespace asyncio;
+		check(!GAsyncIO.ThreadCount && "Async io already initialized");
+		if (!threadCount)
+			threadCount = CVar_IOThreadCount.Get() > 0 ? (uint32_t)CVar_IOThreadCount.Get() : 1;
+		threadCount = threadCount < MaxThreads ? threadCount : MaxThreads;
+		GAsyncIO.MaxInFlightBytes = (uint64_t)__max(CVar_IOMaxInFlightMB.Get(), 1) << 20;
+		{
+			std::lock_guard<std::mutex> lock(GAsyncIO.Mutex);
+			GAsyncIO.Running.store(true, std::memory_order_release);
+		}
+		GAsyncIO.ThreadCount = threadCount;
+		for (uint32_t i = 0; i < threadCount; ++i)
+			GAsyncIO.Threads[i] = std::thread(&IOThreadMain, i);
+		logfinfo("Async io: %d threads, %d MB in flight.\n", threadCount, (int)(GAsyncIO.MaxInFlightBytes >> 20));
+
+		AddConsoleCommand("io_stats", &ExecCommand_DumpIOStats);
+		AddConsoleCommand("io_test", &ExecCommand_TestAsyncIO);
+	}
+
+	void TerminateAsyncIO()
+	{
+		using namespace asyncio;
+		if (!GAsyncIO.ThreadCount)
+			return;
+		tIORequest* cancelled = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(GAsyncIO.Mutex);
+			GAsyncIO.Running.store(false, std::memory_order_release);
+			for (uint32_t i = 0; i < IOPriority_Count; ++i)
+			{
+				while (tIORequest* request = GAsyncIO.Queues[i].Head)
+				{
+					RemoveRequest(request);
+					request->Status.store(IOStatus_Cancelled, std::memory_order_release);
+					request->Next = cancelled;
+					cancelled = request;
+				}
+			}
+		}
+		GAsyncIO.Condition.notify_all();
+		for (uint32_t i = 0; i < GAsyncIO.ThreadCount; ++i)
+			GAsyncIO.Threads[i].join();
+		GAsyncIO.ThreadCount = 0;
+		while (cancelled)
+		{
+			tIORequest* next = cancelled->Next;
+			cancelled->Next = nullptr;
+			GAsyncIO.Cancelled.fetch_add(1, std::memory_order_relaxed);
+			FinishRequest(cancelled);
+			cancelled = next;
+		}
+	}
+
+	bool IsAsyncIORunning()
+	{
+		return asyncio::GAsyncIO.Running.load(std::memory_order_acquire);
+	}
+
+	tIORequest* ReadFileAsync(const char* filepath, eIOPriority priority, tIOCallback callback, void* userData)
+	{
+		using namespace asyncio;
+		check(filepath && *filepath && priority < IOPriority_Count);
+		tIORequest* request = _new tIORequest();
+		strcpy_s(request->Path, filepath);
+		request->Callback = callback;
+		request->UserData = userData;
+		request->Priority = priority;
+		request->Status.store(IOStatus_Queued, std::memory_order_relaxed);
+		request->Finished.store(false, std::memory_order_relaxed);
+		request->Bytes = 0;
+		request->Prev = nullptr;
+		request->Next = nullptr;
+		GAsyncIO.Requests.fetch_add(1, std::memory_order_relaxed);
+		{
+			std::lock_guard<std::mutex> lock(GAsyncIO.Mutex);
+			if (GAsyncIO.Running.load(std::memory_order_relaxed))
+				PushRequest(request);
+			else
+				request->Status.store(IOStatus_Reading, std::memory_order_release);
+		}
+		if (request->Status.load(std::memory_order_relaxed) == IOStatus_Queued)
+			GAsyncIO.Condition.notify_one();
+		else
+			ReadRequest(request);
+		return request;
+	}
+
+	bool CancelIORequest(tIORequest* request)
+	{
+		using namespace asyncio;
+		check(request);
+		{
+			std::lock_guard<std::mutex> lock(GAsyncIO.Mutex);
+			if (request->Status.load(std::memory_order_relaxed) != IOStatus_Queued)
+				return false;
+			RemoveRequest(request);
+			request->Status.store(IOStatus_Cancelled, std::memory_order_release);
+		}
+		GAsyncIO.Cancelled.fetch_add(1, std::memory_order_relaxed);
+		FinishRequest(request);
+		return true;
+	}
+
+	void WaitIORequest(tIORequest* request)
+	{
+		using namespace asyncio;
+		check(request);
+		if (request->Status.load(std::memory_order_acquire) == IOStatus_Queued)
+		{
+			bool promoted = false;
+			{
+				std::lock_guard<std::mutex> lock(GAsyncIO.Mutex);
+				if (request->Status.load(std::memory_order_relaxed) == IOStatus_Queued && request->Priority != IOPriority_High)
+				{
+					RemoveRequest(request);
+					request->Priority = IOPriority_High;
+					PushRequest(request);
+					promoted = true;
+				}
+			}
+			if (promoted)
+				GAsyncIO.Condition.notify_one();
+		}
+		while (!request->IsFinished())
+		{
+			if (!ExecutePendingJob())
+				std::this_thread::yield();
+		}
+	}
+
+	void ReleaseIORequest(tIORequest* request)
+	{
+		using namespace asyncio;
+		if (!request)
+			return;
+		WaitIORequest(request);
+		if (request->Bytes)
+		{
+			{
+				std::lock_guard<std::mutex> lock(GAsyncIO.Mutex);
+				check(GAsyncIO.InFlightBytes >= request->Bytes);
+				GAsyncIO.InFlightBytes -= request->Bytes;
+			}
+			GAsyncIO.Condition.notify_all();
+		}
+		delete request;
+	}
+
+	tIOStats GetIOStats()
+	{
+		using namespace asyncio;
+		tIOStats stats;
+		stats.Requests = GAsyncIO.Requests.load(std::memory_order_relaxed);
+		stats.Failed = GAsyncIO.Failed.load(std::memory_order_relaxed);
+		stats.Cancelled = GAsyncIO.Cancelled.load(std::memory_order_relaxed);
+		stats.BytesRead = GAsyncIO.BytesRead.load(std::memory_order_relaxed);
+		stats.ReadMs = (double)GAsyncIO.ReadUs.load(std::memory_order_relaxed) * 1e-3;
+		std::lock_guard<std::mutex> lock(GAsyncIO.Mutex);
+		stats.InFlightBytes = GAsyncIO.InFlightBytes;
+		stats.PeakInFlightBytes = GAsyncIO.PeakInFlightBytes;
+		return stats;
+	}
+
+	namespace asyncio
+	{
+		struct tTestFile
+		{
+			char Path[512];
+			uint64_t Checksum;
+			size_t Size;
+		};
+
+		struct tTestResult
+		{
+			uint64_t Checksum;
+			size_t Size;
+			// position in completion order.
+			uint32_t Order;
+			std::atomic<uint32_t>* Completed;
+		};
+
+		struct tTestCollector
+		{
+			const char* Directory;
+			tDynArray<tTestFile>* Files;
+		};
+
+		void CollectTestFile(const char* path, void* userData)
+		{
+			tTestCollector& collector = *static_cast<tTestCollector*>(userData);
+			tTestFile file;
+			sprintf_s(file.Path, "%s/%s", collector.Directory, path);
+			file.Checksum = 0;
+			file.Size = 0;
+			collector.Files->push_back(file);
+		}
+
+		uint64_t Checksum(const void* data, size_t size)
+		{
+			// FNV-1a over words, tail bytewise.
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			uint64_t hash = 0xcbf29ce484222325ull;
+			size_t i = 0;
+			for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+			{
+				uint64_t word;
+				memcpy(&word, bytes + i, sizeof(uint64_t));
+				hash = (hash ^ word) * 0x100000001b3ull;
+			}
+			for (; i < size; ++i)
+				hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+			return hash;
+		}
+
+		// stands for the decoder: runs on a job worker while the io threads keep reading.
+		void TestCallback(tIORequest& request, void* userData)
+		{
+			tTestResult& result = *static_cast<tTestResult*>(userData);
+			result.Order = result.Completed->fetch_add(1, std::memory_order_relaxed);
+			if (request.IsDone())
+			{
+				result.Checksum = Checksum(request.GetData(), request.GetSize());
+				result.Size = request.GetSize();
+			}
+		}
+
+		// no work in the callback, so the completion order follows the read order and not the job queue.
+		void OrderCallback(tIORequest& request, void* userData)
+		{
+			tTestResult& result = *static_cast<tTestResult*>(userData);
+			result.Order = result.Completed->fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	bool TestAsyncIO()
+	{
+		using namespace asyncio;
+		if (!IsAsyncIORunning() || GetJobThreadIndex() != 0)
+		{
+			logerror("Async io tests must run on the main thread with async io running.\n");
+			return false;
+		}
+		char directory[256];
+		cAssetPath::GetWorkspacePath(directory, CVar_IOTestDirectory.Get());
+		tDynArray<tTestFile> files;
+		tTestCollector collector = { directory, &files };
+		Platform::VisitDirectoryFiles(directory, true, &CollectTestFile, &collector);
+		if (files.empty())
+		{
+			logferror("Async io test without files: %s\n", directory);
+			return false;
+		}
+		uint32_t count = (uint32_t)files.size();
+
+		// reference pass, also leaves the files in the os cache so both timed passes read from memory.
+		size_t totalBytes = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			cMappedFile file;
+			if (file.Open(files[i].Path))
+			{
+				files[i].Checksum = Checksum(file.GetData(), file.GetSize());
+				files[i].Size = file.GetSize();
+				totalBytes += file.GetSize();
+			}
+		}
+
+		loginfo("****************** Async io tests ******************\n");
+		bool result = true;
+		Profiling::sProfilingTimer timer;
+
+		// read and hash one file after the other on this thread.
+		timer.Start();
+		uint64_t syncChecksum = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			cMappedFile file;
+			if (file.Open(files[i].Path))
+				syncChecksum ^= Checksum(file.GetData(), file.GetSize());
+		}
+		double syncMs = timer.Stop();
+
+		// same work through the io service, hashing on the job workers.
+		tDynArray<tTestResult> results(count);
+		tDynArray<tIORequest*> requests(count);
+		std::atomic<uint32_t> completed = 0;
+		timer.Start();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			results[i] = { 0, 0, 0, &completed };
+			requests[i] = ReadFileAsync(files[i].Path, IOPriority_Normal, &TestCallback, &results[i]);
+		}
+		bool valid = true;
+		uint64_t asyncChecksum = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			WaitIORequest(requests[i]);
+			valid &= requests[i]->IsDone() && results[i].Checksum == files[i].Checksum && results[i].Size == files[i].Size;
+			asyncChecksum ^= results[i].Checksum;
+			ReleaseIORequest(requests[i]);
+		}
+		double asyncMs = timer.Stop();
+		result &= TestResult(valid && asyncChecksum == syncChecksum, "Async io", "data");
+
+		// cancel every other request of a batch. Cancelled ones still finish with their callback.
+		completed = 0;
+		uint32_t cancelledCount = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			results[i] = { 0, 0, 0, &completed };
+			requests[i] = ReadFileAsync(files[i].Path, IOPriority_Low, &TestCallback, &results[i]);
+		}
+		bool cancelled[2] = { true, true };
+		for (uint32_t i = 1; i < count; i += 2)
+		{
+			if (CancelIORequest(requests[i]))
+			{
+				++cancelledCount;
+				cancelled[0] &= requests[i]->Status.load() == IOStatus_Cancelled;
+			}
+		}
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			WaitIORequest(requests[i]);
+			eIOStatus status = requests[i]->Status.load();
+			cancelled[1] &= status == IOStatus_Cancelled || (status == IOStatus_Done && results[i].Checksum == files[i].Checksum);
+			ReleaseIORequest(requests[i]);
+		}
+		result &= TestResult(cancelled[0] && cancelled[1] && completed.load() == count, "Async io", "cancellation");
+
+		// a high priority request behind a full low priority queue only waits for the reads already started.
+		// reads already started when it is submitted can finish first (all of them when reads are faster than submissions).
+		completed = 0;
+		uint32_t startedBeforeHigh = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			results[i] = { 0, 0, 0, &completed };
+			if (i == count - 1)
+			{
+				for (uint32_t j = 0; j < i; ++j)
+					startedBeforeHigh += requests[j]->Status.load() != IOStatus_Queued ? 1 : 0;
+			}
+			requests[i] = ReadFileAsync(files[i].Path, i == count - 1 ? IOPriority_High : IOPriority_Low, &OrderCallback, &results[i]);
+		}
+		WaitIORequest(requests[count - 1]);
+		uint32_t highOrder = results[count - 1].Order;
+		for (uint32_t i = 0; i < count; ++i)
+			ReleaseIORequest(requests[i]);
+		// slack for the reads popped after counting and callbacks finishing out of order on the workers.
+		result &= TestResult(highOrder <= startedBeforeHigh + GAsyncIO.ThreadCount * 2, "Async io", "priority");
+
+		tIOStats stats = GetIOStats();
+		result &= TestResult(!stats.InFlightBytes, "Async io", "budget released");
+
+		double mb = (double)totalBytes / (1024.0 * 1024.0);
+		logfinfo("Files: %d (%.2f MB), cancelled %d, high priority finished %d of %d (%d started before its submission)\n",
+			count, mb, cancelledCount, highOrder + 1, count, startedBeforeHigh);
+		logfinfo("Sync read + hash:	%8.2f ms (%8.2f MB/s)\n", syncMs, mb * 1000.0 / __max(syncMs, 1e-3));
+		logfinfo("Async read + hash:	%8.2f ms (%8.2f MB/s)\n", asyncMs, mb * 1000.0 / __max(asyncMs, 1e-3));
+		logfinfo("Peak in flight:	%8.2f MB (budget %d MB)\n", (double)stats.PeakInFlightBytes / (1024.0 * 1024.0), (int)(GAsyncIO.MaxInFlightBytes >> 20));
+		loginfo("****************************************************\n");
+		return result;
+	}
+}
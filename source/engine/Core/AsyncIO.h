@@ -0,0 +1,101 @@
+// header file for Mist project
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include "Utils/FileSystem.h"
+
+/**
+ * Asynchronous file reads. Dedicated I/O threads take queued requests by priority (FIFO inside the
+ * same priority) and bring the whole file to memory: mapped view with its pages read in, or a
+ * buffered read when the file can't be mapped. When a request finishes its callback runs as a job,
+ * so decoding happens on the job workers while the I/O threads already read the next files.
+ * File data is valid until the request is released. Bytes read and not released yet are bounded by
+ * IOMaxInFlightMB: once over budget the I/O threads only take high priority requests until the
+ * owners release enough data. Waiting for a queued request promotes it to high priority, so a
+ * waiter never depends on the budget.
+ */
+
+namespace Mist
+{
+	enum eIOPriority
+	{
+		// something is waiting for the data, ignores the in flight budget.
+		IOPriority_High,
+		IOPriority_Normal,
+		// prefetch, read when nothing else is queued.
+		IOPriority_Low,
+		IOPriority_Count
+	};
+
+	enum eIOStatus : uint32_t
+	{
+		IOStatus_Queued,
+		IOStatus_Reading,
+		IOStatus_Done,
+		IOStatus_Failed,
+		IOStatus_Cancelled,
+	};
+
+	struct tIORequest;
+
+	// runs on a job thread once the request is done, failed or cancelled. The request must not be released here.
+	typedef void (*tIOCallback)(tIORequest& request, void* userData);
+
+	struct tIORequest
+	{
+		char Path[256];
+		cMappedFile File;
+		tIOCallback Callback;
+		void* UserData;
+		// guarded by the queue lock while queued.
+		eIOPriority Priority;
+		std::atomic<eIOStatus> Status;
+		// status is final and the callback returned.
+		std::atomic<bool> Finished;
+		// bytes charged to the in flight budget until release.
+		size_t Bytes;
+		// queue link, owned by the io service.
+		tIORequest* Prev;
+		tIORequest* Next;
+
+		inline bool IsDone() const { return Status.load(std::memory_order_acquire) == IOStatus_Done; }
+		inline bool IsFinished() const { return Finished.load(std::memory_order_acquire); }
+		// valid once done until release. Null for empty files.
+		inline const void* GetData() const { return File.GetData(); }
+		inline size_t GetSize() const { return File.GetSize(); }
+	};
+
+	struct tIOStats
+	{
+		uint64_t Requests;
+		uint64_t Failed;
+		uint64_t Cancelled;
+		uint64_t BytesRead;
+		// accumulated time of the io threads reading.
+		double ReadMs;
+		uint64_t InFlightBytes;
+		uint64_t PeakInFlightBytes;
+	};
+
+	// threadCount 0 takes CVar IOThreadCount.
+	void InitAsyncIO(uint32_t threadCount = 0);
+	// queued requests are cancelled, the ones being read are finished.
+	void TerminateAsyncIO();
+	bool IsAsyncIORunning();
+
+	// path used as given, like cMappedFile. Without io threads running the file is read on the calling thread.
+	tIORequest* ReadFileAsync(const char* filepath, eIOPriority priority = IOPriority_Normal, tIOCallback callback = nullptr, void* userData = nullptr);
+	// removes a queued request, its callback runs with IOStatus_Cancelled. False if the read already started.
+	bool CancelIORequest(tIORequest* request);
+	// waits until the request is finished, executing jobs meanwhile (safe inside jobs).
+	void WaitIORequest(tIORequest* request);
+	// waits for the request and frees it together with its file data.
+	void ReleaseIORequest(tIORequest* request);
+
+	tIOStats GetIOStats();
+
+	// Reads the files of CVar IOTestDirectory through the io service, checks data, priorities and
+	// cancellation against synchronous reads and logs throughput.
+	bool TestAsyncIO();
+}
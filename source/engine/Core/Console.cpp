@@ -3,36 +3,23 @@
 #include <cstdio>
 #include <stdarg.h>
 #include <string>
-#include <Windows.h>
-#include <debugapi.h>
 #include <string.h>
-#include <imgui/imgui.h>
 #include "Core/SystemMemory.h"
 #include "Application/CmdParser.h"
-#include "Application/Application.h"
 #include "Utils/TimeUtils.h"
-#include "Utils/GenericUtils.h"
-#include "RenderSystem/UI.h"
 
 
 namespace Mist
 {
-	CIntVar CVar_ShowConsole("ShowConsole", 0);
+	CIntVar CVar_ConsoleLogBudget("ConsoleLogBudgetKB", 1024);
 
 	Console g_Console;
 
-	extern ImVec4 LogLevelImGuiColor(LogLevel level);
-
 	void AddConsoleCommand(const char* cmdname, FnExecCommandCallback fn)
 	{
 		g_Console.AddCommandCallback(cmdname, fn);
 	}
 
-	void DrawConsole()
-	{
-		g_Console.Draw();
-	}
-
 	void FlushPendingConsoleCommands()
 	{
 		g_Console.ExecuteDeferredCommand();
@@ -43,40 +30,135 @@ namespace Mist
 		g_Console.Log(level, msg);
 	}
 
+	void TerminateConsoleLog()
+	{
+		g_Console.ReleaseLogs();
+	}
+
+	tConsoleLogHistory::~tConsoleLogHistory()
+	{
+		SetBudget(0);
+	}
+
+	void tConsoleLogHistory::SetBudget(uint32_t bytes)
+	{
+		if (m_data)
+			Mist::Free(m_data);
+		if (m_lines)
+			Mist::Free(m_lines);
+		m_data = bytes ? (char*)_malloc(bytes) : nullptr;
+		m_size = bytes;
+		m_head = 0;
+		m_lines = nullptr;
+		m_lineCapacity = 0;
+		m_firstLine += m_lineCount;
+		m_lineStart = 0;
+		m_lineCount = 0;
+	}
+
+	char* tConsoleLogHistory::Push(LogLevel level, uint32_t length)
+	{
+		check(m_data);
+		length = __min(length, m_size);
+		bool wrap = m_head + length > m_size;
+		uint32_t offset = wrap ? 0 : m_head;
+		// lines ahead of the head are the oldest ones. When wrapping, the tail of the arena is
+		// discarded and everything overlapping the new range is evicted.
+		while (m_lineCount)
+		{
+			const tLine& oldest = GetLine(m_firstLine);
+			bool inTail = wrap && oldest.Offset >= m_head;
+			bool overlaps = oldest.Offset < offset + length && offset < oldest.Offset + oldest.Length;
+			if (!inTail && !overlaps)
+				break;
+			PopLine();
+		}
+		PushLine({ offset, length, level });
+		m_head = offset + length;
+		return m_data + offset;
+	}
+
+	void tConsoleLogHistory::PopLine()
+	{
+		check(m_lineCount);
+		m_lineStart = (m_lineStart + 1) & (m_lineCapacity - 1);
+		--m_lineCount;
+		++m_firstLine;
+	}
+
+	void tConsoleLogHistory::PushLine(const tLine& line)
+	{
+		if (m_lineCount == m_lineCapacity)
+		{
+			uint32_t capacity = m_lineCapacity ? m_lineCapacity * 2 : 256;
+			tLine* lines = (tLine*)_malloc(sizeof(tLine) * capacity);
+			for (uint32_t i = 0; i < m_lineCount; ++i)
+				lines[i] = m_lines[(m_lineStart + i) & (m_lineCapacity - 1)];
+			if (m_lines)
+				Mist::Free(m_lines);
+			m_lines = lines;
+			m_lineCapacity = capacity;
+			m_lineStart = 0;
+		}
+		m_lines[(m_lineStart + m_lineCount) & (m_lineCapacity - 1)] = line;
+		++m_lineCount;
+	}
+
 	Console::Console()
 		: m_mode(ConsoleMode_Input), 
 		m_newEntry(false),
 		m_historyIndex(0),
 		m_pendingExecuteCommand(false)
 	{
-		rendersystem::ui::AddWindowCallback("Console", [](void* data) 
-			{
-				check(data);
-				Console* c = static_cast<Console*>(data);
-				c->Draw();
-			}, this);
 	}
 
 	void Console::AddCommandCallback(const char* cmdname, FnExecCommandCallback fn)
 	{
-		m_cmdFunctions.Push(fn);
-		m_callbacksNames.Push(cmdname);
+		check(cmdname && *cmdname && fn);
+		uint64_t hash = HashCStr(cmdname);
+		check(m_commandIndex.Find(hash, [&](uint32_t i) { return m_commands[i].Name == cmdname; }) == tNameIndex::InvalidItem);
+		m_commandIndex.Insert(hash, (uint32_t)m_commands.size());
+		m_commands.push_back({ cmdname, fn });
+	}
+
+	void Console::ReleaseLogs()
+	{
+		std::lock_guard<std::mutex> lock(m_logMutex);
+		m_logs.SetBudget(0);
+		m_filteredLines = tDynArray<uint64_t>();
+		m_filteredBegin = 0;
+		m_filteredEnd = m_logs.GetFirstLineId();
+		m_logsReleased = true;
 	}
 
 	void Console::Log(LogLevel level, const char* msg)
 	{
 		check((uint32_t)level < (uint32_t)LogLevel::Count);
+		char prefix[32];
+		uint32_t prefixLength = (uint32_t)sprintf_s(prefix, "[%lld] ", GetFrameCount());
+		uint32_t msgLength = (uint32_t)strlen(msg);
+		// each entry is drawn as a line, trailing line break is implicit.
+		while (msgLength && msg[msgLength - 1] == '\n')
+			--msgLength;
+
+		std::lock_guard<std::mutex> lock(m_logMutex);
+		if (m_logsReleased)
+			return;
+		uint32_t budget = (uint32_t)__max(CVar_ConsoleLogBudget.Get(), 1) * 1024;
+		if (m_logs.GetBudget() != budget)
+			m_logs.SetBudget(budget);
 		++m_counters[(uint32_t)level];
-		tLogEntry entry;
-		sprintf_s(entry.Msg, "[%lld] %s", tApplication::GetFrame(), msg);
-		entry.Level = level;
-		m_logs.Push(entry);
+		uint32_t length = __min(prefixLength + msgLength, budget);
+		char* text = m_logs.Push(level, length);
+		memcpy(text, prefix, __min(prefixLength, length));
+		if (length > prefixLength)
+			memcpy(text + prefixLength, msg, length - prefixLength);
 		m_newEntry = true;
 	}
 
 	void Console::LogFmt(LogLevel level, const char* fmt, ...)
 	{
-		char buff[CONSOLE_LOG_MSG_SIZE];
+		char buff[LOG_MSG_MAX_SIZE];
 		va_list lst;
 		va_start(lst, fmt);
 		vsprintf_s(buff, fmt, lst);
@@ -84,88 +166,40 @@ namespace Mist
 		Console::Log(level, buff);
 	}
 
-	void Console::Draw()
+	void Console::UpdateFilteredLines()
 	{
-		if (!CVar_ShowConsole.Get())
+		if (m_filters == FilterAll)
 			return;
-
-		ImGuiWindowFlags flags = ImGuiWindowFlags_None;
-		if (CVar_ShowConsole.Get() == 1)
+		if (m_filteredMask != m_filters)
 		{
-			ImGuiViewport* viewport = ImGui::GetMainViewport();
-			float x = viewport->Pos.x;
-			float y = viewport->Pos.y;
-			const float width = viewport->Size.x;
-			const float height = viewport->Size.y;
-			ImGui::SetNextWindowPos({ x + 0.f, y + 0.5f * height });
-			ImGui::SetNextWindowSize({ width, 0.5f * height });
-			flags = ImGuiWindowFlags_NoMove 
-				| ImGuiWindowFlags_NoResize 
-				| ImGuiWindowFlags_NoBackground 
-				| ImGuiWindowFlags_NoDecoration;
+			m_filteredMask = m_filters;
+			m_filteredLines.clear();
+			m_filteredBegin = 0;
+			m_filteredEnd = m_logs.GetFirstLineId();
 		}
-		ImGui::Begin("Console", nullptr, flags);
-		// ImGui::Checkbox("AutoMove", &m_autoMove);
-		bool goend = m_newEntry;
-		ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.55f, 1.f), 
-			"Error: %4d | Warn: %4d | Info: %4d | Ok: %4d | Debug: %4d",
-			m_counters[(uint32_t)LogLevel::Error],
-			m_counters[(uint32_t)LogLevel::Warn],
-			m_counters[(uint32_t)LogLevel::Info],
-			m_counters[(uint32_t)LogLevel::Ok],
-			m_counters[(uint32_t)LogLevel::Debug]
-			);
-		m_newEntry = false;
-		float footerHeight = ImGui::GetStyle().ItemSpacing.y + ImGui::GetFrameHeightWithSpacing();
-        if (ImGui::BeginPopupContextItem("filters_popup"))
-        {
-            ImGuiUtils::CheckboxBitField("Info", &m_filters, FilterInfo);
-            ImGuiUtils::CheckboxBitField("Debug", &m_filters, FilterDebug);
-            ImGuiUtils::CheckboxBitField("Ok", &m_filters, FilterOk);
-            ImGuiUtils::CheckboxBitField("Warning", &m_filters, FilterWarn);
-            ImGuiUtils::CheckboxBitField("Error", &m_filters, FilterError);
-			if (ImGui::Button("Go end"))
-				goend = true;
-            ImGui::EndPopup();
-        }
-		if (ImGui::BeginChild("Scrollable", ImVec2(0.f, -footerHeight), false))
+		// discard evicted lines
+		while (m_filteredBegin < m_filteredLines.size() && m_filteredLines[m_filteredBegin] < m_logs.GetFirstLineId())
+			++m_filteredBegin;
+		if (m_filteredBegin > 1024 && m_filteredBegin * 2 > m_filteredLines.size())
 		{
-			ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(4, 1));
-
-			for (uint32_t i = 0; i < m_logs.GetCount(); ++i)
-			{
-				const tLogEntry& entry = m_logs.GetFromOldest(i);
-				if (*entry.Msg && ((1<<(int32_t)entry.Level)&m_filters))
-					ImGui::TextColored(LogLevelImGuiColor(entry.Level), entry.Msg);
-			}
-			if (goend)
-				ImGui::SetScrollHereY(1.f);
-			ImGui::PopStyleVar();
-			ImGui::EndChild();
-			ImGui::OpenPopupOnItemClick("filters_popup", ImGuiPopupFlags_MouseButtonRight);
+			m_filteredLines.erase(m_filteredLines.begin(), m_filteredLines.begin() + m_filteredBegin);
+			m_filteredBegin = 0;
 		}
-
-		flags = ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_EscapeClearsAll 
-			| ImGuiInputTextFlags_CallbackHistory
-			| ImGuiInputTextFlags_CallbackEdit;
-		bool reclaimFocus = false;
-		if (ImGui::InputText("Input", m_inputCommand, 256, flags, &Console::ConsoleInputCallback, this))
+		// append lines pushed since last update
+		uint64_t id = __max(m_filteredEnd, m_logs.GetFirstLineId());
+		for (; id < m_logs.GetEndLineId(); ++id)
 		{
-			reclaimFocus = true;
-			m_pendingExecuteCommand = true;
+			if ((1 << (int32_t)m_logs.GetLine(id).Level) & m_filters)
+				m_filteredLines.push_back(id);
 		}
-
-		ImGui::SetItemDefaultFocus();
-		if (reclaimFocus)
-			ImGui::SetKeyboardFocusHere(-1);
-		ImGui::End();
+		m_filteredEnd = id;
 	}
 
 	void Console::PrintCommandList()
 	{
 		loginfo("> cmdlist:\n");
-		for (uint32_t i = 0; i < m_callbacksNames.GetSize(); ++i)
-			logfinfo("%s\n", m_callbacksNames[i].CStr());
+		for (const tCommand& command : m_commands)
+			logfinfo("%s\n", command.Name.CStr());
 		loginfo("============\n");
 	}
 
@@ -200,14 +234,11 @@ namespace Mist
 		InsertCommandHistory(cmd);
 		if (!ExecInternalCommand(cmd))
 		{
-			check(m_callbacksNames.GetSize() == m_cmdFunctions.GetSize());
-			for (uint32_t i = 0; i < m_cmdFunctions.GetSize(); ++i)
+			uint32_t index = m_commandIndex.Find(HashCStr(cmd), [&](uint32_t i) { return m_commands[i].Name == cmd; });
+			if (index != tNameIndex::InvalidItem)
 			{
-				if (!strcmp(m_callbacksNames[i].CStr(), cmd))
-				{
-					m_cmdFunctions[i](cmd);
-					return;
-				}
+				m_commands[index].Fn(cmd);
+				return;
 			}
 		}
 		else
@@ -219,74 +250,4 @@ namespace Mist
 	{
 		m_history.Push(cmd);
 	}
-
-	int Console::ConsoleHistoryCallback(ImGuiInputTextCallbackData* data)
-	{
-		check(data && data->UserData);
-		Console& console = *(Console*)data->UserData; 
-		switch (data->EventKey)
-		{
-		case ImGuiKey_UpArrow:
-		{
-			if (console.m_historyIndex == UINT32_MAX)
-				console.m_historyIndex = 0;
-			else
-			{
-				if (console.m_historyIndex == console.m_history.GetCount()
-					|| console.m_history.GetFromLatest(console.m_historyIndex).IsEmpty())
-				{
-					logerror("End of history command.\n");
-				}
-				else
-					++console.m_historyIndex;
-
-			}
-		} break;
-		case ImGuiKey_DownArrow:
-		{
-			if (console.m_historyIndex == 0)
-				console.m_historyIndex = UINT32_MAX;
-			else
-				--console.m_historyIndex;
-		} break;
-		}
-
-		if (console.m_historyIndex != UINT32_MAX)
-		{
-			const tInputString& str = console.m_history.GetFromLatest(console.m_historyIndex);
-			if (!str.IsEmpty())
-			{
-				check(data->BufSize > (int)str.Length());
-				strcpy_s(data->Buf, data->BufSize, str.CStr());
-				data->BufTextLen = str.Length();
-				data->BufDirty = true;
-				data->SelectAll();
-			}
-		}
-		else
-		{
-			data->ClearSelection();
-			*data->Buf = 0;
-			data->BufTextLen = 0;
-			data->BufDirty = true;
-		}
-		return 0;
-	}
-
-	int Console::ConsoleInputCallback(ImGuiInputTextCallbackData* data)
-	{
-		check(data && data->UserData);
-		Console& console = *(Console*)data->UserData;
-		if (data->EventFlag == ImGuiInputTextFlags_CallbackEdit)
-			console.ResetHistoryMode();
-		if (data->EventFlag == ImGuiInputTextFlags_CallbackHistory)
-			Console::ConsoleHistoryCallback(data);
-		return 0;
-	}
-
-	void Console::ResetHistoryMode()
-	{
-		m_historyIndex = UINT32_MAX;
-	}
-
 }
\ No newline at end of file
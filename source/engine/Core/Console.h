@@ -2,10 +2,8 @@
 
 #include "Logger.h"
 #include "Types.h"
+#include <mutex>
 
-#define CONSOLE_LOG_MSG_SIZE LOG_MSG_MAX_SIZE
-#define CONSOLE_LOG_COUNT 1024
-#define CONSOLE_CMD_CALLBACKS_COUNT 64
 #define CONSOLE_INPUT_LENGTH 256
 #define CONSOLE_HISTORY_SIZE 32
 
@@ -18,6 +16,54 @@ namespace Mist
 	void DrawConsole();
 	void FlushPendingConsoleCommands();
 	void ConsoleLog(LogLevel level, const char* msg);
+	// releases the console log history, later logs skip the console. Called by TerminateLog.
+	void TerminateConsoleLog();
+
+	/**
+	 * Console log history. Text is packed in a circular byte arena and indexed by a ring of
+	 * line offsets. Oldest lines are evicted when a new one doesn't fit in the byte budget.
+	 * Lines are identified by an absolute id that keeps growing while lines are evicted.
+	 */
+	class tConsoleLogHistory
+	{
+	public:
+		struct tLine
+		{
+			uint32_t Offset;
+			uint32_t Length;
+			LogLevel Level;
+		};
+
+		tConsoleLogHistory() = default;
+		~tConsoleLogHistory();
+		DELETE_COPY_CONSTRUCTORS(tConsoleLogHistory);
+
+		// drops current history.
+		void SetBudget(uint32_t bytes);
+		inline uint32_t GetBudget() const { return m_size; }
+
+		// reserves room for a new line and returns where to write its text.
+		char* Push(LogLevel level, uint32_t length);
+
+		inline uint64_t GetFirstLineId() const { return m_firstLine; }
+		inline uint64_t GetEndLineId() const { return m_firstLine + m_lineCount; }
+		inline uint32_t GetLineCount() const { return m_lineCount; }
+		inline const tLine& GetLine(uint64_t id) const { check(id >= m_firstLine && id < GetEndLineId()); return m_lines[(m_lineStart + (id - m_firstLine)) & (m_lineCapacity - 1)]; }
+		inline const char* GetText(const tLine& line) const { return m_data + line.Offset; }
+
+	private:
+		void PopLine();
+		void PushLine(const tLine& line);
+
+		char* m_data = nullptr;
+		uint32_t m_size = 0;
+		uint32_t m_head = 0;
+		tLine* m_lines = nullptr;
+		uint32_t m_lineCapacity = 0;
+		uint32_t m_lineStart = 0;
+		uint32_t m_lineCount = 0;
+		uint64_t m_firstLine = 0;
+	};
 
 	class Console
 	{
@@ -39,14 +85,6 @@ namespace Mist
 			FilterWarn = 1 << (uint32_t)LogLevel::Warn,
 			FilterAll = 0xffffffff
 		};
-
-		struct tLogEntry
-		{
-			LogLevel Level;
-			char Msg[CONSOLE_LOG_MSG_SIZE];
-
-			tLogEntry() : Level(LogLevel::Info), Msg{ 0 } {}
-		};
 	public:
 		Console();
 
@@ -54,6 +92,7 @@ namespace Mist
 
 		void Log(LogLevel level, const char* msg);
 		void LogFmt(LogLevel level, const char* fmt, ...);
+		void ReleaseLogs();
 
 		void Draw();
 		void PrintCommandList();
@@ -66,9 +105,18 @@ namespace Mist
 		static int ConsoleHistoryCallback(ImGuiInputTextCallbackData* data);
 		static int ConsoleInputCallback(ImGuiInputTextCallbackData* data);
 		void ResetHistoryMode();
+		void UpdateFilteredLines();
 	private:
-		tCircularBuffer<tLogEntry, CONSOLE_LOG_COUNT> m_logs;
+		// entries are pushed from the log thread.
+		std::mutex m_logMutex;
+		tConsoleLogHistory m_logs;
+		bool m_logsReleased = false;
 		int32_t m_filters = FilterAll;
+		// absolute ids of lines passing m_filters, only used when some level is filtered out.
+		tDynArray<uint64_t> m_filteredLines;
+		uint32_t m_filteredBegin = 0;
+		uint64_t m_filteredEnd = 0;
+		int32_t m_filteredMask = FilterAll;
 		uint32_t m_counters[(uint32_t)LogLevel::Count];
 		bool m_newEntry;
 		uint32_t m_historyIndex;
@@ -76,7 +124,12 @@ namespace Mist
 		eConsoleMode m_mode;
 		char m_inputCommand[CONSOLE_INPUT_LENGTH];
 		bool m_pendingExecuteCommand;
-		tStaticArray<tFixedString<64>, CONSOLE_CMD_CALLBACKS_COUNT> m_callbacksNames;
-		tStaticArray<FnExecCommandCallback, CONSOLE_CMD_CALLBACKS_COUNT> m_cmdFunctions;
+		struct tCommand
+		{
+			tFixedString<64> Name;
+			FnExecCommandCallback Fn;
+		};
+		tDynArray<tCommand> m_commands;
+		tNameIndex m_commandIndex;
 	};
 }
@@ -0,0 +1,195 @@
+#include "Core/Console.h"
+#include "Core/Debug.h"
+#include <string.h>
+#include <imgui/imgui.h>
+#include "Application/CmdParser.h"
+#include "Utils/GenericUtils.h"
+
+// ImGui side of the console, the log history and the commands live in Console.cpp.
+
+namespace Mist
+{
+	CIntVar CVar_ShowConsole("ShowConsole", 0);
+
+	extern Console g_Console;
+
+	ImVec4 LogLevelImGuiColor(LogLevel level)
+	{
+		switch (level)
+		{
+		case LogLevel::Info: return ImVec4(0.7f, 0.7f, 0.7f, 1.f);
+		case LogLevel::Debug: return ImVec4(0.4f, 0.65f, 0.85f, 1.f);
+		case LogLevel::Ok: return ImVec4(0.2f, 0.91f, 0.26f, 1.f);
+		case LogLevel::Warn: return ImVec4(0.9647f, 1.f, 0.2392f, 1.f);
+		case LogLevel::Error: return ImVec4(1.f, 0.f, 0.f, 1.f);
+		default:
+			break;
+		}
+		return ImVec4(0.2f, 0.2f, 0.2f, 1.f);
+	}
+
+	void DrawConsole()
+	{
+		g_Console.Draw();
+	}
+
+	void Console::Draw()
+	{
+		if (!CVar_ShowConsole.Get())
+			return;
+
+		ImGuiWindowFlags flags = ImGuiWindowFlags_None;
+		if (CVar_ShowConsole.Get() == 1)
+		{
+			ImGuiViewport* viewport = ImGui::GetMainViewport();
+			float x = viewport->Pos.x;
+			float y = viewport->Pos.y;
+			const float width = viewport->Size.x;
+			const float height = viewport->Size.y;
+			ImGui::SetNextWindowPos({ x + 0.f, y + 0.5f * height });
+			ImGui::SetNextWindowSize({ width, 0.5f * height });
+			flags = ImGuiWindowFlags_NoMove 
+				| ImGuiWindowFlags_NoResize 
+				| ImGuiWindowFlags_NoBackground 
+				| ImGuiWindowFlags_NoDecoration;
+		}
+		ImGui::Begin("Console", nullptr, flags);
+		// ImGui::Checkbox("AutoMove", &m_autoMove);
+		bool goend = m_newEntry;
+		ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.55f, 1.f), 
+			"Error: %4d | Warn: %4d | Info: %4d | Ok: %4d | Debug: %4d",
+			m_counters[(uint32_t)LogLevel::Error],
+			m_counters[(uint32_t)LogLevel::Warn],
+			m_counters[(uint32_t)LogLevel::Info],
+			m_counters[(uint32_t)LogLevel::Ok],
+			m_counters[(uint32_t)LogLevel::Debug]
+			);
+		m_newEntry = false;
+		float footerHeight = ImGui::GetStyle().ItemSpacing.y + ImGui::GetFrameHeightWithSpacing();
+        if (ImGui::BeginPopupContextItem("filters_popup"))
+        {
+            ImGuiUtils::CheckboxBitField("Info", &m_filters, FilterInfo);
+            ImGuiUtils::CheckboxBitField("Debug", &m_filters, FilterDebug);
+            ImGuiUtils::CheckboxBitField("Ok", &m_filters, FilterOk);
+            ImGuiUtils::CheckboxBitField("Warning", &m_filters, FilterWarn);
+            ImGuiUtils::CheckboxBitField("Error", &m_filters, FilterError);
+			if (ImGui::Button("Go end"))
+				goend = true;
+            ImGui::EndPopup();
+        }
+		if (ImGui::BeginChild("Scrollable", ImVec2(0.f, -footerHeight), false))
+		{
+			ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(4, 1));
+
+			std::lock_guard<std::mutex> lock(m_logMutex);
+			UpdateFilteredLines();
+			bool filtered = m_filters != FilterAll;
+			uint32_t lineCount = filtered ? (uint32_t)m_filteredLines.size() - m_filteredBegin : m_logs.GetLineCount();
+			// only visible lines are touched, cost doesn't depend on history length.
+			ImGuiListClipper clipper;
+			clipper.Begin((int)lineCount);
+			while (clipper.Step())
+			{
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+				{
+					uint64_t id = filtered ? m_filteredLines[m_filteredBegin + i] : m_logs.GetFirstLineId() + i;
+					const tConsoleLogHistory::tLine& line = m_logs.GetLine(id);
+					const char* text = m_logs.GetText(line);
+					ImGui::PushStyleColor(ImGuiCol_Text, LogLevelImGuiColor(line.Level));
+					ImGui::TextUnformatted(text, text + line.Length);
+					ImGui::PopStyleColor();
+				}
+			}
+			clipper.End();
+			if (goend)
+				ImGui::SetScrollHereY(1.f);
+			ImGui::PopStyleVar();
+			ImGui::EndChild();
+			ImGui::OpenPopupOnItemClick("filters_popup", ImGuiPopupFlags_MouseButtonRight);
+		}
+
+		flags = ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_EscapeClearsAll 
+			| ImGuiInputTextFlags_CallbackHistory
+			| ImGuiInputTextFlags_CallbackEdit;
+		bool reclaimFocus = false;
+		if (ImGui::InputText("Input", m_inputCommand, 256, flags, &Console::ConsoleInputCallback, this))
+		{
+			reclaimFocus = true;
+			m_pendingExecuteCommand = true;
+		}
+
+		ImGui::SetItemDefaultFocus();
+		if (reclaimFocus)
+			ImGui::SetKeyboardFocusHere(-1);
+		ImGui::End();
+	}
+
+	int Console::ConsoleHistoryCallback(ImGuiInputTextCallbackData* data)
+	{
+		check(data && data->UserData);
+		Console& console = *(Console*)data->UserData; 
+		switch (data->EventKey)
+		{
+		case ImGuiKey_UpArrow:
+		{
+			if (console.m_historyIndex == UINT32_MAX)
+				console.m_historyIndex = 0;
+			else
+			{
+				if (console.m_historyIndex == console.m_history.GetCount()
+					|| console.m_history.GetFromLatest(console.m_historyIndex).IsEmpty())
+				{
+					logerror("End of history command.\n");
+				}
+				else
+					++console.m_historyIndex;
+
+			}
+		} break;
+		case ImGuiKey_DownArrow:
+		{
+			if (console.m_historyIndex == 0)
+				console.m_historyIndex = UINT32_MAX;
+			else
+				--console.m_historyIndex;
+		} break;
+		}
+
+		if (console.m_historyIndex != UINT32_MAX)
+		{
+			const tInputString& str = console.m_history.GetFromLatest(console.m_historyIndex);
+			if (!str.IsEmpty())
+			{
+				check(data->BufSize > (int)str.Length());
+				strcpy_s(data->Buf, data->BufSize, str.CStr());
+				data->BufTextLen = str.Length();
+				data->BufDirty = true;
+				data->SelectAll();
+			}
+		}
+		else
+		{
+			data->ClearSelection();
+			*data->Buf = 0;
+			data->BufTextLen = 0;
+			data->BufDirty = true;
+		}
+		return 0;
+	}
+
+	int Console::ConsoleInputCallback(ImGuiInputTextCallbackData* data)
+	{
+		check(data && data->UserData);
+		Console& console = *(Console*)data->UserData;
+		if (data->EventFlag == ImGuiInputTextFlags_CallbackEdit)
+			console.ResetHistoryMode();
+		if (data->EventFlag == ImGuiInputTextFlags_CallbackHistory)
+			Console::ConsoleHistoryCallback(data);
+		return 0;
+	}
+
+	void Console::ResetHistoryMode()
+	{
+		m_historyIndex = UINT32_MAX;
+	}
+}
@@ -1,165 +1,59 @@
 // src file for Mist project 
 #include "Core/Debug.h"
+#include "Core/DebugProfiler.h"
 #include "Core/Logger.h"
 #include "Core/Types.h"
 
-#include <Windows.h>
+#include "Core/Platform.h"
 #include <string>
-#include <DbgHelp.h>
-#include "imgui.h"
 #include <unordered_map>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include "Application/CmdParser.h"
-#include "Render/RenderEngine.h"
-#include "Render/VulkanRenderEngine.h"
-#include "Application/Application.h"
-#include "RenderSystem/RenderSystem.h"
-#include "glm/ext/quaternion_common.inl"
+#include "Utils/TimeUtils.h"
 
-
-#pragma comment(lib,"Dbghelp.lib")
-
-namespace win
+namespace
 {
-	/**
-	 * Reference: https://stackoverflow.com/questions/590160/how-to-log-stack-frames-with-windows-x64
-	 */
-	void WriteStackDump()
-	{
-		static constexpr size_t MaxNameLen = 128;
-
-		CONTEXT ctx;
-		RtlCaptureContext(&ctx);
-
-		BOOL    result;
-		HANDLE  process;
-		HANDLE  thread;
-
-		STACKFRAME64        stack;
-		ULONG               frame;
-		DWORD64             displacement;
-
-		DWORD disp;
-		IMAGEHLP_LINE64* line;
-
-		char buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME * sizeof(TCHAR)];
-		PSYMBOL_INFO pSymbol = (PSYMBOL_INFO)buffer;
-
-		// On x64, StackWalk64 modifies the context record, that could
-		// cause crashes, so we create a copy to prevent it
-		CONTEXT ctxCopy;
-		memcpy(&ctxCopy, &ctx, sizeof(CONTEXT));
-
-		memset(&stack, 0, sizeof(STACKFRAME64));
-
-		process = GetCurrentProcess();
-		thread = GetCurrentThread();
-		displacement = 0;
-#if !defined(_M_AMD64)
-		stack.AddrPC.Offset = (*ctx).Eip;
-		stack.AddrPC.Mode = AddrModeFlat;
-		stack.AddrStack.Offset = (*ctx).Esp;
-		stack.AddrStack.Mode = AddrModeFlat;
-		stack.AddrFrame.Offset = (*ctx).Ebp;
-		stack.AddrFrame.Mode = AddrModeFlat;
-#endif
-
-		SymInitialize(process, NULL, TRUE); //load symbols
-
-		Mist::Log(Mist::LogLevel::Debug, "\n\n=================================================\n\n");
-
-		for (frame = 0; ; frame++)
-		{
-			//get next call from stack
-			result = StackWalk64
-			(
-#if defined(_M_AMD64)
-				IMAGE_FILE_MACHINE_AMD64
-#else
-				IMAGE_FILE_MACHINE_I386
-#endif
-				,
-				process,
-				thread,
-				&stack,
-				&ctxCopy,
-				NULL,
-				SymFunctionTableAccess64,
-				SymGetModuleBase64,
-				NULL
-			);
-
-			if (!result) break;
-
-			//get symbol name for address
-			pSymbol->SizeOfStruct = sizeof(SYMBOL_INFO);
-			pSymbol->MaxNameLen = MAX_SYM_NAME;
-			SymFromAddr(process, (ULONG64)stack.AddrPC.Offset, &displacement, pSymbol);
-
-			line = (IMAGEHLP_LINE64*)malloc(sizeof(IMAGEHLP_LINE64));
-			line->SizeOfStruct = sizeof(IMAGEHLP_LINE64);
-
-			//try to get line
-			if (SymGetLineFromAddr64(process, stack.AddrPC.Offset, &disp, line))
-			{
-				Mist::Logf(Mist::LogLevel::Debug, "%s(%lu) in %s : address: 0x%0X\n", line->FileName, line->LineNumber, pSymbol->Name, pSymbol->Address);
-			}
-			else
-			{
-#if 0
-				//failed to get line
-				Mist::Logf(Mist::LogLevel::Debug, "%s, address 0x%0X.", pSymbol->Name, pSymbol->Address);
-				hModule = NULL;
-				lstrcpyA(module, "");
-				GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
-					(LPCTSTR)(stack.AddrPC.Offset), &hModule);
-
-				//at least print module name
-				if (hModule != NULL)GetModuleFileNameA(hModule, module, MaxNameLen);
-
-				printf("in %s\n", module);
-#endif // 0
-
-			}
+	Mist::Debug::tDebugCheckCallback GDebugCheckCallback = nullptr;
 
-			free(line);
-			line = NULL;
-		}
-		Mist::Log(Mist::LogLevel::Debug, "\n=================================================\n\n");
-	}
-
-	UINT GetButtonType(Mist::Debug::eDialogButtonType type)
+	Mist::Platform::eMessageBoxButtons GetButtonType(Mist::Debug::eDialogButtonType type)
 	{
 		switch (type)
 		{
-		case Mist::Debug::DIALOG_BUTTON_YESNO: return MB_YESNO;
-		case Mist::Debug::DIALOG_BUTTON_YESNOCANCEL: return MB_YESNOCANCEL;
-		case Mist::Debug::DIALOG_BUTTON_OK:return MB_OK;
-		case Mist::Debug::DIALOG_BUTTON_OKCANCEL: return MB_OKCANCEL;
+		case Mist::Debug::DIALOG_BUTTON_YESNO: return Mist::Platform::MessageBoxButtons_YesNo;
+		case Mist::Debug::DIALOG_BUTTON_YESNOCANCEL: return Mist::Platform::MessageBoxButtons_YesNoCancel;
+		case Mist::Debug::DIALOG_BUTTON_OK: return Mist::Platform::MessageBoxButtons_Ok;
+		case Mist::Debug::DIALOG_BUTTON_OKCANCEL: return Mist::Platform::MessageBoxButtons_OkCancel;
 		}
-		return 0;
+		return Mist::Platform::MessageBoxButtons_Ok;
 	}
 
-	Mist::Debug::eDialogMessageResult GetResult(int res)
+	Mist::Debug::eDialogMessageResult GetResult(Mist::Platform::eMessageBoxResult res)
 	{
 		switch (res)
 		{
-		case IDCANCEL: return Mist::Debug::DIALOG_MESSAGE_RESULT_CANCEL;
-		case IDOK: return Mist::Debug::DIALOG_MESSAGE_RESULT_OK;
-		case IDYES: return Mist::Debug::DIALOG_MESSAGE_RESULT_YES;
-		case IDNO: return Mist::Debug::DIALOG_MESSAGE_RESULT_NO;
+		case Mist::Platform::MessageBoxResult_Cancel: return Mist::Debug::DIALOG_MESSAGE_RESULT_CANCEL;
+		case Mist::Platform::MessageBoxResult_Ok: return Mist::Debug::DIALOG_MESSAGE_RESULT_OK;
+		case Mist::Platform::MessageBoxResult_Yes: return Mist::Debug::DIALOG_MESSAGE_RESULT_YES;
+		case Mist::Platform::MessageBoxResult_No: return Mist::Debug::DIALOG_MESSAGE_RESULT_NO;
 		}
 		return Mist::Debug::DIALOG_MESSAGE_RESULT_NO;
 	}
+
+	Mist::Debug::eDialogMessageResult ShowDialog(Mist::Platform::eMessageBoxType type, Mist::Debug::eDialogButtonType button, const char* title, const char* msg)
+	{
+		return GetResult(Mist::Platform::ShowMessageBox(type, GetButtonType(button), title, msg));
+	}
 }
 
 bool Mist::Debug::DebugCheck(const char* txt, const char* file, const char* fn, int line)
 {
 	Mist::Debug::PrintCallstack();
-	if (g_render)
-		g_render->DumpState();
+	if (GDebugCheckCallback)
+		GDebugCheckCallback();
 	logerror("============================================================\n\n");
-    logferror("Frame: %d\n", Mist::tApplication::GetFrame());
+    logferror("Frame: %d\n", Mist::GetFrameCount());
 	logferror("Check failed: %s\n\n", txt);
 	logferror("File: %s\n", file);
 	logferror("Function: %s\n", fn);
@@ -170,16 +64,36 @@ bool Mist::Debug::DebugCheck(const char* txt, const char* file, const char* fn,
 
 	eDialogMessageResult res = DialogMsgErrorF(DIALOG_BUTTON_YESNO, 
 		"Frame: %d\nCheck failed:\n\n%s\n\nFile: %s\nFunction: %s\n\nLine: %d\n\nDebug program?", 
-		Mist::tApplication::GetFrame(),
+		Mist::GetFrameCount(),
 		txt, file, fn, line);
 	return res == DIALOG_MESSAGE_RESULT_YES;
 }
 
+void Mist::Debug::SetDebugCheckCallback(tDebugCheckCallback callback)
+{
+	GDebugCheckCallback = callback;
+}
+
 void Mist::Debug::PrintCallstack(size_t count, size_t offset)
 {
-#ifdef _WIN32
-	win::WriteStackDump();
-#endif
+	static constexpr uint32_t MaxFrames = 64;
+	void* frames[MaxFrames];
+	uint32_t maxFrames = count ? (uint32_t)__min(count, (size_t)MaxFrames) : MaxFrames;
+	// skip PrintCallstack itself.
+	uint32_t frameCount = Mist::Platform::CaptureStack(frames, maxFrames, (uint32_t)offset + 1);
+
+	Mist::Log(Mist::LogLevel::Debug, "\n\n=================================================\n\n");
+	for (uint32_t i = 0; i < frameCount; ++i)
+	{
+		Mist::Platform::tStackSymbol symbol;
+		if (!Mist::Platform::ResolveStackSymbol(frames[i], symbol))
+			Mist::Logf(Mist::LogLevel::Debug, "address: 0x%llx\n", (unsigned long long)(uintptr_t)frames[i]);
+		else if (symbol.Line)
+			Mist::Logf(Mist::LogLevel::Debug, "%s(%u) in %s : address: 0x%llx\n", symbol.File, symbol.Line, symbol.Name, (unsigned long long)symbol.Address);
+		else
+			Mist::Logf(Mist::LogLevel::Debug, "%s in %s : address: 0x%llx\n", symbol.File, symbol.Name, (unsigned long long)(uintptr_t)frames[i]);
+	}
+	Mist::Log(Mist::LogLevel::Debug, "\n=================================================\n\n");
 }
 
 void Mist::Debug::ExitError()
@@ -190,9 +104,7 @@ void Mist::Debug::ExitError()
 
 Mist::Debug::eDialogMessageResult Mist::Debug::DialogMsgInfo(eDialogButtonType type, const char* msg)
 {
-	UINT button = win::GetButtonType(type);
-	int res = MessageBoxA(NULL, msg, "Info message", button | MB_ICONINFORMATION);
-	return win::GetResult(res);
+	return ShowDialog(Mist::Platform::MessageBox_Info, type, "Info message", msg);
 }
 
 Mist::Debug::eDialogMessageResult Mist::Debug::DialogMsgInfoF(eDialogButtonType type, const char* msg, ...)
@@ -207,9 +119,7 @@ Mist::Debug::eDialogMessageResult Mist::Debug::DialogMsgInfoF(eDialogButtonType
 
 Mist::Debug::eDialogMessageResult Mist::Debug::DialogMsgWarning(eDialogButtonType type, const char* msg)
 {
-	UINT button = win::GetButtonType(type);
-	int res = MessageBoxA(NULL, msg, "Warning message", button | MB_ICONWARNING);
-	return win::GetResult(res);
+	return ShowDialog(Mist::Platform::MessageBox_Warning, type, "Warning message", msg);
 }
 
 Mist::Debug::eDialogMessageResult Mist::Debug::DialogMsgWarningF(eDialogButtonType type, const char* msg, ...)
@@ -224,9 +134,7 @@ Mist::Debug::eDialogMessageResult Mist::Debug::DialogMsgWarningF(eDialogButtonTy
 
 Mist::Debug::eDialogMessageResult Mist::Debug::DialogMsgError(eDialogButtonType type, const char* msg)
 {
-	UINT button = win::GetButtonType(type);
-	int res = MessageBoxA(NULL, msg, "Error message", button | MB_ICONERROR);
-	return win::GetResult(res);
+	return ShowDialog(Mist::Platform::MessageBox_Error, type, "Error message", msg);
 }
 
 Mist::Debug::eDialogMessageResult Mist::Debug::DialogMsgErrorF(eDialogButtonType type, const char* msg, ...)
@@ -239,8 +147,6 @@ Mist::Debug::eDialogMessageResult Mist::Debug::DialogMsgErrorF(eDialogButtonType
 	return DialogMsgError(type, buff);
 }
 
-#define PROFILING_AVERAGE_DATA_COUNT 64
-
 namespace Mist::Debug
 {
 	extern uint32_t GVulkanLayerValidationErrors;
@@ -248,7 +154,6 @@ namespace Mist::Debug
 
 namespace Mist
 {
-	CIntVar CVar_ShowStats("ShowStats", 1);
 	CIntVar CVar_ShowCpuProf("r_ShowCpuProf", 0);
 	CIntVar CVar_ShowCpuProfRatio("r_ShowCpuProfRatio", 5);
 
@@ -256,145 +161,29 @@ namespace Mist
 	{
 		sRenderStats GRenderStats;
 		bool g_cpuProfilingEnabled = false;
+		bool g_cpuProfCaptureAll = false;
 		size_t g_profilerFrame = 0;
 
 		size_t GetFrame() { return g_profilerFrame; }
 		size_t GetLastFrameIndex() { return (GetFrame() - 1) % 2; }
 		size_t GetCurrentFrameIndex() { return GetFrame() % 2; }
 
-		struct tCpuProfItem
-		{
-			tFixedString<64> Label;
-			double Value;
-		};
-
-		struct sProfilerKey
-		{
-			union
-			{
-				char Id[32];
-				uint32_t AsUint;
-			};
-
-			sProfilerKey() : AsUint(0) {}
-			sProfilerKey(const char* id) : AsUint(0) { strcpy_s(Id, id); }
-
-			bool operator==(const sProfilerKey& other) const { return AsUint == other.AsUint; }
+		sProfiler GProfiler;
 
-			struct Hasher
-			{
-				std::size_t operator()(const sProfilerKey& key) const
-				{
-					return std::hash<uint32_t>()(key.AsUint);
-				}
-			};
-		};
-
-		struct sProfilerEntry
-		{
-			Mist::tCircularBuffer<double, PROFILING_AVERAGE_DATA_COUNT> Data;
-			double Min = DBL_MAX;
-			double Max = -DBL_MAX;
-		};
+		thread_local tCpuProfThread* GCpuProfThread = nullptr;
+		std::atomic<bool> GCpuProfRecording = false;
 
-		struct sProfiler
+		tCpuProfThread& CpuProfGetThread()
 		{
-			tCircularBuffer<float, 128> CPUTimeArray;
-			tCircularBuffer<float, 128> GPUTimeArray;
-
-			typedef tStackTree<tCpuProfItem, 64> tCpuProfStackTree;
-			tCpuProfStackTree CpuProfStack[2];
-			std::unordered_map<sProfilerKey, sProfilerEntry, sProfilerKey::Hasher> EntryMap;
-
-			static void GetStats(tCircularBuffer<float, 128>& data, float& min, float& max, float& mean, float& last)
-			{
-				mean = 0.f;
-				min = FLT_MAX;
-				max = -FLT_MAX;
-				last = data.GetLast();
-				for (uint32_t i = 0; i < data.GetCount(); ++i)
-				{
-					float value = data.GetFromOldest(i);
-					min = __min(min, value);
-					max = __max(max, value);
-					mean += value;
-				}
-				mean /= data.GetCount();
-			}
-
-			static void BuildGpuProfTree(tCpuProfStackTree& stack, index_t root, double minValue, double maxValue)
-			{
-				index_t index = root;
-				glm::vec4 goodColor = glm::vec4(0.f, 1.f, 0.f, 1.f);
-				glm::vec4 badColor = glm::vec4(1.f, 0.f, 0.f, 1.f);
-				const char* valuefmt = "%10.5f";
-				while (index != index_invalid)
-				{
-					ImGui::TableNextRow();
-					ImGui::TableNextColumn();
-					tCpuProfStackTree::tItem& item = stack.Items[index];
-					tCpuProfItem& data = stack.Data[item.DataIndex];
-					if (item.Child != index_invalid)
-					{
-						bool treeOpen = ImGui::TreeNodeEx(data.Label.CStr(),
-							ImGuiTreeNodeFlags_SpanAllColumns
-							| ImGuiTreeNodeFlags_DefaultOpen);
-						ImGui::TableNextColumn();
-						double v = data.Value;
-						glm::vec4 c = glm::mix(goodColor, badColor, (v - minValue) / (maxValue - minValue));
-						ImGui::TextColored({ c.x, c.y, c.z, c.w }, valuefmt, v);
-						if (treeOpen)
-						{
-							BuildGpuProfTree(stack, item.Child, minValue, maxValue);
-							ImGui::TreePop();
-						}
-					}
-					else
-					{
-						ImGui::Text("%s", data.Label.CStr());
-						ImGui::TableNextColumn();
-						double v = stack.Data[item.DataIndex].Value;
-						glm::vec4 c = glm::mix(goodColor, badColor, (v - minValue) / (maxValue - minValue));
-						ImGui::TextColored({c.x, c.y, c.z, c.w}, valuefmt, v);
-					}
-					index = item.Sibling;
-				}
-			}
-
-			void ImGuiDraw()
+			if (!GCpuProfThread)
 			{
-				tCpuProfStackTree& stack = CpuProfStack[GetLastFrameIndex()];
-				check(stack.Current == index_invalid);
-
-				index_t size = stack.Items.GetSize();
-				float heightPerLine = 20.f; //approx?
-				ImGuiViewport* viewport = ImGui::GetMainViewport();
-
-				ImVec2 winpos = ImVec2(0.f, 100.f);
-				//ImGui::SetNextWindowPos(winpos);
-				ImGui::SetNextWindowSize(ImVec2(500.f, (float)size * heightPerLine));
-				//ImGui::SetNextWindowBgAlpha(0.8f);
-				ImGui::Begin("Cpu profiling", nullptr, ImGuiWindowFlags_NoDecoration
-					| ImGuiWindowFlags_NoBackground
-					| ImGuiWindowFlags_NoDocking);
-				if (!stack.Items.IsEmpty())
-				{
-					ImGuiTableFlags flags = ImGuiTableFlags_BordersV | ImGuiTableFlags_BordersOuterH
-						| ImGuiTableFlags_Resizable
-						| ImGuiTableFlags_RowBg
-						| ImGuiTableFlags_NoBordersInBody;
-					if (ImGui::BeginTable("CpuProf", 2, flags))
-					{
-						ImGui::TableSetupColumn("Process");
-						ImGui::TableSetupColumn("Time (ms)");
-						ImGui::TableHeadersRow();
-						BuildGpuProfTree(stack, 0, 0.0, 4.0);
-						ImGui::EndTable();
-					}
-				}
-				ImGui::End();
+				GCpuProfThread = _new tCpuProfThread();
+				std::lock_guard<std::mutex> lock(GProfiler.ThreadMutex);
+				GCpuProfThread->Name.Fmt("Thread %d", (int)GProfiler.Threads.size());
+				GProfiler.Threads.push_back(GCpuProfThread);
 			}
-		} GProfiler;
+			return *GCpuProfThread;
+		}
 
 		void sProfilingTimer::Start()
 		{
@@ -413,18 +202,25 @@ namespace Mist
 #endif // _USE_CHRONO_PROFILING
 		}
 
-		sScopedTimer::sScopedTimer(const char* nameId)
+		sProfilerZone::sProfilerZone(const char* name, const char* file, uint32_t line)
+			: Name(name), File(file), Line(line)
 		{
-			strcpy_s(Id, nameId);
-			CpuProf_Begin(Id);
+			Id = GProfiler.RegisterZone(this);
+		}
+
+		sScopedTimer::sScopedTimer(const sProfilerZone& zone)
+			: ZoneId(zone.Id)
+		{
+			Recording = CpuProf_Begin(ZoneId);
 			Start();
 		}
 
 		sScopedTimer::~sScopedTimer()
 		{
 			double elapsed = Stop();
-			AddProfilerEntry(Id, elapsed);
-			CpuProf_End(static_cast<float>(elapsed));
+			// zones opened before profiling was enabled are not closed into the buffer.
+			if (Recording)
+				CpuProf_End(static_cast<float>(elapsed));
 		}
 
 		void sRenderStats::Reset()
@@ -434,16 +230,6 @@ namespace Mist
 			SetBindingCount = 0;
 		}
 
-		void AddProfilerEntry(const char* key, double timeDiff)
-		{
-			if (!GProfiler.EntryMap.contains(key))
-				GProfiler.EntryMap[key] = sProfilerEntry();
-			sProfilerEntry& entry = GProfiler.EntryMap[key];
-			entry.Data.Push(timeDiff);
-			entry.Max = __max(timeDiff, entry.Max);
-			entry.Min = __min(timeDiff, entry.Min);
-		}
-
 		void AddCPUTime(float ms)
 		{
 			GProfiler.CPUTimeArray.Push(ms);
@@ -454,123 +240,6 @@ namespace Mist
 			GProfiler.GPUTimeArray.Push(ms);
 		}
 
-		float ImGuiGetFpsPlotValue(void* data, int index)
-		{
-			sProfiler& prof = *(sProfiler*)data;
-			return prof.CPUTimeArray.GetFromOldest(index);
-		}
-
-		float ImGuiGetMsPlotValue(void* data, int index)
-		{
-			sProfiler& prof = *(sProfiler*)data;
-			return 1000.f / prof.CPUTimeArray.GetFromOldest(index);
-		}
-
-		void ImGuiDraw()
-		{
-			struct
-			{
-				float minMs, maxMs, meanMs, lastMs;
-			} cpuTimes, gpuTimes;
-			if (CVar_ShowStats.Get())
-			{
-				sProfiler::GetStats(GProfiler.CPUTimeArray, cpuTimes.minMs, cpuTimes.maxMs, cpuTimes.meanMs, cpuTimes.lastMs);
-				sProfiler::GetStats(GProfiler.GPUTimeArray, gpuTimes.minMs, gpuTimes.maxMs, gpuTimes.meanMs, gpuTimes.lastMs);
-
-				ImGuiWindowFlags flags = ImGuiWindowFlags_NoMove
-					| ImGuiWindowFlags_NoDecoration
-					| ImGuiWindowFlags_AlwaysAutoResize
-					| ImGuiWindowFlags_NoResize
-					//| ImGuiWindowFlags_NoInputs
-					;
-				ImGuiViewport* viewport = ImGui::GetMainViewport();
-				ImGui::SetNextWindowPos(ImVec2{ viewport->Pos.x, viewport->Pos.y + 10.f});
-				ImGui::SetNextWindowSize(ImVec2{ viewport->Size.x * 0.5f, viewport->Size.y * 0.15f });
-				ImGui::SetNextWindowBgAlpha(0.f);
-				ImGui::PushStyleColor(ImGuiCol_PlotLines, ImVec4(0.1f, 0.9f, 0.34f, 1.f));
-				ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.1f, 0.9f, 0.34f, 0.f));
-				ImGui::PushStyleColor(ImGuiCol_Border, ImVec4(0.1f, 0.9f, 0.34f, 0.f));
-				ImGui::Begin("fps", nullptr, flags);
-				ImGui::Text(
-#if defined(_DEBUG)
-                    "DEBUG"
-#else
-                    "RELEASE"
-#endif
-				);
-				ImGui::Text("Frame: %6d | %6.2f fps", tApplication::GetFrame(), 1000.f / cpuTimes.meanMs);
-				ImGui::Text("Cpu %2.3f ms", cpuTimes.meanMs);
-				ImGui::Text("Gpu %2.3f ms", g_render->GetGpuTimeUs() * 0.001f);
-				ImGui::Text("%ux%u", g_render->GetRenderResolution().width, g_render->GetRenderResolution().height);
-				if (CVar_ShowStats.Get() > 1 && 0)
-				{
-					ImGui::Columns(3, nullptr, false);
-					auto utilLamb = [&](const char* label, float ms)
-						{
-							ImGui::Text("%8s", label);
-							ImGui::NextColumn();
-							//ImGui::Text("%3.3f fps", 1000.f/ms);
-							//ImGui::NextColumn();
-							ImGui::Text("%3.3f ms", ms);
-							ImGui::NextColumn();
-						};
-					if (ImGui::BeginChild("Child_cpu_perf"))
-					{
-						ImGui::Text("CPU stats");
-						ImGui::Columns(2, nullptr, false);
-						utilLamb("Last", cpuTimes.lastMs);
-						utilLamb("Mean", cpuTimes.meanMs);
-						utilLamb("Max", cpuTimes.maxMs);
-						utilLamb("Min", cpuTimes.minMs);
-						ImGui::Columns();
-						ImGui::EndChild();
-					}
-					ImGui::NextColumn();
-					if (ImGui::BeginChild("Child_gpu_perf"))
-					{
-						ImGui::Text("GPU stats");
-						ImGui::Columns(2, nullptr, false);
-						utilLamb("Last", gpuTimes.lastMs);
-						utilLamb("Mean", gpuTimes.meanMs);
-						utilLamb("Min", gpuTimes.minMs);
-						utilLamb("Max", gpuTimes.maxMs);
-						ImGui::Columns();
-						ImGui::EndChild();
-					}
-					ImGui::NextColumn();
-					if (ImGui::BeginChild("Child_mem"))
-					{
-						/*auto lmbShowMemStat = [](const char* label, uint64_t allocated, uint64_t maxAllocated)
-							{
-								ImGui::Text("%15s", label);
-								ImGui::NextColumn();
-								ImGui::Text("%8.3f MB", (float)allocated / 1024.f / 1024.f);
-								ImGui::NextColumn();
-								ImGui::Text("%8.3f MB", (float)maxAllocated / 1024.f / 1024.f);
-								ImGui::NextColumn();
-							};
-
-						const tSystemMemStats& systemStats = GetMemoryStats();
-						
-						const tMemStats& bufferStats = context.Allocator->BufferStats;
-						const tMemStats& texStats = context.Allocator->TextureStats;
-						ImGui::Text("Memory");
-						ImGui::Columns(3, nullptr, false);
-						lmbShowMemStat("System", systemStats.Allocated, systemStats.MaxAllocated);
-						lmbShowMemStat("GPU buffer", bufferStats.Allocated, bufferStats.MaxAllocated);
-						lmbShowMemStat("GPU texture", texStats.Allocated, texStats.MaxAllocated);
-						ImGui::Columns();*/
-						ImGui::EndChild();
-					}
-
-					ImGui::Columns();
-				}
-
-				ImGui::End();
-				ImGui::PopStyleColor(3);
-			}
-		}
-
 		bool CpuProfSlotThisFrame() 
 		{ 
 			return !(GetFrame() % __max(CVar_ShowCpuProfRatio.Get(), 2));
@@ -578,12 +247,7 @@ namespace Mist
 
 		bool IsCpuProfActive()
 		{
-			return CpuProfSlotThisFrame() && Profiling::g_cpuProfilingEnabled;
-		}
-
-		Profiling::sProfiler::tCpuProfStackTree& CpuProfGetStack()
-		{
-			return GProfiler.CpuProfStack[GetCurrentFrameIndex()];
+			return g_cpuProfCaptureAll || (CpuProfSlotThisFrame() && Profiling::g_cpuProfilingEnabled);
 		}
 
 		bool CpuProfSetActive(bool active) 
@@ -593,36 +257,61 @@ namespace Mist
 			return res;
 		}
 
-		void CpuProf_Begin(const char* label)
+		bool CpuProf_Begin(uint32_t zoneId)
 		{
-			if (IsCpuProfActive())
-				CpuProfGetStack().Push({ label, 0.0 });
+			if (!GCpuProfRecording.load(std::memory_order_relaxed))
+				return false;
+			tCpuProfThread& thread = CpuProfGetThread();
+			std::lock_guard<std::mutex> lock(thread.Mutex);
+			tCpuProfEvent& e = thread.Events.emplace_back();
+			e.ZoneId = zoneId;
+			e.Parent = thread.Current;
+			e.Value = 0.0;
+			thread.Current = (uint32_t)thread.Events.size() - 1;
+			return true;
 		}
 
 		void CpuProf_End(float ms)
 		{
-			if (IsCpuProfActive())
-			{
-				CpuProfGetStack().GetCurrent().Value = ms;
-				CpuProfGetStack().Pop();
-			}
+			tCpuProfThread& thread = CpuProfGetThread();
+			std::lock_guard<std::mutex> lock(thread.Mutex);
+			check(thread.Current != CpuProfInvalid);
+			tCpuProfEvent& e = thread.Events[thread.Current];
+			e.Value = ms;
+			thread.Current = e.Parent;
 		}
 
 		void CpuProf_Reset()
 		{
+			if (GCpuProfRecording.load())
+				GProfiler.Merge();
 			bool changed = CpuProfSetActive(CVar_ShowCpuProf.Get());
 			if (Profiling::g_cpuProfilingEnabled)
 			{
 				++g_profilerFrame;
 			}
-			if (IsCpuProfActive())
-				CpuProfGetStack().Reset();
+			GCpuProfRecording.store(IsCpuProfActive());
 		}
 
-		void CpuProf_ImGuiDraw()
+		void CpuProf_SetThreadName(const char* name)
 		{
-			if (Profiling::g_cpuProfilingEnabled)
-				GProfiler.ImGuiDraw();
+			tCpuProfThread& thread = CpuProfGetThread();
+			{
+				std::lock_guard<std::mutex> lock(thread.Mutex);
+				thread.Name = name;
+			}
+			Platform::SetCurrentThreadName(name);
+		}
+
+		void CpuProf_SetCaptureAll(bool captureAll)
+		{
+			g_cpuProfCaptureAll = captureAll;
+		}
+
+		void CpuProf_VisitLastFrame(tCpuProfZoneVisitor visitor, void* userData)
+		{
+			check(visitor);
+			GProfiler.Visit(visitor, userData);
 		}
 	}
-}
+}
\ No newline at end of file
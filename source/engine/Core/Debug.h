@@ -2,20 +2,17 @@
 #pragma once
 
 #include <cassert>
+#include "Core/Platform.h"
 
 #define _USE_CHRONO_PROFILING
 #ifdef _USE_CHRONO_PROFILING
 #include <chrono>
 #endif
-#include <intrin.h>
 
 #define DUMMY_MACRO do {((void)0);}while(0)
 
 #define expand(x) (x)
 
-#define MIST_DEBUG_BREAK __debugbreak()
-#define MIST_INSTRUCTION_EXCEPTION __ud2()
-
 #define check(expr) \
 do \
 { \
@@ -61,7 +58,11 @@ do \
 #endif
 
 
-#define CPU_PROFILE_SCOPE(name) Mist::Profiling::sScopedTimer __timer##name(#name); PROF_ZONE_SCOPED(#name)
+// each call site registers its own zone once, so zones never share an id even with equal names.
+#define CPU_PROFILE_SCOPE(name) \
+	static const Mist::Profiling::sProfilerZone __zone##name(#name, __FILE__, __LINE__); \
+	Mist::Profiling::sScopedTimer __timer##name(__zone##name); \
+	PROF_ZONE_SCOPED(#name)
 
 namespace Mist
 {
@@ -84,6 +85,9 @@ namespace Mist
 		};
 
 		bool DebugCheck(const char* txt, const char* file, const char* fn, int line);
+		// runs on a failed check before it is reported, lets the render engine dump its state.
+		typedef void (*tDebugCheckCallback)();
+		void SetDebugCheckCallback(tDebugCheckCallback callback);
 		void PrintCallstack(size_t count = 0, size_t offset = 0);
 		void ExitError();
 
@@ -108,11 +112,21 @@ namespace Mist
 			double Stop();
 		};
 
+		struct sProfilerZone
+		{
+			sProfilerZone(const char* name, const char* file, uint32_t line);
+			const char* Name;
+			const char* File;
+			uint32_t Line;
+			uint32_t Id;
+		};
+
 		struct sScopedTimer : public sProfilingTimer
 		{
-			sScopedTimer(const char* id);
+			sScopedTimer(const sProfilerZone& zone);
 			~sScopedTimer();
-			char Id[32];
+			uint32_t ZoneId;
+			bool Recording;
 		};
 
 		struct sRenderStats
@@ -124,15 +138,21 @@ namespace Mist
 			void Reset();
 		};
 
-		void AddProfilerEntry(const char* key, double timeDiff);
 		void AddGPUTime(float ms);
 		void AddCPUTime(float ms);
 		void ImGuiDraw();
 
-		void CpuProf_Begin(const char* label);
+		// Zones are recorded in a per thread buffer, CpuProf_Reset merges all threads at frame end.
+		bool CpuProf_Begin(uint32_t zoneId);
 		void CpuProf_End(float ms);
 		void CpuProf_Reset();
 		void CpuProf_ImGuiDraw();
+		void CpuProf_SetThreadName(const char* name);
+		// records every frame regardless of r_ShowCpuProf and its ratio (benchmark runs).
+		void CpuProf_SetCaptureAll(bool captureAll);
+		// zones merged by the last CpuProf_Reset, depth first per thread. Depth 0 are the thread roots.
+		typedef void (*tCpuProfZoneVisitor)(const char* threadName, const char* zoneName, uint32_t depth, double ms, void* userData);
+		void CpuProf_VisitLastFrame(tCpuProfZoneVisitor visitor, void* userData);
 
 		extern sRenderStats GRenderStats;
 	}
@@ -0,0 +1,184 @@
+// header file for Mist project 
+#pragma once
+
+#include <cfloat>
+#include <mutex>
+#include "Core/Debug.h"
+#include "Core/Types.h"
+
+#define PROFILING_AVERAGE_DATA_COUNT 64
+
+/**
+ * Cpu profiler state, recorded and merged in Debug.cpp and drawn by the ImGui windows of DebugUI.cpp.
+ */
+
+namespace Mist
+{
+	namespace Profiling
+	{
+		static constexpr uint32_t CpuProfInvalid = UINT32_MAX;
+
+		struct tCpuProfEvent
+		{
+			uint32_t ZoneId;
+			uint32_t Parent;
+			// filled on merge
+			uint32_t Child;
+			uint32_t Sibling;
+			double Value;
+		};
+
+		// Recording buffer owned by a thread. The lock is only contended while merging.
+		struct tCpuProfThread
+		{
+			std::mutex Mutex;
+			tFixedString<32> Name;
+			tDynArray<tCpuProfEvent> Events;
+			uint32_t Current = CpuProfInvalid;
+		};
+
+		struct tCpuProfFrameThread
+		{
+			tFixedString<32> Name;
+			uint32_t FirstEvent;
+			uint32_t EventCount;
+		};
+
+		// all threads recorded in a frame, events use indices local to its thread.
+		struct tCpuProfFrame
+		{
+			tDynArray<tCpuProfEvent> Events;
+			tDynArray<tCpuProfFrameThread> Threads;
+		};
+
+		struct sProfilerEntry
+		{
+			Mist::tCircularBuffer<double, PROFILING_AVERAGE_DATA_COUNT> Data;
+			double Min = DBL_MAX;
+			double Max = -DBL_MAX;
+			double Mean = 0.0;
+		};
+
+		struct sProfiler
+		{
+			tCircularBuffer<float, 128> CPUTimeArray;
+			tCircularBuffer<float, 128> GPUTimeArray;
+
+			std::mutex ZoneMutex;
+			tDynArray<const sProfilerZone*> Zones;
+			tDynArray<sProfilerEntry> Entries;
+
+			std::mutex ThreadMutex;
+			tDynArray<tCpuProfThread*> Threads;
+
+			tCpuProfFrame LastFrame;
+
+			static void GetStats(tCircularBuffer<float, 128>& data, float& min, float& max, float& mean, float& last)
+			{
+				mean = 0.f;
+				min = FLT_MAX;
+				max = -FLT_MAX;
+				last = data.GetLast();
+				for (uint32_t i = 0; i < data.GetCount(); ++i)
+				{
+					float value = data.GetFromOldest(i);
+					min = __min(min, value);
+					max = __max(max, value);
+					mean += value;
+				}
+				mean /= data.GetCount();
+			}
+
+			uint32_t RegisterZone(const sProfilerZone* zone)
+			{
+				std::lock_guard<std::mutex> lock(ZoneMutex);
+				Zones.push_back(zone);
+				return (uint32_t)Zones.size() - 1;
+			}
+
+			const char* GetZoneName(uint32_t zoneId)
+			{
+				std::lock_guard<std::mutex> lock(ZoneMutex);
+				return Zones[zoneId]->Name;
+			}
+
+			// collects closed events of every thread into LastFrame and updates zone stats.
+			void Merge()
+			{
+				LastFrame.Events.clear();
+				LastFrame.Threads.clear();
+				{
+					std::lock_guard<std::mutex> lock(ThreadMutex);
+					for (tCpuProfThread* thread : Threads)
+					{
+						std::lock_guard<std::mutex> threadLock(thread->Mutex);
+						// zones still open at frame end stay on the thread for next merge.
+						if (thread->Events.empty() || thread->Current != CpuProfInvalid)
+							continue;
+						tCpuProfFrameThread& frameThread = LastFrame.Threads.emplace_back();
+						frameThread.Name = thread->Name;
+						frameThread.FirstEvent = (uint32_t)LastFrame.Events.size();
+						frameThread.EventCount = (uint32_t)thread->Events.size();
+						LastFrame.Events.insert(LastFrame.Events.end(), thread->Events.begin(), thread->Events.end());
+						thread->Events.clear();
+					}
+				}
+
+				for (const tCpuProfFrameThread& thread : LastFrame.Threads)
+				{
+					tCpuProfEvent* events = LastFrame.Events.data() + thread.FirstEvent;
+					// link children in recording order, walking backwards to prepend siblings.
+					for (uint32_t i = 0; i < thread.EventCount; ++i)
+						events[i].Child = events[i].Sibling = CpuProfInvalid;
+					uint32_t lastRoot = CpuProfInvalid;
+					for (uint32_t i = thread.EventCount - 1; i < thread.EventCount; --i)
+					{
+						tCpuProfEvent& e = events[i];
+						uint32_t& head = e.Parent != CpuProfInvalid ? events[e.Parent].Child : lastRoot;
+						e.Sibling = head;
+						head = i;
+					}
+				}
+
+				std::lock_guard<std::mutex> lock(ZoneMutex);
+				if (Entries.size() < Zones.size())
+					Entries.resize(Zones.size());
+				for (const tCpuProfEvent& e : LastFrame.Events)
+				{
+					sProfilerEntry& entry = Entries[e.ZoneId];
+					entry.Data.Push(e.Value);
+					entry.Max = __max(e.Value, entry.Max);
+					entry.Min = __min(e.Value, entry.Min);
+					double mean = 0.0;
+					for (uint32_t i = 0; i < entry.Data.GetCount(); ++i)
+						mean += entry.Data.Get(i);
+					entry.Mean = mean / entry.Data.GetCount();
+				}
+			}
+
+			// ImGui windows, DebugUI.cpp.
+			void BuildCpuProfTree(const tCpuProfEvent* events, uint32_t root, double minValue, double maxValue);
+			void ImGuiDraw();
+
+			void VisitEvents(const tCpuProfEvent* events, uint32_t root, uint32_t depth, const char* threadName, tCpuProfZoneVisitor visitor, void* userData)
+			{
+				for (uint32_t index = root; index != CpuProfInvalid; index = events[index].Sibling)
+				{
+					const tCpuProfEvent& e = events[index];
+					visitor(threadName, Zones[e.ZoneId]->Name, depth, e.Value, userData);
+					VisitEvents(events, e.Child, depth + 1, threadName, visitor, userData);
+				}
+			}
+
+			void Visit(tCpuProfZoneVisitor visitor, void* userData)
+			{
+				std::lock_guard<std::mutex> lock(ZoneMutex);
+				for (const tCpuProfFrameThread& thread : LastFrame.Threads)
+					VisitEvents(LastFrame.Events.data() + thread.FirstEvent, 0, 0, thread.Name.CStr(), visitor, userData);
+			}
+		};
+
+		extern sProfiler GProfiler;
+		extern bool g_cpuProfilingEnabled;
+	}
+}
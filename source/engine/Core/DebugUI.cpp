@@ -0,0 +1,219 @@
+// src file for Mist project 
+#include "Core/DebugProfiler.h"
+#include "imgui.h"
+#include "Application/CmdParser.h"
+#include "Application/Application.h"
+#include "Render/RenderEngine.h"
+#include "Render/VulkanRenderEngine.h"
+#include "RenderSystem/RenderSystem.h"
+#include <glm/glm.hpp>
+#include "glm/ext/quaternion_common.inl"
+
+namespace Mist
+{
+	CIntVar CVar_ShowStats("ShowStats", 1);
+
+	namespace Profiling
+	{
+		void sProfiler::BuildCpuProfTree(const tCpuProfEvent* events, uint32_t root, double minValue, double maxValue)
+		{
+			uint32_t index = root;
+			glm::vec4 goodColor = glm::vec4(0.f, 1.f, 0.f, 1.f);
+			glm::vec4 badColor = glm::vec4(1.f, 0.f, 0.f, 1.f);
+			const char* valuefmt = "%10.5f";
+			while (index != CpuProfInvalid)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				const tCpuProfEvent& e = events[index];
+				const char* label = Zones[e.ZoneId]->Name;
+				ImGui::PushID((int)index);
+				bool treeOpen = false;
+				if (e.Child != CpuProfInvalid)
+				{
+					treeOpen = ImGui::TreeNodeEx(label,
+						ImGuiTreeNodeFlags_SpanAllColumns
+						| ImGuiTreeNodeFlags_DefaultOpen);
+				}
+				else
+					ImGui::Text("%s", label);
+				ImGui::TableNextColumn();
+				double v = e.Value;
+				glm::vec4 c = glm::mix(goodColor, badColor, (v - minValue) / (maxValue - minValue));
+				ImGui::TextColored({ c.x, c.y, c.z, c.w }, valuefmt, v);
+				ImGui::TableNextColumn();
+				ImGui::Text(valuefmt, e.ZoneId < Entries.size() ? Entries[e.ZoneId].Mean : 0.0);
+				if (treeOpen)
+				{
+					BuildCpuProfTree(events, e.Child, minValue, maxValue);
+					ImGui::TreePop();
+				}
+				ImGui::PopID();
+				index = e.Sibling;
+			}
+		}
+
+		void sProfiler::ImGuiDraw()
+		{
+			std::lock_guard<std::mutex> lock(ZoneMutex);
+			index_t size = (index_t)(LastFrame.Events.size() + LastFrame.Threads.size());
+			float heightPerLine = 20.f; //approx?
+			ImGuiViewport* viewport = ImGui::GetMainViewport();
+
+			ImVec2 winpos = ImVec2(0.f, 100.f);
+			//ImGui::SetNextWindowPos(winpos);
+			ImGui::SetNextWindowSize(ImVec2(600.f, (float)size * heightPerLine));
+			//ImGui::SetNextWindowBgAlpha(0.8f);
+			ImGui::Begin("Cpu profiling", nullptr, ImGuiWindowFlags_NoDecoration
+				| ImGuiWindowFlags_NoBackground
+				| ImGuiWindowFlags_NoDocking);
+			if (!LastFrame.Events.empty())
+			{
+				ImGuiTableFlags flags = ImGuiTableFlags_BordersV | ImGuiTableFlags_BordersOuterH
+					| ImGuiTableFlags_Resizable
+					| ImGuiTableFlags_RowBg
+					| ImGuiTableFlags_NoBordersInBody;
+				if (ImGui::BeginTable("CpuProf", 3, flags))
+				{
+					ImGui::TableSetupColumn("Process");
+					ImGui::TableSetupColumn("Time (ms)");
+					ImGui::TableSetupColumn("Avg (ms)");
+					ImGui::TableHeadersRow();
+					for (const tCpuProfFrameThread& thread : LastFrame.Threads)
+					{
+						ImGui::TableNextRow();
+						ImGui::TableNextColumn();
+						ImGui::TextDisabled("%s", thread.Name.CStr());
+						// roots are linked as siblings of the first event.
+						BuildCpuProfTree(LastFrame.Events.data() + thread.FirstEvent, 0, 0.0, 4.0);
+					}
+					ImGui::EndTable();
+				}
+			}
+			ImGui::End();
+		}
+
+		float ImGuiGetFpsPlotValue(void* data, int index)
+		{
+			sProfiler& prof = *(sProfiler*)data;
+			return prof.CPUTimeArray.GetFromOldest(index);
+		}
+
+		float ImGuiGetMsPlotValue(void* data, int index)
+		{
+			sProfiler& prof = *(sProfiler*)data;
+			return 1000.f / prof.CPUTimeArray.GetFromOldest(index);
+		}
+
+		void ImGuiDraw()
+		{
+			struct
+			{
+				float minMs, maxMs, meanMs, lastMs;
+			} cpuTimes, gpuTimes;
+			if (CVar_ShowStats.Get())
+			{
+				sProfiler::GetStats(GProfiler.CPUTimeArray, cpuTimes.minMs, cpuTimes.maxMs, cpuTimes.meanMs, cpuTimes.lastMs);
+				sProfiler::GetStats(GProfiler.GPUTimeArray, gpuTimes.minMs, gpuTimes.maxMs, gpuTimes.meanMs, gpuTimes.lastMs);
+
+				ImGuiWindowFlags flags = ImGuiWindowFlags_NoMove
+					| ImGuiWindowFlags_NoDecoration
+					| ImGuiWindowFlags_AlwaysAutoResize
+					| ImGuiWindowFlags_NoResize
+					//| ImGuiWindowFlags_NoInputs
+					;
+				ImGuiViewport* viewport = ImGui::GetMainViewport();
+				ImGui::SetNextWindowPos(ImVec2{ viewport->Pos.x, viewport->Pos.y + 10.f});
+				ImGui::SetNextWindowSize(ImVec2{ viewport->Size.x * 0.5f, viewport->Size.y * 0.15f });
+				ImGui::SetNextWindowBgAlpha(0.f);
+				ImGui::PushStyleColor(ImGuiCol_PlotLines, ImVec4(0.1f, 0.9f, 0.34f, 1.f));
+				ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.1f, 0.9f, 0.34f, 0.f));
+				ImGui::PushStyleColor(ImGuiCol_Border, ImVec4(0.1f, 0.9f, 0.34f, 0.f));
+				ImGui::Begin("fps", nullptr, flags);
+				ImGui::Text(
+#if defined(_DEBUG)
+                    "DEBUG"
+#else
+                    "RELEASE"
+#endif
+				);
+				ImGui::Text("Frame: %6d | %6.2f fps", tApplication::GetFrame(), 1000.f / cpuTimes.meanMs);
+				ImGui::Text("Cpu %2.3f ms", cpuTimes.meanMs);
+				ImGui::Text("Gpu %2.3f ms", g_render->GetGpuTimeUs() * 0.001f);
+				ImGui::Text("%ux%u", g_render->GetRenderResolution().width, g_render->GetRenderResolution().height);
+				if (CVar_ShowStats.Get() > 1 && 0)
+				{
+					ImGui::Columns(3, nullptr, false);
+					auto utilLamb = [&](const char* label, float ms)
+						{
+							ImGui::Text("%8s", label);
+							ImGui::NextColumn();
+							//ImGui::Text("%3.3f fps", 1000.f/ms);
+							//ImGui::NextColumn();
+							ImGui::Text("%3.3f ms", ms);
+							ImGui::NextColumn();
+						};
+					if (ImGui::BeginChild("Child_cpu_perf"))
+					{
+						ImGui::Text("CPU stats");
+						ImGui::Columns(2, nullptr, false);
+						utilLamb("Last", cpuTimes.lastMs);
+						utilLamb("Mean", cpuTimes.meanMs);
+						utilLamb("Max", cpuTimes.maxMs);
+						utilLamb("Min", cpuTimes.minMs);
+						ImGui::Columns();
+						ImGui::EndChild();
+					}
+					ImGui::NextColumn();
+					if (ImGui::BeginChild("Child_gpu_perf"))
+					{
+						ImGui::Text("GPU stats");
+						ImGui::Columns(2, nullptr, false);
+						utilLamb("Last", gpuTimes.lastMs);
+						utilLamb("Mean", gpuTimes.meanMs);
+						utilLamb("Min", gpuTimes.minMs);
+						utilLamb("Max", gpuTimes.maxMs);
+						ImGui::Columns();
+						ImGui::EndChild();
+					}
+					ImGui::NextColumn();
+					if (ImGui::BeginChild("Child_mem"))
+					{
+						/*auto lmbShowMemStat = [](const char* label, uint64_t allocated, uint64_t maxAllocated)
+							{
+								ImGui::Text("%15s", label);
+								ImGui::NextColumn();
+								ImGui::Text("%8.3f MB", (float)allocated / 1024.f / 1024.f);
+								ImGui::NextColumn();
+								ImGui::Text("%8.3f MB", (float)maxAllocated / 1024.f / 1024.f);
+								ImGui::NextColumn();
+							};
+
+						const tSystemMemStats& systemStats = GetMemoryStats();
+						
+						const tMemStats& bufferStats = context.Allocator->BufferStats;
+						const tMemStats& texStats = context.Allocator->TextureStats;
+						ImGui::Text("Memory");
+						ImGui::Columns(3, nullptr, false);
+						lmbShowMemStat("System", systemStats.Allocated, systemStats.MaxAllocated);
+						lmbShowMemStat("GPU buffer", bufferStats.Allocated, bufferStats.MaxAllocated);
+						lmbShowMemStat("GPU texture", texStats.Allocated, texStats.MaxAllocated);
+						ImGui::Columns();*/
+						ImGui::EndChild();
+					}
+
+					ImGui::Columns();
+				}
+
+				ImGui::End();
+				ImGui::PopStyleColor(3);
+			}
+		}
+
+		void CpuProf_ImGuiDraw()
+		{
+			if (Profiling::g_cpuProfilingEnabled)
+				GProfiler.ImGuiDraw();
+		}
+	}
+}
@@ -2,6 +2,12 @@
 #include "Application/Application.h"
 #include "Core/Logger.h"
 #include "Core/SystemMemory.h"
+#include "Core/StringId.h"
+#include "Core/Hash.h"
+#include "Application/CmdParser.h"
+#include "Utils/FileSystem.h"
+#include "Utils/Compression.h"
+#include "Scene/SceneComponents.h"
 
 int main(int argc, char* argv[])
 {
@@ -11,6 +17,13 @@ int main(int argc, char* argv[])
 		PROFILE_SCOPE_LOG(InitApp, "Init app");
 		Mist::InitSytemMemory();
 		Mist::InitLog("log.html");
+		Mist::InitStringIds();
+		Mist::InitHash();
+		Mist::InitTypes();
+		Mist::InitCVars();
+		Mist::InitFileSystem();
+		Mist::InitCompression();
+		Mist::InitSceneComponents();
 		app = Mist::tApplication::CreateApplication(argc, argv);
 	}
 	{
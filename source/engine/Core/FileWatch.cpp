@@ -0,0 +1,373 @@
+#include "Core/FileWatch.h"
+#include "Core/Debug.h"
+#include "Core/Logger.h"
+#include "Core/Console.h"
+#include "Application/CmdParser.h"
+#include "Utils/FileSystem.h"
+#include "Core/TestUtils.h"
+#if defined(_WIN32)
+#include <direct.h>
+#endif
+
+namespace Mist
+{
+	CBoolVar CVar_FileWatch("fs_watch", true);
+	CIntVar CVar_FileWatchCoalesceMs("fs_watchCoalesceMs", 100);
+
+	namespace filewatch
+	{
+		// net change of a burst, false when there is nothing to report.
+		bool GetNetChange(Platform::eFileChange first, Platform::eFileChange last, Platform::eFileChange& change)
+		{
+			if (first == Platform::FileChange_Added)
+			{
+				// temporary file.
+				if (last == Platform::FileChange_Removed)
+					return false;
+				change = Platform::FileChange_Added;
+			}
+			else
+			{
+				change = last == Platform::FileChange_Removed ? Platform::FileChange_Removed : Platform::FileChange_Modified;
+			}
+			return true;
+		}
+
+		uint64_t MsToTicks(uint32_t ms)
+		{
+			return Platform::GetTickFrequency() * ms / 1000;
+		}
+
+		struct tListener
+		{
+			tFileWatchCallback Callback;
+			void* UserData;
+		};
+
+		struct tFileWatchService
+		{
+			cFileWatcher Watcher;
+			tDynArray<tListener> Listeners;
+		};
+
+		tFileWatchService GFileWatch;
+
+		void Dispatch(const tFileWatchEvent* events, uint32_t count, void* userData)
+		{
+			for (size_t i = 0; i < GFileWatch.Listeners.size(); ++i)
+				GFileWatch.Listeners[i].Callback(events, count, GFileWatch.Listeners[i].UserData);
+		}
+	}
+
+	cFileWatcher::~cFileWatcher()
+	{
+		End();
+	}
+
+	bool cFileWatcher::Begin(const char* directory, bool recursive, uint32_t coalesceMs)
+	{
+		check(!IsWatching());
+		if (!Platform::BeginDirectoryWatch(directory, recursive, m_watch))
+			return false;
+		m_coalesceTicks = filewatch::MsToTicks(coalesceMs);
+		m_pending.clear();
+		m_overflow = false;
+		return true;
+	}
+
+	void cFileWatcher::End()
+	{
+		Platform::EndDirectoryWatch(m_watch);
+		m_pending.clear();
+		m_events.clear();
+		m_overflow = false;
+	}
+
+	void cFileWatcher::OnFileChange(const char* path, Platform::eFileChange change, void* userData)
+	{
+		cFileWatcher& watcher = *static_cast<cFileWatcher*>(userData);
+		uint64_t now = Platform::GetTicks();
+		// while overflowed single changes don't matter, only when the burst ends.
+		if (change == Platform::FileChange_Overflow || watcher.m_overflow)
+		{
+			watcher.m_overflow = true;
+			watcher.m_overflowTick = now;
+			return;
+		}
+		if (strlen(path) >= sizeof(tPendingChange::Path))
+		{
+			logfwarn("File watch path too long, change ignored: %s\n", path);
+			return;
+		}
+		for (size_t i = 0; i < watcher.m_pending.size(); ++i)
+		{
+			if (!strcmp(watcher.m_pending[i].Path, path))
+			{
+				watcher.m_pending[i].Last = change;
+				watcher.m_pending[i].LastTick = now;
+				return;
+			}
+		}
+		tPendingChange pending;
+		strcpy_s(pending.Path, path);
+		pending.First = change;
+		pending.Last = change;
+		pending.LastTick = now;
+		watcher.m_pending.push_back(pending);
+	}
+
+	uint32_t cFileWatcher::Update(tFileWatchCallback callback, void* userData, bool flush)
+	{
+		if (!IsWatching())
+			return 0;
+		Platform::PollDirectoryWatch(m_watch, &OnFileChange, this);
+		uint64_t now = Platform::GetTicks();
+		m_events.clear();
+		if (m_overflow)
+		{
+			if (!flush && now - m_overflowTick < m_coalesceTicks)
+				return 0;
+			// the pending changes are part of the lost ones.
+			m_pending.clear();
+			m_overflow = false;
+			tFileWatchEvent e;
+			*e.Path = 0;
+			e.Change = Platform::FileChange_Overflow;
+			m_events.push_back(e);
+		}
+		else
+		{
+			size_t kept = 0;
+			for (size_t i = 0; i < m_pending.size(); ++i)
+			{
+				const tPendingChange& pending = m_pending[i];
+				if (!flush && now - pending.LastTick < m_coalesceTicks)
+				{
+					m_pending[kept++] = pending;
+					continue;
+				}
+				tFileWatchEvent e;
+				if (filewatch::GetNetChange(pending.First, pending.Last, e.Change))
+				{
+					strcpy_s(e.Path, pending.Path);
+					m_events.push_back(e);
+				}
+			}
+			m_pending.resize(kept);
+		}
+		if (!m_events.empty())
+			callback(m_events.data(), (uint32_t)m_events.size(), userData);
+		return (uint32_t)m_events.size();
+	}
+
+	namespace filewatch_test
+	{
+		struct tEventLog
+		{
+			tDynArray<tFileWatchEvent> Events;
+		};
+
+		void LogEvents(const tFileWatchEvent* events, uint32_t count, void* userData)
+		{
+			tEventLog& log = *static_cast<tEventLog*>(userData);
+			log.Events.insert(log.Events.end(), events, events + count);
+		}
+
+		// polls until something was reported and nothing is pending, or until timeoutMs.
+		void Settle(cFileWatcher& watcher, tEventLog& log, uint32_t timeoutMs)
+		{
+			log.Events.clear();
+			uint64_t end = Platform::GetTicks() + filewatch::MsToTicks(timeoutMs);
+			do
+			{
+				Platform::SleepMs(10);
+				watcher.Update(&LogEvents, &log);
+			} while ((log.Events.empty() || watcher.HasPendingChanges()) && Platform::GetTicks() < end);
+		}
+
+		const tFileWatchEvent* FindEvent(const tEventLog& log, const char* path)
+		{
+			for (size_t i = 0; i < log.Events.size(); ++i)
+			{
+				if (!strcmp(log.Events[i].Path, path))
+					return &log.Events[i];
+			}
+			return nullptr;
+		}
+
+		bool IsOnlyEvent(const tEventLog& log, const char* path, Platform::eFileChange change)
+		{
+			const tFileWatchEvent* e = FindEvent(log, path);
+			return log.Events.size() == 1 && e && e->Change == change;
+		}
+
+		bool WriteTestFile(const char* directory, const char* name, const char* content)
+		{
+			char path[512];
+			sprintf_s(path, "%s/%s", directory, name);
+			FILE* f = nullptr;
+			if (fopen_s(&f, path, "wb"))
+				return false;
+			fwrite(content, 1, strlen(content), f);
+			fclose(f);
+			return true;
+		}
+
+		void RemoveTestFile(const char* directory, const char* name)
+		{
+			char path[512];
+			sprintf_s(path, "%s/%s", directory, name);
+			remove(path);
+		}
+
+		bool ReplaceTestFile(const char* directory, const char* from, const char* to)
+		{
+			char fromPath[512];
+			char toPath[512];
+			sprintf_s(fromPath, "%s/%s", directory, from);
+			sprintf_s(toPath, "%s/%s", directory, to);
+			if (!rename(fromPath, toPath))
+				return true;
+			// rename doesn't replace on windows.
+			remove(toPath);
+			return !rename(fromPath, toPath);
+		}
+	}
+
+	bool TestFileWatch()
+	{
+		using namespace filewatch_test;
+		char directory[256];
+		cAssetPath::GetWorkspacePath(directory, "fs_watchtest");
+		char subdirectory[260];
+		sprintf_s(subdirectory, "%s/sub", directory);
+		FileSystem::Mkdir(directory);
+		cFileWatcher watcher;
+		if (!watcher.Begin(directory, true, 50))
+		{
+			logferror("File watch not available for %s\n", directory);
+			_rmdir(directory);
+			return false;
+		}
+
+		loginfo("****************** File watch tests ******************\n");
+		// every step polls up to one second, a slow os reports late but only once.
+		const uint32_t timeoutMs = 1000;
+		bool result = true;
+		tEventLog log;
+
+		// written and closed: one addition, not an addition plus modifications.
+		result &= TestResult(WriteTestFile(directory, "a.txt", "0"), "File watch", "create file");
+		Settle(watcher, log, timeoutMs);
+		result &= TestResult(IsOnlyEvent(log, "a.txt", Platform::FileChange_Added), "File watch", "added");
+
+		for (uint32_t i = 0; i < 3; ++i)
+			WriteTestFile(directory, "a.txt", "1");
+		Settle(watcher, log, timeoutMs);
+		result &= TestResult(IsOnlyEvent(log, "a.txt", Platform::FileChange_Modified), "File watch", "modified coalesced");
+
+		// editors save to a temporary file renamed over the original.
+		WriteTestFile(directory, "a.txt.tmp", "2");
+		ReplaceTestFile(directory, "a.txt.tmp", "a.txt");
+		Settle(watcher, log, timeoutMs);
+		const tFileWatchEvent* replaced = FindEvent(log, "a.txt");
+		result &= TestResult(log.Events.size() == 1 && replaced && replaced->Change != Platform::FileChange_Removed, "File watch", "replaced by rename");
+
+		// created and deleted in the same burst: nothing to report.
+		WriteTestFile(directory, "b.txt", "3");
+		RemoveTestFile(directory, "b.txt");
+		Settle(watcher, log, 200);
+		result &= TestResult(log.Events.empty() && !watcher.HasPendingChanges(), "File watch", "temporary file");
+
+		// new directories join the watch.
+		FileSystem::Mkdir(subdirectory);
+		Settle(watcher, log, 100);
+		WriteTestFile(subdirectory, "c.txt", "4");
+		Settle(watcher, log, timeoutMs);
+		const tFileWatchEvent* nested = FindEvent(log, "sub/c.txt");
+		result &= TestResult(nested && nested->Change == Platform::FileChange_Added, "File watch", "new subdirectory");
+
+		RemoveTestFile(directory, "a.txt");
+		Settle(watcher, log, timeoutMs);
+		result &= TestResult(IsOnlyEvent(log, "a.txt", Platform::FileChange_Removed), "File watch", "removed");
+
+		// flush reports without waiting for the burst to end.
+		WriteTestFile(subdirectory, "c.txt", "5");
+		uint64_t end = Platform::GetTicks() + filewatch::MsToTicks(timeoutMs);
+		while (!watcher.HasPendingChanges() && Platform::GetTicks() < end)
+		{
+			log.Events.clear();
+			watcher.Update(&LogEvents, &log);
+			Platform::SleepMs(1);
+		}
+		log.Events.clear();
+		watcher.Update(&LogEvents, &log, true);
+		result &= TestResult(IsOnlyEvent(log, "sub/c.txt", Platform::FileChange_Modified) && !watcher.HasPendingChanges(), "File watch", "flush");
+
+		watcher.End();
+		RemoveTestFile(subdirectory, "c.txt");
+		_rmdir(subdirectory);
+		_rmdir(directory);
+		loginfo("******************************************************\n");
+		return result;
+	}
+
+	void ExecCommand_TestFileWatch(const char* command)
+	{
+		TestFileWatch();
+	}
+
+	void InitFileWatch()
+	{
+		using namespace filewatch;
+		AddConsoleCommand("fs_watchtest", &ExecCommand_TestFileWatch);
+		if (!CVar_FileWatch.Get())
+		{
+			loginfo("File watch disabled.\n");
+			return;
+		}
+		uint32_t coalesceMs = (uint32_t)__max(CVar_FileWatchCoalesceMs.Get(), 0);
+		if (GFileWatch.Watcher.Begin(CVar_Workspace.Get(), true, coalesceMs))
+			logfinfo("File watch: %s (%u ms coalesce)\n", CVar_Workspace.Get(), coalesceMs);
+		else
+			logfwarn("File watch not available for %s, reload changes by command.\n", CVar_Workspace.Get());
+	}
+
+	void TerminateFileWatch()
+	{
+		using namespace filewatch;
+		GFileWatch.Watcher.End();
+		GFileWatch.Listeners.clear();
+	}
+
+	bool IsFileWatchRunning()
+	{
+		return filewatch::GFileWatch.Watcher.IsWatching();
+	}
+
+	void UpdateFileWatch()
+	{
+		using namespace filewatch;
+		CPU_PROFILE_SCOPE(UpdateFileWatch);
+		GFileWatch.Watcher.Update(&Dispatch, nullptr);
+	}
+
+	void AddFileWatchListener(tFileWatchCallback callback, void* userData)
+	{
+		check(callback);
+		filewatch::GFileWatch.Listeners.push_back({ callback, userData });
+	}
+
+	void RemoveFileWatchListener(tFileWatchCallback callback, void* userData)
+	{
+		tDynArray<filewatch::tListener>& listeners = filewatch::GFileWatch.Listeners;
+		for (size_t i = 0; i < listeners.size(); ++i)
+		{
+			if (listeners[i].Callback == callback && listeners[i].UserData == userData)
+			{
+				listeners.erase(listeners.begin() + i);
+				return;
+			}
+		}
+	}
+}
@@ -0,0 +1,82 @@
+// header file for Mist project
+#pragma once
+
+#include <stdint.h>
+#include "Core/Types.h"
+#include "Core/Platform.h"
+
+/**
+ * File change events of a directory tree, from the os notifications (inotify, ReadDirectoryChangesW)
+ * polled without blocking. Changes are coalesced per path: a path is reported once it has been quiet
+ * for the coalesce time, with the net change of the burst. Saving through a temporary file and a rename
+ * reports one change of the final file, a file created and deleted in between reports nothing. When the
+ * os drops notifications a single FileChange_Overflow is reported and the listener must assume that
+ * anything changed.
+ */
+
+namespace Mist
+{
+	struct tFileWatchEvent
+	{
+		// relative to the watched directory, '/' separated. Empty for FileChange_Overflow.
+		char Path[256];
+		// Added and Modified both mean new content, a file replaced by a rename may report either.
+		Platform::eFileChange Change;
+	};
+
+	typedef void (*tFileWatchCallback)(const tFileWatchEvent* events, uint32_t count, void* userData);
+
+	class cFileWatcher
+	{
+	public:
+		cFileWatcher() = default;
+		~cFileWatcher();
+		cFileWatcher(const cFileWatcher&) = delete;
+		cFileWatcher& operator=(const cFileWatcher&) = delete;
+
+		bool Begin(const char* directory, bool recursive, uint32_t coalesceMs);
+		void End();
+		inline bool IsWatching() const { return m_watch.IsValid(); }
+		inline bool HasPendingChanges() const { return !m_pending.empty() || m_overflow; }
+
+		// polls the os and calls callback once with the changes quiet for the coalesce time, or every
+		// pending change with flush. Returns the number of events reported.
+		uint32_t Update(tFileWatchCallback callback, void* userData, bool flush = false);
+
+	private:
+		struct tPendingChange
+		{
+			char Path[256];
+			// first and last change of the burst give the net change.
+			Platform::eFileChange First;
+			Platform::eFileChange Last;
+			uint64_t LastTick;
+		};
+
+		static void OnFileChange(const char* path, Platform::eFileChange change, void* userData);
+
+	private:
+		Platform::tDirectoryWatch m_watch;
+		uint64_t m_coalesceTicks = 0;
+		tDynArray<tPendingChange> m_pending;
+		tDynArray<tFileWatchEvent> m_events;
+		bool m_overflow = false;
+		uint64_t m_overflowTick = 0;
+	};
+
+	/**
+	 * Workspace watch. Listeners run on the main thread from UpdateFileWatch, once per frame with the
+	 * coalesced events, paths relative to the workspace.
+	 */
+	// watches CVar_Workspace unless fs_watch is disabled.
+	void InitFileWatch();
+	void TerminateFileWatch();
+	bool IsFileWatchRunning();
+	void UpdateFileWatch();
+	void AddFileWatchListener(tFileWatchCallback callback, void* userData);
+	void RemoveFileWatchListener(tFileWatchCallback callback, void* userData);
+
+	// Watches a temporary directory of the workspace, writes, replaces and deletes files in it and
+	// checks the coalesced events.
+	bool TestFileWatch();
+}
@@ -0,0 +1,157 @@
+#include "Core/FrameAllocator.h"
+#include "Core/SystemMemory.h"
+#include "Core/Debug.h"
+#include "Core/Logger.h"
+#include "Core/Console.h"
+#include "Application/CmdParser.h"
+#include "Render/Globals.h"
+#include <string.h>
+
+namespace Mist
+{
+	CIntVar CVar_FrameArenaSize("FrameArenaSizeKB", 512);
+
+	tLinearAllocator::~tLinearAllocator()
+	{
+		Destroy();
+	}
+
+	void tLinearAllocator::Init(size_t blockSize)
+	{
+		check(!m_current);
+		m_blockSize = blockSize;
+		if (m_blockSize)
+			PushBlock(m_blockSize);
+	}
+
+	void tLinearAllocator::Destroy()
+	{
+		while (m_current)
+		{
+			tBlock* next = m_current->Next;
+			Free(m_current);
+			m_current = next;
+		}
+		m_pointer = nullptr;
+		m_end = nullptr;
+		m_used = 0;
+		m_capacity = 0;
+		m_blockCount = 0;
+	}
+
+	void* tLinearAllocator::Allocate(size_t size, size_t alignment)
+	{
+		check(alignment && !(alignment & (alignment - 1)));
+		uintptr_t p = ((uintptr_t)m_pointer + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		if (!m_current || p + size > (uintptr_t)m_end)
+		{
+			PushBlock(__max(m_blockSize, size + alignment));
+			p = ((uintptr_t)m_pointer + alignment - 1) & ~(uintptr_t)(alignment - 1);
+			check(p + size <= (uintptr_t)m_end);
+		}
+		m_pointer = (uint8_t*)(p + size);
+		return (void*)p;
+	}
+
+	void tLinearAllocator::Reset()
+	{
+		m_peak = __max(m_peak, GetUsed());
+		if (m_current && m_current->Next)
+		{
+			// merge chain in a single block, next frames will fit in it.
+			size_t capacity = m_capacity;
+			Destroy();
+			m_blockSize = __max(m_blockSize, capacity);
+			PushBlock(m_blockSize);
+		}
+		else if (m_current)
+		{
+#ifdef _DEBUG
+			// catch anyone still reading data from a retired frame.
+			memset(GetBlockData(m_current), 0xcd, m_pointer - GetBlockData(m_current));
+#endif // _DEBUG
+			m_pointer = GetBlockData(m_current);
+		}
+		m_used = 0;
+	}
+
+	void tLinearAllocator::PushBlock(size_t size)
+	{
+		tBlock* block = (tBlock*)_malloc(sizeof(tBlock) + size);
+		check(block);
+		block->Next = m_current;
+		block->Size = size;
+		if (m_current)
+			m_used += (size_t)(m_pointer - GetBlockData(m_current));
+		m_current = block;
+		m_pointer = GetBlockData(block);
+		m_end = m_pointer + size;
+		m_capacity += size;
+		++m_blockCount;
+	}
+
+	namespace frameallocator
+	{
+		tLinearAllocator Arenas[globals::MaxOverlappedFrames];
+		uint32_t Current = 0;
+	}
+
+	void DumpFrameAllocatorStats()
+	{
+		loginfo("****************** Frame allocator stats ******************\n");
+		for (uint32_t i = 0; i < globals::MaxOverlappedFrames; ++i)
+		{
+			const tLinearAllocator& arena = frameallocator::Arenas[i];
+			logfinfo("Arena %d%c | used %9lld bytes | peak %9lld bytes | capacity %9lld bytes | blocks %2d\n",
+				i, i == frameallocator::Current ? '*' : ' ', arena.GetUsed(), arena.GetPeak(), arena.GetCapacity(), arena.GetBlockCount());
+		}
+		loginfo("***********************************************************\n");
+	}
+
+	void ExecCommand_DumpFrameAllocatorStats(const char* command)
+	{
+		DumpFrameAllocatorStats();
+	}
+
+	void InitFrameAllocator()
+	{
+		size_t arenaSize = (size_t)__max(CVar_FrameArenaSize.Get(), 1) * 1024;
+		for (uint32_t i = 0; i < globals::MaxOverlappedFrames; ++i)
+			frameallocator::Arenas[i].Init(arenaSize);
+		frameallocator::Current = 0;
+		AddConsoleCommand("c_frameallocstats", &ExecCommand_DumpFrameAllocatorStats);
+	}
+
+	void TerminateFrameAllocator()
+	{
+		for (uint32_t i = 0; i < globals::MaxOverlappedFrames; ++i)
+			frameallocator::Arenas[i].Destroy();
+	}
+
+	void FrameAllocator_BeginFrame(uint64_t frame)
+	{
+		frameallocator::Current = (uint32_t)(frame % globals::MaxOverlappedFrames);
+		frameallocator::Arenas[frameallocator::Current].Reset();
+	}
+
+	tLinearAllocator* GetFrameAllocator()
+	{
+		return &frameallocator::Arenas[frameallocator::Current];
+	}
+
+	tLinearAllocator* GetFrameAllocator(uint32_t arenaIndex)
+	{
+		check(arenaIndex < globals::MaxOverlappedFrames);
+		return &frameallocator::Arenas[arenaIndex];
+	}
+
+	uint32_t GetFrameAllocatorCount()
+	{
+		return globals::MaxOverlappedFrames;
+	}
+
+	void* FrameMalloc(size_t size, size_t alignment)
+	{
+		return GetFrameAllocator()->Allocate(size, alignment);
+	}
+}
@@ -0,0 +1,117 @@
+// header file for Mist project
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
+
+namespace Mist
+{
+	// Bump allocator. Allocations are never released individually, Reset() releases all of them at once.
+	// Memory is requested in blocks to the system allocator. When a block is exhausted a new one is chained,
+	// and the next Reset() merges the chain in a single block big enough for the peak usage, so after
+	// a few frames of warm up no more system allocations are done.
+	// Not thread safe.
+	class tLinearAllocator
+	{
+		struct tBlock
+		{
+			tBlock* Next;
+			size_t Size;
+		};
+	public:
+		static constexpr size_t DefaultAlignment = 16;
+
+		tLinearAllocator() = default;
+		~tLinearAllocator();
+		tLinearAllocator(const tLinearAllocator&) = delete;
+		tLinearAllocator& operator=(const tLinearAllocator&) = delete;
+
+		void Init(size_t blockSize);
+		void Destroy();
+
+		[[nodiscard]] void* Allocate(size_t size, size_t alignment = DefaultAlignment);
+		template <typename T>
+		[[nodiscard]] T* AllocateArray(size_t count) { return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T))); }
+
+		void Reset();
+
+		inline size_t GetUsed() const { return m_used + (size_t)(m_pointer - GetBlockData(m_current)); }
+		inline size_t GetPeak() const { return m_peak; }
+		inline size_t GetCapacity() const { return m_capacity; }
+		inline uint32_t GetBlockCount() const { return m_blockCount; }
+
+	private:
+		void PushBlock(size_t size);
+		static inline uint8_t* GetBlockData(tBlock* block) { return block ? reinterpret_cast<uint8_t*>(block + 1) : nullptr; }
+
+		tBlock* m_current = nullptr;
+		uint8_t* m_pointer = nullptr;
+		uint8_t* m_end = nullptr;
+		size_t m_blockSize = 0;
+		// bytes consumed in the chained blocks, without counting current block.
+		size_t m_used = 0;
+		size_t m_peak = 0;
+		size_t m_capacity = 0;
+		uint32_t m_blockCount = 0;
+	};
+
+	// One arena per overlapped frame (globals::MaxOverlappedFrames).
+	// The arena of a frame is reset when that frame slot is reused, so the data allocated during a frame
+	// is valid until the gpu has retired it.
+	// Owned by the thread that records the frame: the render thread when r_renderThread is enabled, the
+	// main thread otherwise. Only the render system allocates from it and begins its frames. The arenas
+	// are not locked, other threads may only read them (stats) at the frame sync point, while the render
+	// thread is idle. Init and terminate before the render thread starts and after it has joined.
+	void InitFrameAllocator();
+	void TerminateFrameAllocator();
+	// Resets the arena of the given frame and sets it as current one.
+	// Caller must guarantee that the last frame which used the same arena has been retired.
+	void FrameAllocator_BeginFrame(uint64_t frame);
+	tLinearAllocator* GetFrameAllocator();
+	tLinearAllocator* GetFrameAllocator(uint32_t arenaIndex);
+	uint32_t GetFrameAllocatorCount();
+	[[nodiscard]] void* FrameMalloc(size_t size, size_t alignment = tLinearAllocator::DefaultAlignment);
+
+	// STL adapter. The arena is bound when the allocator is created (current frame arena by default),
+	// so containers must be released before their arena is reset.
+	template <typename T>
+	class tFrameStdAllocator
+	{
+	public:
+		typedef T value_type;
+		typedef std::true_type propagate_on_container_copy_assignment;
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+		tFrameStdAllocator() noexcept : m_arena(GetFrameAllocator()) {}
+		explicit tFrameStdAllocator(tLinearAllocator* arena) noexcept : m_arena(arena) {}
+
+		template <typename U>
+		constexpr tFrameStdAllocator(const tFrameStdAllocator<U>& other) noexcept : m_arena(other.GetArena()) {}
+
+		[[nodiscard]] T* allocate(size_t size)
+		{
+			return m_arena->AllocateArray<T>(size);
+		}
+
+		void deallocate(T* ptr, size_t size) noexcept
+		{
+			// memory is released when arena is reset.
+		}
+
+		inline tLinearAllocator* GetArena() const { return m_arena; }
+
+	private:
+		tLinearAllocator* m_arena;
+	};
+
+	template <class T, class U>
+	bool operator ==(const tFrameStdAllocator<T>& a, const tFrameStdAllocator<U>& b) { return a.GetArena() == b.GetArena(); }
+	template <class T, class U>
+	bool operator !=(const tFrameStdAllocator<T>& a, const tFrameStdAllocator<U>& b) { return a.GetArena() != b.GetArena(); }
+
+	template <typename T>
+	using tFrameDynArray = std::vector<T, tFrameStdAllocator<T>>;
+}
@@ -0,0 +1,167 @@
+#include "Core/Hash.h"
+#include "Core/Types.h"
+#include "Core/Debug.h"
+#include "Core/Logger.h"
+#include "Core/Console.h"
+#include <algorithm>
+#include <bit>
+#include <string>
+#include <string_view>
+
+namespace Mist
+{
+	namespace hash_test
+	{
+		// Hashes a set of similar names (the worst case for weak hashes) and counts full and 32 bit collisions.
+		// Also checks bucket distribution of the low bits, which is what the hash maps use.
+		void TestCollisions()
+		{
+			static constexpr uint32_t KeyCount = 1 << 20;
+			static constexpr uint32_t BucketBits = 16;
+			static constexpr uint32_t BucketCount = 1 << BucketBits;
+			static const char* Patterns[] = { "u_material%d", "texture_%08x", "%d", "shaders/pass_%d.frag" };
+
+			uint64_t* hashes = (uint64_t*)malloc(sizeof(uint64_t) * KeyCount);
+			uint32_t* buckets = (uint32_t*)malloc(sizeof(uint32_t) * BucketCount);
+			check(hashes && buckets);
+			for (uint32_t p = 0; p < CountOf(Patterns); ++p)
+			{
+				memset(buckets, 0, sizeof(uint32_t) * BucketCount);
+				char key[64];
+				for (uint32_t i = 0; i < KeyCount; ++i)
+				{
+					sprintf_s(key, Patterns[p], i);
+					hashes[i] = HashCStr(key);
+					++buckets[hashes[i] & (BucketCount - 1)];
+				}
+
+				// chi square over buckets, expected value close to BucketCount - 1 with a low deviation.
+				double expected = (double)KeyCount / BucketCount;
+				double chi = 0.0;
+				for (uint32_t i = 0; i < BucketCount; ++i)
+					chi += ((double)buckets[i] - expected) * ((double)buckets[i] - expected) / expected;
+
+				std::sort(hashes, hashes + KeyCount);
+				uint32_t collisions64 = 0;
+				for (uint32_t i = 1; i < KeyCount; ++i)
+					collisions64 += hashes[i] == hashes[i - 1];
+				for (uint32_t i = 0; i < KeyCount; ++i)
+					hashes[i] &= 0xffffffffull;
+				std::sort(hashes, hashes + KeyCount);
+				uint32_t collisions32 = 0;
+				for (uint32_t i = 1; i < KeyCount; ++i)
+					collisions32 += hashes[i] == hashes[i - 1];
+				double expected32 = (double)KeyCount * (KeyCount - 1) / (2.0 * 4294967296.0);
+
+				logfinfo("%-22s | %d keys | 64 bit collisions %d | 32 bit collisions %5d (expected %5.0f) | chi2 %8.1f (expected %d)\n",
+					Patterns[p], KeyCount, collisions64, collisions32, expected32, chi, BucketCount - 1);
+				if (collisions64)
+					logferror("Hash test: %d full collisions with pattern %s\n", collisions64, Patterns[p]);
+			}
+			free(hashes);
+			free(buckets);
+		}
+
+		// Flips each input bit and measures how many output bits change. Ideal result is 32.
+		void TestAvalanche()
+		{
+			static constexpr uint32_t Samples = 1 << 12;
+			static constexpr uint32_t Sizes[] = { 4, 8, 16, 32, 64 };
+			uint64_t seed = 0x9e3779b97f4a7c15ull;
+			for (uint32_t s = 0; s < CountOf(Sizes); ++s)
+			{
+				uint8_t data[64];
+				uint64_t changedBits = 0;
+				uint64_t tests = 0;
+				uint32_t worstBias = 0;
+				uint32_t bitChanges[64] = { 0 };
+				for (uint32_t i = 0; i < Samples; ++i)
+				{
+					for (uint32_t j = 0; j < Sizes[s]; ++j)
+					{
+						seed = HashInt(seed);
+						data[j] = (uint8_t)seed;
+					}
+					uint64_t h = HashBytes(data, Sizes[s]);
+					for (uint32_t bit = 0; bit < Sizes[s] * 8; ++bit)
+					{
+						data[bit >> 3] ^= 1 << (bit & 7);
+						uint64_t diff = h ^ HashBytes(data, Sizes[s]);
+						data[bit >> 3] ^= 1 << (bit & 7);
+						for (uint32_t k = 0; k < 64; ++k)
+							bitChanges[k] += (diff >> k) & 1;
+						changedBits += (uint64_t)std::popcount(diff);
+						++tests;
+					}
+				}
+				for (uint32_t k = 0; k < 64; ++k)
+				{
+					uint32_t bias = (uint32_t)abs((int64_t)bitChanges[k] * 2 - (int64_t)tests);
+					worstBias = __max(worstBias, bias);
+				}
+				logfinfo("Avalanche %2d bytes | %5.2f bits changed (ideal 32) | worst output bit bias %.3f%%\n",
+					Sizes[s], (double)changedBits / tests, 50.0 * worstBias / tests);
+			}
+		}
+
+		// Bytes per nanosecond for several key sizes, against std::hash over string_view (no allocation)
+		// and over a temporary std::string (previous path of std::hash<Mist::String>).
+		void TestThroughput()
+		{
+			static constexpr uint32_t Sizes[] = { 4, 16, 32, 64, 256, 4096 };
+			static constexpr uint32_t BytesPerTest = 1 << 26;
+			char* data = (char*)malloc(4096 + 1);
+			check(data);
+			for (uint32_t i = 0; i < 4096; ++i)
+				data[i] = 'a' + (char)(i % 26);
+			data[4096] = 0;
+
+			for (uint32_t s = 0; s < CountOf(Sizes); ++s)
+			{
+				uint32_t size = Sizes[s];
+				uint32_t iterations = BytesPerTest / size;
+				uint64_t acc = 0;
+				Profiling::sProfilingTimer timer;
+
+				timer.Start();
+				for (uint32_t i = 0; i < iterations; ++i)
+					acc += HashBytes(data + (i & 7), size - (i & 7 & (size - 1)));
+				double hashMs = timer.Stop();
+
+				timer.Start();
+				for (uint32_t i = 0; i < iterations; ++i)
+					acc += std::hash<std::string_view>()(std::string_view(data + (i & 7), size - (i & 7 & (size - 1))));
+				double stdMs = timer.Stop();
+
+				timer.Start();
+				for (uint32_t i = 0; i < iterations; ++i)
+					acc += std::hash<std::string>()(std::string(data + (i & 7), size - (i & 7 & (size - 1))));
+				double stdStringMs = timer.Stop();
+
+				logfinfo("%4d bytes | HashBytes %6.2f ns (%5.2f GB/s) | std::hash view %6.2f ns | std::hash string %6.2f ns [%llx]\n",
+					size, hashMs * 1e6 / iterations, (double)iterations * size / (hashMs * 1e6),
+					stdMs * 1e6 / iterations, stdStringMs * 1e6 / iterations, acc & 0xf);
+			}
+			free(data);
+		}
+	}
+
+	void BenchmarkHash()
+	{
+		loginfo("****************** Hash tests ******************\n");
+		hash_test::TestCollisions();
+		hash_test::TestAvalanche();
+		hash_test::TestThroughput();
+		loginfo("************************************************\n");
+	}
+
+	void ExecCommand_BenchmarkHash(const char* command)
+	{
+		BenchmarkHash();
+	}
+
+	void InitHash()
+	{
+		AddConsoleCommand("c_hashbench", &ExecCommand_BenchmarkHash);
+	}
+}
@@ -0,0 +1,156 @@
+// header file for Mist project
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include <functional>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * Non allocating 64 bit hashes. Byte hashing follows wyhash design (128 bit multiply and fold),
+ * fast for short keys (render descriptions, property names) with good avalanche on all input bits.
+ */
+
+namespace Mist
+{
+	namespace hash_detail
+	{
+		inline constexpr uint64_t Secret[4] =
+		{
+			0x2d358dccaa6c78a5ull,
+			0x8bb84b93962eacc9ull,
+			0x4b33a62ed433d4a3ull,
+			0x4d5a2da51de1aa47ull
+		};
+
+		inline void Mul128(uint64_t& a, uint64_t& b)
+		{
+#if defined(_MSC_VER)
+			a = _umul128(a, b, &b);
+#else
+			__uint128_t r = (__uint128_t)a * b;
+			a = (uint64_t)r;
+			b = (uint64_t)(r >> 64);
+#endif
+		}
+
+		inline uint64_t Mix(uint64_t a, uint64_t b)
+		{
+			Mul128(a, b);
+			return a ^ b;
+		}
+
+		inline uint64_t Read8(const uint8_t* p) { uint64_t v; memcpy(&v, p, sizeof(v)); return v; }
+		inline uint64_t Read4(const uint8_t* p) { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+		inline uint64_t Read3(const uint8_t* p, size_t k) { return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1]; }
+	}
+
+	inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0)
+	{
+		using namespace hash_detail;
+		const uint8_t* p = static_cast<const uint8_t*>(data);
+		seed ^= Mix(seed ^ Secret[0], Secret[1]);
+		uint64_t a;
+		uint64_t b;
+		if (size <= 16)
+		{
+			if (size >= 4)
+			{
+				a = (Read4(p) << 32) | Read4(p + ((size >> 3) << 2));
+				b = (Read4(p + size - 4) << 32) | Read4(p + size - 4 - ((size >> 3) << 2));
+			}
+			else if (size > 0)
+			{
+				a = Read3(p, size);
+				b = 0;
+			}
+			else
+				a = b = 0;
+		}
+		else
+		{
+			size_t i = size;
+			if (i > 48)
+			{
+				uint64_t seed1 = seed;
+				uint64_t seed2 = seed;
+				do
+				{
+					seed = Mix(Read8(p) ^ Secret[1], Read8(p + 8) ^ seed);
+					seed1 = Mix(Read8(p + 16) ^ Secret[2], Read8(p + 24) ^ seed1);
+					seed2 = Mix(Read8(p + 32) ^ Secret[3], Read8(p + 40) ^ seed2);
+					p += 48;
+					i -= 48;
+				} while (i > 48);
+				seed ^= seed1 ^ seed2;
+			}
+			while (i > 16)
+			{
+				seed = Mix(Read8(p) ^ Secret[1], Read8(p + 8) ^ seed);
+				i -= 16;
+				p += 16;
+			}
+			a = Read8(p + i - 16);
+			b = Read8(p + i - 8);
+		}
+		a ^= Secret[1];
+		b ^= seed;
+		Mul128(a, b);
+		return Mix(a ^ Secret[0] ^ size, b ^ Secret[1]);
+	}
+
+	inline uint64_t HashCStr(const char* str, uint64_t seed = 0)
+	{
+		return str ? HashBytes(str, strlen(str), seed) : HashBytes(nullptr, 0, seed);
+	}
+
+	inline uint64_t HashInt(uint64_t value)
+	{
+		uint64_t a = value ^ hash_detail::Secret[0];
+		uint64_t b = hash_detail::Secret[1];
+		hash_detail::Mul128(a, b);
+		return hash_detail::Mix(a ^ hash_detail::Secret[0], b ^ hash_detail::Secret[1]);
+	}
+
+	// Merges two hashes. Order dependent.
+	inline uint64_t HashMerge(uint64_t seed, uint64_t value)
+	{
+		return hash_detail::Mix(seed ^ hash_detail::Secret[2], value ^ hash_detail::Secret[3]);
+	}
+
+	// Hash of a single value. Scalars, pointers and C strings are hashed here,
+	// any other type goes to its std::hash specialization.
+	template <typename T>
+	inline uint64_t HashValue(const T& value)
+	{
+		if constexpr (std::is_same_v<T, bool>)
+			return HashInt(value ? 1 : 0);
+		else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+			return HashInt((uint64_t)value);
+		else if constexpr (std::is_floating_point_v<T>)
+		{
+			// +0 and -0 compare equal, must hash equal.
+			if (value == T(0))
+				return HashInt(0);
+			double d = (double)value;
+			uint64_t bits;
+			memcpy(&bits, &d, sizeof(bits));
+			return HashInt(bits);
+		}
+		else if constexpr (std::is_array_v<T> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<T>>, char>)
+			return HashCStr(value);
+		else if constexpr (std::is_pointer_v<T> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>)
+			return HashCStr(value);
+		else if constexpr (std::is_pointer_v<T>)
+			return HashInt((uint64_t)(uintptr_t)value);
+		else
+			return (uint64_t)std::hash<T>()(value);
+	}
+
+	// Collision, distribution, avalanche and throughput report.
+	void BenchmarkHash();
+	void InitHash();
+}
@@ -0,0 +1,723 @@
+#include "Core/JobSystem.h"
+#include "Core/Types.h"
+#include "Core/Debug.h"
+#include "Core/Logger.h"
+#include "Core/Console.h"
+#include "Core/SystemMemory.h"
+#include "Application/CmdParser.h"
+#include "Core/TestUtils.h"
+#include <thread>
+
+namespace Mist
+{
+	CIntVar CVar_JobWorkerCount("JobWorkerCount", 0); // 0 - hardware threads, >0 - threads running jobs (main thread included)
+
+	struct tJobSystemAccess
+	{
+		static std::atomic<uint32_t>& Value(tJobCounter* counter) { return counter->m_value; }
+		static std::atomic<uint32_t>& Finishing(tJobCounter* counter) { return counter->m_finishing; }
+		static std::mutex& Mutex(tJobCounter* counter) { return counter->m_mutex; }
+		static tJob*& Dependents(tJobCounter* counter) { return counter->m_dependents; }
+	};
+
+	namespace jobsystem
+	{
+		static constexpr uint32_t MaxThreads = 64;
+		static constexpr uint32_t DequeCapacity = 1 << 12;
+		static constexpr uint32_t JobsPerThread = 1 << 12;
+		static constexpr uint32_t SpinCount = 64;
+
+		enum eJobState : uint32_t
+		{
+			JobState_Free,
+			// job from a thread ring, released when executed.
+			JobState_Ring,
+			// job allocated on the heap by a thread outside the pool, freed when executed.
+			JobState_Heap,
+		};
+
+		/**
+		 * Chase-Lev work stealing deque with fixed capacity (Le, Pop, Cohen, Nardelli 2013 memory orders).
+		 * Only the owner thread pushes and pops from the bottom, any thread steals from the top.
+		 */
+		class tWorkStealingDeque
+		{
+		public:
+			tWorkStealingDeque()
+			{
+				for (uint32_t i = 0; i < DequeCapacity; ++i)
+					m_buffer[i].store(nullptr, std::memory_order_relaxed);
+			}
+
+			// owner only. Returns false when full.
+			bool Push(tJob* job)
+			{
+				int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+				int64_t top = m_top.load(std::memory_order_acquire);
+				if (bottom - top >= (int64_t)DequeCapacity)
+					return false;
+				m_buffer[bottom & (DequeCapacity - 1)].store(job, std::memory_order_relaxed);
+				// bottom is always published with release (plain stores on x64), thieves acquire it
+				// before reading the slot.
+				m_bottom.store(bottom + 1, std::memory_order_release);
+				return true;
+			}
+
+			// owner only. LIFO, keeps recently pushed (cache hot) jobs on the owner.
+			tJob* Pop()
+			{
+				int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+				m_bottom.store(bottom, std::memory_order_release);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				int64_t top = m_top.load(std::memory_order_relaxed);
+				tJob* job = nullptr;
+				if (top <= bottom)
+				{
+					job = m_buffer[bottom & (DequeCapacity - 1)].load(std::memory_order_relaxed);
+					if (top == bottom)
+					{
+						// last job, race against stealers.
+						if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+							job = nullptr;
+						m_bottom.store(bottom + 1, std::memory_order_release);
+					}
+				}
+				else
+					m_bottom.store(bottom + 1, std::memory_order_release);
+				return job;
+			}
+
+			// any thread. FIFO. May fail while there are jobs when racing other thieves.
+			tJob* Steal()
+			{
+				int64_t top = m_top.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				int64_t bottom = m_bottom.load(std::memory_order_acquire);
+				if (top >= bottom)
+					return nullptr;
+				tJob* job = m_buffer[top & (DequeCapacity - 1)].load(std::memory_order_relaxed);
+				if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					return nullptr;
+				return job;
+			}
+
+			inline bool IsEmpty() const
+			{
+				return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+			}
+
+		private:
+			alignas(64) std::atomic<int64_t> m_top = 0;
+			alignas(64) std::atomic<int64_t> m_bottom = 0;
+			alignas(64) std::atomic<tJob*> m_buffer[DequeCapacity];
+		};
+
+		struct alignas(64) tWorker
+		{
+			tWorkStealingDeque Deque;
+			// jobs allocated by this thread. Any thread may release them.
+			tJob Jobs[JobsPerThread];
+			uint32_t JobIndex = 0;
+			std::thread Thread;
+			std::atomic<uint64_t> Executed = 0;
+			std::atomic<uint64_t> Stolen = 0;
+		};
+
+		struct tJobSystem
+		{
+			tWorker* Workers = nullptr;
+			// Workers is aligned to the cache line inside this allocation.
+			void* WorkersMemory = nullptr;
+			uint32_t WorkerCount = 0;
+			std::atomic<bool> Running = false;
+			// incremented on each submission, idle workers sleep on it.
+			alignas(64) std::atomic<uint32_t> Signal = 0;
+			std::atomic<uint32_t> Sleepers = 0;
+			// jobs submitted from threads outside the pool.
+			alignas(64) std::mutex ExternalMutex;
+			tJob* ExternalHead = nullptr;
+			tJob* ExternalTail = nullptr;
+			std::atomic<uint32_t> ExternalCount = 0;
+		};
+
+		tJobSystem GJobSystem;
+		thread_local uint32_t GThreadIndex = UINT32_MAX;
+
+		inline uint32_t NextRandom(uint32_t& seed)
+		{
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+			return seed;
+		}
+
+		void PushExternal(tJob* job)
+		{
+			std::lock_guard<std::mutex> lock(GJobSystem.ExternalMutex);
+			job->Next = nullptr;
+			if (GJobSystem.ExternalTail)
+				GJobSystem.ExternalTail->Next = job;
+			else
+				GJobSystem.ExternalHead = job;
+			GJobSystem.ExternalTail = job;
+			GJobSystem.ExternalCount.fetch_add(1, std::memory_order_release);
+		}
+
+		tJob* PopExternal()
+		{
+			if (!GJobSystem.ExternalCount.load(std::memory_order_acquire))
+				return nullptr;
+			std::lock_guard<std::mutex> lock(GJobSystem.ExternalMutex);
+			tJob* job = GJobSystem.ExternalHead;
+			if (job)
+			{
+				GJobSystem.ExternalHead = job->Next;
+				if (!GJobSystem.ExternalHead)
+					GJobSystem.ExternalTail = nullptr;
+				GJobSystem.ExternalCount.fetch_sub(1, std::memory_order_relaxed);
+			}
+			return job;
+		}
+
+		tJob* FindJob(uint32_t index)
+		{
+			tJob* job = nullptr;
+			uint32_t count = GJobSystem.WorkerCount;
+			if (index < count)
+			{
+				job = GJobSystem.Workers[index].Deque.Pop();
+				if (job)
+					return job;
+			}
+			job = PopExternal();
+			if (job)
+				return job;
+			static thread_local uint32_t seed = 0x9e3779b9u ^ (uint32_t)(uintptr_t)&seed;
+			uint32_t start = NextRandom(seed) % count;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				uint32_t victim = (start + i) % count;
+				if (victim == index)
+					continue;
+				job = GJobSystem.Workers[victim].Deque.Steal();
+				if (job)
+				{
+					if (index < count)
+						GJobSystem.Workers[index].Stolen.fetch_add(1, std::memory_order_relaxed);
+					return job;
+				}
+			}
+			return nullptr;
+		}
+
+		void WakeWorker()
+		{
+			GJobSystem.Signal.fetch_add(1, std::memory_order_seq_cst);
+			if (GJobSystem.Sleepers.load(std::memory_order_seq_cst))
+				GJobSystem.Signal.notify_one();
+		}
+
+		void Execute(tJob* job);
+
+		void Push(tJob* job)
+		{
+			uint32_t index = GThreadIndex;
+			if (!GJobSystem.Running.load(std::memory_order_acquire))
+			{
+				Execute(job);
+				return;
+			}
+			if (index < GJobSystem.WorkerCount)
+			{
+				// deque full, running the job here keeps the program progressing.
+				if (!GJobSystem.Workers[index].Deque.Push(job))
+				{
+					Execute(job);
+					return;
+				}
+			}
+			else
+				PushExternal(job);
+			WakeWorker();
+		}
+
+		// last decrement of a counter: queue the jobs waiting for it.
+		void ReleaseDependents(tJobCounter* counter)
+		{
+			tJob* dependents;
+			{
+				std::lock_guard<std::mutex> lock(tJobSystemAccess::Mutex(counter));
+				dependents = tJobSystemAccess::Dependents(counter);
+				tJobSystemAccess::Dependents(counter) = nullptr;
+			}
+			while (dependents)
+			{
+				tJob* next = dependents->Next;
+				Push(dependents);
+				dependents = next;
+			}
+		}
+
+		void Execute(tJob* job)
+		{
+			job->Function(job->Data);
+			tJobCounter* counter = job->Counter;
+			// the job can be reused as soon as it is released, read everything before.
+			if (job->InUse.load(std::memory_order_relaxed) == JobState_Heap)
+				Mist::Free(job);
+			else
+				job->InUse.store(JobState_Free, std::memory_order_release);
+			if (GThreadIndex < GJobSystem.WorkerCount)
+				GJobSystem.Workers[GThreadIndex].Executed.fetch_add(1, std::memory_order_relaxed);
+
+			if (counter)
+			{
+				// the counter can be destroyed by its waiter once m_value and m_finishing are both zero.
+				tJobSystemAccess::Finishing(counter).fetch_add(1, std::memory_order_relaxed);
+				if (tJobSystemAccess::Value(counter).fetch_sub(1, std::memory_order_acq_rel) == 1)
+					ReleaseDependents(counter);
+				tJobSystemAccess::Finishing(counter).fetch_sub(1, std::memory_order_release);
+			}
+		}
+
+		void WorkerMain(uint32_t index)
+		{
+			GThreadIndex = index;
+			char name[32];
+			sprintf_s(name, "Job worker %d", index);
+			Profiling::CpuProf_SetThreadName(name);
+			while (GJobSystem.Running.load(std::memory_order_acquire))
+			{
+				tJob* job = FindJob(index);
+				for (uint32_t i = 0; !job && i < SpinCount; ++i)
+				{
+					std::this_thread::yield();
+					job = FindJob(index);
+				}
+				if (job)
+				{
+					Execute(job);
+					continue;
+				}
+
+				// go to sleep until a new submission. Checking for jobs after reading the signal
+				// closes the window where a job is pushed between the search and the wait.
+				uint32_t signal = GJobSystem.Signal.load(std::memory_order_seq_cst);
+				GJobSystem.Sleepers.fetch_add(1, std::memory_order_seq_cst);
+				job = FindJob(index);
+				if (!job && GJobSystem.Running.load(std::memory_order_acquire))
+					GJobSystem.Signal.wait(signal, std::memory_order_seq_cst);
+				GJobSystem.Sleepers.fetch_sub(1, std::memory_order_relaxed);
+				if (job)
+					Execute(job);
+			}
+		}
+	}
+
+	void ExecCommand_TestJobSystem(const char* command)
+	{
+		TestJobSystem();
+	}
+
+	void ExecCommand_BenchmarkJobSystem(const char* command)
+	{
+		BenchmarkJobSystem();
+	}
+
+	void ExecCommand_DumpJobStats(const char* command)
+	{
+		using namespace jobsystem;
+		if (!IsJobSystemRunning())
+			return;
+		loginfo("****************** Job system stats ******************\n");
+		for (uint32_t i = 0; i < GJobSystem.WorkerCount; ++i)
+		{
+			logfinfo("Thread %2d: executed %10lld | stolen %10lld\n", i,
+				GJobSystem.Workers[i].Executed.load(std::memory_order_relaxed),
+				GJobSystem.Workers[i].Stolen.load(std::memory_order_relaxed));
+		}
+		loginfo("******************************************************\n");
+	}
+
+	void InitJobSystem(uint32_t workerCount)
+	{
+		using namespace jobsystem;
+		check(!GJobSystem.Running.load() && "Job system already initialized");
+		if (!workerCount)
+			workerCount = CVar_JobWorkerCount.Get() > 0 ? (uint32_t)CVar_JobWorkerCount.Get() : std::thread::hardware_concurrency();
+		workerCount = __max(1u, workerCount);
+		workerCount = workerCount < MaxThreads ? workerCount : MaxThreads;
+
+		GJobSystem.WorkersMemory = _malloc(sizeof(tWorker) * workerCount + alignof(tWorker));
+		GJobSystem.Workers = (tWorker*)(((uintptr_t)GJobSystem.WorkersMemory + alignof(tWorker) - 1) & ~(uintptr_t)(alignof(tWorker) - 1));
+		for (uint32_t i = 0; i < workerCount; ++i)
+		{
+			new(&GJobSystem.Workers[i]) tWorker();
+			for (uint32_t j = 0; j < JobsPerThread; ++j)
+				GJobSystem.Workers[i].Jobs[j].InUse.store(JobState_Free, std::memory_order_relaxed);
+		}
+		GJobSystem.WorkerCount = workerCount;
+		GThreadIndex = 0;
+		GJobSystem.Running.store(true, std::memory_order_release);
+		for (uint32_t i = 1; i < workerCount; ++i)
+			GJobSystem.Workers[i].Thread = std::thread(&WorkerMain, i);
+		logfinfo("Job system: %d threads (%d workers + main thread).\n", workerCount, workerCount - 1);
+
+		AddConsoleCommand("c_jobtest", &ExecCommand_TestJobSystem);
+		AddConsoleCommand("c_jobbench", &ExecCommand_BenchmarkJobSystem);
+		AddConsoleCommand("c_jobstats", &ExecCommand_DumpJobStats);
+	}
+
+	void TerminateJobSystem()
+	{
+		using namespace jobsystem;
+		if (!GJobSystem.Running.load())
+			return;
+		check(GThreadIndex == 0 && "Job system must be terminated from the thread that initialized it");
+		// finish pending work before stopping the workers.
+		while (tJob* job = FindJob(0))
+			Execute(job);
+		GJobSystem.Running.store(false, std::memory_order_release);
+		GJobSystem.Signal.fetch_add(1, std::memory_order_seq_cst);
+		GJobSystem.Signal.notify_all();
+		for (uint32_t i = 1; i < GJobSystem.WorkerCount; ++i)
+			GJobSystem.Workers[i].Thread.join();
+		for (uint32_t i = 0; i < GJobSystem.WorkerCount; ++i)
+			GJobSystem.Workers[i].~tWorker();
+		Mist::Free(GJobSystem.WorkersMemory);
+		GJobSystem.WorkersMemory = nullptr;
+		GJobSystem.Workers = nullptr;
+		GJobSystem.WorkerCount = 0;
+		GThreadIndex = UINT32_MAX;
+	}
+
+	bool IsJobSystemRunning()
+	{
+		return jobsystem::GJobSystem.Running.load(std::memory_order_acquire);
+	}
+
+	uint32_t GetJobThreadCount()
+	{
+		return IsJobSystemRunning() ? jobsystem::GJobSystem.WorkerCount : 1;
+	}
+
+	uint32_t GetJobThreadIndex()
+	{
+		return jobsystem::GThreadIndex;
+	}
+
+	tJob* AllocateJob()
+	{
+		using namespace jobsystem;
+		uint32_t index = GThreadIndex;
+		if (index >= GJobSystem.WorkerCount)
+		{
+			tJob* job = (tJob*)_malloc(sizeof(tJob));
+			new(job) tJob();
+			job->InUse.store(JobState_Heap, std::memory_order_relaxed);
+			job->Next = nullptr;
+			return job;
+		}
+
+		tWorker& worker = GJobSystem.Workers[index];
+		while (true)
+		{
+			for (uint32_t i = 0; i < JobsPerThread; ++i)
+			{
+				tJob* job = &worker.Jobs[worker.JobIndex++ & (JobsPerThread - 1)];
+				if (job->InUse.load(std::memory_order_acquire) == JobState_Free)
+				{
+					job->InUse.store(JobState_Ring, std::memory_order_relaxed);
+					job->Next = nullptr;
+					return job;
+				}
+			}
+			// every job of the ring is in flight, help until one is released.
+			if (tJob* job = FindJob(index))
+				Execute(job);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	void SubmitJob(tJob* job, const tJobCounter* dependency)
+	{
+		check(job && job->Function);
+		if (job->Counter)
+			tJobSystemAccess::Value(job->Counter).fetch_add(1, std::memory_order_relaxed);
+		if (dependency && !dependency->IsDone())
+		{
+			tJobCounter* counter = const_cast<tJobCounter*>(dependency);
+			std::unique_lock<std::mutex> lock(tJobSystemAccess::Mutex(counter));
+			// checked again under the lock, the last decrement takes it before reading dependents.
+			if (tJobSystemAccess::Value(counter).load(std::memory_order_acquire))
+			{
+				job->Next = tJobSystemAccess::Dependents(counter);
+				tJobSystemAccess::Dependents(counter) = job;
+				return;
+			}
+		}
+		jobsystem::Push(job);
+	}
+
+	void WaitForCounter(const tJobCounter* counter)
+	{
+		check(counter);
+		uint32_t index = jobsystem::GThreadIndex;
+		while (!counter->IsDone())
+		{
+			if (!IsJobSystemRunning())
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			if (tJob* job = jobsystem::FindJob(index))
+				jobsystem::Execute(job);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	bool ExecutePendingJob()
+	{
+		if (!IsJobSystemRunning())
+			return false;
+		tJob* job = jobsystem::FindJob(jobsystem::GThreadIndex);
+		if (!job)
+			return false;
+		jobsystem::Execute(job);
+		return true;
+	}
+
+	namespace jobsystem
+	{
+		// lots of tiny jobs fighting for the same counter and cache line.
+		bool TestContention()
+		{
+			static constexpr uint32_t JobCount = 1 << 18;
+			std::atomic<uint32_t> sum = 0;
+			tJobCounter counter;
+			for (uint32_t i = 0; i < JobCount; ++i)
+				RunJob([&sum, i]() { sum.fetch_add(i & 0xff, std::memory_order_relaxed); }, &counter);
+			WaitForCounter(&counter);
+			uint32_t expected = 0;
+			for (uint32_t i = 0; i < JobCount; ++i)
+				expected += i & 0xff;
+			return sum.load() == expected;
+		}
+
+		// jobs spawning jobs on the same counter, with waits inside jobs.
+		struct tNestedData
+		{
+			tJobCounter* Counter;
+			std::atomic<uint32_t>* Leaves;
+			uint32_t Depth;
+		};
+
+		void NestedJob(tNestedData data)
+		{
+			if (!data.Depth)
+			{
+				data.Leaves->fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			tNestedData child = { data.Counter, data.Leaves, data.Depth - 1 };
+			for (uint32_t i = 0; i < 4; ++i)
+				RunJob([child]() { NestedJob(child); }, data.Counter);
+			if (data.Depth == 3)
+			{
+				// wait on a local counter from inside a job.
+				tJobCounter local;
+				std::atomic<uint32_t> localLeaves = 0;
+				tNestedData localData = { &local, &localLeaves, 2 };
+				RunJob([localData]() { NestedJob(localData); }, &local);
+				WaitForCounter(&local);
+				check(localLeaves.load() == 16);
+			}
+		}
+
+		bool TestNested()
+		{
+			static constexpr uint32_t Depth = 6;
+			std::atomic<uint32_t> leaves = 0;
+			tJobCounter counter;
+			tNestedData data = { &counter, &leaves, Depth };
+			RunJob([data]() { NestedJob(data); }, &counter);
+			WaitForCounter(&counter);
+			return leaves.load() == (1u << (2 * Depth));
+		}
+
+		// chains of dependent batches: each batch must see the whole previous batch finished.
+		bool TestDependencies()
+		{
+			static constexpr uint32_t Stages = 64;
+			static constexpr uint32_t JobsPerStage = 32;
+			std::atomic<uint32_t> done[Stages];
+			std::atomic<uint32_t> errors = 0;
+			tJobCounter counters[Stages];
+			for (uint32_t i = 0; i < Stages; ++i)
+				done[i].store(0);
+			for (uint32_t s = 0; s < Stages; ++s)
+			{
+				for (uint32_t j = 0; j < JobsPerStage; ++j)
+				{
+					RunJob([&done, &errors, s]()
+						{
+							if (s && done[s - 1].load(std::memory_order_acquire) != JobsPerStage)
+								errors.fetch_add(1);
+							done[s].fetch_add(1, std::memory_order_release);
+						}, &counters[s], s ? &counters[s - 1] : nullptr);
+				}
+			}
+			WaitForCounter(&counters[Stages - 1]);
+			bool result = !errors.load();
+			for (uint32_t i = 0; i < Stages; ++i)
+			{
+				WaitForCounter(&counters[i]);
+				result &= done[i].load() == JobsPerStage;
+			}
+			return result;
+		}
+
+		bool TestParallelFor()
+		{
+			static constexpr uint32_t Count = 1 << 20;
+			uint32_t* values = (uint32_t*)_malloc(sizeof(uint32_t) * Count);
+			ParallelFor(Count, 0, [values](uint32_t i) { values[i] = i * 2654435761u; });
+			uint64_t serial = 0;
+			for (uint32_t i = 0; i < Count; ++i)
+				serial += i * 2654435761u;
+			std::atomic<uint64_t> sum = 0;
+			ParallelForRange(Count, 1000, [values, &sum](uint32_t begin, uint32_t end)
+				{
+					uint64_t local = 0;
+					for (uint32_t i = begin; i < end; ++i)
+						local += values[i];
+					sum.fetch_add(local, std::memory_order_relaxed);
+				});
+			Mist::Free(values);
+			return sum.load() == serial;
+		}
+
+		// submission and waiting from threads outside the pool.
+		bool TestExternalThreads()
+		{
+			static constexpr uint32_t ThreadCount = 4;
+			static constexpr uint32_t JobCount = 1 << 12;
+			std::atomic<uint32_t> sum = 0;
+			std::thread threads[ThreadCount];
+			for (uint32_t t = 0; t < ThreadCount; ++t)
+			{
+				threads[t] = std::thread([&sum]()
+					{
+						tJobCounter counter;
+						for (uint32_t i = 0; i < JobCount; ++i)
+							RunJob([&sum]() { sum.fetch_add(1, std::memory_order_relaxed); }, &counter);
+						WaitForCounter(&counter);
+					});
+			}
+			for (uint32_t t = 0; t < ThreadCount; ++t)
+				threads[t].join();
+			return sum.load() == ThreadCount * JobCount;
+		}
+
+		// work with no shared writes, so speedup only depends on the scheduler.
+		uint64_t BenchmarkKernel(uint32_t begin, uint32_t end)
+		{
+			uint64_t acc = 0;
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				uint64_t h = i;
+				for (uint32_t j = 0; j < 64; ++j)
+					h = (h ^ (h >> 29)) * 0xbf58476d1ce4e5b9ull;
+				acc += h;
+			}
+			return acc;
+		}
+	}
+
+	bool TestJobSystem()
+	{
+		using namespace jobsystem;
+		if (!IsJobSystemRunning() || GetJobThreadIndex() != 0)
+		{
+			logerror("Job tests must run on the main thread with the job system running.\n");
+			return false;
+		}
+		loginfo("****************** Job system tests ******************\n");
+		bool result = true;
+		result &= TestResult(TestContention(), "Job", "contention");
+		result &= TestResult(TestNested(), "Job", "nested jobs");
+		result &= TestResult(TestDependencies(), "Job", "dependencies");
+		result &= TestResult(TestParallelFor(), "Job", "parallel for");
+		result &= TestResult(TestExternalThreads(), "Job", "external threads");
+		loginfo("******************************************************\n");
+		return result;
+	}
+
+	void BenchmarkJobSystem()
+	{
+		using namespace jobsystem;
+		if (!IsJobSystemRunning() || GetJobThreadIndex() != 0)
+		{
+			logerror("Job benchmark must run on the main thread with the job system running.\n");
+			return;
+		}
+		loginfo("****************** Job system benchmark ******************\n");
+		Profiling::sProfilingTimer timer;
+
+		// scheduling overhead.
+		static constexpr uint32_t EmptyJobs = 1 << 20;
+		tJobCounter counter;
+		timer.Start();
+		for (uint32_t i = 0; i < EmptyJobs; ++i)
+			RunJob([]() {}, &counter);
+		WaitForCounter(&counter);
+		double emptyMs = timer.Stop();
+		logfinfo("Empty jobs: %d jobs in %.2f ms (%.1f ns/job)\n", EmptyJobs, emptyMs, emptyMs * 1e6 / EmptyJobs);
+
+		// scaling: same total work split in as many chunks as threads used.
+		static constexpr uint32_t Count = 1 << 22;
+		timer.Start();
+		uint64_t serial = BenchmarkKernel(0, Count);
+		double serialMs = timer.Stop();
+		logfinfo("Serial:                 %8.2f ms\n", serialMs);
+		uint32_t threadCount = GetJobThreadCount();
+		for (uint32_t threads = 2; ; threads = threads * 2 < threadCount ? threads * 2 : threadCount)
+		{
+			std::atomic<uint64_t> sum = 0;
+			timer.Start();
+			ParallelForRange(Count, (Count + threads - 1) / threads, [&sum](uint32_t begin, uint32_t end)
+				{
+					sum.fetch_add(BenchmarkKernel(begin, end), std::memory_order_relaxed);
+				});
+			double ms = timer.Stop();
+			check(sum.load() == serial);
+			logfinfo("%2d threads:             %8.2f ms | speedup %5.2fx | efficiency %5.1f%%\n",
+				threads, ms, serialMs / ms, 100.0 * serialMs / ms / threads);
+			if (threads >= threadCount)
+				break;
+		}
+
+		// granularity: batch size against scheduling overhead.
+		static constexpr uint32_t BatchSizes[] = { 64, 1024, 16384, 0 };
+		for (uint32_t i = 0; i < CountOf(BatchSizes); ++i)
+		{
+			std::atomic<uint64_t> sum = 0;
+			timer.Start();
+			ParallelForRange(Count, BatchSizes[i], [&sum](uint32_t begin, uint32_t end)
+				{
+					sum.fetch_add(BenchmarkKernel(begin, end), std::memory_order_relaxed);
+				});
+			double ms = timer.Stop();
+			check(sum.load() == serial);
+			char label[32];
+			if (BatchSizes[i])
+				sprintf_s(label, "Batch %d:", BatchSizes[i]);
+			else
+				sprintf_s(label, "Batch auto:");
+			logfinfo("%-24s%8.2f ms | speedup %5.2fx\n", label, ms, serialMs / ms);
+		}
+		loginfo("**********************************************************\n");
+	}
+}
@@ -0,0 +1,149 @@
+// header file for Mist project
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Job system. A fixed pool of worker threads (hardware threads - 1, the main thread is worker 0)
+ * each one with a lock free work stealing deque (Chase-Lev). Jobs pushed from a worker go to its
+ * own deque, idle workers steal from the others. Jobs pushed from threads outside the pool go to
+ * a shared queue.
+ * Completion is tracked with tJobCounter: running a job with a counter increments it, finishing the
+ * job decrements it. WaitForCounter executes pending jobs while waiting, so waiting inside a job
+ * doesn't block a worker. A job can depend on a counter: it is queued when the counter reaches zero.
+ */
+
+namespace Mist
+{
+	typedef void (*tJobFunction)(void* data);
+
+	struct tJob;
+
+	class tJobCounter
+	{
+	public:
+		tJobCounter() = default;
+		tJobCounter(const tJobCounter&) = delete;
+		tJobCounter& operator=(const tJobCounter&) = delete;
+
+		// a done counter is not touched anymore by the job system, it can be destroyed.
+		inline bool IsDone() const { return !m_value.load(std::memory_order_acquire) && !m_finishing.load(std::memory_order_acquire); }
+		inline uint32_t GetValue() const { return m_value.load(std::memory_order_acquire); }
+
+	private:
+		friend struct tJobSystemAccess;
+		std::atomic<uint32_t> m_value = 0;
+		// threads still releasing dependents after the last decrement.
+		std::atomic<uint32_t> m_finishing = 0;
+		// jobs waiting for this counter to reach zero.
+		std::mutex m_mutex;
+		tJob* m_dependents = nullptr;
+	};
+
+	struct tJob
+	{
+		static constexpr size_t InlineDataSize = 64;
+
+		tJobFunction Function;
+		void* Data;
+		tJobCounter* Counter;
+		tJob* Next;
+		std::atomic<uint32_t> InUse;
+		// storage for lambda jobs, Data points here.
+		alignas(16) uint8_t InlineData[InlineDataSize];
+	};
+
+	// workerCount 0 sizes the pool from hardware threads (CVar JobWorkerCount overrides it).
+	void InitJobSystem(uint32_t workerCount = 0);
+	void TerminateJobSystem();
+	bool IsJobSystemRunning();
+	// threads executing jobs, including the main thread.
+	uint32_t GetJobThreadCount();
+	// 0 for main thread, [1, count) for workers, UINT32_MAX for threads outside the pool.
+	uint32_t GetJobThreadIndex();
+
+	// Internal: job allocation from the calling thread ring and submission.
+	tJob* AllocateJob();
+	void SubmitJob(tJob* job, const tJobCounter* dependency);
+
+	inline void RunJob(tJobFunction fn, void* data, tJobCounter* counter = nullptr, const tJobCounter* dependency = nullptr)
+	{
+		tJob* job = AllocateJob();
+		job->Function = fn;
+		job->Data = data;
+		job->Counter = counter;
+		SubmitJob(job, dependency);
+	}
+
+	// Runs a callable (usually a lambda) as a job. Captures are stored inside the job, keep them small.
+	template <typename Fn>
+	inline void RunJob(Fn&& fn, tJobCounter* counter = nullptr, const tJobCounter* dependency = nullptr)
+	{
+		typedef std::decay_t<Fn> FnType;
+		static_assert(sizeof(FnType) <= tJob::InlineDataSize && alignof(FnType) <= 16, "Job lambda captures too big, capture by reference or pass data pointer.");
+		tJob* job = AllocateJob();
+		new(job->InlineData) FnType(std::forward<Fn>(fn));
+		job->Function = [](void* data)
+			{
+				FnType& f = *static_cast<FnType*>(data);
+				f();
+				f.~FnType();
+			};
+		job->Data = job->InlineData;
+		job->Counter = counter;
+		SubmitJob(job, dependency);
+	}
+
+	// Waits until counter reaches zero, executing other jobs meanwhile.
+	void WaitForCounter(const tJobCounter* counter);
+	// Executes one pending job on the calling thread, false if there was none. For waits not tracked by a counter.
+	bool ExecutePendingJob();
+
+	// Splits [0, count) in batches and calls fn(begin, end) for each one across the pool.
+	// Returns when all batches are done. batchSize 0 picks a size from count and thread count.
+	template <typename Fn>
+	void ParallelForRange(uint32_t count, uint32_t batchSize, Fn&& fn)
+	{
+		if (!count)
+			return;
+		uint32_t threads = GetJobThreadCount();
+		if (!batchSize)
+			batchSize = (count + threads * 4 - 1) / (threads * 4);
+		batchSize = batchSize ? batchSize : 1;
+		if (threads <= 1 || batchSize >= count)
+		{
+			fn(0u, count);
+			return;
+		}
+		tJobCounter counter;
+		// last batch runs on the calling thread.
+		uint32_t begin = 0;
+		for (; begin + batchSize < count; begin += batchSize)
+		{
+			uint32_t end = begin + batchSize;
+			RunJob([&fn, begin, end]() { fn(begin, end); }, &counter);
+		}
+		fn(begin, count);
+		WaitForCounter(&counter);
+	}
+
+	// fn(index) for each index in [0, count).
+	template <typename Fn>
+	void ParallelFor(uint32_t count, uint32_t batchSize, Fn&& fn)
+	{
+		ParallelForRange(count, batchSize, [&fn](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; ++i)
+					fn(i);
+			});
+	}
+
+	// Correctness tests under contention and scaling benchmark. Log results.
+	bool TestJobSystem();
+	void BenchmarkJobSystem();
+}
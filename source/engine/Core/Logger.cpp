@@ -4,13 +4,13 @@
 #include <cstdio>
 #include <stdarg.h>
 #include <string>
-#include <Windows.h>
-#include <debugapi.h>
+#include "Core/Platform.h"
 #include <string.h>
-#include <imgui/imgui.h>
 #include "Core/SystemMemory.h"
 #include "Application/CmdParser.h"
-#include "Application/Application.h"
+#include "Utils/TimeUtils.h"
+#include <atomic>
+#include <thread>
 
 
 
@@ -40,6 +40,10 @@
 
 //#define LOG_DEBUG_FLUSH
 
+// messages longer than this are copied into a heap block owned by the queue entry.
+#define LOG_ENTRY_INLINE_SIZE 512
+#define LOG_QUEUE_SIZE 1024
+
 namespace Mist
 {
     CIntVar CVar_LogToConsole("s_logToConsole", 2); // 0 - never, 1 - on error, 2 - always
@@ -85,28 +89,8 @@ namespace Mist
 		return "#000000";
 	}
 
-	ImVec4 LogLevelImGuiColor(LogLevel level)
-	{
-		switch (level)
-		{
-		case LogLevel::Info: return ImVec4(0.7f, 0.7f, 0.7f, 1.f);
-		case LogLevel::Debug: return ImVec4(0.4f, 0.65f, 0.85f, 1.f);
-		case LogLevel::Ok: return ImVec4(0.2f, 0.91f, 0.26f, 1.f);
-		case LogLevel::Warn: return ImVec4(0.9647f, 1.f, 0.2392f, 1.f);
-		case LogLevel::Error: return ImVec4(1.f, 0.f, 0.f, 1.f);
-		default:
-			break;
-		}
-		return ImVec4(0.2f, 0.2f, 0.2f, 1.f);
-	}
-
 	class LogHtmlFile
 	{
-		struct LogEntry
-		{
-			LogLevel Level;
-			char Msg[LOG_MSG_MAX_SIZE];
-		};
 	public:
 		LogHtmlFile(const char* filepath)
 		{
@@ -118,27 +102,23 @@ namespace Mist
 
 		~LogHtmlFile()
 		{
-			Flush();
 			PrintFoot();
+			Flush();
 			Close();
 		}
 
 		void Push(LogLevel level, const char* logEntry)
 		{
-			LogEntry& entry = m_entryArray[m_index++];
-			strcpy_s(entry.Msg, logEntry);
-			entry.Level = level;
-			if (m_index == MaxBufferSize)
-				Flush();
+			// only called from the log thread, stdio buffering is enough here.
+			if (m_file)
+				fprintf_s(m_file, "<div style=\"color:%s\">[%7s] %s</div>\n",
+					LogLevelHtmlColor(level), LogLevelToStr(level), logEntry);
 		}
 
 		void Flush()
 		{
-			for (uint32_t i = 0; i < m_index; ++i)
-			{
-				Print(m_entryArray[i]);
-			}
-			m_index = 0;
+			if (m_file)
+				fflush(m_file);
 		}
 	private:
 		void PrintHeader()
@@ -152,12 +132,6 @@ namespace Mist
 			fprintf_s(m_file, "</body>\n");
 		}
 
-		void Print(const LogEntry& entry)
-		{
-			fprintf_s(m_file, "<div style=\"color:%s\">[%7s] %s</div>\n", 
-				LogLevelHtmlColor(entry.Level), LogLevelToStr(entry.Level), entry.Msg);
-		}
-
 		void Open(bool overrideContent = false)
 		{
 			if (!m_file)
@@ -170,76 +144,366 @@ namespace Mist
 		}
 
 	private:
-		static constexpr size_t MaxBufferSize = 128;
-		LogEntry m_entryArray[MaxBufferSize];
 		std::string m_filepath;
-		uint32_t m_index = 0;
 		FILE* m_file;
 	};
 
+	/**
+	 * Bounded multi producer queue (Vyukov). Each cell carries a sequence number, producers
+	 * claim a cell with a CAS over the enqueue position and publish it bumping the sequence.
+	 * Only the log thread consumes.
+	 */
+	struct tLogEntry
+	{
+		LogLevel Level;
+		uint64_t Frame;
+		char* HeapMsg;
+		char Msg[LOG_ENTRY_INLINE_SIZE];
+
+		const char* GetMsg() const { return HeapMsg ? HeapMsg : Msg; }
+	};
+
+	class tLogQueue
+	{
+		struct tCell
+		{
+			std::atomic<size_t> Sequence;
+			tLogEntry Entry;
+		};
+	public:
+		void Init(size_t capacity)
+		{
+			check(capacity && !(capacity & (capacity - 1)));
+			m_cells = (tCell*)_malloc(sizeof(tCell) * capacity);
+			m_mask = capacity - 1;
+			for (size_t i = 0; i < capacity; ++i)
+				new(&m_cells[i].Sequence) std::atomic<size_t>(i);
+			m_enqueuePos.store(0);
+			m_dequeuePos.store(0);
+		}
+
+		void Destroy()
+		{
+			Mist::Free(m_cells);
+			m_cells = nullptr;
+		}
+
+		// returns a claimed cell entry to be filled or nullptr if the queue is full.
+		tLogEntry* BeginPush(size_t& pos)
+		{
+			pos = m_enqueuePos.load(std::memory_order_relaxed);
+			while (true)
+			{
+				tCell& cell = m_cells[pos & m_mask];
+				size_t seq = cell.Sequence.load(std::memory_order_acquire);
+				intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+				if (!diff)
+				{
+					if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						return &cell.Entry;
+				}
+				else if (diff < 0)
+					return nullptr;
+				else
+					pos = m_enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		void EndPush(size_t pos)
+		{
+			m_cells[pos & m_mask].Sequence.store(pos + 1, std::memory_order_release);
+		}
+
+		template <typename Fn>
+		bool Consume(Fn&& fn)
+		{
+			size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+			tCell& cell = m_cells[pos & m_mask];
+			size_t seq = cell.Sequence.load(std::memory_order_acquire);
+			if (seq != pos + 1)
+				return false;
+			m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+			fn(cell.Entry);
+			cell.Sequence.store(pos + m_mask + 1, std::memory_order_release);
+			return true;
+		}
+
+	private:
+		tCell* m_cells = nullptr;
+		size_t m_mask = 0;
+		alignas(64) std::atomic<size_t> m_enqueuePos = 0;
+		alignas(64) std::atomic<size_t> m_dequeuePos = 0;
+	};
+
 	LogHtmlFile* GLogFile = nullptr;
 
-	void Log(LogLevel level, const char* msg)
+	struct tLogBackend
 	{
-#ifndef _DEBUG
-		if (level == LogLevel::Debug)
-			return;
-#endif // !_DEBUG
-		uint64_t frame = tApplication::GetFrame();
-        if (level == LogLevel::Error && CVar_LogToConsole.Get() > 0 || CVar_LogToConsole.Get() == 2)
+		tLogQueue Queue;
+		std::thread Thread;
+		// written by the log thread before Started is published, InitLog waits for it.
+		std::thread::id ThreadId;
+		std::atomic<bool> Started = false;
+		std::atomic<bool> Running = false;
+		// producers only notify when the log thread is going to sleep.
+		std::atomic<uint32_t> Signal = 0;
+		std::atomic<bool> Sleeping = false;
+		std::atomic<uint64_t> Pushed = 0;
+		std::atomic<uint64_t> Processed = 0;
+	} GLogBackend;
+
+	// sinks: stdout, debugger output, html file and ingame console.
+	void WriteLogSinks(LogLevel level, uint64_t frame, const char* msg)
+	{
+		if ((level == LogLevel::Error && CVar_LogToConsole.Get() > 0) || CVar_LogToConsole.Get() == 2)
 			printf("%s[%6lld][%7s]%s %s%s", ANSI_COLOR_CYAN, frame, LogLevelToStr(level), LogLevelFormat(level), msg, ANSI_RESET_ALL);
-		wchar_t wString[LOG_MSG_MAX_SIZE];
-		MultiByteToWideChar(CP_ACP, 0, msg, -1, wString, 4096);
-		OutputDebugString(wString);
+		Platform::DebugOutput(msg);
 		if (GLogFile)
 			GLogFile->Push(level, msg);
 		ConsoleLog(level, msg);
+	}
+
+	bool ProcessLogQueue()
+	{
+		bool processed = false;
+		while (GLogBackend.Queue.Consume([](tLogEntry& entry)
+			{
+				WriteLogSinks(entry.Level, entry.Frame, entry.GetMsg());
+				if (entry.HeapMsg)
+				{
+					Mist::Free(entry.HeapMsg);
+					entry.HeapMsg = nullptr;
+				}
+			}))
+		{
+			++GLogBackend.Processed;
+			processed = true;
+		}
+		return processed;
+	}
+
+	void LogThreadMain()
+	{
+		GLogBackend.ThreadId = std::this_thread::get_id();
+		GLogBackend.Started.store(true);
+		GLogBackend.Started.notify_one();
+		Platform::SetCurrentThreadName("Log");
+		while (GLogBackend.Running.load())
+		{
+			if (ProcessLogQueue())
+				continue;
+			uint32_t signal = GLogBackend.Signal.load();
+			GLogBackend.Sleeping.store(true);
+			// recheck after publishing the sleeping state to not miss a push.
+			if (GLogBackend.Pushed.load() == GLogBackend.Processed.load())
+				GLogBackend.Signal.wait(signal);
+			GLogBackend.Sleeping.store(false);
+		}
+		ProcessLogQueue();
 #ifdef LOG_DEBUG_FLUSH
-		GLogFile->Flush();
+		if (GLogFile)
+			GLogFile->Flush();
 #endif // LOG_DEBUG_FLUSH
 	}
 
-	void Logf(LogLevel level, const char* fmt, ...)
+	void WakeLogThread()
 	{
-		switch (level)
+		if (GLogBackend.Sleeping.load())
+		{
+			++GLogBackend.Signal;
+			GLogBackend.Signal.notify_one();
+		}
+	}
+
+	bool IsLogThreadRunning()
+	{
+		return GLogBackend.Running.load() && std::this_thread::get_id() != GLogBackend.ThreadId;
+	}
+
+	template <typename FillFn>
+	void PushLogEntry(LogLevel level, FillFn&& fill)
+	{
+		size_t pos;
+		tLogEntry* entry;
+		// queue full: help the log thread draining instead of losing the message.
+		while (!(entry = GLogBackend.Queue.BeginPush(pos)))
 		{
-		case LogLevel::Debug:
+			WakeLogThread();
+			std::this_thread::yield();
+		}
+		entry->Level = level;
+		entry->Frame = GetFrameCount();
+		entry->HeapMsg = nullptr;
+		fill(*entry);
+		GLogBackend.Queue.EndPush(pos);
+		++GLogBackend.Pushed;
+		WakeLogThread();
+	}
+
+	void Log(LogLevel level, const char* msg)
+	{
 #ifndef _DEBUG
-			break;
-#endif
-		case LogLevel::Info:
-		case LogLevel::Ok:
-		case LogLevel::Warn:
-		case LogLevel::Error:
+		if (level == LogLevel::Debug)
+			return;
+#endif // !_DEBUG
+		if (!IsLogThreadRunning())
+		{
+			WriteLogSinks(level, GetFrameCount(), msg);
+			return;
+		}
+		PushLogEntry(level, [msg](tLogEntry& entry)
+			{
+				size_t len = strlen(msg);
+				if (len < LOG_ENTRY_INLINE_SIZE)
+					memcpy(entry.Msg, msg, len + 1);
+				else
+				{
+					entry.HeapMsg = (char*)_malloc(len + 1);
+					memcpy(entry.HeapMsg, msg, len + 1);
+				}
+			});
+	}
+
+	void Logf(LogLevel level, const char* fmt, ...)
+	{
+#ifndef _DEBUG
+		if (level == LogLevel::Debug)
+			return;
+#endif // !_DEBUG
+		va_list lst;
+		va_start(lst, fmt);
+		if (!IsLogThreadRunning())
+		{
 			char buff[LOG_MSG_MAX_SIZE];
-			va_list lst;
-			va_start(lst, fmt);
 			vsprintf_s(buff, fmt, lst);
-			va_end(lst);
-			Log(level, buff);
+			WriteLogSinks(level, GetFrameCount(), buff);
 		}
+		else
+		{
+			// arguments may not outlive this call, so the message is printed straight into the queue cell.
+			PushLogEntry(level, [fmt, &lst](tLogEntry& entry)
+				{
+					va_list args;
+					va_copy(args, lst);
+					int len = vsnprintf(entry.Msg, LOG_ENTRY_INLINE_SIZE, fmt, args);
+					va_end(args);
+					if (len >= LOG_ENTRY_INLINE_SIZE)
+					{
+						len = __min(len, LOG_MSG_MAX_SIZE - 1);
+						entry.HeapMsg = (char*)_malloc(len + 1);
+						va_copy(args, lst);
+						vsnprintf(entry.HeapMsg, len + 1, fmt, args);
+						va_end(args);
+					}
+				});
+		}
+		va_end(lst);
 	}
 
 	void FlushLogToFile()
 	{
-		check(GLogFile);
-		GLogFile->Flush();
+		if (IsLogThreadRunning())
+		{
+			uint64_t pushed = GLogBackend.Pushed.load();
+			while (GLogBackend.Processed.load() < pushed)
+			{
+				WakeLogThread();
+				std::this_thread::yield();
+			}
+		}
+		else if (GLogBackend.Running.load())
+		{
+			// called from the log thread itself (i.e. a failed check inside a sink).
+			ProcessLogQueue();
+		}
+		if (GLogFile)
+			GLogFile->Flush();
+		fflush(stdout);
+	}
+
+	// Measures the time spent by the caller in Logf, the only cost left on the calling thread.
+	void BenchmarkLog()
+	{
+		static constexpr uint32_t LogsPerThread = 1024;
+		const uint32_t threadCount = __max(__min(std::thread::hardware_concurrency(), 8u), 1u);
+		struct tThreadStats
+		{
+			double MeanUs = 0.0;
+			double MaxUs = 0.0;
+		};
+		tThreadStats* stats = (tThreadStats*)_malloc(sizeof(tThreadStats) * threadCount);
+		std::thread* threads = (std::thread*)_malloc(sizeof(std::thread) * threadCount);
+		for (uint32_t t = 0; t < threadCount; ++t)
+		{
+			new(&stats[t]) tThreadStats();
+			new(&threads[t]) std::thread([t, &stats]()
+				{
+					double total = 0.0;
+					for (uint32_t i = 0; i < LogsPerThread; ++i)
+					{
+						tTimePoint start = GetTimePoint();
+						logfinfo("[logbench] thread %d message %d value %f\n", t, i, (float)i * 0.5f);
+						double us = GetMiliseconds(GetTimePoint() - start) * 1e3;
+						total += us;
+						stats[t].MaxUs = __max(stats[t].MaxUs, us);
+					}
+					stats[t].MeanUs = total / LogsPerThread;
+				});
+		}
+		for (uint32_t t = 0; t < threadCount; ++t)
+		{
+			threads[t].join();
+			threads[t].~thread();
+		}
+		FlushLogToFile();
+		for (uint32_t t = 0; t < threadCount; ++t)
+			logfinfo("Log bench thread %2d: mean %8.3f us | max %8.3f us\n", t, stats[t].MeanUs, stats[t].MaxUs);
+		Mist::Free(threads);
+		Mist::Free(stats);
+	}
+
+	void ExecCommand_BenchmarkLog(const char* cmd)
+	{
+		BenchmarkLog();
 	}
 
 	void InitLog(const char* outputFile)
 	{
 		check(!GLogFile);
 		GLogFile = _new LogHtmlFile(outputFile);
+		check(!GLogBackend.Running.load());
+		GLogBackend.Queue.Init(LOG_QUEUE_SIZE);
+		GLogBackend.Running.store(true);
+		GLogBackend.Thread = std::thread(&LogThreadMain);
+		GLogBackend.Started.wait(false);
+		AddConsoleCommand("s_logbench", &ExecCommand_BenchmarkLog);
 	}
 
 	void TerminateLog()
 	{
 		loginfo("Close log.\n");
+		if (GLogBackend.Running.load())
+		{
+			FlushLogToFile();
+			bool isLogThread = std::this_thread::get_id() == GLogBackend.ThreadId;
+			GLogBackend.Running.store(false);
+			++GLogBackend.Signal;
+			GLogBackend.Signal.notify_one();
+			// TerminateLog from a failed check in the log thread can't join itself.
+			if (isLogThread)
+				GLogBackend.Thread.detach();
+			else
+				GLogBackend.Thread.join();
+			GLogBackend.Queue.Destroy();
+			GLogBackend.Started.store(false);
+		}
 		if (GLogFile)
 		{
 			delete GLogFile;
 			GLogFile = nullptr;
 		}
+		// history stays in the log arena until here, memory is terminated next.
+		TerminateConsoleLog();
 	}
 
-}
\ No newline at end of file
+}
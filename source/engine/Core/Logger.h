@@ -16,12 +16,16 @@ namespace Mist
 	};
 	const char* LogLevelToStr(LogLevel level);
 
+	// Log calls only enqueue the message, the log thread writes it to the sinks.
 	void Log(LogLevel level, const char* msg);
 	void Logf(LogLevel level, const char* fmt, ...);
+	// blocks until all queued messages are written and the log file is flushed.
 	void FlushLogToFile();
 
 	void InitLog(const char* outputFile);
 	void TerminateLog();
+	// time spent by the callers of Logf, several threads logging at once.
+	void BenchmarkLog();
 
 }
 
@@ -31,8 +35,8 @@ namespace Mist
 #define logerror(msg) logferror(msg)
 #define logwarn(msg) logfwarn(msg)
 
-#define logfinfo(msg, ...) Mist::Logf(Mist::LogLevel::Info, msg, __VA_ARGS__)
-#define logfdebug(msg, ...) Mist::Logf(Mist::LogLevel::Debug, msg, __VA_ARGS__)
-#define logfok(msg, ...) Mist::Logf(Mist::LogLevel::Ok, msg, __VA_ARGS__)
-#define logferror(msg, ...) Mist::Logf(Mist::LogLevel::Error, msg, __VA_ARGS__)
-#define logfwarn(msg, ...) Mist::Logf(Mist::LogLevel::Warn, msg, __VA_ARGS__)
+#define logfinfo(msg, ...) Mist::Logf(Mist::LogLevel::Info, msg, ##__VA_ARGS__)
+#define logfdebug(msg, ...) Mist::Logf(Mist::LogLevel::Debug, msg, ##__VA_ARGS__)
+#define logfok(msg, ...) Mist::Logf(Mist::LogLevel::Ok, msg, ##__VA_ARGS__)
+#define logferror(msg, ...) Mist::Logf(Mist::LogLevel::Error, msg, ##__VA_ARGS__)
+#define logfwarn(msg, ...) Mist::Logf(Mist::LogLevel::Warn, msg, ##__VA_ARGS__)
@@ -0,0 +1,295 @@
+// header file for Mist project
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Platform layer. Everything the engine needs from the OS goes through here: timers, threads,
+ * debug output, stack capture, file mapping and file change notification.
+ * Implementations live in PlatformWin32.cpp and PlatformPosix.cpp, only one of them is compiled.
+ * Non MSVC compilers also get the subset of the MSVC CRT the engine code uses (*_s functions,
+ * __max/__min...), so the rest of the code doesn't need per platform branches.
+ */
+
+#if defined(_WIN32)
+#define MIST_PLATFORM_WINDOWS
+#elif defined(__linux__) || defined(__APPLE__)
+#define MIST_PLATFORM_POSIX
+#else
+#error Platform not supported
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MIST_DEBUG_BREAK __debugbreak()
+#define MIST_INSTRUCTION_EXCEPTION __ud2()
+#define MIST_FORCEINLINE __forceinline
+#define MIST_NOINLINE __declspec(noinline)
+#else
+#include <signal.h>
+#define MIST_DEBUG_BREAK raise(SIGTRAP)
+#define MIST_INSTRUCTION_EXCEPTION __builtin_trap()
+#define MIST_FORCEINLINE inline __attribute__((always_inline))
+#define MIST_NOINLINE __attribute__((noinline))
+#endif
+
+#if !defined(_MSC_VER)
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifndef __max
+#define __max(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+#ifndef __min
+#define __min(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+typedef int errno_t;
+
+inline errno_t strncpy_s(char* dst, size_t dstSize, const char* src, size_t count)
+{
+	if (!dst || !dstSize)
+		return EINVAL;
+	// past dstSize it doesn't fit anyway, and src may be a buffer shorter than count.
+	size_t len = strnlen(src, count < dstSize ? count : dstSize);
+	if (len >= dstSize)
+	{
+		*dst = 0;
+		return ERANGE;
+	}
+	memcpy(dst, src, len);
+	dst[len] = 0;
+	return 0;
+}
+template <size_t N>
+inline errno_t strncpy_s(char(&dst)[N], const char* src, size_t count) { return strncpy_s(dst, N, src, count); }
+// src is null terminated, strlen instead of a dstSize bound that can be past a shorter src buffer.
+inline errno_t strcpy_s(char* dst, size_t dstSize, const char* src)
+{
+	if (!dst || !dstSize)
+		return EINVAL;
+	size_t len = strlen(src);
+	if (len >= dstSize)
+	{
+		*dst = 0;
+		return ERANGE;
+	}
+	memcpy(dst, src, len + 1);
+	return 0;
+}
+template <size_t N>
+inline errno_t strcpy_s(char(&dst)[N], const char* src) { return strcpy_s(dst, N, src); }
+inline errno_t strcat_s(char* dst, size_t dstSize, const char* src)
+{
+	size_t len = strnlen(dst, dstSize);
+	return len < dstSize ? strcpy_s(dst + len, dstSize - len, src) : ERANGE;
+}
+template <size_t N>
+inline errno_t strcat_s(char(&dst)[N], const char* src) { return strcat_s(dst, N, src); }
+
+inline int vsprintf_s(char* dst, size_t dstSize, const char* fmt, va_list args) { return vsnprintf(dst, dstSize, fmt, args); }
+template <size_t N>
+inline int vsprintf_s(char(&dst)[N], const char* fmt, va_list args) { return vsnprintf(dst, N, fmt, args); }
+inline int sprintf_s(char* dst, size_t dstSize, const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	int r = vsnprintf(dst, dstSize, fmt, args);
+	va_end(args);
+	return r;
+}
+template <size_t N>
+inline int sprintf_s(char(&dst)[N], const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	int r = vsnprintf(dst, N, fmt, args);
+	va_end(args);
+	return r;
+}
+#define fprintf_s fprintf
+#define strtok_s strtok_r
+#define _stricmp strcasecmp
+#define _strnicmp strncasecmp
+#define _getcwd getcwd
+
+inline errno_t memcpy_s(void* dst, size_t dstSize, const void* src, size_t count)
+{
+	if (count > dstSize)
+		return ERANGE;
+	memcpy(dst, src, count);
+	return 0;
+}
+
+inline errno_t fopen_s(FILE** file, const char* filename, const char* mode)
+{
+	*file = fopen(filename, mode);
+	return *file ? 0 : errno;
+}
+
+inline size_t fread_s(void* dst, size_t dstSize, size_t elementSize, size_t count, FILE* file)
+{
+	if (elementSize && count > dstSize / elementSize)
+		count = dstSize / elementSize;
+	return fread(dst, elementSize, count, file);
+}
+
+inline int _mkdir(const char* path) { return mkdir(path, 0755); }
+inline int _rmdir(const char* path) { return rmdir(path); }
+#endif // !_MSC_VER
+
+namespace Mist
+{
+	namespace Platform
+	{
+		/**
+		 * Timers
+		 */
+		// monotonic high resolution counter.
+		uint64_t GetTicks();
+		// ticks per second.
+		uint64_t GetTickFrequency();
+
+		/**
+		 * Threads
+		 */
+		uint64_t GetCurrentThreadId();
+		// name shown by debuggers and system tools (truncated to 15 characters on linux).
+		void SetCurrentThreadName(const char* name);
+		void SleepMs(uint32_t ms);
+		// spin wait hint.
+		MIST_FORCEINLINE void CpuRelax()
+		{
+#if defined(_MSC_VER)
+			_mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+			__builtin_ia32_pause();
+#elif defined(__aarch64__)
+			__asm__ __volatile__("yield");
+#endif
+		}
+
+		/**
+		 * Debug
+		 */
+		// text for an attached debugger (OutputDebugString on windows, stderr elsewhere).
+		void DebugOutput(const char* msg);
+		bool IsDebuggerAttached();
+
+		enum eMessageBoxType
+		{
+			MessageBox_Info,
+			MessageBox_Warning,
+			MessageBox_Error,
+		};
+
+		enum eMessageBoxButtons
+		{
+			MessageBoxButtons_Ok,
+			MessageBoxButtons_OkCancel,
+			MessageBoxButtons_YesNo,
+			MessageBoxButtons_YesNoCancel,
+		};
+
+		enum eMessageBoxResult
+		{
+			MessageBoxResult_Ok,
+			MessageBoxResult_Cancel,
+			MessageBoxResult_Yes,
+			MessageBoxResult_No,
+		};
+
+		// modal dialog. Without a native dialog the message goes to stderr and the result is
+		// yes/ok when a debugger is attached, no/cancel otherwise.
+		eMessageBoxResult ShowMessageBox(eMessageBoxType type, eMessageBoxButtons buttons, const char* title, const char* msg);
+
+		/**
+		 * Stack capture
+		 */
+		struct tStackSymbol
+		{
+			char Name[256];
+			char File[256];
+			uint32_t Line;
+			uintptr_t Address;
+		};
+
+		// return addresses of the calling thread, skipping the first skip frames (CaptureStack excluded).
+		uint32_t CaptureStack(void** frames, uint32_t maxFrames, uint32_t skip = 0);
+		// fills what is available for the address, false if nothing could be resolved.
+		bool ResolveStackSymbol(void* address, tStackSymbol& symbol);
+
+		/**
+		 * File mapping
+		 */
+		struct tMappedFile
+		{
+			const void* Data = nullptr;
+			size_t Size = 0;
+			// os handles, platform specific.
+			void* FileHandle = nullptr;
+			void* MappingHandle = nullptr;
+
+			inline bool IsMapped() const { return Data || FileHandle; }
+		};
+
+		// read only view of the whole file. Empty files are mapped with null Data and Size 0.
+		bool MapFile(const char* filepath, tMappedFile& mappedFile);
+		void UnmapFile(tMappedFile& mappedFile);
+
+		enum eMappedFileAdvice
+		{
+			MappedFileAdvice_Normal,
+			MappedFileAdvice_Sequential,
+			MappedFileAdvice_Random,
+			// read the pages ahead of the first access.
+			MappedFileAdvice_WillNeed,
+		};
+
+		// access pattern hint for a range of the view. Only a hint, the os may ignore it.
+		void AdviseMappedFile(const tMappedFile& mappedFile, size_t offset, size_t size, eMappedFileAdvice advice);
+
+		/**
+		 * Directory listing
+		 */
+		// path relative to the visited directory, '/' separated.
+		typedef void (*tFileVisitCallback)(const char* path, void* userData);
+
+		// calls callback for every file under directory, subdirectories are not reported. Returns the number of files.
+		uint32_t VisitDirectoryFiles(const char* directory, bool recursive, tFileVisitCallback callback, void* userData);
+
+		/**
+		 * File change notification
+		 */
+		enum eFileChange
+		{
+			FileChange_Modified,
+			FileChange_Added,
+			FileChange_Removed,
+			// the os dropped notifications, any file may have changed. Reported with an empty path.
+			FileChange_Overflow,
+		};
+
+		// path relative to the watched directory, '/' separated.
+		typedef void (*tFileChangeCallback)(const char* path, eFileChange change, void* userData);
+
+		struct tDirectoryWatch
+		{
+			void* Handle = nullptr;
+			void* Data = nullptr;
+
+			inline bool IsValid() const { return Handle != nullptr; }
+		};
+
+		bool BeginDirectoryWatch(const char* directory, bool recursive, tDirectoryWatch& watch);
+		void EndDirectoryWatch(tDirectoryWatch& watch);
+		// non blocking, calls callback for each change since last poll. Returns the number of changes.
+		uint32_t PollDirectoryWatch(tDirectoryWatch& watch, tFileChangeCallback callback, void* userData);
+	}
+}
@@ -0,0 +1,421 @@
+#include "Core/Platform.h"
+
+#if defined(MIST_PLATFORM_POSIX)
+#include <time.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <cxxabi.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <stdlib.h>
+#include "Core/Debug.h"
+#include "Core/SystemMemory.h"
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <sys/inotify.h>
+#endif
+
+namespace Mist
+{
+	namespace Platform
+	{
+		uint64_t GetTicks()
+		{
+			timespec t;
+			clock_gettime(CLOCK_MONOTONIC, &t);
+			return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+		}
+
+		uint64_t GetTickFrequency()
+		{
+			return 1000000000ull;
+		}
+
+		uint64_t GetCurrentThreadId()
+		{
+#if defined(__linux__)
+			return (uint64_t)syscall(SYS_gettid);
+#else
+			uint64_t id;
+			pthread_threadid_np(nullptr, &id);
+			return id;
+#endif
+		}
+
+		void SetCurrentThreadName(const char* name)
+		{
+#if defined(__linux__)
+			char buff[16];
+			strncpy(buff, name, sizeof(buff) - 1);
+			buff[sizeof(buff) - 1] = 0;
+			pthread_setname_np(pthread_self(), buff);
+#else
+			pthread_setname_np(name);
+#endif
+		}
+
+		void SleepMs(uint32_t ms)
+		{
+			timespec t;
+			t.tv_sec = ms / 1000;
+			t.tv_nsec = (long)(ms % 1000) * 1000000;
+			while (nanosleep(&t, &t) == -1 && errno == EINTR);
+		}
+
+		void DebugOutput(const char* msg)
+		{
+			// stdout already gets the log, the debugger reads stderr.
+			if (IsDebuggerAttached())
+				fputs(msg, stderr);
+		}
+
+		bool IsDebuggerAttached()
+		{
+#if defined(__linux__)
+			FILE* f = fopen("/proc/self/status", "r");
+			if (!f)
+				return false;
+			char line[256];
+			int tracer = 0;
+			while (fgets(line, sizeof(line), f))
+			{
+				if (!strncmp(line, "TracerPid:", 10))
+				{
+					tracer = atoi(line + 10);
+					break;
+				}
+			}
+			fclose(f);
+			return tracer != 0;
+#else
+			return false;
+#endif
+		}
+
+		eMessageBoxResult ShowMessageBox(eMessageBoxType type, eMessageBoxButtons buttons, const char* title, const char* msg)
+		{
+			fprintf(stderr, "[%s] %s\n", title, msg);
+			fflush(stderr);
+			bool accept = IsDebuggerAttached();
+			switch (buttons)
+			{
+			case MessageBoxButtons_YesNo:
+			case MessageBoxButtons_YesNoCancel:
+				return accept ? MessageBoxResult_Yes : MessageBoxResult_No;
+			case MessageBoxButtons_OkCancel:
+				return accept ? MessageBoxResult_Ok : MessageBoxResult_Cancel;
+			case MessageBoxButtons_Ok:
+			default:
+				return MessageBoxResult_Ok;
+			}
+		}
+
+		uint32_t CaptureStack(void** frames, uint32_t maxFrames, uint32_t skip)
+		{
+			static constexpr uint32_t MaxCapture = 128;
+			void* buff[MaxCapture];
+			// skip this function too.
+			int count = backtrace(buff, MaxCapture);
+			uint32_t first = skip + 1;
+			uint32_t written = 0;
+			for (uint32_t i = first; i < (uint32_t)count && written < maxFrames; ++i)
+				frames[written++] = buff[i];
+			return written;
+		}
+
+		bool ResolveStackSymbol(void* address, tStackSymbol& symbol)
+		{
+			*symbol.Name = 0;
+			*symbol.File = 0;
+			symbol.Line = 0;
+			symbol.Address = (uintptr_t)address;
+			Dl_info info;
+			if (!dladdr(address, &info))
+				return false;
+			// no line info without parsing dwarf, module path instead.
+			if (info.dli_fname)
+				strcpy_s(symbol.File, info.dli_fname);
+			if (info.dli_sname)
+			{
+				int status = 0;
+				char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+				strcpy_s(symbol.Name, !status && demangled ? demangled : info.dli_sname);
+				// allocated by the c++ runtime with malloc.
+				free(demangled);
+			}
+			return *symbol.Name || *symbol.File;
+		}
+
+		bool MapFile(const char* filepath, tMappedFile& mappedFile)
+		{
+			check(!mappedFile.IsMapped());
+			int fd = open(filepath, O_RDONLY);
+			if (fd == -1)
+				return false;
+			struct stat info;
+			if (fstat(fd, &info) == -1)
+			{
+				close(fd);
+				return false;
+			}
+			void* data = nullptr;
+			if (info.st_size)
+			{
+				data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (data == MAP_FAILED)
+				{
+					close(fd);
+					return false;
+				}
+			}
+			mappedFile.Data = data;
+			mappedFile.Size = (size_t)info.st_size;
+			// descriptor stored +1 so 0 is still a valid one.
+			mappedFile.FileHandle = (void*)(intptr_t)(fd + 1);
+			mappedFile.MappingHandle = nullptr;
+			return true;
+		}
+
+		void UnmapFile(tMappedFile& mappedFile)
+		{
+			if (mappedFile.Data)
+				munmap(const_cast<void*>(mappedFile.Data), mappedFile.Size);
+			if (mappedFile.FileHandle)
+				close((int)((intptr_t)mappedFile.FileHandle - 1));
+			mappedFile = tMappedFile();
+		}
+
+		void AdviseMappedFile(const tMappedFile& mappedFile, size_t offset, size_t size, eMappedFileAdvice advice)
+		{
+			if (!mappedFile.Data || offset >= mappedFile.Size)
+				return;
+			size = __min(size, mappedFile.Size - offset);
+			// madvise wants a page aligned address.
+			static const uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+			uintptr_t begin = (uintptr_t)mappedFile.Data + offset;
+			uintptr_t alignedBegin = begin & ~(pageSize - 1);
+			int flags = MADV_NORMAL;
+			switch (advice)
+			{
+			case MappedFileAdvice_Sequential: flags = MADV_SEQUENTIAL; break;
+			case MappedFileAdvice_Random: flags = MADV_RANDOM; break;
+			case MappedFileAdvice_WillNeed: flags = MADV_WILLNEED; break;
+			default: break;
+			}
+			madvise((void*)alignedBegin, size + (begin - alignedBegin), flags);
+		}
+
+		static uint32_t VisitDirectoryFiles(const char* root, const char* relative, bool recursive, tFileVisitCallback callback, void* userData)
+		{
+			char path[512];
+			if (*relative)
+				sprintf_s(path, "%s/%s", root, relative);
+			else
+				strcpy_s(path, root);
+			DIR* dir = opendir(path);
+			if (!dir)
+				return 0;
+			uint32_t count = 0;
+			while (dirent* entry = readdir(dir))
+			{
+				if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+					continue;
+				char child[512];
+				if (*relative)
+					sprintf_s(child, "%s/%s", relative, entry->d_name);
+				else
+					strcpy_s(child, entry->d_name);
+				char full[512];
+				sprintf_s(full, "%s/%s", root, child);
+				struct stat info;
+				if (stat(full, &info))
+					continue;
+				if (S_ISDIR(info.st_mode))
+				{
+					if (recursive)
+						count += VisitDirectoryFiles(root, child, recursive, callback, userData);
+				}
+				else if (S_ISREG(info.st_mode))
+				{
+					callback(child, userData);
+					++count;
+				}
+			}
+			closedir(dir);
+			return count;
+		}
+
+		uint32_t VisitDirectoryFiles(const char* directory, bool recursive, tFileVisitCallback callback, void* userData)
+		{
+			check(directory && callback);
+			return VisitDirectoryFiles(directory, "", recursive, callback, userData);
+		}
+
+#if defined(__linux__)
+		/**
+		 * inotify watches a single directory, recursive watches add one descriptor per subdirectory
+		 * and keep its path relative to the root to build the reported paths.
+		 */
+		struct tInotifyWatch
+		{
+			int Fd;
+			bool Recursive;
+			uint32_t Count;
+			uint32_t Capacity;
+			int* Descriptors;
+			char (*Paths)[256];
+		};
+
+		static void InotifyAddDirectory(tInotifyWatch& w, const char* root, const char* relative)
+		{
+			char path[512];
+			if (*relative)
+				sprintf_s(path, "%s/%s", root, relative);
+			else
+				strcpy_s(path, root);
+			// modifications are reported once the writer closes the file, not on every write.
+			int wd = inotify_add_watch(w.Fd, path, IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+			if (wd == -1)
+				return;
+			if (w.Count == w.Capacity)
+			{
+				w.Capacity = __max(w.Capacity * 2, 16u);
+				w.Descriptors = (int*)_realloc(w.Descriptors, sizeof(int) * w.Capacity);
+				w.Paths = (char(*)[256])_realloc(w.Paths, sizeof(*w.Paths) * w.Capacity);
+			}
+			w.Descriptors[w.Count] = wd;
+			strcpy_s(w.Paths[w.Count], relative);
+			++w.Count;
+
+			if (!w.Recursive)
+				return;
+			DIR* dir = opendir(path);
+			if (!dir)
+				return;
+			while (dirent* entry = readdir(dir))
+			{
+				if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+					continue;
+				char child[512];
+				if (*relative)
+					sprintf_s(child, "%s/%s", relative, entry->d_name);
+				else
+					strcpy_s(child, entry->d_name);
+				char full[512];
+				sprintf_s(full, "%s/%s", root, child);
+				struct stat info;
+				if (!stat(full, &info) && S_ISDIR(info.st_mode))
+					InotifyAddDirectory(w, root, child);
+			}
+			closedir(dir);
+		}
+
+		bool BeginDirectoryWatch(const char* directory, bool recursive, tDirectoryWatch& watch)
+		{
+			check(!watch.IsValid());
+			int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (fd == -1)
+				return false;
+			tInotifyWatch* w = _new tInotifyWatch{ fd, recursive, 0, 0, nullptr, nullptr };
+			InotifyAddDirectory(*w, directory, "");
+			if (!w->Count)
+			{
+				close(fd);
+				delete w;
+				return false;
+			}
+			size_t len = strlen(directory) + 1;
+			char* root = (char*)_malloc(len);
+			memcpy(root, directory, len);
+			watch.Handle = w;
+			watch.Data = root;
+			return true;
+		}
+
+		void EndDirectoryWatch(tDirectoryWatch& watch)
+		{
+			if (!watch.IsValid())
+				return;
+			tInotifyWatch* w = (tInotifyWatch*)watch.Handle;
+			close(w->Fd);
+			Mist::Free(w->Descriptors);
+			Mist::Free(w->Paths);
+			delete w;
+			Mist::Free(watch.Data);
+			watch = tDirectoryWatch();
+		}
+
+		uint32_t PollDirectoryWatch(tDirectoryWatch& watch, tFileChangeCallback callback, void* userData)
+		{
+			check(watch.IsValid() && callback);
+			tInotifyWatch& w = *(tInotifyWatch*)watch.Handle;
+			const char* root = (const char*)watch.Data;
+			alignas(inotify_event) char buff[4096];
+			uint32_t changes = 0;
+			while (true)
+			{
+				ssize_t len = read(w.Fd, buff, sizeof(buff));
+				if (len <= 0)
+					break;
+				for (ssize_t offset = 0; offset < len; )
+				{
+					const inotify_event* e = (const inotify_event*)(buff + offset);
+					offset += sizeof(inotify_event) + e->len;
+					if (e->mask & IN_Q_OVERFLOW)
+					{
+						callback("", FileChange_Overflow, userData);
+						++changes;
+						continue;
+					}
+					if (!e->len)
+						continue;
+					const char* dir = nullptr;
+					for (uint32_t i = 0; i < w.Count && !dir; ++i)
+						dir = w.Descriptors[i] == e->wd ? w.Paths[i] : nullptr;
+					if (!dir)
+						continue;
+					char path[512];
+					if (*dir)
+						sprintf_s(path, "%s/%s", dir, e->name);
+					else
+						strcpy_s(path, e->name);
+					if (e->mask & IN_ISDIR)
+					{
+						// new subdirectories join the watch, directory events are not reported.
+						if (w.Recursive && (e->mask & (IN_CREATE | IN_MOVED_TO)))
+							InotifyAddDirectory(w, root, path);
+						continue;
+					}
+					eFileChange change = FileChange_Modified;
+					if (e->mask & (IN_CREATE | IN_MOVED_TO))
+						change = FileChange_Added;
+					else if (e->mask & (IN_DELETE | IN_MOVED_FROM))
+						change = FileChange_Removed;
+					else if (!(e->mask & IN_CLOSE_WRITE))
+						continue;
+					callback(path, change, userData);
+					++changes;
+				}
+			}
+			return changes;
+		}
+#else
+		bool BeginDirectoryWatch(const char* directory, bool recursive, tDirectoryWatch& watch)
+		{
+			return false;
+		}
+
+		void EndDirectoryWatch(tDirectoryWatch& watch)
+		{
+		}
+
+		uint32_t PollDirectoryWatch(tDirectoryWatch& watch, tFileChangeCallback callback, void* userData)
+		{
+			return 0;
+		}
+#endif // __linux__
+	}
+}
+#endif // MIST_PLATFORM_POSIX
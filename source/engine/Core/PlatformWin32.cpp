@@ -0,0 +1,342 @@
+#include "Core/Platform.h"
+
+#if defined(MIST_PLATFORM_WINDOWS)
+#include <Windows.h>
+#include <DbgHelp.h>
+#include <mutex>
+#include "Core/Debug.h"
+#include "Core/SystemMemory.h"
+
+#pragma comment(lib,"Dbghelp.lib")
+
+namespace Mist
+{
+	namespace Platform
+	{
+		uint64_t GetTicks()
+		{
+			LARGE_INTEGER t;
+			BOOL b = QueryPerformanceCounter(&t);
+			check(b);
+			return (uint64_t)t.QuadPart;
+		}
+
+		uint64_t GetTickFrequency()
+		{
+			static const uint64_t frequency = []()
+				{
+					LARGE_INTEGER f;
+					BOOL b = QueryPerformanceFrequency(&f);
+					check(b && f.QuadPart);
+					return (uint64_t)f.QuadPart;
+				}();
+			return frequency;
+		}
+
+		uint64_t GetCurrentThreadId()
+		{
+			return (uint64_t)::GetCurrentThreadId();
+		}
+
+		void SetCurrentThreadName(const char* name)
+		{
+			wchar_t wname[64];
+			MultiByteToWideChar(CP_UTF8, 0, name, -1, wname, (int)(sizeof(wname) / sizeof(*wname)));
+			wname[63] = 0;
+			SetThreadDescription(GetCurrentThread(), wname);
+		}
+
+		void SleepMs(uint32_t ms)
+		{
+			Sleep(ms);
+		}
+
+		void DebugOutput(const char* msg)
+		{
+			OutputDebugStringA(msg);
+		}
+
+		bool IsDebuggerAttached()
+		{
+			return IsDebuggerPresent() != FALSE;
+		}
+
+		eMessageBoxResult ShowMessageBox(eMessageBoxType type, eMessageBoxButtons buttons, const char* title, const char* msg)
+		{
+			UINT flags = 0;
+			switch (buttons)
+			{
+			case MessageBoxButtons_Ok: flags = MB_OK; break;
+			case MessageBoxButtons_OkCancel: flags = MB_OKCANCEL; break;
+			case MessageBoxButtons_YesNo: flags = MB_YESNO; break;
+			case MessageBoxButtons_YesNoCancel: flags = MB_YESNOCANCEL; break;
+			}
+			switch (type)
+			{
+			case MessageBox_Info: flags |= MB_ICONINFORMATION; break;
+			case MessageBox_Warning: flags |= MB_ICONWARNING; break;
+			case MessageBox_Error: flags |= MB_ICONERROR; break;
+			}
+			switch (MessageBoxA(NULL, msg, title, flags))
+			{
+			case IDCANCEL: return MessageBoxResult_Cancel;
+			case IDOK: return MessageBoxResult_Ok;
+			case IDYES: return MessageBoxResult_Yes;
+			case IDNO: return MessageBoxResult_No;
+			}
+			return MessageBoxResult_No;
+		}
+
+		uint32_t CaptureStack(void** frames, uint32_t maxFrames, uint32_t skip)
+		{
+			// skip this function too.
+			return RtlCaptureStackBackTrace((DWORD)skip + 1, (DWORD)maxFrames, frames, nullptr);
+		}
+
+		bool ResolveStackSymbol(void* address, tStackSymbol& symbol)
+		{
+			// DbgHelp is single threaded.
+			static std::mutex mutex;
+			std::lock_guard<std::mutex> lock(mutex);
+			HANDLE process = GetCurrentProcess();
+			static bool initialized = false;
+			if (!initialized)
+			{
+				SymSetOptions(SymGetOptions() | SYMOPT_LOAD_LINES | SYMOPT_UNDNAME);
+				initialized = SymInitialize(process, NULL, TRUE) != FALSE;
+			}
+
+			*symbol.Name = 0;
+			*symbol.File = 0;
+			symbol.Line = 0;
+			symbol.Address = (uintptr_t)address;
+
+			char buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME * sizeof(TCHAR)];
+			PSYMBOL_INFO info = (PSYMBOL_INFO)buffer;
+			info->SizeOfStruct = sizeof(SYMBOL_INFO);
+			info->MaxNameLen = MAX_SYM_NAME;
+			DWORD64 displacement = 0;
+			if (SymFromAddr(process, (DWORD64)address, &displacement, info))
+			{
+				strcpy_s(symbol.Name, info->Name);
+				symbol.Address = (uintptr_t)info->Address;
+			}
+
+			IMAGEHLP_LINE64 line;
+			line.SizeOfStruct = sizeof(IMAGEHLP_LINE64);
+			DWORD lineDisplacement = 0;
+			if (SymGetLineFromAddr64(process, (DWORD64)address, &lineDisplacement, &line))
+			{
+				strcpy_s(symbol.File, line.FileName);
+				symbol.Line = line.LineNumber;
+			}
+			return *symbol.Name || *symbol.File;
+		}
+
+		bool MapFile(const char* filepath, tMappedFile& mappedFile)
+		{
+			check(!mappedFile.IsMapped());
+			HANDLE file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+			if (file == INVALID_HANDLE_VALUE)
+				return false;
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(file, &size))
+			{
+				CloseHandle(file);
+				return false;
+			}
+			HANDLE mapping = NULL;
+			const void* data = nullptr;
+			// empty files can't be mapped.
+			if (size.QuadPart)
+			{
+				mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+				if (!mapping)
+				{
+					CloseHandle(file);
+					return false;
+				}
+				data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				if (!data)
+				{
+					CloseHandle(mapping);
+					CloseHandle(file);
+					return false;
+				}
+			}
+			mappedFile.Data = data;
+			mappedFile.Size = (size_t)size.QuadPart;
+			mappedFile.FileHandle = file;
+			mappedFile.MappingHandle = mapping;
+			return true;
+		}
+
+		void UnmapFile(tMappedFile& mappedFile)
+		{
+			if (mappedFile.Data)
+				UnmapViewOfFile(mappedFile.Data);
+			if (mappedFile.MappingHandle)
+				CloseHandle(mappedFile.MappingHandle);
+			if (mappedFile.FileHandle)
+				CloseHandle(mappedFile.FileHandle);
+			mappedFile = tMappedFile();
+		}
+
+		void AdviseMappedFile(const tMappedFile& mappedFile, size_t offset, size_t size, eMappedFileAdvice advice)
+		{
+			if (!mappedFile.Data || offset >= mappedFile.Size)
+				return;
+			// the view is opened for random access, read ahead is done by prefetching the range.
+			if (advice != MappedFileAdvice_WillNeed && advice != MappedFileAdvice_Sequential)
+				return;
+			WIN32_MEMORY_RANGE_ENTRY range;
+			range.VirtualAddress = (uint8_t*)mappedFile.Data + offset;
+			range.NumberOfBytes = __min(size, mappedFile.Size - offset);
+			PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+		}
+
+		static uint32_t VisitDirectoryFiles(const char* root, const char* relative, bool recursive, tFileVisitCallback callback, void* userData)
+		{
+			char pattern[512];
+			if (*relative)
+				sprintf_s(pattern, "%s/%s/*", root, relative);
+			else
+				sprintf_s(pattern, "%s/*", root);
+			WIN32_FIND_DATAA data;
+			HANDLE find = FindFirstFileA(pattern, &data);
+			if (find == INVALID_HANDLE_VALUE)
+				return 0;
+			uint32_t count = 0;
+			do
+			{
+				if (!strcmp(data.cFileName, ".") || !strcmp(data.cFileName, ".."))
+					continue;
+				char child[512];
+				if (*relative)
+					sprintf_s(child, "%s/%s", relative, data.cFileName);
+				else
+					strcpy_s(child, data.cFileName);
+				if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+				{
+					if (recursive)
+						count += VisitDirectoryFiles(root, child, recursive, callback, userData);
+				}
+				else
+				{
+					callback(child, userData);
+					++count;
+				}
+			} while (FindNextFileA(find, &data));
+			FindClose(find);
+			return count;
+		}
+
+		uint32_t VisitDirectoryFiles(const char* directory, bool recursive, tFileVisitCallback callback, void* userData)
+		{
+			check(directory && callback);
+			return VisitDirectoryFiles(directory, "", recursive, callback, userData);
+		}
+
+		/**
+		 * ReadDirectoryChangesW with an overlapped read always in flight. Polling checks the event
+		 * without waiting, consumes the notifications and queues the next read.
+		 */
+		struct tWin32Watch
+		{
+			HANDLE Directory;
+			OVERLAPPED Overlapped;
+			BOOL Recursive;
+			alignas(DWORD) uint8_t Buffer[16 * 1024];
+		};
+
+		static bool IssueDirectoryRead(tWin32Watch& w)
+		{
+			return ReadDirectoryChangesW(w.Directory, w.Buffer, sizeof(w.Buffer), w.Recursive,
+				FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE,
+				NULL, &w.Overlapped, NULL) != FALSE;
+		}
+
+		bool BeginDirectoryWatch(const char* directory, bool recursive, tDirectoryWatch& watch)
+		{
+			check(!watch.IsValid());
+			HANDLE dir = CreateFileA(directory, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+				NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+			if (dir == INVALID_HANDLE_VALUE)
+				return false;
+			tWin32Watch* w = _new tWin32Watch();
+			w->Directory = dir;
+			w->Recursive = recursive ? TRUE : FALSE;
+			memset(&w->Overlapped, 0, sizeof(w->Overlapped));
+			w->Overlapped.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+			if (!w->Overlapped.hEvent || !IssueDirectoryRead(*w))
+			{
+				if (w->Overlapped.hEvent)
+					CloseHandle(w->Overlapped.hEvent);
+				CloseHandle(dir);
+				delete w;
+				return false;
+			}
+			watch.Handle = w;
+			return true;
+		}
+
+		void EndDirectoryWatch(tDirectoryWatch& watch)
+		{
+			if (!watch.IsValid())
+				return;
+			tWin32Watch* w = (tWin32Watch*)watch.Handle;
+			CancelIoEx(w->Directory, &w->Overlapped);
+			DWORD bytes;
+			// the buffer must outlive the cancelled read.
+			GetOverlappedResult(w->Directory, &w->Overlapped, &bytes, TRUE);
+			CloseHandle(w->Overlapped.hEvent);
+			CloseHandle(w->Directory);
+			delete w;
+			watch = tDirectoryWatch();
+		}
+
+		uint32_t PollDirectoryWatch(tDirectoryWatch& watch, tFileChangeCallback callback, void* userData)
+		{
+			check(watch.IsValid() && callback);
+			tWin32Watch& w = *(tWin32Watch*)watch.Handle;
+			uint32_t changes = 0;
+			DWORD bytes = 0;
+			while (GetOverlappedResult(w.Directory, &w.Overlapped, &bytes, FALSE))
+			{
+				// bytes 0: buffer overflowed and changes were lost.
+				if (!bytes)
+				{
+					callback("", FileChange_Overflow, userData);
+					++changes;
+				}
+				for (DWORD offset = 0; bytes; )
+				{
+					const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)(w.Buffer + offset);
+					char path[512];
+					int len = WideCharToMultiByte(CP_UTF8, 0, info->FileName, (int)(info->FileNameLength / sizeof(WCHAR)), path, sizeof(path) - 1, NULL, NULL);
+					path[len] = 0;
+					for (int i = 0; i < len; ++i)
+						path[i] = path[i] == '\\' ? '/' : path[i];
+					eFileChange change = FileChange_Modified;
+					switch (info->Action)
+					{
+					case FILE_ACTION_ADDED:
+					case FILE_ACTION_RENAMED_NEW_NAME: change = FileChange_Added; break;
+					case FILE_ACTION_REMOVED:
+					case FILE_ACTION_RENAMED_OLD_NAME: change = FileChange_Removed; break;
+					}
+					callback(path, change, userData);
+					++changes;
+					if (!info->NextEntryOffset)
+						break;
+					offset += info->NextEntryOffset;
+				}
+				ResetEvent(w.Overlapped.hEvent);
+				if (!IssueDirectoryRead(w))
+					break;
+			}
+			return changes;
+		}
+	}
+}
+#endif // MIST_PLATFORM_WINDOWS
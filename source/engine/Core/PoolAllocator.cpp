@@ -0,0 +1,226 @@
+#include "Core/PoolAllocator.h"
+#include "Core/SystemMemory.h"
+#include "Core/Types.h"
+#include "Core/Debug.h"
+#include "Core/Logger.h"
+#include "Core/Console.h"
+
+namespace Mist
+{
+	tPoolAllocator::~tPoolAllocator()
+	{
+		// Static destruction order is unknown, chunks are released on TerminatePoolAllocator.
+	}
+
+	void* tPoolAllocator::Allocate(size_t size)
+	{
+		if (!size || size > MaxSize)
+			return _malloc(__max(size, 1));
+
+		uint32_t index = GetSizeClass(size);
+		size_t slotSize = GetSizeClassSize(index);
+		tSizeClass& sizeClass = m_classes[index];
+		void* p = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(sizeClass.Mutex);
+			if (sizeClass.FreeList)
+			{
+				p = sizeClass.FreeList;
+				sizeClass.FreeList = sizeClass.FreeList->Next;
+			}
+			else
+			{
+				if (!sizeClass.Pointer || sizeClass.Pointer + slotSize > sizeClass.End)
+					PushChunk(sizeClass, slotSize);
+				p = sizeClass.Pointer;
+				sizeClass.Pointer += slotSize;
+			}
+		}
+		m_allocated += slotSize;
+		++m_count;
+		return p;
+	}
+
+	void tPoolAllocator::Release(void* p, size_t size)
+	{
+		if (!p)
+			return;
+		if (!size || size > MaxSize)
+		{
+			Free(p);
+			return;
+		}
+
+		uint32_t index = GetSizeClass(size);
+		size_t slotSize = GetSizeClassSize(index);
+		tSizeClass& sizeClass = m_classes[index];
+		{
+			std::lock_guard<std::mutex> lock(sizeClass.Mutex);
+			tFreeNode* node = static_cast<tFreeNode*>(p);
+			node->Next = sizeClass.FreeList;
+			sizeClass.FreeList = node;
+		}
+		check(m_allocated.load() >= slotSize && m_count.load());
+		m_allocated -= slotSize;
+		--m_count;
+	}
+
+	void tPoolAllocator::Destroy()
+	{
+		check(!m_count.load());
+		for (uint32_t i = 0; i < SizeClassCount; ++i)
+		{
+			tSizeClass& sizeClass = m_classes[i];
+			std::lock_guard<std::mutex> lock(sizeClass.Mutex);
+			while (sizeClass.Chunks)
+			{
+				tChunk* next = sizeClass.Chunks->Next;
+				Free(sizeClass.Chunks);
+				sizeClass.Chunks = next;
+			}
+			sizeClass.FreeList = nullptr;
+			sizeClass.Pointer = nullptr;
+			sizeClass.End = nullptr;
+		}
+		m_capacity = 0;
+		m_chunkCount = 0;
+	}
+
+	tPoolStats tPoolAllocator::GetStats() const
+	{
+		tPoolStats stats;
+		stats.Allocated = m_allocated.load();
+		stats.Capacity = m_capacity.load();
+		stats.ObjectCount = m_count.load();
+		stats.ChunkCount = m_chunkCount.load();
+		return stats;
+	}
+
+	void tPoolAllocator::PushChunk(tSizeClass& sizeClass, size_t slotSize)
+	{
+		// chunk header takes one slot to keep slots aligned to granularity.
+		size_t headerSize = __max(sizeof(tChunk), Granularity);
+		size_t chunkSize = __max(ChunkSize, headerSize + slotSize * 8);
+		tChunk* chunk = (tChunk*)_malloc(chunkSize);
+		check(chunk);
+		chunk->Next = sizeClass.Chunks;
+		sizeClass.Chunks = chunk;
+		sizeClass.Pointer = (uint8_t*)chunk + headerSize;
+		sizeClass.End = (uint8_t*)chunk + chunkSize;
+		m_capacity += chunkSize;
+		++m_chunkCount;
+	}
+
+	tPoolAllocator& GetPoolAllocator()
+	{
+		static tPoolAllocator pool;
+		return pool;
+	}
+
+	void* PoolMalloc(size_t size)
+	{
+		return GetPoolAllocator().Allocate(size);
+	}
+
+	void PoolFree(void* p, size_t size)
+	{
+		GetPoolAllocator().Release(p, size);
+	}
+
+	tPoolStats GetPoolStats()
+	{
+		return GetPoolAllocator().GetStats();
+	}
+
+	void DumpPoolStats()
+	{
+		tPoolStats stats = GetPoolStats();
+		loginfo("****************** Pool allocator stats ******************\n");
+		logfinfo("Live objects:		%8lld\n", stats.ObjectCount);
+		logfinfo("Allocated:		%8lld bytes\n", stats.Allocated);
+		logfinfo("Capacity:		%8lld bytes (%d chunks)\n", stats.Capacity, stats.ChunkCount);
+		loginfo("**********************************************************\n");
+	}
+
+	// Create/destroy churn over a set of live objects, with the sizes of the render resources.
+	// Compares the pool against the tracked system allocator.
+	void BenchmarkPoolAllocator()
+	{
+		static constexpr size_t Sizes[] = { 48, 96, 160, 256, 400, 640 };
+		static constexpr uint32_t LiveCount = 1 << 12;
+		static constexpr uint32_t Iterations = 1 << 20;
+
+		struct tLiveObject
+		{
+			void* Data;
+			size_t Size;
+		};
+		tLiveObject* live = (tLiveObject*)malloc(sizeof(tLiveObject) * LiveCount);
+		check(live);
+
+		loginfo("****************** Pool allocator benchmark ******************\n");
+		for (uint32_t usePool = 0; usePool < 2; ++usePool)
+		{
+			uint32_t seed = 0x12345678;
+			auto nextRandom = [&seed]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+			for (uint32_t i = 0; i < LiveCount; ++i)
+			{
+				live[i].Size = Sizes[nextRandom() % CountOf(Sizes)];
+				live[i].Data = usePool ? PoolMalloc(live[i].Size) : _malloc(live[i].Size);
+			}
+
+			Profiling::sProfilingTimer timer;
+			timer.Start();
+			for (uint32_t i = 0; i < Iterations; ++i)
+			{
+				tLiveObject& object = live[nextRandom() % LiveCount];
+				if (usePool)
+					PoolFree(object.Data, object.Size);
+				else
+					Free(object.Data);
+				object.Size = Sizes[nextRandom() % CountOf(Sizes)];
+				object.Data = usePool ? PoolMalloc(object.Size) : _malloc(object.Size);
+			}
+			double ms = timer.Stop();
+
+			for (uint32_t i = 0; i < LiveCount; ++i)
+			{
+				if (usePool)
+					PoolFree(live[i].Data, live[i].Size);
+				else
+					Free(live[i].Data);
+			}
+			logfinfo("%s | %d live objects | %7.2f ns per create/destroy\n",
+				usePool ? "Pool  " : "Malloc", LiveCount, ms * 1e6 / Iterations);
+		}
+		loginfo("**************************************************************\n");
+		free(live);
+	}
+
+	void ExecCommand_DumpPoolStats(const char* command)
+	{
+		DumpPoolStats();
+	}
+
+	void ExecCommand_BenchmarkPoolAllocator(const char* command)
+	{
+		BenchmarkPoolAllocator();
+	}
+
+	void InitPoolAllocator()
+	{
+		AddConsoleCommand("c_poolstats", &ExecCommand_DumpPoolStats);
+		AddConsoleCommand("c_poolbench", &ExecCommand_BenchmarkPoolAllocator);
+	}
+
+	void TerminatePoolAllocator()
+	{
+		tPoolStats stats = GetPoolStats();
+		if (stats.ObjectCount)
+		{
+			logferror("Pool allocator: %lld objects (%lld bytes) not released.\n", stats.ObjectCount, stats.Allocated);
+			return;
+		}
+		GetPoolAllocator().Destroy();
+	}
+}
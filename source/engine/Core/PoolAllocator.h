@@ -0,0 +1,112 @@
+// header file for Mist project
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+
+namespace Mist
+{
+	struct tPoolStats
+	{
+		// bytes of live objects, rounded up to their size class.
+		size_t Allocated = 0;
+		// bytes requested to the system allocator for chunks.
+		size_t Capacity = 0;
+		size_t ObjectCount = 0;
+		uint32_t ChunkCount = 0;
+	};
+
+	// Small object allocator. Requests are rounded up to a size class, each size class
+	// carves fixed size slots from chunks and recycles released slots with an intrusive free list.
+	// Allocate and Release are O(1). Chunks are requested to the system allocator (tracked) and kept
+	// until Destroy(). Requests bigger than MaxSize fall back to the system allocator.
+	class tPoolAllocator
+	{
+		struct tFreeNode
+		{
+			tFreeNode* Next;
+		};
+
+		struct tChunk
+		{
+			tChunk* Next;
+		};
+
+		struct tSizeClass
+		{
+			std::mutex Mutex;
+			tFreeNode* FreeList = nullptr;
+			uint8_t* Pointer = nullptr;
+			uint8_t* End = nullptr;
+			tChunk* Chunks = nullptr;
+		};
+
+	public:
+		static constexpr size_t Granularity = 16;
+		static constexpr size_t MaxSize = 1024;
+		static constexpr uint32_t SizeClassCount = MaxSize / Granularity;
+		static constexpr size_t ChunkSize = 1 << 16;
+
+		tPoolAllocator() = default;
+		~tPoolAllocator();
+		tPoolAllocator(const tPoolAllocator&) = delete;
+		tPoolAllocator& operator=(const tPoolAllocator&) = delete;
+
+		[[nodiscard]] void* Allocate(size_t size);
+		void Release(void* p, size_t size);
+		// Release all chunks. All objects must be released before.
+		void Destroy();
+
+		tPoolStats GetStats() const;
+
+		static inline uint32_t GetSizeClass(size_t size) { return (uint32_t)((size + Granularity - 1) / Granularity) - 1; }
+		static inline size_t GetSizeClassSize(uint32_t sizeClass) { return ((size_t)sizeClass + 1) * Granularity; }
+
+	private:
+		void PushChunk(tSizeClass& sizeClass, size_t slotSize);
+
+		tSizeClass m_classes[SizeClassCount];
+		std::atomic<size_t> m_allocated = 0;
+		std::atomic<size_t> m_capacity = 0;
+		std::atomic<size_t> m_count = 0;
+		std::atomic<uint32_t> m_chunkCount = 0;
+	};
+
+	tPoolAllocator& GetPoolAllocator();
+	[[nodiscard]] void* PoolMalloc(size_t size);
+	void PoolFree(void* p, size_t size);
+	tPoolStats GetPoolStats();
+	void InitPoolAllocator();
+	// Releases pool chunks if there are no live objects, reports them otherwise.
+	void TerminatePoolAllocator();
+	// Create/destroy churn with the sizes of the render resources, pool against system allocator.
+	void BenchmarkPoolAllocator();
+
+	// Inherit to allocate the objects of T from the pool allocator with plain new/delete.
+	// Note: _new uses global operator new and would skip the pool, don't use it with these types.
+	template <typename T>
+	class tPoolObject
+	{
+	public:
+		static void* operator new(size_t size)
+		{
+			return PoolMalloc(size);
+		}
+
+		static void operator delete(void* p, size_t size)
+		{
+			PoolFree(p, size);
+		}
+
+		// keep placement new visible.
+		static void* operator new(size_t size, void* p) noexcept
+		{
+			return p;
+		}
+
+		static void operator delete(void* p, void* place) noexcept
+		{
+		}
+	};
+}
@@ -0,0 +1,324 @@
+#include "Core/StringId.h"
+#include "Core/Types.h"
+#include "Core/Debug.h"
+#include "Core/Logger.h"
+#include "Core/Console.h"
+#include <atomic>
+#include <mutex>
+#include <stdlib.h>
+
+namespace Mist
+{
+	namespace stringid
+	{
+		struct tEntry
+		{
+			const char* Str;
+			uint64_t Hash;
+			uint32_t Length;
+		};
+
+		// open addressing table of ids. Slots are only written under the mutex and published
+		// with release stores, readers probe them with acquire loads.
+		struct tIndexTable
+		{
+			uint32_t Mask;
+			tIndexTable* Retired;
+			std::atomic<uint32_t> Slots[1];
+		};
+
+		static constexpr uint32_t EntriesPerChunk = 1 << 12;
+		static constexpr uint32_t MaxChunks = 1 << 10;
+		static constexpr size_t StringBlockSize = 1 << 16;
+		static constexpr uint32_t MinTableSize = 1 << 10;
+
+		/**
+		 * Entries live in fixed chunks that never move, so an id can be resolved without locks.
+		 * The table lives for the whole process: ids are created by static initializers before
+		 * InitSytemMemory and can be read by static destructors, so its memory comes from the CRT heap
+		 * and is never released (it would show up as a leak in the memory trace otherwise).
+		 */
+		struct tStringTable
+		{
+			std::mutex Mutex;
+			std::atomic<tEntry*> Chunks[MaxChunks];
+			std::atomic<tIndexTable*> Index;
+			std::atomic<uint32_t> Count;
+			char* Block = nullptr;
+			size_t BlockUsed = 0;
+			size_t BlockSize = 0;
+			size_t StringBytes = 0;
+
+			tStringTable()
+			{
+				for (uint32_t i = 0; i < MaxChunks; ++i)
+					Chunks[i].store(nullptr, std::memory_order_relaxed);
+				Index.store(CreateIndex(MinTableSize), std::memory_order_relaxed);
+				// id 0 is the invalid id, resolves to an empty string.
+				tEntry* chunk = CreateChunk();
+				chunk[0] = { "", HashStringId(""), 0 };
+				Chunks[0].store(chunk, std::memory_order_release);
+				Count.store(1, std::memory_order_release);
+			}
+
+			static tIndexTable* CreateIndex(uint32_t size)
+			{
+				check(size && !(size & (size - 1)));
+				tIndexTable* table = (tIndexTable*)malloc(sizeof(tIndexTable) + sizeof(std::atomic<uint32_t>) * (size - 1));
+				check(table);
+				table->Mask = size - 1;
+				table->Retired = nullptr;
+				for (uint32_t i = 0; i < size; ++i)
+					new(&table->Slots[i]) std::atomic<uint32_t>(tStringId::InvalidId);
+				return table;
+			}
+
+			static tEntry* CreateChunk()
+			{
+				tEntry* chunk = (tEntry*)malloc(sizeof(tEntry) * EntriesPerChunk);
+				check(chunk);
+				return chunk;
+			}
+
+			inline const tEntry& GetEntry(uint32_t id) const
+			{
+				check(id < Count.load(std::memory_order_acquire));
+				return Chunks[id / EntriesPerChunk].load(std::memory_order_acquire)[id % EntriesPerChunk];
+			}
+
+			uint32_t Find(const char* str, uint64_t hash) const
+			{
+				const tIndexTable* index = Index.load(std::memory_order_acquire);
+				for (uint32_t i = (uint32_t)hash & index->Mask; ; i = (i + 1) & index->Mask)
+				{
+					uint32_t id = index->Slots[i].load(std::memory_order_acquire);
+					if (id == tStringId::InvalidId)
+						return tStringId::InvalidId;
+					const tEntry& entry = GetEntry(id);
+					if (entry.Hash == hash && !strcmp(entry.Str, str))
+						return id;
+				}
+			}
+
+			// must be called with the mutex locked.
+			const char* CopyString(const char* str, uint32_t length)
+			{
+				size_t size = (size_t)length + 1;
+				if (BlockUsed + size > BlockSize)
+				{
+					BlockSize = __max(StringBlockSize, size);
+					Block = (char*)malloc(BlockSize);
+					check(Block);
+					BlockUsed = 0;
+				}
+				char* dst = Block + BlockUsed;
+				memcpy(dst, str, size);
+				BlockUsed += size;
+				StringBytes += size;
+				return dst;
+			}
+
+			// must be called with the mutex locked.
+			void InsertIndex(tIndexTable* index, uint32_t id, uint64_t hash)
+			{
+				uint32_t i = (uint32_t)hash & index->Mask;
+				while (index->Slots[i].load(std::memory_order_relaxed) != tStringId::InvalidId)
+					i = (i + 1) & index->Mask;
+				index->Slots[i].store(id, std::memory_order_release);
+			}
+
+			// must be called with the mutex locked.
+			void GrowIndex()
+			{
+				tIndexTable* old = Index.load(std::memory_order_relaxed);
+				tIndexTable* index = CreateIndex((old->Mask + 1) * 2);
+				uint32_t count = Count.load(std::memory_order_relaxed);
+				for (uint32_t id = 1; id < count; ++id)
+					InsertIndex(index, id, GetEntry(id).Hash);
+				// readers may still be probing the old table, keep it alive.
+				index->Retired = old;
+				Index.store(index, std::memory_order_release);
+			}
+
+			uint32_t Intern(const char* str, uint64_t hash)
+			{
+				uint32_t id = Find(str, hash);
+				if (id != tStringId::InvalidId)
+					return id;
+
+				std::lock_guard<std::mutex> lock(Mutex);
+				// another thread may have interned it, or grown the index, while we were waiting.
+				id = Find(str, hash);
+				if (id != tStringId::InvalidId)
+					return id;
+
+				id = Count.load(std::memory_order_relaxed);
+				check(id < EntriesPerChunk * MaxChunks && "String id table is full");
+				uint32_t chunkIndex = id / EntriesPerChunk;
+				tEntry* chunk = Chunks[chunkIndex].load(std::memory_order_relaxed);
+				if (!chunk)
+				{
+					chunk = CreateChunk();
+					Chunks[chunkIndex].store(chunk, std::memory_order_release);
+				}
+				uint32_t length = (uint32_t)strlen(str);
+				chunk[id % EntriesPerChunk] = { CopyString(str, length), hash, length };
+				// entry must be visible before the id can be reached from the index.
+				Count.store(id + 1, std::memory_order_release);
+
+				tIndexTable* index = Index.load(std::memory_order_relaxed);
+				if ((id + 1) * 4 > (index->Mask + 1) * 3)
+					GrowIndex();
+				else
+					InsertIndex(index, id, hash);
+				return id;
+			}
+		};
+
+		tStringTable& GetTable()
+		{
+			// construct on first use, ids are created from static initializers.
+			static tStringTable* table = new(malloc(sizeof(tStringTable))) tStringTable();
+			return *table;
+		}
+	}
+
+	tStringId::tStringId(const char* str)
+		: tStringId(str, HashStringId(str))
+	{
+	}
+
+	tStringId::tStringId(const char* str, uint64_t hash)
+	{
+		check(str && hash == HashStringId(str));
+		m_id = *str ? stringid::GetTable().Intern(str, hash) : InvalidId;
+	}
+
+	tStringId tStringId::Find(const char* str)
+	{
+		return Find(str, HashStringId(str));
+	}
+
+	tStringId tStringId::Find(const char* str, uint64_t hash)
+	{
+		tStringId id;
+		if (str && *str)
+			id.m_id = stringid::GetTable().Find(str, hash);
+		return id;
+	}
+
+	const char* tStringId::CStr() const
+	{
+		return stringid::GetTable().GetEntry(m_id).Str;
+	}
+
+	uint64_t tStringId::GetHash() const
+	{
+		return stringid::GetTable().GetEntry(m_id).Hash;
+	}
+
+	uint32_t tStringId::GetLength() const
+	{
+		return stringid::GetTable().GetEntry(m_id).Length;
+	}
+
+	tStringIdStats GetStringIdStats()
+	{
+		stringid::tStringTable& table = stringid::GetTable();
+		std::lock_guard<std::mutex> lock(table.Mutex);
+		tStringIdStats stats;
+		stats.StringCount = table.Count.load(std::memory_order_relaxed) - 1;
+		stats.StringBytes = table.StringBytes;
+		stats.TableCapacity = table.Index.load(std::memory_order_relaxed)->Mask + 1;
+		return stats;
+	}
+
+	void DumpStringIdStats()
+	{
+		tStringIdStats stats = GetStringIdStats();
+		loginfo("****************** String id stats ******************\n");
+		logfinfo("Strings:		%8d\n", stats.StringCount);
+		logfinfo("String bytes:	%8lld bytes\n", stats.StringBytes);
+		logfinfo("Index size:	%8d slots (load %.2f)\n", stats.TableCapacity, (float)stats.StringCount / (float)stats.TableCapacity);
+		loginfo("*****************************************************\n");
+	}
+
+	// Shader property style lookups: strcmp over a list of names vs String keyed map vs interned ids.
+	void BenchmarkStringIds()
+	{
+		static constexpr uint32_t NameCount = 24;
+		static constexpr uint32_t Iterations = 1 << 20;
+		char names[NameCount][32];
+		tStringId ids[NameCount];
+		tFlatMap<String, uint32_t, tStringHash, tStringEqualTo> stringMap;
+		tFlatMap<tStringId, uint32_t> idMap;
+		for (uint32_t i = 0; i < NameCount; ++i)
+		{
+			sprintf_s(names[i], "u_shaderProperty_%d", i);
+			ids[i] = tStringId(names[i]);
+			stringMap[names[i]] = i;
+			idMap[ids[i]] = i;
+		}
+
+		uint64_t acc = 0;
+		Profiling::sProfilingTimer timer;
+		timer.Start();
+		for (uint32_t i = 0; i < Iterations; ++i)
+		{
+			const char* name = names[(i * 7) % NameCount];
+			for (uint32_t j = 0; j < NameCount; ++j)
+			{
+				if (!strcmp(names[j], name))
+				{
+					acc += j;
+					break;
+				}
+			}
+		}
+		double linearMs = timer.Stop();
+
+		timer.Start();
+		for (uint32_t i = 0; i < Iterations; ++i)
+			acc += stringMap.find(names[(i * 7) % NameCount])->second;
+		double stringMapMs = timer.Stop();
+
+		timer.Start();
+		for (uint32_t i = 0; i < Iterations; ++i)
+			acc += idMap.find(tStringId::Find(names[(i * 7) % NameCount]))->second;
+		double findMs = timer.Stop();
+
+		timer.Start();
+		for (uint32_t i = 0; i < Iterations; ++i)
+			acc += idMap.find(ids[(i * 7) % NameCount])->second;
+		double idMapMs = timer.Stop();
+
+		timer.Start();
+		for (uint32_t i = 0; i < Iterations; ++i)
+			acc += idMap.find(STRING_ID("u_shaderProperty_3"))->second;
+		double literalMs = timer.Stop();
+
+		loginfo("****************** String id benchmark ******************\n");
+		logfinfo("Linear strcmp (%d names):	%6.2f ns\n", NameCount, linearMs * 1e6 / Iterations);
+		logfinfo("String map by const char*:	%6.2f ns\n", stringMapMs * 1e6 / Iterations);
+		logfinfo("tStringId::Find + id map:	%6.2f ns\n", findMs * 1e6 / Iterations);
+		logfinfo("STRING_ID literal + id map:	%6.2f ns\n", literalMs * 1e6 / Iterations);
+		logfinfo("Id map:				%6.2f ns [%llx]\n", idMapMs * 1e6 / Iterations, acc & 0xf);
+		loginfo("*********************************************************\n");
+	}
+
+	void ExecCommand_DumpStringIdStats(const char* command)
+	{
+		DumpStringIdStats();
+	}
+
+	void ExecCommand_BenchmarkStringIds(const char* command)
+	{
+		BenchmarkStringIds();
+	}
+
+	void InitStringIds()
+	{
+		AddConsoleCommand("c_stringidstats", &ExecCommand_DumpStringIdStats);
+		AddConsoleCommand("c_stringidbench", &ExecCommand_BenchmarkStringIds);
+	}
+}
@@ -0,0 +1,102 @@
+// header file for Mist project
+#pragma once
+
+#include <stdint.h>
+#include <type_traits>
+#include <functional>
+#include "Core/Hash.h"
+
+/**
+ * Interned strings. Each distinct string is stored once in a global table and referenced
+ * by a 32 bit id, so hot paths compare and hash ids instead of characters.
+ * Interning is thread safe (writers serialize on a mutex), reading the string or hash of an id
+ * and looking up already interned strings (tStringId::Find) don't take any lock.
+ * Ids are only valid in the current process, use GetHash() for a content hash stable between runs.
+ */
+
+// Interned id of a string literal. The hash is computed at compile time and the string is
+// interned once per call site, later calls only read a local static.
+#define STRING_ID(str) \
+	([]() -> const Mist::tStringId& \
+	{ \
+		static const Mist::tStringId __stringId(str, std::integral_constant<uint64_t, Mist::HashStringId(str)>::value); \
+		return __stringId; \
+	}())
+
+namespace Mist
+{
+	// FNV-1a 64. Usable in constant expressions.
+	constexpr uint64_t HashFnv1a64(const char* str)
+	{
+		uint64_t h = 0xcbf29ce484222325ull;
+		for (; *str; ++str)
+			h = (h ^ (uint8_t)*str) * 0x100000001b3ull;
+		return h;
+	}
+
+	// FNV-1a 64 with a final mix for the low bits. Usable in constant expressions.
+	constexpr uint64_t HashStringId(const char* str)
+	{
+		uint64_t h = HashFnv1a64(str);
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return h;
+	}
+
+	class tStringId
+	{
+	public:
+		static constexpr uint32_t InvalidId = 0;
+
+		tStringId() = default;
+		// interns str.
+		explicit tStringId(const char* str);
+		// interns str with a precomputed HashStringId(str).
+		tStringId(const char* str, uint64_t hash);
+
+		// id of an already interned string, invalid id if str was never interned. Lock free.
+		static tStringId Find(const char* str);
+		static tStringId Find(const char* str, uint64_t hash);
+
+		const char* CStr() const;
+		uint64_t GetHash() const;
+		uint32_t GetLength() const;
+		inline uint32_t GetId() const { return m_id; }
+		inline bool IsValid() const { return m_id != InvalidId; }
+
+		inline bool operator==(const tStringId& other) const { return m_id == other.m_id; }
+		inline bool operator!=(const tStringId& other) const { return m_id != other.m_id; }
+
+	private:
+		uint32_t m_id = InvalidId;
+	};
+
+	struct tStringIdStats
+	{
+		uint32_t StringCount = 0;
+		// bytes used by string characters.
+		size_t StringBytes = 0;
+		uint32_t TableCapacity = 0;
+	};
+
+	tStringIdStats GetStringIdStats();
+	// registers console commands. Interning works before this call.
+	void InitStringIds();
+	// strcmp over a list of names vs String keyed map vs interned ids.
+	void BenchmarkStringIds();
+}
+
+namespace std
+{
+	template <>
+	struct hash<Mist::tStringId>
+	{
+		size_t operator()(const Mist::tStringId& id) const
+		{
+			return (size_t)Mist::HashInt(id.GetId());
+		}
+	};
+}
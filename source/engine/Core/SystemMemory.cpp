@@ -4,6 +4,10 @@
 #include "Core/Types.h"
 #include "Core/Debug.h"
 #include "Core/Console.h"
+#include "Core/PoolAllocator.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #define MEM_BLOCK_HEADER
 //#define MEM_BLOCK_HEADER_INTENSIVE_CHECK
@@ -18,7 +22,190 @@
 
 namespace Mist
 {
-	tSystemMemStats SystemMemStats;
+	/**
+	 * Allocation tracker.
+	 * Live allocations are stored in a sharded open addressing table keyed by address, so
+	 * add/remove are O(1) and only lock the shard owning the address. File and line of each
+	 * allocation are interned once in a call site table that is lock free to read.
+	 */
+	namespace memtrace
+	{
+		static constexpr uint32_t ShardCount = 64;
+		static constexpr uint32_t ShardMinCapacity = 1 << 10;
+		static constexpr uint32_t CallSiteTableSize = tSystemMemStats::CallSiteSize * 2;
+
+		struct tAllocShard
+		{
+			std::mutex Mutex;
+			tSystemAllocTrace* Slots = nullptr;
+			uint32_t Capacity = 0;
+			uint32_t Count = 0;
+		};
+
+		tAllocShard Shards[ShardCount];
+
+		std::atomic<size_t> Allocated = 0;
+		std::atomic<size_t> MaxAllocated = 0;
+		std::atomic<size_t> AllocationCount = 0;
+		std::atomic<size_t> TotalAllocationCount = 0;
+
+		// Call site 0 is reserved for allocations done once the call site table is full.
+		tSystemAllocCallSite CallSites[tSystemMemStats::CallSiteSize] = { {"<call site table overflow>", 0} };
+		std::atomic<uint32_t> CallSiteTable[CallSiteTableSize];
+		std::atomic<uint32_t> CallSiteCount = 1;
+		std::mutex CallSiteMutex;
+
+		inline size_t HashAddress(const void* p)
+		{
+			// blocks are at least 8 bytes aligned, discard low bits before mixing.
+			uint64_t h = ((uint64_t)(size_t)p >> 3) * 0x9E3779B97F4A7C15ull;
+			return (size_t)(h ^ (h >> 32));
+		}
+
+		inline tAllocShard& GetShard(size_t hash) { return Shards[(hash >> 24) & (ShardCount - 1)]; }
+
+		inline uint32_t HashCallSite(const char* file, uint32_t line)
+		{
+			uint64_t h = ((uint64_t)(size_t)file ^ ((uint64_t)line << 40)) * 0x9E3779B97F4A7C15ull;
+			return (uint32_t)(h >> 32);
+		}
+
+		uint32_t FindCallSite(const char* file, uint32_t line, uint32_t& slot)
+		{
+			for (slot = HashCallSite(file, line) & (CallSiteTableSize - 1); ; slot = (slot + 1) & (CallSiteTableSize - 1))
+			{
+				uint32_t index = CallSiteTable[slot].load(std::memory_order_acquire);
+				if (!index)
+					return 0;
+				const tSystemAllocCallSite& site = CallSites[index];
+				if (site.File == file && site.Line == line)
+					return index;
+			}
+		}
+
+		uint32_t InternCallSite(const char* file, uint32_t line)
+		{
+			uint32_t slot;
+			if (uint32_t index = FindCallSite(file, line, slot))
+				return index;
+			std::lock_guard<std::mutex> lock(CallSiteMutex);
+			// other thread could have inserted it before taking the lock.
+			if (uint32_t index = FindCallSite(file, line, slot))
+				return index;
+			uint32_t index = CallSiteCount.load(std::memory_order_relaxed);
+			if (index >= tSystemMemStats::CallSiteSize)
+				return 0;
+			CallSites[index].File = file;
+			CallSites[index].Line = line;
+			CallSiteCount.store(index + 1, std::memory_order_relaxed);
+			CallSiteTable[slot].store(index, std::memory_order_release);
+			return index;
+		}
+
+		void InsertSlot(tSystemAllocTrace* slots, uint32_t capacity, const tSystemAllocTrace& trace)
+		{
+			uint32_t mask = capacity - 1;
+			for (uint32_t i = (uint32_t)HashAddress(trace.Data) & mask; ; i = (i + 1) & mask)
+			{
+				if (!slots[i].Data)
+				{
+					slots[i] = trace;
+					return;
+				}
+			}
+		}
+
+		void GrowShard(tAllocShard& shard)
+		{
+			uint32_t capacity = shard.Capacity ? shard.Capacity * 2 : ShardMinCapacity;
+			tSystemAllocTrace* slots = (tSystemAllocTrace*)calloc(capacity, sizeof(tSystemAllocTrace));
+			check(slots);
+			for (uint32_t i = 0; i < shard.Capacity; ++i)
+			{
+				if (shard.Slots[i].Data)
+					InsertSlot(slots, capacity, shard.Slots[i]);
+			}
+			free(shard.Slots);
+			shard.Slots = slots;
+			shard.Capacity = capacity;
+		}
+
+		void Add(const void* p, size_t size, const char* file, uint32_t line)
+		{
+			tSystemAllocTrace trace;
+			trace.Data = p;
+			trace.Size = size;
+			trace.CallSite = InternCallSite(file, line);
+
+			tAllocShard& shard = GetShard(HashAddress(p));
+			{
+				std::lock_guard<std::mutex> lock(shard.Mutex);
+				// keep load factor under 3/4
+				if ((shard.Count + 1) * 4 > shard.Capacity * 3)
+					GrowShard(shard);
+				InsertSlot(shard.Slots, shard.Capacity, trace);
+				++shard.Count;
+			}
+
+			++AllocationCount;
+			++TotalAllocationCount;
+			size_t allocated = Allocated.fetch_add(size) + size;
+			size_t maxAllocated = MaxAllocated.load(std::memory_order_relaxed);
+			while (allocated > maxAllocated && !MaxAllocated.compare_exchange_weak(maxAllocated, allocated));
+		}
+
+		bool Remove(const void* p)
+		{
+			if (!p)
+				return false;
+			size_t hash = HashAddress(p);
+			tAllocShard& shard = GetShard(hash);
+			size_t size = 0;
+			{
+				std::lock_guard<std::mutex> lock(shard.Mutex);
+				if (!shard.Count)
+					return false;
+				uint32_t mask = shard.Capacity - 1;
+				uint32_t i = (uint32_t)hash & mask;
+				for (; shard.Slots[i].Data != p; i = (i + 1) & mask)
+				{
+					if (!shard.Slots[i].Data)
+						return false;
+				}
+				size = shard.Slots[i].Size;
+				// backward shift deletion, keeps probe sequences valid without tombstones.
+				for (uint32_t j = (i + 1) & mask; shard.Slots[j].Data; j = (j + 1) & mask)
+				{
+					uint32_t home = (uint32_t)HashAddress(shard.Slots[j].Data) & mask;
+					if (((j - home) & mask) >= ((j - i) & mask))
+					{
+						shard.Slots[i] = shard.Slots[j];
+						i = j;
+					}
+				}
+				shard.Slots[i] = tSystemAllocTrace();
+				--shard.Count;
+			}
+			check(Allocated.load() >= size);
+			Allocated -= size;
+			--AllocationCount;
+			return true;
+		}
+
+		template <typename Fn>
+		void ForEach(Fn&& fn)
+		{
+			for (uint32_t s = 0; s < ShardCount; ++s)
+			{
+				std::lock_guard<std::mutex> lock(Shards[s].Mutex);
+				for (uint32_t i = 0; i < Shards[s].Capacity; ++i)
+				{
+					if (Shards[s].Slots[i].Data)
+						fn(Shards[s].Slots[i]);
+				}
+			}
+		}
+	}
 
     struct BlockHeader
     {
@@ -51,115 +238,131 @@ namespace Mist
 		check(b->id == GetBlockHeaderId(b));
 	}
 
-    void IntegrityCheck(tSystemMemStats& stats)
+	// blocks not given by Malloc, without header. Out of line: inlined in a caller that frees a block
+	// from Malloc, gcc would see this free with the data pointer past the header (-Wfree-nonheap-object).
+	MIST_NOINLINE void FreeUntracked(void* p)
+	{
+		free(p);
+	}
+
+    void SysMem_IntegrityCheck()
     {
 #if defined(MEM_BLOCK_HEADER) && defined(MEM_TRACE_ON)
-        for (uint32_t i = 0; i < stats.MemTraceIndex; ++i)
-        {
-            const void* d = stats.MemTraceArray[i].Data;
-            if (!d)
-                continue;
-            const BlockHeader* b = GetBlockHeader(d);
-            check(BlockHeaderCheck(b));
-        }
+		memtrace::ForEach([](const tSystemAllocTrace& trace)
+			{
+				check(BlockHeaderCheck(GetBlockHeader(trace.Data)));
+			});
 #endif
     }
-    void SysMem_IntegrityCheck() { IntegrityCheck(SystemMemStats); }
-
 
-	void AddMemTrace(tSystemMemStats& stats, const void* p, size_t size, const char* file, uint32_t line)
+	void AddMemTrace(const void* p, size_t size, const char* file, uint32_t line)
 	{
 #ifdef MEM_TRACE_ON
 		check(p && size && file);
-		tSystemAllocTrace* trace = nullptr;
-		if (stats.FreeIndicesIndex)
-		{
-			unsigned int i = stats.FreeIndicesArray[stats.FreeIndicesIndex - 1];
-			stats.FreeIndicesArray[stats.FreeIndicesIndex - 1] = UINT32_MAX;
-			--stats.FreeIndicesIndex;
-			trace = &stats.MemTraceArray[i];
-		}
-		else
-		{
-			//check(stats.MemTraceIndex < stats.MemTraceSize);
-			if (stats.MemTraceIndex < stats.MemTraceSize)
-				trace = &stats.MemTraceArray[stats.MemTraceIndex++];
-			if (stats.MemTraceIndex > stats.MemTraceSize * 3 / 4)
-				logfwarn("MemTraceIndex close to overflow: %d/%d\n", stats.MemTraceIndex, stats.MemTraceSize);
-		}
-		//check(trace);
-		if (!trace) return;
-		trace->Data = p;
-		trace->Size = size;
-		trace->Line = line;
-		strcpy_s(trace->File, file);
-		stats.Allocated += size;
-		stats.MaxAllocated = __max(stats.Allocated, stats.MaxAllocated);
+		memtrace::Add(p, size, file, line);
 #endif // MEM_TRACE_ON
 	}
 
-	bool RemoveMemTrace(tSystemMemStats& stats, const void* p)
+	bool RemoveMemTrace(const void* p)
 	{
 #ifdef MEM_TRACE_ON
-		for (uint32_t i = 0; i < stats.MemTraceIndex; ++i)
-		{
-			if (stats.MemTraceArray[i].Data == p)
-			{
-				check(stats.Allocated - stats.MemTraceArray[i].Size < stats.Allocated);
-				check(stats.FreeIndicesIndex < stats.MemTraceSize);
-
-				stats.FreeIndicesArray[stats.FreeIndicesIndex++] = i;
-				stats.Allocated -= stats.MemTraceArray[i].Size;
-				stats.MemTraceArray[i].Data = nullptr;
-				stats.MemTraceArray[i].Size = 0;
-				stats.MemTraceArray[i].Line = 0;
-				*stats.MemTraceArray[i].File = 0;
-				return true;
-			}
-		}
-#endif // MEM_TRACE_ON
-
+		return memtrace::Remove(p);
+#else
 		return false;
+#endif // MEM_TRACE_ON
 	}
 
-	void DumpMemoryTrace(const tSystemMemStats& memStats)
+	void DumpMemoryTrace()
 	{
+		tSystemMemStats memStats = GetMemoryStats();
 		logfinfo("Allocated: %9lld bytes | MaxAllocated: %9lld bytes\n", memStats.Allocated, memStats.MaxAllocated);
-		for (uint32_t i = 0; i < memStats.MemTraceSize; ++i)
+		// gather first, logging while a shard is locked could allocate and deadlock.
+		tSystemAllocTrace* traces = (tSystemAllocTrace*)malloc(sizeof(tSystemAllocTrace) * (memStats.AllocationCount + 1024));
+		check(traces);
+		size_t count = 0;
+		size_t maxCount = memStats.AllocationCount + 1024;
+		memtrace::ForEach([&](const tSystemAllocTrace& trace)
+			{
+				if (count < maxCount)
+					traces[count++] = trace;
+			});
+		for (size_t i = 0; i < count; ++i)
 		{
-			if (memStats.MemTraceArray[i].Data)
-				logfinfo("[%4d] 0x%p | %9lld bytes | %256s (%5d)\n", i, 
-					memStats.MemTraceArray[i].Data, 
-					memStats.MemTraceArray[i].Size, 
-					memStats.MemTraceArray[i].File, 
-					memStats.MemTraceArray[i].Line);
+			const tSystemAllocCallSite& site = memtrace::CallSites[traces[i].CallSite];
+			logfinfo("[%4lld] 0x%p | %9lld bytes | %256s (%5d)\n", i, traces[i].Data, traces[i].Size, site.File, site.Line);
 		}
+		free(traces);
 	}
 
-	void DumpStats(const tSystemMemStats& memStats)
-	{
-		logfinfo("Num allocations %6d/%6d | Num free indices %6d | Bytes allocated %10d | Max bytes allocated %d\n",
-			memStats.MemTraceIndex, memStats.MemTraceSize, memStats.FreeIndicesIndex, memStats.Allocated, memStats.MaxAllocated);
-	}
-
-	void DumpMemoryStats(const tSystemMemStats& memStats)
+	void DumpMemoryStats()
 	{
+		tSystemMemStats memStats = GetMemoryStats();
 		loginfo("****************** Host memory stats ******************\n");
 		logfinfo("Current bytes allocated:		%8lld bytes\n", memStats.Allocated);
 		logfinfo("    Max bytes allocated:		%8lld bytes\n", memStats.MaxAllocated);
-		logfinfo("Memory trace registered:		%8d/%8d\n", memStats.MemTraceIndex, memStats.MemTraceSize);
-		logfinfo("Free indices availables:		%8d\n", memStats.FreeIndicesIndex);
+		logfinfo("      Live allocations:		%8lld\n", memStats.AllocationCount);
+		logfinfo("     Total allocations:		%8lld\n", memStats.TotalAllocationCount);
+		logfinfo("   Pool bytes allocated:		%8lld/%8lld bytes\n", memStats.PoolAllocated, memStats.PoolCapacity);
+		logfinfo("      Live pool objects:		%8lld\n", memStats.PoolObjectCount);
+		logfinfo("Call sites registered:		%8d/%8d\n", memStats.CallSiteCount, tSystemMemStats::CallSiteSize);
 		loginfo("*******************************************************\n");
 	}
 
-	void DumpMemoryStats()
+	// Measures Malloc/Free cost with an increasing number of live allocations.
+	// Cost per operation should stay flat across rows.
+	void BenchmarkMemoryTrace()
 	{
-		DumpMemoryStats(SystemMemStats);
+		static constexpr uint32_t LiveCounts[] = { 1 << 10, 1 << 13, 1 << 16, 1 << 18 };
+		static constexpr uint32_t Iterations = 1 << 17;
+		const uint32_t threadCount = __max(std::thread::hardware_concurrency(), 1u);
+
+		loginfo("****************** Memory trace benchmark ******************\n");
+		for (uint32_t c = 0; c < CountOf(LiveCounts); ++c)
+		{
+			uint32_t liveCount = LiveCounts[c];
+			void** live = (void**)malloc(sizeof(void*) * liveCount);
+			check(live);
+			for (uint32_t i = 0; i < liveCount; ++i)
+				live[i] = _malloc(16 + (i & 127));
+
+			Profiling::sProfilingTimer timer;
+			timer.Start();
+			for (uint32_t i = 0; i < Iterations; ++i)
+				Free(_malloc(16 + (i & 127)));
+			double singleMs = timer.Stop();
+
+			std::thread* threads = (std::thread*)malloc(sizeof(std::thread) * threadCount);
+			check(threads);
+			timer.Start();
+			for (uint32_t t = 0; t < threadCount; ++t)
+			{
+				new(&threads[t]) std::thread([]()
+					{
+						for (uint32_t i = 0; i < Iterations; ++i)
+							Free(_malloc(16 + (i & 127)));
+					});
+			}
+			for (uint32_t t = 0; t < threadCount; ++t)
+			{
+				threads[t].join();
+				threads[t].~thread();
+			}
+			double threadedMs = timer.Stop();
+			free(threads);
+
+			for (uint32_t i = 0; i < liveCount; ++i)
+				Free(live[i]);
+			free(live);
+
+			logfinfo("Live allocs %7d | 1 thread %7.2f ns/op | %2d threads %7.2f ns/op\n",
+				liveCount, singleMs * 1e6 / Iterations, threadCount, threadedMs * 1e6 / ((double)Iterations * threadCount));
+		}
+		loginfo("************************************************************\n");
 	}
 
 	void ExecCommand_DumpMemoryTrace(const char* command)
 	{
-		DumpMemoryTrace(SystemMemStats);
+		DumpMemoryTrace();
 	}
 
 	void ExecCommand_DumpMemoryStats(const char* command)
@@ -167,37 +370,45 @@ namespace Mist
 		DumpMemoryStats();
 	}
 
+	void ExecCommand_BenchmarkMemoryTrace(const char* command)
+	{
+		BenchmarkMemoryTrace();
+	}
+
 	void InitSytemMemory()
 	{
-		SystemMemStats.MemTraceArray = new tSystemAllocTrace[tSystemMemStats::MemTraceSize];
-		SystemMemStats.FreeIndicesArray = new unsigned int[tSystemMemStats::MemTraceSize];
-		SystemMemStats.MemTraceIndex = 0;
-		SystemMemStats.FreeIndicesIndex = 0;
 		AddConsoleCommand("c_memorydump", &ExecCommand_DumpMemoryTrace);
 		AddConsoleCommand("c_memorystats", &ExecCommand_DumpMemoryStats);
+		AddConsoleCommand("c_memorybench", &ExecCommand_BenchmarkMemoryTrace);
+		InitPoolAllocator();
 	}
 
 	void TerminateSystemMemory()
 	{
-		DumpMemoryTrace(SystemMemStats);
-		//assert(SystemMemStats.Allocated == 0);
-		SystemMemStats.MemTraceIndex = 0;
-		delete[] SystemMemStats.MemTraceArray;
-		SystemMemStats.MemTraceArray = nullptr;
-		SystemMemStats.FreeIndicesIndex = 0;
-		delete[] SystemMemStats.FreeIndicesArray;
-		SystemMemStats.FreeIndicesArray = nullptr;
+		TerminatePoolAllocator();
+		DumpMemoryTrace();
+		// Trace tables are not released: static destructors can still free tracked blocks after this point.
 	}
 
-	const tSystemMemStats& GetMemoryStats()
+	tSystemMemStats GetMemoryStats()
 	{
-		return SystemMemStats;
+		tSystemMemStats stats;
+		stats.Allocated = memtrace::Allocated.load();
+		stats.MaxAllocated = memtrace::MaxAllocated.load();
+		stats.AllocationCount = memtrace::AllocationCount.load();
+		stats.TotalAllocationCount = memtrace::TotalAllocationCount.load();
+		stats.CallSiteCount = memtrace::CallSiteCount.load();
+		tPoolStats poolStats = GetPoolStats();
+		stats.PoolAllocated = poolStats.Allocated;
+		stats.PoolCapacity = poolStats.Capacity;
+		stats.PoolObjectCount = poolStats.ObjectCount;
+		return stats;
 	}
 
 	void* Malloc(size_t size, const char* file, int line)
 	{
 #ifdef MEM_BLOCK_HEADER_INTENSIVE_CHECK
-		IntegrityCheck(SystemMemStats);
+		SysMem_IntegrityCheck();
 #endif // MEM_BLOCK_HEADER_INTENSIVE_CHECK
 
 #if defined(MEM_BLOCK_HEADER) && defined(MEM_TRACE_ON)
@@ -209,7 +420,7 @@ namespace Mist
 		void* ret = malloc(size);
 		check(ret);
 #endif // MEM_BLOCK_HEADER && MEM_TRACE_ON
-		AddMemTrace(SystemMemStats, ret, size, file, line);
+		AddMemTrace(ret, size, file, line);
 		return ret;
 	}
 
@@ -218,12 +429,12 @@ namespace Mist
 		if (!p)
 			return Malloc(size, file, line);
 #ifdef MEM_BLOCK_HEADER_INTENSIVE_CHECK
-		IntegrityCheck(SystemMemStats);
+		SysMem_IntegrityCheck();
 #endif // MEM_BLOCK_HEADER_INTENSIVE_CHECK
 		check(p);
 #if defined(MEM_BLOCK_HEADER) && defined(MEM_TRACE_ON)
 		void* r = nullptr;
-		if (RemoveMemTrace(SystemMemStats, p))
+		if (RemoveMemTrace(p))
 		{
 			void* b = GetBlockHeader(p);
 			void* q = realloc(b, size + sizeof(BlockHeader));
@@ -233,34 +444,34 @@ namespace Mist
 		else
 			r = realloc(p, size);
 		check(size < UINT32_MAX);
-		AddMemTrace(SystemMemStats, r, size, file, line);
+		AddMemTrace(r, size, file, line);
 		check(r);
 		return r;
 #else
-		RemoveMemTrace(SystemMemStats, p);
+		RemoveMemTrace(p);
 		void* q = realloc(p, size);
 		check(q);
-		AddMemTrace(SystemMemStats, p, size, file, line);
+		AddMemTrace(q, size, file, line);
 		return q;
 #endif // MEM_BLOCK_HEADER
 	}
 
-	void Mist::Free(void* p)
+	void Free(void* p)
 	{
 #ifdef MEM_BLOCK_HEADER_INTENSIVE_CHECK
-		IntegrityCheck(SystemMemStats);
+		SysMem_IntegrityCheck();
 #endif // MEM_BLOCK_HEADER_INTENSIVE_CHECK
 #if defined(MEM_BLOCK_HEADER) && defined(MEM_TRACE_ON)
-		if (RemoveMemTrace(SystemMemStats, p))
+		if (RemoveMemTrace(p))
 		{
 			check(BlockHeaderCheck(GetBlockHeader(p)));
 			void* b = GetBlockHeader(p);
 			free(b);
 		}
 		else
-			free(p);
+			FreeUntracked(p);
 #else
-		RemoveMemTrace(SystemMemStats, p);
+		RemoveMemTrace(p);
 		free(p);
 #endif // MEM_BLOCK_HEADER
 	}
@@ -272,6 +483,11 @@ void* operator new(size_t size, const char* file, int line)
 	return Mist::Malloc(size, file, line);
 }
 
+void* operator new[](size_t size, const char* file, int line)
+{
+	return Mist::Malloc(size, file, line);
+}
+
 void operator delete(void* p)
 {
 	Mist::Free(p);
@@ -2,42 +2,63 @@
 #pragma once
 
 #include <cassert>
+#include <stddef.h>
 #include <forward_list>
 
 [[nodiscard]] void* operator new(size_t size, const char* file, int line);
+[[nodiscard]] void* operator new[](size_t size, const char* file, int line);
 void operator delete(void* p);
 void operator delete[](void* p);
 void operator delete(void* p, const char* file, int lin);
 void operator delete[](void* p, const char* file, int lin);
 
-#define _new ::new(__FILE__ " " __FUNCTION__, __LINE__)
+// allocation site tag. __FUNCTION__ is only a string literal in msvc.
+#if defined(_MSC_VER)
+#define MIST_ALLOC_LOCATION __FILE__ " " __FUNCTION__
+#else
+#define MIST_ALLOC_LOCATION __FILE__
+#endif
+
+#define _new ::new(MIST_ALLOC_LOCATION, __LINE__)
 #define _malloc(size) Mist::Malloc(size, __FILE__, __LINE__)
 #define _realloc(_p, _size) Mist::Realloc(_p, _size, __FILE__, __LINE__)
 
 namespace Mist
 {
+	struct tSystemAllocCallSite
+	{
+		const char* File = nullptr;
+		unsigned int Line = 0;
+	};
+
 	struct tSystemAllocTrace
 	{
 		const void* Data = nullptr;
 		size_t Size = 0;
-		unsigned int Line = 0;
-		char File[512];
+		unsigned int CallSite = 0;
 	};
 
 	struct tSystemMemStats
 	{
 		size_t Allocated = 0;
 		size_t MaxAllocated = 0;
-		static constexpr size_t MemTraceSize = 1<<16;
-		tSystemAllocTrace* MemTraceArray = nullptr;
-		unsigned int MemTraceIndex = 0;
-		unsigned int* FreeIndicesArray = nullptr;
-		unsigned int FreeIndicesIndex = 0;
+		size_t AllocationCount = 0;
+		// monotonic, never decremented. Diff two snapshots to count allocations done in between.
+		size_t TotalAllocationCount = 0;
+		// small objects served by the pool allocator. Pool chunks are accounted in Allocated too.
+		size_t PoolAllocated = 0;
+		size_t PoolCapacity = 0;
+		size_t PoolObjectCount = 0;
+		static constexpr size_t CallSiteSize = 1 << 13;
+		unsigned int CallSiteCount = 0;
 	};
 
 	void InitSytemMemory();
 	void TerminateSystemMemory();
-	const tSystemMemStats& GetMemoryStats();
+	// Malloc/Free cost with an increasing number of live allocations.
+	void BenchmarkMemoryTrace();
+	// returns a snapshot of the tracker counters. Safe to call from any thread.
+	tSystemMemStats GetMemoryStats();
 	void SysMem_IntegrityCheck();
 	void DumpMemoryStats();
 
@@ -58,7 +79,7 @@ namespace Mist
 
 		[[nodiscard]] T* allocate(size_t size)
 		{
-			T* ptr = static_cast<T*>(::Mist::Malloc(size * sizeof(T), __FILE__ " " __FUNCTION__, __LINE__));
+			T* ptr = static_cast<T*>(::Mist::Malloc(size * sizeof(T), MIST_ALLOC_LOCATION, __LINE__));
 			assert(ptr);
 			return ptr;
 		}
@@ -86,7 +107,7 @@ namespace Mist
 	public:
 		static void* allocate(size_t size)
 		{
-			void* ptr = ::Mist::Malloc(size, __FILE__ " " __FUNCTION__, __LINE__);
+			void* ptr = ::Mist::Malloc(size, MIST_ALLOC_LOCATION, __LINE__);
 			assert(ptr);
 			return ptr;
 		}
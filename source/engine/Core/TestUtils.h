@@ -0,0 +1,42 @@
+// header file for Mist project
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include "Core/Logger.h"
+
+/**
+ * Scaffold shared by the Test* console commands of the engine modules.
+ */
+
+namespace Mist
+{
+	// logs one case of a test as "<test> test <name> OK/FAILED" and returns its result.
+	inline bool TestResult(bool result, const char* test, const char* name)
+	{
+		char label[128];
+		snprintf(label, sizeof(label), "%s test %s", test, name);
+		if (result)
+			logfinfo("%-48s OK\n", label);
+		else
+			logferror("%-48s FAILED\n", label);
+		return result;
+	}
+
+	// xorshift64*, fixed seed so every run generates the same data and a failure repeats.
+	struct tRandom
+	{
+		uint64_t State = 0x9e3779b97f4a7c15ull;
+
+		uint32_t Next()
+		{
+			State ^= State >> 12;
+			State ^= State << 25;
+			State ^= State >> 27;
+			return (uint32_t)((State * 0x2545f4914f6cdd1dull) >> 32);
+		}
+
+		uint32_t Range(uint32_t count) { return count ? Next() % count : 0; }
+		float Range(float min, float max) { return min + (max - min) * (float)(Next() >> 8) * (1.f / 16777216.f); }
+	};
+}
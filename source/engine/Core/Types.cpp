@@ -1,4 +1,6 @@
 #include "Types.h"
+#include "Core/Logger.h"
+#include "Core/Console.h"
 #include "glm/glm.hpp"
 
 namespace Mist
@@ -84,4 +86,172 @@ namespace Mist
 			++wild;
 		return !*wild;
 	}
-}
\ No newline at end of file
+
+	void tNameIndex::Insert(uint64_t hash, uint32_t item)
+	{
+		check(item != InvalidItem);
+		// keep load factor under 1/2
+		if ((m_count + 1) * 2 > (uint32_t)m_slots.size())
+			Grow();
+		uint32_t mask = (uint32_t)m_slots.size() - 1;
+		uint32_t i = (uint32_t)hash & mask;
+		while (m_slots[i].Item != InvalidItem)
+			i = (i + 1) & mask;
+		m_slots[i].Hash = hash;
+		m_slots[i].Item = item;
+		++m_count;
+	}
+
+	uint32_t tNameIndex::FindSlot(uint64_t hash, uint32_t item) const
+	{
+		check(!m_slots.empty());
+		uint32_t mask = (uint32_t)m_slots.size() - 1;
+		for (uint32_t i = (uint32_t)hash & mask; m_slots[i].Item != InvalidItem; i = (i + 1) & mask)
+		{
+			if (m_slots[i].Item == item)
+				return i;
+		}
+		return InvalidItem;
+	}
+
+	void tNameIndex::Remove(uint64_t hash, uint32_t item)
+	{
+		uint32_t i = FindSlot(hash, item);
+		check(i != InvalidItem);
+		uint32_t mask = (uint32_t)m_slots.size() - 1;
+		// backward shift deletion
+		for (uint32_t j = (i + 1) & mask; m_slots[j].Item != InvalidItem; j = (j + 1) & mask)
+		{
+			uint32_t home = (uint32_t)m_slots[j].Hash & mask;
+			if (((j - home) & mask) >= ((j - i) & mask))
+			{
+				m_slots[i] = m_slots[j];
+				i = j;
+			}
+		}
+		m_slots[i] = tSlot();
+		--m_count;
+	}
+
+	void tNameIndex::Replace(uint64_t hash, uint32_t oldItem, uint32_t newItem)
+	{
+		uint32_t i = FindSlot(hash, oldItem);
+		check(i != InvalidItem && newItem != InvalidItem);
+		m_slots[i].Item = newItem;
+	}
+
+	void tNameIndex::Grow()
+	{
+		tDynArray<tSlot> slots(std::move(m_slots));
+		m_slots.clear();
+		m_slots.resize(slots.empty() ? 64 : slots.size() * 2);
+		m_count = 0;
+		for (const tSlot& slot : slots)
+		{
+			if (slot.Item != InvalidItem)
+				Insert(slot.Hash, slot.Item);
+		}
+	}
+
+	namespace flatmap_bench
+	{
+		template <typename Map_t, typename Key_t, typename LookupKey_t>
+		void Run(const char* label, const Key_t* keys, const LookupKey_t* lookups, const LookupKey_t* misses, uint32_t count)
+		{
+			static constexpr uint32_t Rounds = 8;
+			double insertMs = 0.0;
+			double findMs = 0.0;
+			double missMs = 0.0;
+			double iterateMs = 0.0;
+			double eraseMs = 0.0;
+			uint64_t acc = 0;
+			Profiling::sProfilingTimer timer;
+			for (uint32_t r = 0; r < Rounds; ++r)
+			{
+				Map_t map;
+				timer.Start();
+				for (uint32_t i = 0; i < count; ++i)
+					map[keys[i]] = i;
+				insertMs += timer.Stop();
+
+				timer.Start();
+				for (uint32_t j = 0; j < 4; ++j)
+				{
+					for (uint32_t i = 0; i < count; ++i)
+					{
+						auto it = map.find(lookups[(i * 7919) % count]);
+						acc += it != map.end() ? it->second : 0;
+					}
+				}
+				findMs += timer.Stop();
+
+				timer.Start();
+				for (uint32_t i = 0; i < count; ++i)
+					acc += map.find(misses[i]) != map.end();
+				missMs += timer.Stop();
+
+				timer.Start();
+				for (const auto& it : map)
+					acc += it.second;
+				iterateMs += timer.Stop();
+
+				timer.Start();
+				for (uint32_t i = 0; i < count; i += 2)
+					acc += map.erase(keys[i]);
+				eraseMs += timer.Stop();
+			}
+			double n = (double)count * Rounds;
+			logfinfo("%-28s | %6d keys | insert %6.2f ns | find %6.2f ns | miss %6.2f ns | iterate %5.2f ns | erase %6.2f ns [%llx]\n",
+				label, count, insertMs * 1e6 / n, findMs * 1e6 / (n * 4.0), missMs * 1e6 / n, iterateMs * 1e6 / n,
+				eraseMs * 1e6 / (n * 0.5), acc & 0xf);
+		}
+	}
+
+	void BenchmarkFlatMap()
+	{
+		static constexpr uint32_t Counts[] = { 64, 1024, 1 << 16 };
+		static constexpr uint32_t MaxCount = 1 << 16;
+		loginfo("****************** Map benchmark ******************\n");
+
+		uint32_t* intKeys = (uint32_t*)malloc(sizeof(uint32_t) * MaxCount * 2);
+		check(intKeys);
+		uint32_t seed = 0x2545f491;
+		for (uint32_t i = 0; i < MaxCount * 2; ++i)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			intKeys[i] = (seed & ~1u) | (i >= MaxCount ? 1 : 0);
+		}
+		// String keys are looked up by const char* as in ShaderMemoryContext and TextureCache.
+		tDynArray<String> strKeys(MaxCount * 2);
+		tDynArray<const char*> strLookups(MaxCount * 2);
+		char buff[64];
+		for (uint32_t i = 0; i < MaxCount * 2; ++i)
+		{
+			sprintf_s(buff, "u_material_%c_%d", i >= MaxCount ? 'm' : 'h', i);
+			strKeys[i] = buff;
+		}
+		for (uint32_t i = 0; i < MaxCount * 2; ++i)
+			strLookups[i] = strKeys[i].c_str();
+
+		for (uint32_t c = 0; c < CountOf(Counts); ++c)
+		{
+			uint32_t count = Counts[c];
+			flatmap_bench::Run<tMap<uint32_t, uint32_t>>("tMap<uint32_t>", intKeys, intKeys, intKeys + MaxCount, count);
+			flatmap_bench::Run<tFlatMap<uint32_t, uint32_t>>("tFlatMap<uint32_t>", intKeys, intKeys, intKeys + MaxCount, count);
+			flatmap_bench::Run<tMap<String, uint32_t>>("tMap<String> (const char*)", strKeys.data(), strLookups.data(), strLookups.data() + MaxCount, count);
+			flatmap_bench::Run<tFlatMap<String, uint32_t, tStringHash, tStringEqualTo>>("tFlatMap<String> (const char*)", strKeys.data(), strLookups.data(), strLookups.data() + MaxCount, count);
+		}
+		free(intKeys);
+		loginfo("***************************************************\n");
+	}
+
+	void ExecCommand_BenchmarkFlatMap(const char* command)
+	{
+		BenchmarkFlatMap();
+	}
+
+	void InitTypes()
+	{
+		AddConsoleCommand("c_mapbench", &ExecCommand_BenchmarkFlatMap);
+	}
+}
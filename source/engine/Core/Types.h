@@ -6,10 +6,17 @@
 #include <string.h>
 #include <vector>
 #include <unordered_map>
+#include <tuple>
+#include <utility>
+#include <type_traits>
 #include <string>
+#include <atomic>
+#if defined(_MSC_VER)
 #include <vcruntime_string.h>
+#endif
 #include "Core/SystemMemory.h"
 #include "Core/Debug.h"
+#include "Core/Hash.h"
 
 #include "codastring.h"
 
@@ -48,6 +55,7 @@ namespace Mist
 	typedef uint32_t lindex_t;
 
 	enum {index_invalid = UINT16_MAX};
+	inline constexpr lindex_t lindex_invalid = UINT32_MAX;
 
 	template <typename T, typename U>
 	T limits_cast(U v) { check(v>= std::numeric_limits<T>::min() && v <= std::numeric_limits<T>::max()); return static_cast<T>(v); }
@@ -67,8 +75,7 @@ namespace Mist
 	template <typename T>
 	inline void HashCombine(std::size_t& seed, const T& v)
 	{
-		std::hash<T> hasher;
-		seed ^= hasher(v) + 0x933779b9 + (seed << 6) + (seed >> 2);
+		seed = (std::size_t)HashMerge(seed, HashValue(v));
 	}
 
 	template <uint32_t Size>
@@ -382,7 +389,7 @@ namespace Mist
 		void Pop()
 		{
 			check(m_data && m_index);
-			m_data[m_index--].~DataType();
+			m_data[--m_index].~DataType();
 		}
 
 		void Resize(uint32_t count)
@@ -541,6 +548,448 @@ namespace Mist
 	bool WildStrcmp(const char* wild, const char* str);
 	bool WildStricmp(const char* wild, const char* str);
 
+	/**
+	 * Open addressing index from a precomputed name hash (HashCStr) to the position of an item stored
+	 * in an external array. Different names may share a hash, Find resolves them with the
+	 * equality callback.
+	 */
+	class tNameIndex
+	{
+	public:
+		static constexpr uint32_t InvalidItem = UINT32_MAX;
+
+		void Insert(uint64_t hash, uint32_t item);
+		void Remove(uint64_t hash, uint32_t item);
+		// changes the item stored for a given entry, for when items are moved in the external array.
+		void Replace(uint64_t hash, uint32_t oldItem, uint32_t newItem);
+		void Clear() { m_slots.clear(); m_count = 0; }
+		inline uint32_t GetCount() const { return m_count; }
+
+		template <typename EqualsFn>
+		uint32_t Find(uint64_t hash, EqualsFn&& equals) const
+		{
+			if (m_slots.empty())
+				return InvalidItem;
+			uint32_t mask = (uint32_t)m_slots.size() - 1;
+			for (uint32_t i = (uint32_t)hash & mask; m_slots[i].Item != InvalidItem; i = (i + 1) & mask)
+			{
+				if (m_slots[i].Hash == hash && equals(m_slots[i].Item))
+					return m_slots[i].Item;
+			}
+			return InvalidItem;
+		}
+
+	private:
+		struct tSlot
+		{
+			uint64_t Hash = 0;
+			uint32_t Item = InvalidItem;
+		};
+		uint32_t FindSlot(uint64_t hash, uint32_t item) const;
+		void Grow();
+
+		tDynArray<tSlot> m_slots;
+		uint32_t m_count = 0;
+	};
+
+	// Hash and equality for String keys that also accept const char*, so tFlatMap lookups
+	// by name don't build a temporary String.
+	struct tStringHash
+	{
+		size_t operator()(const String& str) const { return (size_t)HashCStr(str.c_str()); }
+		size_t operator()(const char* str) const { return (size_t)HashCStr(str); }
+	};
+
+	struct tStringEqualTo
+	{
+		bool operator()(const String& a, const String& b) const { return !strcmp(a.c_str(), b.c_str()); }
+		bool operator()(const String& a, const char* b) const { return !strcmp(a.c_str(), b); }
+	};
+
+	/**
+	 * Open addressing hash map with robin hood probing and backward shift erase.
+	 * Pairs are stored inline in a single slot array, with one byte per slot holding the probe
+	 * distance (0 means empty), so a lookup walks contiguous memory instead of chasing bucket nodes.
+	 * Usage is the same as tMap (find, operator[], at, contains, emplace, erase, iteration over pairs).
+	 * Note: unlike tMap, insert and erase move elements. Pointers, references and iterators to
+	 * elements are invalidated by any insertion or erase.
+	 * Lookups are templated over the key type, with a Hasher/EqualTo pair accepting other types
+	 * (like tStringHash/tStringEqualTo) find works with them without converting the key.
+	 */
+	template <typename Key_t, typename Value_t, typename Hasher_t = std::hash<Key_t>, typename EqualTo = std::equal_to<Key_t>, typename Alloc_t = tStdAllocator<uint8_t>>
+	class tFlatMap
+	{
+		typedef tFlatMap<Key_t, Value_t, Hasher_t, EqualTo, Alloc_t> ThisType;
+	public:
+		typedef Key_t key_type;
+		typedef Value_t mapped_type;
+		typedef std::pair<Key_t, Value_t> value_type;
+
+		static constexpr size_t MinCapacity = 8;
+		// robin hood keeps probe sequences short, a high load factor is fine.
+		static constexpr size_t MaxLoadNum = 7;
+		static constexpr size_t MaxLoadDen = 8;
+		// distance is stored in one byte, grow before any chain gets close to the limit.
+		static constexpr uint8_t MaxDistance = 128;
+
+		template <bool IsConst>
+		class tIterator
+		{
+			friend class tFlatMap;
+			typedef std::conditional_t<IsConst, const value_type, value_type> ElementType;
+		public:
+			tIterator() = default;
+			tIterator(const uint8_t* dist, ElementType* slot) : m_dist(dist), m_slot(slot) {}
+			// iterator to const_iterator conversion.
+			template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+			tIterator(const tIterator<OtherConst>& other) : m_dist(other.m_dist), m_slot(other.m_slot) {}
+
+			ElementType& operator*() const { return *m_slot; }
+			ElementType* operator->() const { return m_slot; }
+			tIterator& operator++()
+			{
+				// distance array ends with a non zero sentinel, no need to check end.
+				do { ++m_dist; ++m_slot; } while (!*m_dist);
+				return *this;
+			}
+			tIterator operator++(int) { tIterator it = *this; ++*this; return it; }
+			template <bool OtherConst>
+			bool operator==(const tIterator<OtherConst>& other) const { return m_slot == other.m_slot; }
+			template <bool OtherConst>
+			bool operator!=(const tIterator<OtherConst>& other) const { return m_slot != other.m_slot; }
+
+		private:
+			template <bool> friend class tIterator;
+			const uint8_t* m_dist = nullptr;
+			ElementType* m_slot = nullptr;
+		};
+		typedef tIterator<false> iterator;
+		typedef tIterator<true> const_iterator;
+
+		tFlatMap() = default;
+		explicit tFlatMap(const Alloc_t& alloc) : m_alloc(alloc) {}
+
+		tFlatMap(const ThisType& other) : m_alloc(other.m_alloc)
+		{
+			*this = other;
+		}
+
+		tFlatMap(ThisType&& other) noexcept : m_alloc(other.m_alloc)
+		{
+			Steal(other);
+		}
+
+		~tFlatMap()
+		{
+			Release();
+		}
+
+		ThisType& operator=(const ThisType& other)
+		{
+			if (this == &other)
+				return *this;
+			clear();
+			reserve(other.m_size);
+			for (const value_type& v : other)
+				InsertUnique(HashKey(v.first), value_type(v));
+			return *this;
+		}
+
+		ThisType& operator=(ThisType&& other) noexcept
+		{
+			if (this == &other)
+				return *this;
+			Release();
+			m_alloc = other.m_alloc;
+			Steal(other);
+			return *this;
+		}
+
+		iterator begin() { return m_size ? iterator(FirstElement()) : end(); }
+		iterator end() { return iterator(m_dist + m_capacity, m_slots + m_capacity); }
+		const_iterator begin() const { return const_cast<ThisType*>(this)->begin(); }
+		const_iterator end() const { return const_cast<ThisType*>(this)->end(); }
+		const_iterator cbegin() const { return begin(); }
+		const_iterator cend() const { return end(); }
+
+		size_t size() const { return m_size; }
+		bool empty() const { return !m_size; }
+		size_t capacity() const { return m_capacity; }
+		float load_factor() const { return m_capacity ? (float)m_size / (float)m_capacity : 0.f; }
+		float max_load_factor() const { return (float)MaxLoadNum / (float)MaxLoadDen; }
+
+		template <typename K>
+		iterator find(const K& key)
+		{
+			size_t index = FindIndex(key);
+			return index != InvalidIndex ? MakeIterator(index) : end();
+		}
+
+		template <typename K>
+		const_iterator find(const K& key) const { return const_cast<ThisType*>(this)->find(key); }
+
+		template <typename K>
+		bool contains(const K& key) const { return FindIndex(key) != InvalidIndex; }
+
+		template <typename K>
+		size_t count(const K& key) const { return contains(key) ? 1 : 0; }
+
+		template <typename K>
+		Value_t& at(const K& key)
+		{
+			size_t index = FindIndex(key);
+			check(index != InvalidIndex && "Key not found in map");
+			return m_slots[index].second;
+		}
+
+		template <typename K>
+		const Value_t& at(const K& key) const { return const_cast<ThisType*>(this)->at(key); }
+
+		Value_t& operator[](const Key_t& key) { return try_emplace(key).first->second; }
+		Value_t& operator[](Key_t&& key) { return try_emplace(std::move(key)).first->second; }
+
+		template <typename K, typename ...Args>
+		std::pair<iterator, bool> try_emplace(K&& key, Args&&... args)
+		{
+			size_t hash = HashKey(key);
+			size_t index = FindIndex(key, hash);
+			if (index != InvalidIndex)
+				return { MakeIterator(index), false };
+			if (NeedsGrow())
+				Rehash(m_capacity ? m_capacity * 2 : MinCapacity);
+			index = InsertUnique(hash, value_type(std::piecewise_construct,
+				std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...)));
+			return { MakeIterator(index), true };
+		}
+
+		std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+		std::pair<iterator, bool> insert(value_type&& value) { return try_emplace(std::move(value.first), std::move(value.second)); }
+
+		template <typename K, typename V>
+		std::pair<iterator, bool> emplace(K&& key, V&& value) { return try_emplace(std::forward<K>(key), std::forward<V>(value)); }
+
+		template <typename K, typename V>
+		std::pair<iterator, bool> insert_or_assign(K&& key, V&& value)
+		{
+			std::pair<iterator, bool> res = try_emplace(std::forward<K>(key));
+			res.first->second = std::forward<V>(value);
+			return res;
+		}
+
+		// returns number of erased elements (0 or 1).
+		template <typename K>
+		size_t erase(const K& key)
+		{
+			size_t index = FindIndex(key);
+			if (index == InvalidIndex)
+				return 0;
+			EraseIndex(index);
+			return 1;
+		}
+
+		// erase element pointed by the iterator. Elements after it may be shifted back, returns
+		// iterator to next element in the slot array.
+		iterator erase(const_iterator it)
+		{
+			size_t index = (size_t)(it.m_slot - m_slots);
+			check(index < m_capacity && m_dist[index]);
+			EraseIndex(index);
+			if (m_dist[index])
+				return MakeIterator(index);
+			return ++MakeIterator(index);
+		}
+
+		iterator erase(iterator it) { return erase(const_iterator(it)); }
+
+		void clear()
+		{
+			for (size_t i = 0; i < m_capacity; ++i)
+			{
+				if (m_dist[i])
+				{
+					m_slots[i].~value_type();
+					m_dist[i] = 0;
+				}
+			}
+			m_size = 0;
+		}
+
+		void reserve(size_t count)
+		{
+			size_t capacity = m_capacity ? m_capacity : MinCapacity;
+			while (count * MaxLoadDen > capacity * MaxLoadNum)
+				capacity *= 2;
+			if (capacity > m_capacity)
+				Rehash(capacity);
+		}
+
+	private:
+		static constexpr size_t InvalidIndex = SIZE_MAX;
+
+		template <typename K>
+		inline size_t HashKey(const K& key) const
+		{
+			// spread hash over the high bits, std::hash may be identity for integers.
+			return (size_t)((uint64_t)Hasher_t()(key) * 0x9e3779b97f4a7c15ull);
+		}
+
+		inline size_t HomeIndex(size_t hash) const { return (size_t)((uint64_t)hash >> m_shift); }
+		inline bool NeedsGrow() const { return (m_size + 1) * MaxLoadDen > m_capacity * MaxLoadNum || m_maxDistance >= MaxDistance; }
+		inline iterator MakeIterator(size_t index) { return iterator(m_dist + index, m_slots + index); }
+		iterator FirstElement()
+		{
+			size_t i = 0;
+			while (!m_dist[i])
+				++i;
+			return MakeIterator(i);
+		}
+
+		template <typename K>
+		size_t FindIndex(const K& key) const { return m_size ? FindIndex(key, HashKey(key)) : InvalidIndex; }
+
+		template <typename K>
+		size_t FindIndex(const K& key, size_t hash) const
+		{
+			if (!m_size)
+				return InvalidIndex;
+			size_t mask = m_capacity - 1;
+			size_t index = HomeIndex(hash);
+			// stop when current slot is closer to its home than we are to ours: key can't be further.
+			for (uint8_t dist = 1; dist <= m_dist[index]; ++dist)
+			{
+				if (m_dist[index] == dist && EqualTo()(m_slots[index].first, key))
+					return index;
+				index = (index + 1) & mask;
+			}
+			return InvalidIndex;
+		}
+
+		// key must not be in the map and there must be room for a new element. Returns final index of value.
+		size_t InsertUnique(size_t hash, value_type&& value)
+		{
+			size_t mask = m_capacity - 1;
+			size_t index = HomeIndex(hash);
+			size_t result = InvalidIndex;
+			uint8_t dist = 1;
+			value_type carried(std::move(value));
+			while (true)
+			{
+				if (!m_dist[index])
+				{
+					new(&m_slots[index]) value_type(std::move(carried));
+					m_dist[index] = dist;
+					m_maxDistance = __max(m_maxDistance, dist);
+					++m_size;
+					return result != InvalidIndex ? result : index;
+				}
+				if (m_dist[index] < dist)
+				{
+					// rich slot, take it and carry on with the displaced element.
+					std::swap(carried, m_slots[index]);
+					std::swap(dist, m_dist[index]);
+					m_maxDistance = __max(m_maxDistance, m_dist[index]);
+					if (result == InvalidIndex)
+						result = index;
+				}
+				check(dist < UINT8_MAX && "tFlatMap probe distance overflow, check hash function quality");
+				++dist;
+				index = (index + 1) & mask;
+			}
+		}
+
+		void EraseIndex(size_t index)
+		{
+			size_t mask = m_capacity - 1;
+			m_slots[index].~value_type();
+			size_t next = (index + 1) & mask;
+			while (m_dist[next] > 1)
+			{
+				new(&m_slots[index]) value_type(std::move(m_slots[next]));
+				m_slots[next].~value_type();
+				m_dist[index] = m_dist[next] - 1;
+				index = next;
+				next = (next + 1) & mask;
+			}
+			m_dist[index] = 0;
+			--m_size;
+		}
+
+		void Rehash(size_t capacity)
+		{
+			check(capacity && !(capacity & (capacity - 1)));
+			value_type* oldSlots = m_slots;
+			uint8_t* oldDist = m_dist;
+			size_t oldCapacity = m_capacity;
+
+			// single allocation: slots followed by distances plus sentinel.
+			uint8_t* data = m_alloc.allocate(capacity * sizeof(value_type) + capacity + 1);
+			m_slots = reinterpret_cast<value_type*>(data);
+			m_dist = data + capacity * sizeof(value_type);
+			memset(m_dist, 0, capacity);
+			m_dist[capacity] = 1;
+			m_capacity = capacity;
+			m_shift = 64;
+			for (size_t c = capacity; c > 1; c >>= 1)
+				--m_shift;
+			m_size = 0;
+			m_maxDistance = 0;
+
+			for (size_t i = 0; i < oldCapacity; ++i)
+			{
+				if (oldDist[i])
+				{
+					InsertUnique(HashKey(oldSlots[i].first), std::move(oldSlots[i]));
+					oldSlots[i].~value_type();
+				}
+			}
+			if (oldSlots)
+				m_alloc.deallocate(reinterpret_cast<uint8_t*>(oldSlots), oldCapacity * sizeof(value_type) + oldCapacity + 1);
+		}
+
+		void Release()
+		{
+			if (m_slots)
+			{
+				clear();
+				m_alloc.deallocate(reinterpret_cast<uint8_t*>(m_slots), m_capacity * sizeof(value_type) + m_capacity + 1);
+			}
+			m_slots = nullptr;
+			m_dist = nullptr;
+			m_capacity = 0;
+			m_size = 0;
+			m_shift = 64;
+			m_maxDistance = 0;
+		}
+
+		void Steal(ThisType& other)
+		{
+			m_slots = other.m_slots;
+			m_dist = other.m_dist;
+			m_capacity = other.m_capacity;
+			m_size = other.m_size;
+			m_shift = other.m_shift;
+			m_maxDistance = other.m_maxDistance;
+			other.m_slots = nullptr;
+			other.m_dist = nullptr;
+			other.m_capacity = 0;
+			other.m_size = 0;
+			other.m_shift = 64;
+			other.m_maxDistance = 0;
+		}
+
+		value_type* m_slots = nullptr;
+		uint8_t* m_dist = nullptr;
+		size_t m_capacity = 0;
+		size_t m_size = 0;
+		uint32_t m_shift = 64;
+		uint8_t m_maxDistance = 0;
+		Alloc_t m_alloc;
+	};
+
+	// tFlatMap vs tMap insert/find/erase/iterate timings.
+	void BenchmarkFlatMap();
+	void InitTypes();
+
 	template <typename Type>
 	inline void Swap(Type& t0, Type& t1)
 	{
@@ -665,13 +1114,21 @@ namespace Mist
 
 namespace std
 {
-	// temp
 	template <>
 	struct hash<Mist::String>
 	{
 		size_t operator()(const Mist::String& str) const
 		{
-			return std::hash<std::string>()(str.c_str());
+			return (size_t)Mist::HashCStr(str.c_str());
+		}
+	};
+
+	template <uint32_t Size>
+	struct hash<Mist::tFixedString<Size>>
+	{
+		size_t operator()(const Mist::tFixedString<Size>& str) const
+		{
+			return (size_t)Mist::HashCStr(str.CStr());
 		}
 	};
 }
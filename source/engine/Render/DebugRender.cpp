@@ -294,7 +294,7 @@ namespace Mist
 				g_render->SetIndexBuffer(nullptr);
 				g_render->SetPrimitive(render::PrimitiveType_LineList);
 				g_render->SetDepthEnable(false, false);
-				g_render->SetShaderProperty("camera", &cameraData, sizeof(cameraData));
+				g_render->SetShaderProperty(STRING_ID("camera"), &cameraData, sizeof(cameraData));
 				g_render->Draw(DebugRenderPipeline.LineBatch.LineArray.GetSize());
 				g_render->SetDefaultGraphicsState();
 				DebugRenderPipeline.LineBatch.Reset();
@@ -308,8 +308,8 @@ namespace Mist
 				g_render->SetVertexBuffer(DebugRenderPipeline.QuadBatch.vertexBuffer);
 				g_render->SetPrimitive(render::PrimitiveType_TriangleList);
 				g_render->SetIndexBuffer(DebugRenderPipeline.QuadBatch.indexBuffer);
-				g_render->SetShaderProperty("u_camera", &orthoproj, sizeof(orthoproj));
-				g_render->SetTextureSlot("u_tex", DebugRenderPipeline.QuadBatch.Textures.GetData(), DebugRenderPipeline.QuadBatch.Textures.GetSize());
+				g_render->SetShaderProperty(STRING_ID("u_camera"), &orthoproj, sizeof(orthoproj));
+				g_render->SetTextureSlot(STRING_ID("u_tex"), DebugRenderPipeline.QuadBatch.Textures.GetData(), DebugRenderPipeline.QuadBatch.Textures.GetSize());
 				g_render->SetDepthEnable(false, false);
 				g_render->DrawIndexed(DebugRenderPipeline.QuadBatch.QuadArray.GetSize() / 4 * 6);
 				g_render->SetDefaultGraphicsState();
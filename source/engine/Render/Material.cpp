@@ -64,8 +64,8 @@ namespace Mist
 
     void cMaterial::BindTextures(rendersystem::RenderSystem* renderSystem) const
     {
-        g_render->SetTextureSlot("u_Textures", m_textures, MATERIAL_TEXTURE_COUNT);
-        g_render->SetSampler("u_Textures", m_samplers, MATERIAL_TEXTURE_COUNT);
+        g_render->SetTextureSlot(STRING_ID("u_Textures"), m_textures, MATERIAL_TEXTURE_COUNT);
+        g_render->SetSampler(STRING_ID("u_Textures"), m_samplers, MATERIAL_TEXTURE_COUNT);
     }
 
     sMaterialRenderData cMaterial::GetRenderData() const
@@ -2,6 +2,7 @@
 #include "Model.h"
 #include "Core/Debug.h"
 #include "Core/Logger.h"
+#include "Core/AsyncIO.h"
 #include "RenderProcesses/RenderProcess.h"
 #include <imgui/imgui.h>
 
@@ -50,7 +51,7 @@
 //#define MESH_DUMP_LOAD_INFO
 #ifdef MESH_DUMP_LOAD_INFO
 #define loadmeshlabel "[loadmesh] "
-#define loadmeshlogf(fmt, ...) logfinfo(loadmeshlabel fmt, __VA_ARGS__)
+#define loadmeshlogf(fmt, ...) logfinfo(loadmeshlabel fmt, ##__VA_ARGS__)
 #define loadmeshlog(fmt, ...) loginfo(loadmeshlabel fmt)
 #else
 #define loadmeshlogf(fmt, ...) DUMMY_MACRO
@@ -261,26 +262,82 @@ namespace gltf_api
         }
 	}
 
+	/**
+	 * cgltf reads the gltf file and its external buffers through these callbacks, so buffers point
+	 * straight into mapped files instead of heap copies. The views opened by one parse are kept in
+	 * file_options user_data until the data is freed.
+	 */
+	typedef Mist::tDynArray<Mist::cMappedFile*> tMappedFiles;
+
+	cgltf_result ReadMappedFile(const cgltf_memory_options* memoryOptions, const cgltf_file_options* fileOptions, const char* path, cgltf_size* size, void** data)
+	{
+		tMappedFiles& files = *static_cast<tMappedFiles*>(fileOptions->user_data);
+		Mist::cMappedFile* file = _new Mist::cMappedFile();
+		// accessors are read in any order.
+		if (!file->Open(path, Mist::cMappedFile::Access_Random))
+		{
+			delete file;
+			return cgltf_result_file_not_found;
+		}
+		// buffers come with their expected size, 0 reads the whole file.
+		if (*size > file->GetSize())
+		{
+			delete file;
+			return cgltf_result_io_error;
+		}
+		if (!*size)
+			*size = file->GetSize();
+		file->Prefetch(0, *size);
+		files.push_back(file);
+		// cgltf does not write to file data.
+		*data = const_cast<void*>(file->GetData());
+		return cgltf_result_success;
+	}
+
+	void ReleaseMappedFile(const cgltf_memory_options* memoryOptions, const cgltf_file_options* fileOptions, void* data)
+	{
+		tMappedFiles& files = *static_cast<tMappedFiles*>(fileOptions->user_data);
+		for (size_t i = 0; i < files.size(); ++i)
+		{
+			if (files[i]->GetData() == data)
+			{
+				delete files[i];
+				files[i] = files.back();
+				files.pop_back();
+				return;
+			}
+		}
+	}
+
 	void FreeData(cgltf_data* data)
 	{
+		tMappedFiles* files = static_cast<tMappedFiles*>(data->file.user_data);
 		cgltf_free(data);
+		check(!files || files->empty());
+		delete files;
 	}
 
 	cgltf_data* ParseFile(const char* filepath)
 	{
 		cgltf_options options;
 		memset(&options, 0, sizeof(cgltf_options));
+		tMappedFiles* files = _new tMappedFiles();
+		options.file.read = &ReadMappedFile;
+		options.file.release = &ReleaseMappedFile;
+		options.file.user_data = files;
 		cgltf_data* data{ nullptr };
 		cgltf_result result = cgltf_parse_file(&options, filepath, &data);
 		if (result != cgltf_result_success)
 		{
 			HandleError(result, filepath);
+			delete files;
 			return nullptr;
 		}
 		result = cgltf_load_buffers(&options, data, filepath);
 		if (result != cgltf_result_success)
 		{
 			HandleError(result, filepath);
+			FreeData(data);
 			return nullptr;
 		}
 		result = cgltf_validate(data);
@@ -381,7 +438,46 @@ namespace gltf_api
 		return device->CreateSampler(desc);
 	}
 
-	bool LoadTexture(render::Device* device, const char* rootAssetPath, const cgltf_texture_view& texView, render::TextureHandle* texOut, render::SamplerHandle* samplerOut)
+	template <typename T>
+	inline Mist::index_t GetArrayElementOffset(const T* root, const T* item) { check(item >= root); return Mist::index_t(item - root); }
+
+	// images of the gltf file decoded up front, indexed as cgltf_data::images.
+	struct tDecodedImages
+	{
+		const cgltf_image* Images;
+		rendersystem::textureloader::TextureData* Data;
+	};
+
+	void DecodeImages(const cgltf_data* data, const char* rootAssetPath, tDecodedImages& decoded)
+	{
+		PROFILE_SCOPE_LOGF(DecodeImages, "Decode model images (%d)", (uint32_t)data->images_count);
+		// file reads go to the io threads and each image is decoded on a job worker as soon as it is read,
+		// so disk reads overlap png/jpg decompression.
+		Mist::tDynArray<Mist::tIORequest*> requests(data->images_count, nullptr);
+		for (uint32_t i = 0; i < (uint32_t)data->images_count; ++i)
+		{
+			const cgltf_image& image = data->images[i];
+			if (!image.uri)
+			{
+				logfwarn("Embedded images not supported: %s\n", image.name ? image.name : "unknown");
+				continue;
+			}
+			char texturePath[512];
+			sprintf_s(texturePath, "%s%s", rootAssetPath, image.uri);
+			requests[i] = rendersystem::textureloader::LoadTextureDataAsync_u8(&decoded.Data[i], texturePath);
+		}
+		for (uint32_t i = 0; i < (uint32_t)requests.size(); ++i)
+		{
+			if (!requests[i])
+				continue;
+			Mist::WaitIORequest(requests[i]);
+			if (!decoded.Data[i].u8data)
+				logferror("Failed to load texture data from %s.\n", requests[i]->Path);
+			Mist::ReleaseIORequest(requests[i]);
+		}
+	}
+
+	bool LoadTexture(render::Device* device, const char* rootAssetPath, const cgltf_texture_view& texView, const tDecodedImages& images, render::TextureHandle* texOut, render::SamplerHandle* samplerOut)
 	{
 		if (!texView.texture)
 			return false;
@@ -389,17 +485,16 @@ namespace gltf_api
 		check(texView.scale == 1.f && !texView.has_transform);
 		char texturePath[512];
 		sprintf_s(texturePath, "%s%s", rootAssetPath, texView.texture->image->uri);
-		check(rendersystem::textureloader::LoadTextureFromFile(texOut, device, texturePath));
+		const rendersystem::textureloader::TextureData& data = images.Data[GetArrayElementOffset(images.Images, texView.texture->image)];
+		check(data.u8data && "Texture image not decoded.");
+		rendersystem::textureloader::CreateTextureFromData(texOut, device, data, texturePath);
 		if (texView.texture->sampler)
 			*samplerOut = LoadSampler(device, texView.texture->sampler);
 		loadmeshlogf("Load texture: %s\n", texView.texture->image->uri);
 		return true;
 	}
 
-	template <typename T>
-	inline Mist::index_t GetArrayElementOffset(const T* root, const T* item) { check(item >= root); return Mist::index_t(item - root); }
-
-	void LoadMaterial(Mist::cMaterial& material, render::Device* device, const cgltf_material& cgltfmtl, const char* rootAssetPath)
+	void LoadMaterial(Mist::cMaterial& material, render::Device* device, const cgltf_material& cgltfmtl, const char* rootAssetPath, const tDecodedImages& images)
 	{
 		material.m_flags = Mist::MATERIAL_FLAG_NONE;
 		// Emissive
@@ -409,7 +504,7 @@ namespace gltf_api
 			ToVec3(material.m_emissiveFactor, cgltfmtl.emissive_factor);
 			material.m_emissiveStrength = cgltfmtl.emissive_strength.emissive_strength;
 			Mist::eMaterialTexture matTexId = Mist::MATERIAL_TEXTURE_EMISSIVE;
-			if (LoadTexture(device, rootAssetPath, cgltfmtl.emissive_texture, &material.m_textures[matTexId], &material.m_samplers[matTexId]))
+			if (LoadTexture(device, rootAssetPath, cgltfmtl.emissive_texture, images, &material.m_textures[matTexId], &material.m_samplers[matTexId]))
 			{
 				material.m_flags |= Mist::MATERIAL_FLAG_HAS_EMISSIVE_MAP;
 			}
@@ -422,7 +517,7 @@ namespace gltf_api
 			material.m_metallicFactor = cgltfmtl.pbr_metallic_roughness.metallic_factor;
 			material.m_roughnessFactor = cgltfmtl.pbr_metallic_roughness.roughness_factor;
 			Mist::eMaterialTexture matTexId = Mist::MATERIAL_TEXTURE_METALLIC_ROUGHNESS;
-			if (LoadTexture(device, rootAssetPath, cgltfmtl.pbr_metallic_roughness.metallic_roughness_texture, &material.m_textures[matTexId], &material.m_samplers[matTexId]))
+			if (LoadTexture(device, rootAssetPath, cgltfmtl.pbr_metallic_roughness.metallic_roughness_texture, images, &material.m_textures[matTexId], &material.m_samplers[matTexId]))
 			{
 				material.m_flags |= Mist::MATERIAL_FLAG_HAS_METALLIC_ROUGHNESS_MAP;
 			}
@@ -435,13 +530,13 @@ namespace gltf_api
 			material.m_flags |= Mist::MATERIAL_FLAG_UNLIT;
 		}
 		// Normal
-		if (LoadTexture(device, rootAssetPath, cgltfmtl.normal_texture, &material.m_textures[Mist::MATERIAL_TEXTURE_NORMAL], &material.m_samplers[Mist::MATERIAL_TEXTURE_NORMAL]))
+		if (LoadTexture(device, rootAssetPath, cgltfmtl.normal_texture, images, &material.m_textures[Mist::MATERIAL_TEXTURE_NORMAL], &material.m_samplers[Mist::MATERIAL_TEXTURE_NORMAL]))
 		{
 			material.m_flags |= Mist::MATERIAL_FLAG_HAS_NORMAL_MAP;
 		}
 		// Albedo
 		ToVec3(material.m_albedo, cgltfmtl.pbr_metallic_roughness.base_color_factor);
-		if (LoadTexture(device, rootAssetPath, cgltfmtl.pbr_metallic_roughness.base_color_texture, &material.m_textures[Mist::MATERIAL_TEXTURE_ALBEDO], &material.m_samplers[Mist::MATERIAL_TEXTURE_ALBEDO]))
+		if (LoadTexture(device, rootAssetPath, cgltfmtl.pbr_metallic_roughness.base_color_texture, images, &material.m_textures[Mist::MATERIAL_TEXTURE_ALBEDO], &material.m_samplers[Mist::MATERIAL_TEXTURE_ALBEDO]))
 			material.m_flags |= Mist::MATERIAL_FLAG_HAS_EMISSIVE_MAP;
 	}
 
@@ -526,13 +621,20 @@ namespace Mist
 
 		if (data->materials_count)
 		{
+			tDynArray<rendersystem::textureloader::TextureData> imageData;
+			imageData.resize(data->images_count);
+			gltf_api::tDecodedImages images = { data->images, imageData.data() };
+			gltf_api::DecodeImages(data, rootAssetPath, images);
+
 			InitMaterials((index_t)data->materials_count);
 			for (uint32_t i = 0; i < data->materials_count; ++i)
 			{
 				m_materials[i].SetName(data->materials[i].name && *data->materials[i].name ? data->materials[i].name : "unknown");
-				gltf_api::LoadMaterial(m_materials[i], device, data->materials[i], rootAssetPath);
+				gltf_api::LoadMaterial(m_materials[i], device, data->materials[i], rootAssetPath, images);
 				//m_materials[i].SetupShader(context);
 			}
+			for (uint32_t i = 0; i < (uint32_t)imageData.size(); ++i)
+				rendersystem::textureloader::FreeTextureData(imageData[i]);
 		}
 		else
 		{
@@ -31,6 +31,8 @@ namespace Mist
 		virtual ~IRenderEngine() = default;
 		virtual bool Init(const Window& window) = 0;
 		virtual bool RenderProcess() = 0;
+		// blocks until the frame kicked by RenderProcess has been recorded and submitted.
+		virtual void WaitRenderFrame() = 0;
 		virtual void Shutdown() = 0;
 
 		virtual void UpdateSceneView(const glm::mat4& view, const glm::mat4& projection) = 0;
@@ -130,8 +130,8 @@ namespace Mist
 		rs->SetViewport(0.f, 0.f, (float)rt->m_info.extent.width, (float)rt->m_info.extent.height);
 		rs->SetScissor(0.f, (float)rt->m_info.extent.width, 0.f, (float)rt->m_info.extent.height);
 		rs->SetShader(m_filterShader);
-		rs->SetTextureSlot("u_tex", m_inputTarget);
-        rs->SetSampler("u_tex", render::Filter_Linear,
+		rs->SetTextureSlot(STRING_ID("u_tex"), m_inputTarget);
+        rs->SetSampler(STRING_ID("u_tex"), render::Filter_Linear,
             render::Filter_Linear,
             render::Filter_Linear,
             render::SamplerAddressMode_ClampToEdge,
@@ -148,7 +148,7 @@ namespace Mist
         params.curve[0] = params.threshold - m_knee;
         params.curve[1] = m_knee * 2.f;
         params.curve[2] = 0.25f / m_knee;
-		rs->SetShaderProperty("u_filterParams", &params, sizeof(params));
+		rs->SetShaderProperty(STRING_ID("u_filterParams"), &params, sizeof(params));
 		rs->DrawFullscreenQuad();
 		rs->EndMarker();
 
@@ -169,8 +169,8 @@ namespace Mist
 				rs->SetScissor(0.f, (float)rt->m_info.extent.width, 0.f, (float)rt->m_info.extent.height);
 
 				render::TextureHandle textureInput = m_renderTargetTexturesArray[i - 1];
-				rs->SetTextureSlot("u_tex", textureInput);
-				rs->SetSampler("u_tex", render::Filter_Linear,
+				rs->SetTextureSlot(STRING_ID("u_tex"), textureInput);
+				rs->SetSampler(STRING_ID("u_tex"), render::Filter_Linear,
 					render::Filter_Linear,
 					render::Filter_Linear,
 					render::SamplerAddressMode_ClampToEdge,
@@ -178,7 +178,7 @@ namespace Mist
 					render::SamplerAddressMode_ClampToEdge);
 
 				glm::vec2 resolution = { (float)rt->m_info.extent.width, (float)rt->m_info.extent.height };
-				rs->SetShaderProperty("u_BloomDownsampleParams", &resolution, sizeof(resolution));
+				rs->SetShaderProperty(STRING_ID("u_BloomDownsampleParams"), &resolution, sizeof(resolution));
 				rs->DrawFullscreenQuad();
 			}
 		}
@@ -201,8 +201,8 @@ namespace Mist
                 rs->SetScissor(0.f, (float)rt->m_info.extent.width, 0.f, (float)rt->m_info.extent.height);
                 
                 render::TextureHandle textureInput = m_renderTargetTexturesArray[i + 1];
-                rs->SetTextureSlot("u_tex", textureInput);
-                rs->SetSampler("u_tex", render::Filter_Linear,
+                rs->SetTextureSlot(STRING_ID("u_tex"), textureInput);
+                rs->SetSampler(STRING_ID("u_tex"), render::Filter_Linear,
                     render::Filter_Linear,
                     render::Filter_Linear,
                     render::SamplerAddressMode_ClampToEdge,
@@ -211,7 +211,7 @@ namespace Mist
 				rs->SetBlendEnable(true);
 				rs->SetBlendFactor(render::BlendFactor_One, render::BlendFactor_One);
 
-                rs->SetShaderProperty("u_BloomUpsampleParams", &m_config.UpscaleFilterRadius, sizeof(m_config.UpscaleFilterRadius));
+                rs->SetShaderProperty(STRING_ID("u_BloomUpsampleParams"), &m_config.UpscaleFilterRadius, sizeof(m_config.UpscaleFilterRadius));
 				rs->DrawFullscreenQuad();
             }
         }
@@ -229,8 +229,8 @@ namespace Mist
 			rs->SetViewport(0.f, 0.f, (float)m_composeTarget->m_info.extent.width, (float)m_composeTarget->m_info.extent.height);
 			rs->SetScissor(0.f, (float)m_composeTarget->m_info.extent.width, 0.f, (float)m_composeTarget->m_info.extent.height);
 			rs->SetDepthEnable(false, false);
-			rs->SetTextureSlot("u_tex0", m_blendTexture);
-			rs->SetTextureSlot("u_tex1", m_renderTargetTexturesArray[0]);
+			rs->SetTextureSlot(STRING_ID("u_tex0"), m_blendTexture);
+			rs->SetTextureSlot(STRING_ID("u_tex1"), m_renderTargetTexturesArray[0]);
 			rs->SetBlendEnable(true);
 			rs->SetBlendFactor(render::BlendFactor_One, render::BlendFactor_One);
 			rs->SetDepthEnable(false, false);
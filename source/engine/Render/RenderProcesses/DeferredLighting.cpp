@@ -139,53 +139,53 @@ namespace Mist
 			///////////////////////////////////////////////////////////commandList->ClearColor();
 
 			// GBUFFER textures
-			rs->SetTextureSlot("u_GBufferPosition", gbuffer->GetRenderTarget()->m_description.colorAttachments[GBuffer::EGBufferTarget::RT_POSITION].texture);
-			rs->SetTextureSlot("u_GBufferNormal", gbuffer->GetRenderTarget()->m_description.colorAttachments[GBuffer::EGBufferTarget::RT_NORMAL].texture);
-			rs->SetTextureSlot("u_GBufferAlbedo", gbuffer->GetRenderTarget()->m_description.colorAttachments[GBuffer::EGBufferTarget::RT_ALBEDO].texture);
-			rs->SetTextureSlot("u_GBufferEmissive", gbuffer->GetRenderTarget()->m_description.colorAttachments[GBuffer::EGBufferTarget::RT_EMISSIVE].texture);
-			rs->SetTextureSlot("u_GBufferDepth", *gbuffer->GetRenderTarget()->m_description.depthStencilAttachment.texture);
+			rs->SetTextureSlot(STRING_ID("u_GBufferPosition"), gbuffer->GetRenderTarget()->m_description.colorAttachments[GBuffer::EGBufferTarget::RT_POSITION].texture);
+			rs->SetTextureSlot(STRING_ID("u_GBufferNormal"), gbuffer->GetRenderTarget()->m_description.colorAttachments[GBuffer::EGBufferTarget::RT_NORMAL].texture);
+			rs->SetTextureSlot(STRING_ID("u_GBufferAlbedo"), gbuffer->GetRenderTarget()->m_description.colorAttachments[GBuffer::EGBufferTarget::RT_ALBEDO].texture);
+			rs->SetTextureSlot(STRING_ID("u_GBufferEmissive"), gbuffer->GetRenderTarget()->m_description.colorAttachments[GBuffer::EGBufferTarget::RT_EMISSIVE].texture);
+			rs->SetTextureSlot(STRING_ID("u_GBufferDepth"), *gbuffer->GetRenderTarget()->m_description.depthStencilAttachment.texture);
 
 			// SSAO textures
-			rs->SetTextureSlot("u_ssao", ssao->GetRenderTarget()->m_description.colorAttachments[0].texture);
+			rs->SetTextureSlot(STRING_ID("u_ssao"), ssao->GetRenderTarget()->m_description.colorAttachments[0].texture);
 
 			// ShadowMapping textures
 			const ShadowMapProcess* shadowMapping = (const ShadowMapProcess*)GetRenderer()->GetRenderProcess(RENDERPROCESS_SHADOWMAP);
 			render::TextureHandle shadowMapTextures[globals::MaxShadowMapAttachments];
 			for (uint32_t i = 0; i < globals::MaxShadowMapAttachments; ++i)
 				shadowMapTextures[i] = shadowMapping->GetRenderTarget(i)->m_description.depthStencilAttachment.texture;
-			rs->SetTextureSlot("u_ShadowMap", shadowMapTextures, globals::MaxShadowMapAttachments);
+			rs->SetTextureSlot(STRING_ID("u_ShadowMap"), shadowMapTextures, globals::MaxShadowMapAttachments);
 
 			// Shadow map lights matrix projection
 			tArray<glm::mat4, globals::MaxShadowMapAttachments> shadowMapMatrices;
 			for (uint32_t i = 0; i < globals::MaxShadowMapAttachments; ++i)
 				shadowMapMatrices[i] = shadowMapping->GetPipeline().GetLightVP(i);
-			rs->SetShaderProperty("u_ShadowMapInfo", shadowMapMatrices.data(), sizeof(glm::mat4) * (uint32_t)shadowMapMatrices.size());
+			rs->SetShaderProperty(STRING_ID("u_ShadowMapInfo"), shadowMapMatrices.data(), sizeof(glm::mat4) * (uint32_t)shadowMapMatrices.size());
 
 			render::TextureHandle brdf = scene->GetIrradianceCube().brdf ? scene->GetIrradianceCube().brdf : nullptr;
 			render::TextureHandle irradiance = scene->GetIrradianceCube().brdf ? scene->GetIrradianceCube().irradiance : scene->GetSkyboxTexture();
 			render::TextureHandle specular = scene->GetIrradianceCube().brdf ? scene->GetIrradianceCube().specular : scene->GetSkyboxTexture();
 
 			const EnvironmentData& env = scene->GetEnvironmentData();
-			rs->SetShaderProperty("u_env", &env, sizeof(env));
-			rs->SetShaderProperty("u_camera", GetCameraData(), sizeof(CameraData));
+			rs->SetShaderProperty(STRING_ID("u_env"), &env, sizeof(env));
+			rs->SetShaderProperty(STRING_ID("u_camera"), GetCameraData(), sizeof(CameraData));
 
-			rs->SetTextureSlot("u_irradianceMap", irradiance);
-			rs->SetSampler("u_irradianceMap", render::Filter_Linear, render::Filter_Linear, render::Filter_Linear,
+			rs->SetTextureSlot(STRING_ID("u_irradianceMap"), irradiance);
+			rs->SetSampler(STRING_ID("u_irradianceMap"), render::Filter_Linear, render::Filter_Linear, render::Filter_Linear,
 				render::SamplerAddressMode_ClampToEdge,
 				render::SamplerAddressMode_ClampToEdge,
 				render::SamplerAddressMode_ClampToEdge);
 
 			if (brdf)
 			{
-				rs->SetTextureSlot("u_brdfMap", brdf);
-				rs->SetSampler("u_brdfMap", render::Filter_Linear, render::Filter_Linear, render::Filter_Linear,
+				rs->SetTextureSlot(STRING_ID("u_brdfMap"), brdf);
+				rs->SetSampler(STRING_ID("u_brdfMap"), render::Filter_Linear, render::Filter_Linear, render::Filter_Linear,
 					render::SamplerAddressMode_ClampToEdge,
 					render::SamplerAddressMode_ClampToEdge,
 					render::SamplerAddressMode_ClampToEdge);
 			}
 
-			rs->SetTextureSlot("u_prefilterMap", specular);
-			rs->SetSampler("u_prefilterMap", render::Filter_Linear, render::Filter_Linear, render::Filter_Linear,
+			rs->SetTextureSlot(STRING_ID("u_prefilterMap"), specular);
+			rs->SetSampler(STRING_ID("u_prefilterMap"), render::Filter_Linear, render::Filter_Linear, render::Filter_Linear,
 				render::SamplerAddressMode_ClampToEdge, 
 				render::SamplerAddressMode_ClampToEdge, 
 				render::SamplerAddressMode_ClampToEdge);
@@ -213,9 +213,9 @@ namespace Mist
 			glm::mat4 proj = GetCameraData()->Projection;
 			CameraData cameraData;
 			cameraData.Set(view, proj);
-            rs->SetShaderProperty("u_camera", &cameraData, sizeof(CameraData));
+            rs->SetShaderProperty(STRING_ID("u_camera"), &cameraData, sizeof(CameraData));
 
-            rs->SetTextureSlot("u_cubemap", scene->GetSkyboxTexture());
+            rs->SetTextureSlot(STRING_ID("u_cubemap"), scene->GetSkyboxTexture());
 
 			rs->DrawIndexed(m_skyModel->m_meshes[0].indexCount);
 			rs->ClearState();
@@ -244,8 +244,8 @@ namespace Mist
 			rs->SetRenderTarget(rt);
 			rs->ClearColor();
 			rs->SetDepthEnable(false, false);
-			rs->SetShaderProperty("u_HdrParams", &params, sizeof(params));
-			rs->SetTextureSlot("u_hdrtex", m_lightingOutput->m_description.colorAttachments[0].texture);
+			rs->SetShaderProperty(STRING_ID("u_HdrParams"), &params, sizeof(params));
+			rs->SetTextureSlot(STRING_ID("u_hdrtex"), m_lightingOutput->m_description.colorAttachments[0].texture);
 			rs->DrawFullscreenQuad();
 			rs->SetDefaultGraphicsState();
 			rs->EndMarker();
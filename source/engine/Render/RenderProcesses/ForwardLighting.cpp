@@ -132,8 +132,8 @@ namespace Mist
 			glm::mat4 ubo[2];
 			ubo[0] = viewRot;
 			ubo[1] = GetCameraData()->Projection * viewRot;
-			g_render->SetShaderProperty("u_ubo", ubo, sizeof(glm::mat4) * 2);
-			g_render->SetTextureSlot("u_cubemap", cubemapTexture);
+			g_render->SetShaderProperty(STRING_ID("u_ubo"), ubo, sizeof(glm::mat4) * 2);
+			g_render->SetTextureSlot(STRING_ID("u_cubemap"), cubemapTexture);
 			g_render->DrawIndexed(mesh.indexCount);
 
 			DebugRender::DrawScreenQuad({}, { m_rt->m_info.extent.width, m_rt->m_info.extent.height }, m_rt->m_description.colorAttachments[0].texture);;
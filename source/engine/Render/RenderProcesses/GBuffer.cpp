@@ -66,7 +66,7 @@ namespace Mist
 		rs->SetDefaultGraphicsState();
 		rs->SetRenderTarget(m_renderTarget);
 		rs->SetShader(m_gbufferShader);
-		rs->SetShaderProperty("u_camera", GetCameraData(), sizeof(CameraData));
+		rs->SetShaderProperty(STRING_ID("u_camera"), GetCameraData(), sizeof(CameraData));
 		rs->ClearColor();
 		rs->ClearDepthStencil();
 		rs->SetStencilEnable(true);
@@ -144,8 +144,8 @@ namespace Mist
 
 		renderSystem->ClearState();
 		renderSystem->SetShader(m_computeShader);
-		renderSystem->BindUAV("u_particles", m_particlesBuffer);
-		renderSystem->SetShaderProperty("u_movParams", &m_params, sizeof(ParameterUBO));
+		renderSystem->BindUAV(STRING_ID("u_particles"), m_particlesBuffer);
+		renderSystem->SetShaderProperty(STRING_ID("u_movParams"), &m_params, sizeof(ParameterUBO));
 		renderSystem->Dispatch(PARTICLE_COUNT / 256, 1, 1);
 	}
 
@@ -164,7 +164,7 @@ namespace Mist
 			renderSystem->SetVertexBuffer(m_particlesBuffer);
 			renderSystem->SetPrimitive(render::PrimitiveType_PointList);
 			
-			renderSystem->SetTextureSlot("u_gradientTex", m_circleGradientTexture);
+			renderSystem->SetTextureSlot(STRING_ID("u_gradientTex"), m_circleGradientTexture);
 			renderSystem->Draw(m_particleCount);
 			renderSystem->ClearState();
 			renderSystem->SetDefaultGraphicsState();
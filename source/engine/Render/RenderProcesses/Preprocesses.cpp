@@ -229,9 +229,9 @@ namespace Mist
 
 				m_irradianceResources.PrepareDraw(renderSystem, rt, rt->m_info.extent, m_irradianceResources.equirectangularShader);
 				renderSystem->ClearColor();
-				renderSystem->SetTextureSlot("u_map", hdrFileContent);
-				renderSystem->SetShaderProperty("u_camera", &cd, sizeof(cd));
-				renderSystem->SetShaderProperty("u_data", &clampColors, sizeof(glm::vec4) * Mist::CountOf(clampColors));
+				renderSystem->SetTextureSlot(STRING_ID("u_map"), hdrFileContent);
+				renderSystem->SetShaderProperty(STRING_ID("u_camera"), &cd, sizeof(cd));
+				renderSystem->SetShaderProperty(STRING_ID("u_data"), &clampColors, sizeof(glm::vec4) * Mist::CountOf(clampColors));
 				m_irradianceResources.DrawCube(renderSystem);
 				renderSystem->ClearState();
 
@@ -279,12 +279,12 @@ namespace Mist
 
 				m_irradianceResources.PrepareDraw(renderSystem, rt, { irradianceCubemap->m_description.extent.width, irradianceCubemap->m_description.extent.height }, m_irradianceResources.irradianceShader);
 				renderSystem->ClearColor();
-				renderSystem->SetTextureSlot("u_cubemap", cubemap);
-				renderSystem->SetSampler("u_cubemap", render::Filter_Linear, render::Filter_Linear, render::Filter_Linear,
+				renderSystem->SetTextureSlot(STRING_ID("u_cubemap"), cubemap);
+				renderSystem->SetSampler(STRING_ID("u_cubemap"), render::Filter_Linear, render::Filter_Linear, render::Filter_Linear,
 					render::SamplerAddressMode_ClampToEdge,
 					render::SamplerAddressMode_ClampToEdge,
 					render::SamplerAddressMode_ClampToEdge);
-				renderSystem->SetShaderProperty("u_camera", &cd, sizeof(cd));
+				renderSystem->SetShaderProperty(STRING_ID("u_camera"), &cd, sizeof(cd));
 				m_irradianceResources.DrawCube(renderSystem);
 				renderSystem->ClearState();
 				
@@ -336,9 +336,9 @@ namespace Mist
 					renderSystem->BeginMarkerFmt("Mip %d Layer %d", mip, i);
 
 					m_irradianceResources.PrepareDraw(renderSystem, rt, { mipWidth, mipHeight }, m_irradianceResources.specularShader);
-					renderSystem->SetTextureSlot("u_cubemap", cubemap);
-					renderSystem->SetShaderProperty("u_camera", &cd, sizeof(cd));
-					renderSystem->SetShaderProperty("u_data", &r, sizeof(r));
+					renderSystem->SetTextureSlot(STRING_ID("u_cubemap"), cubemap);
+					renderSystem->SetShaderProperty(STRING_ID("u_camera"), &cd, sizeof(cd));
+					renderSystem->SetShaderProperty(STRING_ID("u_data"), &r, sizeof(r));
 					m_irradianceResources.DrawCube(renderSystem);
 					renderSystem->ClearState();
 					
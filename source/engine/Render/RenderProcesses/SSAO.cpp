@@ -71,13 +71,13 @@ namespace Mist
 			rs->SetScissor(m_rt->m_info.GetScissor());
 
 			rs->SetDepthEnable(false, false);
-			rs->SetShaderProperty("u_ssao", &m_ssaoParams, sizeof(m_ssaoParams));
+			rs->SetShaderProperty(STRING_ID("u_ssao"), &m_ssaoParams, sizeof(m_ssaoParams));
 
 			const GBuffer* gbuffer = static_cast<const GBuffer*>(GetRenderer()->GetRenderProcess(RENDERPROCESS_GBUFFER));
-			rs->SetTextureSlot("u_GBufferPosition", *gbuffer->GetRenderTarget()->m_description.colorAttachments[GBuffer::RT_POSITION].texture);
-			rs->SetTextureSlot("u_GBufferNormal", gbuffer->GetRenderTarget()->m_description.colorAttachments[GBuffer::RT_NORMAL].texture);
-			//rs->SetTextureSlot("u_GBufferDepth", gbuffer->GetRenderTarget()->m_description.depthStencilAttachment.texture);
-			rs->SetTextureSlot("u_SSAONoise", m_noiseTexture);
+			rs->SetTextureSlot(STRING_ID("u_GBufferPosition"), *gbuffer->GetRenderTarget()->m_description.colorAttachments[GBuffer::RT_POSITION].texture);
+			rs->SetTextureSlot(STRING_ID("u_GBufferNormal"), gbuffer->GetRenderTarget()->m_description.colorAttachments[GBuffer::RT_NORMAL].texture);
+			//rs->SetTextureSlot(STRING_ID("u_GBufferDepth"), gbuffer->GetRenderTarget()->m_description.depthStencilAttachment.texture);
+			rs->SetTextureSlot(STRING_ID("u_SSAONoise"), m_noiseTexture);
 			rs->DrawFullscreenQuad();
 			rs->ClearState();
 			rs->EndMarker();
@@ -90,8 +90,8 @@ namespace Mist
 			rs->SetViewport(m_blurRT->m_info.GetViewport());
 			rs->SetScissor(m_blurRT->m_info.GetScissor());
 			glm::vec4 blurParams = { 1.f / (float)m_rt->m_info.extent.width, 1.f / (float)m_rt->m_info.extent.height, 0.f, 0.f };
-			rs->SetShaderProperty("u_data", &blurParams, sizeof(glm::vec4));
-			rs->SetTextureSlot("u_ssaoTex", m_rt->m_description.colorAttachments[0].texture);
+			rs->SetShaderProperty(STRING_ID("u_data"), &blurParams, sizeof(glm::vec4));
+			rs->SetTextureSlot(STRING_ID("u_ssaoTex"), m_rt->m_description.colorAttachments[0].texture);
 			rs->DrawFullscreenQuad();
 
 			rs->ClearState();
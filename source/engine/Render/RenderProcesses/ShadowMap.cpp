@@ -141,7 +141,7 @@ namespace Mist
 	{
 		check(lightIndex < globals::MaxShadowMapAttachments);
 		uint32_t depthVPOffset = sizeof(glm::mat4) * lightIndex; 
-		rs->SetShaderProperty("u_ubo", &m_depthMVPCache[lightIndex], sizeof(glm::mat4));
+		rs->SetShaderProperty(STRING_ID("u_ubo"), &m_depthMVPCache[lightIndex], sizeof(glm::mat4));
 		scene->DrawGeometry(rs, RenderFlags_ShadowMap | RenderFlags_NoTextures);
 	}
 
@@ -369,41 +369,37 @@ namespace Mist
 			glm::mat4 view = GetCameraData()->View;
 			glm::mat4 cameraProj = GetCameraData()->Projection;
 
-			// TODO: cache on scene a preprocessed light array to show. Dont iterate over ALL objects checking if they have light component.
-			uint32_t count = scene.GetRenderObjectCount();
+			// shadow lights published by the scene for this frame.
+			const tSceneRenderData& renderData = scene.GetRenderData();
 			m_lightCount = 0;
-			for (uint32_t i = 0; i < count; ++i)
+			for (uint32_t i = 0; i < renderData.ShadowLights.GetSize(); ++i)
 			{
-				const LightComponent* light = scene.GetLight(i);
-				if (light && light->Type != ELightType::Point && light->ProjectShadows)
+				const tShadowLightData& light = renderData.ShadowLights[i];
+				switch (light.Type)
 				{
-					const TransformComponent& t = scene.GetTransform(i);
-					switch (light->Type)
+				case ELightType::Directional:
+					if (m_debugDirParams.show)
 					{
-					case ELightType::Directional:
-						if (m_debugDirParams.show)
-						{
-							m_debugDirParams.pos = glm::vec3(0.f);
-							m_debugDirParams.rot = t.Rotation;
-							for (uint32_t j = 0; j < CountOf(m_debugDirParams.clips); ++j)
-								m_debugDirParams.clips[j] = m_shadowMapPipeline.m_orthoParams[j];
-						}
-						m_shadowMapPipeline.SetupDirectionalLight(m_lightCount++, view, cameraProj, t.Rotation);
-						break;
-					case ELightType::Spot:
-					{
-						if (m_debugLightParams.show)
-						{
-							m_debugLightParams.pos = t.Position;
-							m_debugLightParams.rot = t.Rotation;
-							m_debugLightParams.cutoff = light->OuterCutoff;
-						}
-						m_shadowMapPipeline.SetupSpotLight(m_lightCount++, view, t.Position, t.Rotation, light->OuterCutoff, m_debugLightParams.clips[0], m_debugLightParams.clips[1]);
+						m_debugDirParams.pos = glm::vec3(0.f);
+						m_debugDirParams.rot = light.Rotation;
+						for (uint32_t j = 0; j < CountOf(m_debugDirParams.clips); ++j)
+							m_debugDirParams.clips[j] = m_shadowMapPipeline.m_orthoParams[j];
 					}
+					m_shadowMapPipeline.SetupDirectionalLight(m_lightCount++, view, cameraProj, light.Rotation);
 					break;
-					default:
-						check(false && "Unreachable");
+				case ELightType::Spot:
+				{
+					if (m_debugLightParams.show)
+					{
+						m_debugLightParams.pos = light.Position;
+						m_debugLightParams.rot = light.Rotation;
+						m_debugLightParams.cutoff = light.OuterCutoff;
 					}
+					m_shadowMapPipeline.SetupSpotLight(m_lightCount++, view, light.Position, light.Rotation, light.OuterCutoff, m_debugLightParams.clips[0], m_debugLightParams.clips[1]);
+				}
+				break;
+				default:
+					check(false && "Unreachable");
 				}
 			}
 			check(m_lightCount <= globals::MaxShadowMapAttachments);
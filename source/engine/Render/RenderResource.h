@@ -4,6 +4,7 @@
 #pragma once
 #include <string.h>
 #include "Core/Debug.h"
+#include "Core/StringId.h"
 namespace Mist
 {
 	enum eResourceType
@@ -31,15 +32,19 @@ namespace Mist
 		}
 
 		const char* GetName() const { return m_name; }
+		// interned name, for lookups by name without string compares.
+		tStringId GetNameId() const { return m_nameId; }
 
 		void SetName(const char* str) 
 		{ 
 			check(*str); 
 			check(strlen(str) <= ResourceNameLength);
 			strcpy_s(m_name, str); 
+			m_nameId = tStringId(m_name);
 		}
 		inline constexpr eResourceType GetType() const { return RType; }
 	private:
 		char m_name[ResourceNameLength];
+		tStringId m_nameId;
 	};
 }
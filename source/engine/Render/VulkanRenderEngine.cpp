@@ -25,6 +25,7 @@
 #include "Application/Event.h"
 #include "Core/SystemMemory.h"
 #include "Render/DebugRender.h"
+#include "Core/FileWatch.h"
 
 
 #include "RenderAPI/Device.h"
@@ -47,6 +48,8 @@ namespace Mist
 	CBoolVar CVar_EnableValidationLayer("r_enableValidationLayer", true);
 	CBoolVar CVar_ExitValidationLayer("r_exitValidationLayer", true);
 	CBoolVar CVar_ShowImGui("ShowImGui", true);
+	// 0 - game and render run serially in the main thread, 1 - frame N is drawn in the render thread while frame N+1 ticks.
+	CBoolVar CVar_RenderThread("r_renderThread", true, CVarFlag_SetOnlyByCmd);
 
 	extern CIntVar CVar_ShowCpuProf;
 
@@ -78,6 +81,7 @@ namespace Mist
 	}
 
 	CBoolVar CVar_ShowImGuiDemo("ShowImGuiDemo", false);
+	CBoolVar CVar_AutoReloadShaders("r_autoReloadShaders", true);
 
 	void ExecCommand_ReloadShaders(const char* cmd)
 	{
@@ -85,6 +89,13 @@ namespace Mist
 		eng->ReloadShaders();
 	}
 
+	void OnWorkspaceFilesChanged(const tFileWatchEvent* events, uint32_t count, void* userData)
+	{
+		check(userData);
+		if (CVar_AutoReloadShaders.Get())
+			static_cast<VulkanRenderEngine*>(userData)->ReloadChangedShaders(events, count);
+	}
+
 	void ExecCommand_DumpShadersInfo(const char* cmd)
 	{
 		VulkanRenderEngine* eng = IRenderEngine::GetRenderEngineAs<VulkanRenderEngine>();
@@ -126,7 +137,8 @@ namespace Mist
 #endif // _DEBUG
 			
 
-		SDL_Init(SDL_INIT_VIDEO);
+		if (window.WindowInstance)
+			SDL_Init(SDL_INIT_VIDEO);
 
 		class WindowRenderInterface : public rendersystem::IWindow
 		{
@@ -141,6 +153,7 @@ namespace Mist
 
 		g_render = m_renderSystem;
 		g_device = m_renderSystem->GetDevice();
+		Debug::SetDebugCheckCallback([]() { if (g_render) g_render->DumpState(); });
 
 		m_renderer.Init(m_renderSystem, this);
 		m_gpuParticleSystem.Init(g_render);
@@ -151,11 +164,13 @@ namespace Mist
 		AddConsoleCommand("r_reloadshaders", ExecCommand_ReloadShaders);
 		AddConsoleCommand("r_dumpshadersinfo", ExecCommand_DumpShadersInfo);
 		AddConsoleCommand("s_setcpuprof", ExecCommand_ActiveCpuProf);
+		AddFileWatchListener(&OnWorkspaceFilesChanged, this);
 
 		//////////////////////////////////////
 		// ImGui callbacks
 		//////////////////////////////////////
 		rendersystem::ui::AddWindowCallback("AppInfo", [](void*) { Profiling::ImGuiDraw(); }, nullptr, true);
+		rendersystem::ui::AddWindowCallback("Console", [](void*) { DrawConsole(); });
 		rendersystem::ui::AddWindowCallback("InputState", &ImGuiDrawInputState);
 		rendersystem::ui::AddWindowCallback("ImGuiDemo", [](void*) { ImGui::ShowDemoWindow(); });
 		rendersystem::ui::AddWindowCallback("Gpu particles", [](void* data) 
@@ -182,26 +197,87 @@ namespace Mist
 					rp->ImGuiDraw();
 				}, m_renderer.GetRenderProcess((RenderProcessType)i));
 
+		if (CVar_RenderThread.Get())
+		{
+			m_renderThreadExit = false;
+			m_renderThread = std::thread(&VulkanRenderEngine::RenderThreadMain, this);
+		}
+		logfinfo("Render thread %s.\n", CVar_RenderThread.Get() ? "enabled" : "disabled");
 		return true;
 	}
 
+	void VulkanRenderEngine::RenderThreadMain()
+	{
+		Profiling::CpuProf_SetThreadName("Render");
+		uint32_t frame = 0;
+		while (true)
+		{
+			m_renderRequest.wait(frame, std::memory_order_acquire);
+			if (m_renderThreadExit.load(std::memory_order_acquire))
+				break;
+			frame = m_renderRequest.load(std::memory_order_acquire);
+			Draw();
+			m_renderDone.store(frame, std::memory_order_release);
+			m_renderDone.notify_one();
+		}
+	}
+
+	void VulkanRenderEngine::KickRenderFrame()
+	{
+		if (!m_renderThread.joinable())
+		{
+			Draw();
+			return;
+		}
+		m_renderRequest.fetch_add(1, std::memory_order_release);
+		m_renderRequest.notify_one();
+	}
+
+	void VulkanRenderEngine::WaitRenderFrame()
+	{
+		CPU_PROFILE_SCOPE(WaitRenderThread);
+		uint32_t requested = m_renderRequest.load(std::memory_order_relaxed);
+		for (uint32_t done = m_renderDone.load(std::memory_order_acquire); done != requested; done = m_renderDone.load(std::memory_order_acquire))
+			m_renderDone.wait(done, std::memory_order_acquire);
+	}
+
 	bool VulkanRenderEngine::RenderProcess()
 	{
 		CPU_PROFILE_SCOPE(Process);
+		// scene render data not used by the frame in flight, overlaps with the render thread.
 		if (m_scene)
-		{
 			m_scene->UpdateRenderData();
-			ShadowMapProcess* shadowMap = static_cast<ShadowMapProcess*>(m_renderer.GetRenderProcess(RENDERPROCESS_SHADOWMAP));
-			shadowMap->CollectLightData(*m_scene);
-		}
+
+		// sync point: from here to the kick the render thread is idle and game state can be shared.
+		WaitRenderFrame();
 		FlushPendingConsoleCommands();
-		Draw();
+		if (m_scene)
+			m_scene->PublishRenderData();
+		g_cameraData = m_viewData;
+		// ui windows edit scene and render processes, build them while nothing is drawing.
+		if (rendersystem::ui::IsEnabled())
+		{
+			g_render->BeginUIFrame();
+			ImGuiDraw();
+			g_render->EndUIFrame();
+		}
+
+		KickRenderFrame();
 		return true;
 	}
 
 	void VulkanRenderEngine::Shutdown()
 	{
 		loginfo("Shutdown render engine.\n");
+		RemoveFileWatchListener(&OnWorkspaceFilesChanged, this);
+		if (m_renderThread.joinable())
+		{
+			WaitRenderFrame();
+			m_renderThreadExit.store(true, std::memory_order_release);
+			m_renderRequest.fetch_add(1, std::memory_order_release);
+			m_renderRequest.notify_one();
+			m_renderThread.join();
+		}
 		g_device->WaitIdle();
 		if (m_scene)
 		{
@@ -212,6 +288,7 @@ namespace Mist
 		m_gpuParticleSystem.Destroy(g_render);
 		DebugRender::Destroy();
 		m_renderer.Destroy(m_renderSystem);
+		Debug::SetDebugCheckCallback(nullptr);
 		g_device = nullptr;
 		g_render = nullptr;
 		m_renderSystem->Destroy();
@@ -220,7 +297,8 @@ namespace Mist
 
 	void VulkanRenderEngine::UpdateSceneView(const glm::mat4& view, const glm::mat4& projection)
 	{
-		g_cameraData.Set(view, projection);
+		// game thread view, published to GetCameraData() with the next frame.
+		m_viewData.Set(view, projection);
 	}
 
 	Scene* VulkanRenderEngine::GetScene()
@@ -255,10 +333,42 @@ namespace Mist
 	void VulkanRenderEngine::ReloadShaders()
 	{
 		PROFILE_SCOPE_LOG(ReloadShaders, "reload shaders");
+		WaitRenderFrame();
 		g_render->ReloadAllShaders();
 		logok("Shader reloaded.\n");
 	}
 
+	void VulkanRenderEngine::ReloadChangedShaders(const tFileWatchEvent* events, uint32_t count)
+	{
+		tDynArray<tStringId> files;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			// os dropped events, any shader may have changed.
+			if (events[i].Change == Platform::FileChange_Overflow)
+			{
+				ReloadShaders();
+				return;
+			}
+			// removed files are reloaded when they come back.
+			if (events[i].Change == Platform::FileChange_Removed)
+				continue;
+			// paths never interned can't be a shader dependency.
+			char normalized[256];
+			tStringId id;
+			if (FileSystem::NormalizePath(events[i].Path, normalized, sizeof(normalized)))
+				id = tStringId::Find(normalized);
+			if (id.IsValid())
+				files.push_back(id);
+		}
+		if (files.empty())
+			return;
+
+		PROFILE_SCOPE_LOG(ReloadChangedShaders, "reload changed shaders");
+		WaitRenderFrame();
+		if (uint32_t reloaded = g_render->ReloadShadersDependingOn(files.data(), (uint32_t)files.size()))
+			logfok("%u shaders reloaded.\n", reloaded);
+	}
+
 	void VulkanRenderEngine::DumpShadersInfo()
 	{
 #if 0
@@ -279,7 +389,6 @@ namespace Mist
 		//DumpMemoryStats();
 
 		g_render->BeginFrame();
-		ImGuiDraw();
 
 		g_render->BeginMarker("Renderer");
 		m_renderer.Draw(m_renderSystem);
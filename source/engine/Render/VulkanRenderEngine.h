@@ -12,6 +12,8 @@
 #include <SDL_vulkan.h>
 #include <string.h>
 #include <chrono>
+#include <atomic>
+#include <thread>
 #include "Render/Globals.h"
 #include "RenderProcesses/GPUParticleSystem.h"
 
@@ -30,6 +32,7 @@ namespace rendersystem
 namespace Mist
 {
 	class IRendererBase;
+	struct tFileWatchEvent;
 
 
 	struct UBOTime
@@ -47,6 +50,8 @@ namespace Mist
 		 */
 		virtual bool Init(const Window& window) override;
 		virtual bool RenderProcess() override;
+		// returns when the last kicked frame is submitted.
+		virtual void WaitRenderFrame() override;
 		virtual void Shutdown() override;
 
 		virtual void UpdateSceneView(const glm::mat4& view, const glm::mat4& projection) override;
@@ -58,13 +63,19 @@ namespace Mist
 		const Renderer* GetRenderer() const { return &m_renderer; }
 
 		virtual void ReloadShaders() override;
+		// reloads the shaders using any of the changed workspace files.
+		void ReloadChangedShaders(const tFileWatchEvent* events, uint32_t count);
 		void DumpShadersInfo();
 
 	protected:
 		void BeginFrame();
+		// records and submits the published frame. Runs in the render thread when enabled.
 		void Draw();
 		void ImGuiDraw();
 
+		void RenderThreadMain();
+		void KickRenderFrame();
+
 		// Initializations
 		bool InitVulkan();
 		bool InitCommands();
@@ -77,6 +88,13 @@ namespace Mist
 		uint32_t m_currentSwapchainIndex;
 
 		Scene* m_scene = nullptr;
+		CameraData m_viewData;
+
+		std::thread m_renderThread;
+		std::atomic<bool> m_renderThreadExit = false;
+		// frames kicked by the game thread and frames finished by the render thread.
+		std::atomic<uint32_t> m_renderRequest = 0;
+		std::atomic<uint32_t> m_renderDone = 0;
 
 		GPUParticleSystem m_gpuParticleSystem;
 #if 0
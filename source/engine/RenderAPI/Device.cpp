@@ -821,6 +821,7 @@ namespace render
 					VkPipelineBindPoint bindPoint = m_cmd->m_graphicsState.pipeline ? VK_PIPELINE_BIND_POINT_GRAPHICS : VK_PIPELINE_BIND_POINT_COMPUTE;
 					VkPipelineLayout layout = m_cmd->m_graphicsState.pipeline ? m_cmd->m_graphicsState.pipeline->m_pipelineLayout : m_cmd->m_computeState.pipeline->m_pipelineLayout;
 					vkCmdBindDescriptorSets(m_cmd->m_currentCommandBuffer->cmd, bindPoint, layout, m_firstSet, m_vksets.GetSize(), m_vksets.GetData(), m_offsets.GetSize(), m_offsets.GetData());
+					m_cmd->m_stats.bindingSets += m_vksets.GetSize();
 
                     // clear queue
                     m_vksets.Clear();
@@ -1312,7 +1313,7 @@ namespace render
     }
 
     Device::Device(const DeviceDescription& description)
-        : m_context(nullptr), m_swapchainIndex(UINT32_MAX), m_queue(nullptr)
+        : m_context(nullptr), m_swapchainIndex(UINT32_MAX), m_offscreenAcquireCount(0), m_queue(nullptr)
     {
         InitContext(description);
         InitMemoryContext();
@@ -1320,7 +1321,10 @@ namespace render
 
         uint32_t backbufferWidth, backbufferHeight;
         Mist::Window::GetWindowExtent(description.windowHandle, backbufferWidth, backbufferHeight);
-        InitSwapchain(backbufferWidth, backbufferHeight);
+        if (description.headless)
+            InitOffscreenSwapchain(backbufferWidth, backbufferHeight);
+        else
+            InitSwapchain(backbufferWidth, backbufferHeight);
     }
 
     Device::~Device()
@@ -1344,7 +1348,7 @@ namespace render
 
     CommandListHandle Device::CreateCommandList()
     {
-        CommandList* cmd = _new CommandList(this);
+        CommandList* cmd = new CommandList(this);
         return CommandListHandle(cmd);
     }
 
@@ -1356,7 +1360,7 @@ namespace render
 
     SemaphoreHandle Device::CreateRenderSemaphore(bool timelineSemaphore)
     {
-        Semaphore* semaphore = _new Semaphore(this);
+        Semaphore* semaphore = new Semaphore(this);
 
         VkSemaphoreTypeCreateInfo typeInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO, nullptr };
         typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
@@ -1389,7 +1393,7 @@ namespace render
 
     BufferHandle Device::CreateBuffer(const BufferDescription& description)
     {
-        Buffer* buffer = _new Buffer(this);
+        Buffer* buffer = new Buffer(this);
         buffer->m_description = description;
         buffer->m_description.bufferUsage = utils::GetBufferUsage(description);
         check(description.size > 0);
@@ -1483,7 +1487,7 @@ namespace render
         check(description.extent.width != 0);
         check(description.extent.height != 0);
         check(description.extent.depth != 0);
-        Texture* texture = _new Texture(this);
+        Texture* texture = new Texture(this);
         texture->m_description = description;
 
         // validation: cube textures must have equal dimensions.
@@ -1555,7 +1559,7 @@ namespace render
     TextureHandle Device::CreateTextureFromNative(const TextureDescription& description, VkImage image)
     {
         check(image != VK_NULL_HANDLE);
-        Texture* texture = _new Texture(this);
+        Texture* texture = new Texture(this);
         texture->m_description = description;
         texture->m_alloc = nullptr;
         texture->m_image = image;
@@ -1600,7 +1604,7 @@ namespace render
 
     SamplerHandle Device::CreateSampler(const SamplerDescription& description)
     {
-        Sampler* sampler = _new Sampler(this);
+        Sampler* sampler = new Sampler(this);
         sampler->m_description = description;
 
         VkSamplerCreateInfo samplerInfo = {};
@@ -1636,7 +1640,7 @@ namespace render
 
     ShaderHandle Device::CreateShader(const ShaderDescription& description, const void* binary, size_t binarySize)
     {
-        Shader* shader = _new Shader(this);
+        Shader* shader = new Shader(this);
         shader->m_description = description;
         VkShaderModuleCreateInfo createInfo = {};
         createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -1658,7 +1662,7 @@ namespace render
 
     RenderTargetHandle Device::CreateRenderTarget(const RenderTargetDescription& description)
     {
-        RenderTarget* renderTarget = _new RenderTarget(this);
+        RenderTarget* renderTarget = new RenderTarget(this);
         renderTarget->m_description = description;
         renderTarget->m_info = RenderTargetInfo(renderTarget->m_description);
         
@@ -1783,7 +1787,7 @@ namespace render
 
     GraphicsPipelineHandle Device::CreateGraphicsPipeline(const GraphicsPipelineDescription& description, RenderTargetHandle rt)
     {
-        GraphicsPipeline* pipeline = _new GraphicsPipeline(this);
+        GraphicsPipeline* pipeline = new GraphicsPipeline(this);
         pipeline->m_description = description;
 
         check(rt && rt->m_renderPass != VK_NULL_HANDLE);
@@ -2000,7 +2004,7 @@ namespace render
 
     BindingLayoutHandle Device::CreateBindingLayout(const BindingLayoutDescription& description)
     {
-        BindingLayout* bindingLayout = _new BindingLayout(this);
+        BindingLayout* bindingLayout = new BindingLayout(this);
         bindingLayout->m_description = description;
 
         // Create descriptor set layout
@@ -2063,7 +2067,7 @@ namespace render
 
     ComputePipelineHandle Device::CreateComputePipeline(const ComputePipelineDescription& description)
     {
-        ComputePipeline* pipeline = _new ComputePipeline(this);
+        ComputePipeline* pipeline = new ComputePipeline(this);
         pipeline->m_description = description;
         
         check(description.computeShader && description.computeShader->m_shader != VK_NULL_HANDLE);
@@ -2105,7 +2109,7 @@ namespace render
 
     BindingSetHandle Device::CreateBindingSet(const BindingSetDescription& description, BindingLayoutHandle layout)
     {
-        BindingSet* bindingSet = _new BindingSet(this);
+        BindingSet* bindingSet = new BindingSet(this);
         bindingSet->m_description = description;
         bindingSet->m_layout = layout;
         check(layout && layout->m_layout != VK_NULL_HANDLE);
@@ -2238,7 +2242,7 @@ namespace render
     QueryPoolHandle Device::CreateQueryPool(const QueryPoolDescription& description)
     {
         check(description.count);
-        QueryPool* query = _new QueryPool(this, description);
+        QueryPool* query = new QueryPool(this, description);
         VkQueryPoolCreateInfo info{ .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, .pNext = nullptr };
         info.flags = 0;
         info.queryType = utils::ConvertQueryType(description.type);
@@ -2268,6 +2272,19 @@ namespace render
     uint32_t Device::AcquireSwapchainIndex(SemaphoreHandle semaphoreToBeSignaled)
     {
         check(m_swapchainIndex == UINT32_MAX);
+        if (!m_swapchain.swapchain)
+        {
+            // offscreen images are used in order, empty submission to signal the semaphore as the acquire would do.
+            m_swapchainIndex = m_offscreenAcquireCount++ % (uint32_t)m_swapchain.images.size();
+            if (semaphoreToBeSignaled)
+            {
+                VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr };
+                submitInfo.signalSemaphoreCount = 1;
+                submitInfo.pSignalSemaphores = &semaphoreToBeSignaled->m_semaphore;
+                check_result(vkQueueSubmit(m_queue->m_queue, 1, &submitInfo, VK_NULL_HANDLE));
+            }
+            return m_swapchainIndex;
+        }
         check_result(vkAcquireNextImageKHR(m_context->device, m_swapchain.swapchain, 1000000000, semaphoreToBeSignaled ? semaphoreToBeSignaled->m_semaphore : nullptr, nullptr, &m_swapchainIndex));
         check(m_swapchainIndex < (uint32_t)m_swapchain.images.size());
         return m_swapchainIndex;
@@ -2276,6 +2293,21 @@ namespace render
     void Device::Present(SemaphoreHandle semaphoreToWait)
     {
         check(m_swapchainIndex < (uint32_t)m_swapchain.images.size());
+        if (!m_swapchain.swapchain)
+        {
+            // nothing to present, consume the semaphore so it can be signaled again.
+            if (semaphoreToWait)
+            {
+                VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+                VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr };
+                submitInfo.waitSemaphoreCount = 1;
+                submitInfo.pWaitSemaphores = &semaphoreToWait->m_semaphore;
+                submitInfo.pWaitDstStageMask = &waitStage;
+                check_result(vkQueueSubmit(m_queue->m_queue, 1, &submitInfo, VK_NULL_HANDLE));
+            }
+            m_swapchainIndex = UINT32_MAX;
+            return;
+        }
         // Present
         VkPresentInfoKHR presentInfo = {};
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -2393,6 +2425,7 @@ namespace render
         vkb::InstanceBuilder builder;
         vkb::Result<vkb::Instance> instanceReturn = builder
             .set_app_name("Vulkan renderer")
+            .set_headless(description.headless)
             .request_validation_layers(Mist::CVar_EnableValidationLayer.Get())
             .require_api_version(major, minor, patch)
             .set_debug_callback(&DebugVulkanCallback)
@@ -2408,12 +2441,14 @@ namespace render
         // Physical device
         VkSurfaceKHR surface = VK_NULL_HANDLE;
         // TODO: app abstraction to separate window functionality
-        Mist::Window::CreateSurface(*reinterpret_cast<const Mist::Window*>(description.windowHandle), &instance, &surface);
+        if (!description.headless)
+            Mist::Window::CreateSurface(*reinterpret_cast<const Mist::Window*>(description.windowHandle), &instance, &surface);
         vkb::PhysicalDeviceSelector selector(instanceReturn.value());
+        // headless runs accept cpu devices (software ICDs).
         vkb::PhysicalDevice vkbPhysicalDevice = selector
             .set_minimum_version(1, 1)
             .set_surface(surface)
-            .allow_any_gpu_device_type(false)
+            .allow_any_gpu_device_type(description.headless)
             .prefer_gpu_device_type(vkb::PreferredDeviceType::discrete)
             .select()
             .value();
@@ -2650,7 +2685,6 @@ namespace render
         check_result(vkGetSwapchainImagesKHR(m_context->device, m_swapchain.swapchain, &swapchainImageCount, swapchainImages));
 
         m_swapchain.images.resize(swapchainImageCount);
-        Mist::tStaticArray<TextureBarrier, 8> barriers;
         for (uint32_t i = 0; i < swapchainImageCount; ++i)
         {
             TextureDescription desc;
@@ -2660,12 +2694,52 @@ namespace render
             desc.mipLevels = 1;
             desc.memoryUsage = MemoryUsage_Gpu;
             desc.isRenderTarget = true;
-            TextureHandle texture = CreateTextureFromNative(desc, swapchainImages[i]);
-            m_swapchain.images[i] = texture;
+            m_swapchain.images[i] = CreateTextureFromNative(desc, swapchainImages[i]);
+        }
+        delete[] swapchainImages;
+        m_swapchain.presentLayout = ImageLayout_PresentSrc;
+        TransitionSwapchainImages();
+    }
+
+    void Device::InitOffscreenSwapchain(uint32_t width, uint32_t height)
+    {
+        check(width && height && !m_context->surface);
+        if (m_swapchain.width == width && m_swapchain.height == height)
+            return;
+        DestroySwapchain();
+
+        static constexpr uint32_t OffscreenImageCount = 3;
+        m_swapchain.width = width;
+        m_swapchain.height = height;
+        m_swapchain.format = Format_R8G8B8A8_UNorm;
+        m_swapchain.colorSpace = ColorSpace_SRGB;
+        m_swapchain.images.resize(OffscreenImageCount);
+        for (uint32_t i = 0; i < OffscreenImageCount; ++i)
+        {
+            TextureDescription desc;
+            desc.extent = { width, height, 1 };
+            desc.format = m_swapchain.format;
+            desc.memoryUsage = MemoryUsage_Gpu;
+            desc.isRenderTarget = true;
+            char name[32];
+            sprintf_s(name, "OffscreenSwapchain_%u", i);
+            desc.debugName = name;
+            m_swapchain.images[i] = CreateTexture(desc);
+        }
+        // left ready to be copied out, PresentSrc needs the swapchain extension.
+        m_swapchain.presentLayout = ImageLayout_TransferSrc;
+        TransitionSwapchainImages();
+        logfinfo("Offscreen swapchain: %u images (%4d x %4d)\n", OffscreenImageCount, width, height);
+    }
 
+    void Device::TransitionSwapchainImages()
+    {
+        Mist::tStaticArray<TextureBarrier, 8> barriers;
+        for (uint32_t i = 0; i < (uint32_t)m_swapchain.images.size(); ++i)
+        {
             TextureBarrier& barrier = barriers.Push();
-            barrier.texture = texture;
-            barrier.newLayout = ImageLayout_PresentSrc;
+            barrier.texture = m_swapchain.images[i];
+            barrier.newLayout = m_swapchain.presentLayout;
         }
         check(!barriers.IsEmpty());
         CommandListHandle cmd = CreateCommandList();
@@ -2675,7 +2749,6 @@ namespace render
         uint64_t id = cmd->ExecuteCommandList();
         check(WaitForSubmissionId(id));
         cmd = nullptr;
-        delete[] swapchainImages;
     }
 
     void Device::DestroyMemoryContext()
@@ -2692,7 +2765,8 @@ namespace render
     {
         check(m_context);
         vkDestroyDevice(m_context->device, m_context->allocationCallbacks);
-        vkDestroySurfaceKHR(m_context->instance, m_context->surface, nullptr);
+        if (m_context->surface)
+            vkDestroySurfaceKHR(m_context->instance, m_context->surface, nullptr);
         if (m_context->debugMessenger)
         {
             PFN_vkDestroyDebugUtilsMessengerEXT pfnDestroyMessenger = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(m_context->instance, "vkDestroyDebugUtilsMessengerEXT");
@@ -11,6 +11,7 @@
 
 
 #include "Core/Types.h"
+#include "Core/PoolAllocator.h"
 #include "Types.h"
 #include "Utils.h"
 
@@ -526,7 +527,7 @@ namespace render
      * Sync
      */
 
-    class Semaphore final : public Mist::Ref<Semaphore>
+    class Semaphore final : public Mist::Ref<Semaphore>, public Mist::tPoolObject<Semaphore>
     {
     public:
         Semaphore(Device* device);
@@ -544,7 +545,7 @@ namespace render
      * Buffer
      */
 
-    class Buffer final : public Mist::Ref<Buffer>
+    class Buffer final : public Mist::Ref<Buffer>, public Mist::tPoolObject<Buffer>
     {
     public:
 
@@ -585,7 +586,7 @@ namespace render
 
     };
 
-    class Texture final : public Mist::Ref<Texture>
+    class Texture final : public Mist::Ref<Texture>, public Mist::tPoolObject<Texture>
     {
     public:
 
@@ -612,10 +613,11 @@ namespace render
         Alloc m_alloc;
         VkImage m_image;
         bool m_owner;
-        Mist::tMap<TextureSubresourceRange, ImageLayout> m_layouts;
+        Mist::tFlatMap<TextureSubresourceRange, ImageLayout> m_layouts;
+        // node map, GetView returns pointers to the views.
         Mist::tMap<TextureViewDescription, TextureView> m_views;
-        typedef Mist::tMap<TextureSubresourceRange, ImageLayout>::const_iterator LayoutConstIterator;
-        typedef Mist::tMap<TextureSubresourceRange, ImageLayout>::iterator LayoutIterator;
+        typedef Mist::tFlatMap<TextureSubresourceRange, ImageLayout>::const_iterator LayoutConstIterator;
+        typedef Mist::tFlatMap<TextureSubresourceRange, ImageLayout>::iterator LayoutIterator;
         typedef Mist::tMap<TextureViewDescription, TextureView>::iterator ViewIterator;
     private:
         Device* m_device;
@@ -626,7 +628,7 @@ namespace render
      * Sampler
      */
 
-    class Sampler final : public Mist::Ref<Sampler>
+    class Sampler final : public Mist::Ref<Sampler>, public Mist::tPoolObject<Sampler>
     {
     public:
 
@@ -655,7 +657,7 @@ namespace render
         Mist::String debugName;
     };
 
-    class Shader final : public Mist::Ref<Shader>
+    class Shader final : public Mist::Ref<Shader>, public Mist::tPoolObject<Shader>
     {
     public:
         Shader(Device* device)
@@ -747,7 +749,7 @@ namespace render
         inline Rect GetScissor() const { return Rect(0, static_cast<float>(extent.width), 0, static_cast<float>(extent.height)); }
 	};
 
-    class RenderTarget final : public Mist::Ref<RenderTarget>
+    class RenderTarget final : public Mist::Ref<RenderTarget>, public Mist::tPoolObject<RenderTarget>
     {
     public:
 
@@ -996,7 +998,7 @@ namespace render
         inline bool operator!=(const BindingLayoutDescription& other) const { return !(*this == other); }
     };
 
-    class BindingLayout final : public Mist::Ref<BindingLayout>
+    class BindingLayout final : public Mist::Ref<BindingLayout>, public Mist::tPoolObject<BindingLayout>
     {
     public:
         static constexpr uint32_t MaxLayouts = 8;
@@ -1135,7 +1137,7 @@ namespace render
         }
     };
 
-    class BindingSet final : public Mist::Ref<BindingSet>
+    class BindingSet final : public Mist::Ref<BindingSet>, public Mist::tPoolObject<BindingSet>
     {
     public:
         static constexpr uint32_t MaxBindingSets = 8;
@@ -1233,7 +1235,7 @@ namespace render
         }
     };
 
-	class GraphicsPipeline : public Mist::Ref<GraphicsPipeline>
+	class GraphicsPipeline : public Mist::Ref<GraphicsPipeline>, public Mist::tPoolObject<GraphicsPipeline>
 	{
 	public:
 		GraphicsPipeline(Device* device)
@@ -1266,7 +1268,7 @@ namespace render
         }
     };
 
-    class ComputePipeline : public Mist::Ref<ComputePipeline>
+    class ComputePipeline : public Mist::Ref<ComputePipeline>, public Mist::tPoolObject<ComputePipeline>
     {
     public:
         ComputePipeline(Device* device)
@@ -1294,7 +1296,7 @@ namespace render
         uint32_t count;
     };
 
-    class QueryPool : public Mist::Ref<QueryPool>
+    class QueryPool : public Mist::Ref<QueryPool>, public Mist::tPoolObject<QueryPool>
     {
     public:
         QueryPool(Device* device, const QueryPoolDescription& description)
@@ -1474,6 +1476,7 @@ namespace render
         uint32_t drawCalls;
         uint32_t rts;
         uint32_t pipelines;
+        uint32_t bindingSets;
     };
 
     struct BlitDescription
@@ -1496,7 +1499,7 @@ namespace render
         TextureSubresourceLayer dstLayer;
     };
 
-    class CommandList final : public Mist::Ref<CommandList>
+    class CommandList final : public Mist::Ref<CommandList>, public Mist::tPoolObject<CommandList>
     {
     public:
 
@@ -1586,6 +1589,8 @@ namespace render
         Mist::String name;
         bool enableValidationLayer;
         const void* windowHandle;
+        // no surface nor swapchain, frames are rendered to offscreen images (works on software ICDs).
+        bool headless;
     };
 
     class Device
@@ -1599,6 +1604,8 @@ namespace render
             Format format;
             VkSwapchainKHR swapchain = VK_NULL_HANDLE;
             Mist::tDynArray<TextureHandle> images;
+            // layout the images must have when they are presented.
+            ImageLayout presentLayout = ImageLayout_PresentSrc;
         };
 
         Device(const DeviceDescription& description);
@@ -1683,6 +1690,8 @@ namespace render
         void InitMemoryContext();
         void InitQueue();
         void InitSwapchain(uint32_t width, uint32_t height);
+        void InitOffscreenSwapchain(uint32_t width, uint32_t height);
+        void TransitionSwapchainImages();
         void DestroyMemoryContext();
         void DestroyContext();
         void DestroyQueue();
@@ -1695,6 +1704,8 @@ namespace render
 
         Swapchain m_swapchain;
         uint32_t m_swapchainIndex;
+        // images acquired by offscreen swapchain, used in order.
+        uint32_t m_offscreenAcquireCount;
         Mist::tDynArray<Buffer*> m_bufferTracking;
         Mist::tDynArray<Texture*> m_textureTracking;
     };
@@ -16,9 +16,9 @@
 #ifdef SHADER_DUMP_INFO
 #define shaderlabel "[shaders] "
 #define shaderlog(fmt) loginfo(shaderlabel fmt)
-#define shaderlogf(fmt, ...) logfinfo(shaderlabel fmt, __VA_ARGS__)
+#define shaderlogf(fmt, ...) logfinfo(shaderlabel fmt, ##__VA_ARGS__)
 #define profile_shader_scope(scope_name, msg) PROFILE_SCOPE_LOG(scope_name, msg)
-#define profile_shader_scope_f(scope_name, fmt, ...) PROFILE_SCOPE_LOGF(scope_name, fmt, __VA_ARGS__)
+#define profile_shader_scope_f(scope_name, fmt, ...) PROFILE_SCOPE_LOGF(scope_name, fmt, ##__VA_ARGS__)
 #else
 #define shaderlog(fmt) DUMMY_MACRO
 #define shaderlogf(fmt, ...) DUMMY_MACRO
@@ -126,13 +126,12 @@ namespace render
                 shaderc_include_result* result = _new shaderc_include_result;
 
                 Mist::cAssetPath path(requestedSource);
-                char* content = nullptr;
-                size_t contentSize;
-                check(Mist::FileSystem::ReadFile(path.c_str(), &content, contentSize));
-                check(content);
-                result->content = content;
-                result->content_length = contentSize;
-                result->user_data = nullptr;
+                // the view lives until shaderc releases the include.
+                Mist::cMappedFile* file = _new Mist::cMappedFile();
+                check(file->Open(path.c_str()));
+                result->content = file->GetSize() ? file->GetText() : "";
+                result->content_length = file->GetSize();
+                result->user_data = file;
                 result->source_name_length = path.GetSize() + 1;
                 char* sourceName = _new char[result->source_name_length];
                 strcpy_s(sourceName, result->source_name_length, path.c_str());
@@ -145,8 +144,8 @@ namespace render
             {
                 if (data)
                 {
-                    delete data->content;
-                    delete data->source_name;
+                    delete static_cast<Mist::cMappedFile*>(data->user_data);
+                    delete[] data->source_name;
                     delete data;
                 }
             }
@@ -267,55 +266,104 @@ namespace render
             return true;
         }
 
-        bool ContainsNewerFileInIncludes_Recursive(const Mist::cAssetPath& rootPath, const char* filepath, const CompilationOptions* options)
-        {
-            // current dependency path
-            Mist::cAssetPath assetPath(filepath);
-
-            // binary filepath from root. We need to compare include files with the final result.
-            char binaryFilepath[1024];
-            GenerateSpvFileName(binaryFilepath, rootPath, *options);
-
-            if (Mist::FileSystem::IsFileNewerThanOther(assetPath, binaryFilepath))
-                return true;
+        // calls visitor with the include paths of the file, in order, until it returns false.
+        typedef bool (*IncludeVisitor)(const char* includePath, void* userData);
 
-            size_t contentSize;
-            char* content;
-            check(Mist::FileSystem::ReadTextFile(assetPath, &content, contentSize));
-            char* it = content;
-            bool containsNewerFile = false;
-            while (it = strstr(it, "#include"))
+        void VisitIncludes(const Mist::cAssetPath& assetPath, IncludeVisitor visitor, void* userData)
+        {
+            // scan the read only view, dependency paths are copied out to be null terminated.
+            Mist::cMappedFile file;
+            check(file.Open(assetPath));
+            const char* it = file.GetText();
+            const char* end = it + file.GetSize();
+            static constexpr char IncludeToken[] = "#include";
+            // token length without terminator
+            static constexpr size_t TokenLength = sizeof(IncludeToken) - 1;
+            while (it && end - it > (ptrdiff_t)TokenLength)
             {
-                // #include length
-                size_t tokenLength = 8;
-                it += tokenLength;
+                it = static_cast<const char*>(memchr(it, '#', end - it - TokenLength));
+                if (!it)
+                    break;
+                if (strncmp(it, IncludeToken, TokenLength))
+                {
+                    ++it;
+                    continue;
+                }
+                it += TokenLength;
                 // After include always at least one space
                 check(*it == ' ');
                 // Looking for open token " or <
-                while (*it == ' ') ++it;
-                check((*it == '"' || *it == '<') && "Unexpected token. Expected '\"' or '<' after include preprocessor instruction.");
+                while (it < end && *it == ' ') ++it;
+                check(it < end && (*it == '"' || *it == '<') && "Unexpected token. Expected '\"' or '<' after include preprocessor instruction.");
                 // Determinate matching close token
                 char closeToken = (*it == '"') ? '"' : '>';
                 ++it;
                 // After open token we have the path
-                char* dependencyPath = it;
+                const char* dependencyBegin = it;
                 // Find close token
-                while (*it && *it != '\r' && *it != '\n' && *it != closeToken) ++it;
-                check(*it == closeToken && "Unexpected close token. Expected '\"' or '>' to close include preprocessor instruction.");
-                // In close token, terminate string dependencyPath
-                *it = 0;
+                while (it < end && *it != '\r' && *it != '\n' && *it != closeToken) ++it;
+                check(it < end && *it == closeToken && "Unexpected close token. Expected '\"' or '>' to close include preprocessor instruction.");
+                char dependencyPath[256];
+                size_t dependencyLen = (size_t)(it - dependencyBegin);
+                check(dependencyLen < sizeof(dependencyPath));
+                memcpy(dependencyPath, dependencyBegin, dependencyLen);
+                dependencyPath[dependencyLen] = 0;
                 ++it;
-                // Build complete asset path and register it.
-                // Keep building dependencies inside current dependency.
-                if (ContainsNewerFileInIncludes_Recursive(rootPath, dependencyPath, options))
-                {
-                    containsNewerFile = true;
-                    logfwarn("Shader dependency newer than compiled binary (%s > %s)\n", dependencyPath, rootPath);
+                if (!visitor(dependencyPath, userData))
                     break;
-                }
             }
-            delete[] content;
-            return containsNewerFile;
+        }
+
+        struct NewerIncludeContext
+        {
+            const Mist::cAssetPath* rootPath;
+            const CompilationOptions* options;
+            bool containsNewerFile;
+        };
+
+        bool ContainsNewerFileInIncludes_Recursive(const Mist::cAssetPath& rootPath, const char* filepath, const CompilationOptions* options)
+        {
+            // current dependency path
+            Mist::cAssetPath assetPath(filepath);
+
+            // binary filepath from root. We need to compare include files with the final result.
+            char binaryFilepath[1024];
+            GenerateSpvFileName(binaryFilepath, rootPath, *options);
+
+            if (Mist::FileSystem::IsFileNewerThanOther(assetPath, binaryFilepath))
+                return true;
+
+            // Keep building dependencies inside current dependency.
+            NewerIncludeContext context = { &rootPath, options, false };
+            VisitIncludes(assetPath, [](const char* dependencyPath, void* userData)
+                {
+                    NewerIncludeContext& context = *static_cast<NewerIncludeContext*>(userData);
+                    if (!ContainsNewerFileInIncludes_Recursive(*context.rootPath, dependencyPath, context.options))
+                        return true;
+                    context.containsNewerFile = true;
+                    logfwarn("Shader dependency newer than compiled binary (%s > %s)\n", dependencyPath, context.rootPath->c_str());
+                    return false;
+                }, &context);
+            return context.containsNewerFile;
+        }
+
+        void CollectDependencies_Recursive(const char* filepath, Mist::tDynArray<Mist::String>& dependencies)
+        {
+            VisitIncludes(Mist::cAssetPath(filepath), [](const char* dependencyPath, void* userData)
+                {
+                    Mist::tDynArray<Mist::String>& dependencies = *static_cast<Mist::tDynArray<Mist::String>*>(userData);
+                    char normalized[256];
+                    check(Mist::FileSystem::NormalizePath(dependencyPath, normalized, sizeof(normalized)));
+                    // shared includes are visited once.
+                    for (uint32_t i = 0; i < (uint32_t)dependencies.size(); ++i)
+                    {
+                        if (!strcmp(dependencies[i].c_str(), normalized))
+                            return true;
+                    }
+                    dependencies.push_back(normalized);
+                    CollectDependencies_Recursive(dependencyPath, dependencies);
+                    return true;
+                }, &dependencies);
         }
 
         bool ShouldRecompileShaderFile(const char* filepath, const CompilationOptions* compileOptions)
@@ -327,13 +375,19 @@ namespace render
             return ContainsNewerFileInIncludes_Recursive(assetPath, filepath, compileOptions);
         }
 
+        void GetShaderDependencies(const char* filepath, Mist::tDynArray<Mist::String>& dependencies)
+        {
+            check(filepath && *filepath);
+            dependencies.clear();
+            CollectDependencies_Recursive(filepath, dependencies);
+        }
+
         CompiledBinary Compile(const char* filepath, ShaderType shaderType, const CompilationOptions* additionalOptions)
         {
             profile_shader_scope_f(Compile, "Compile shader (%s)", filepath);
-            char* source;
-            size_t s;
             Mist::cAssetPath path(filepath);
-            check(Mist::FileSystem::ReadFile(path, &source, s));
+            Mist::cMappedFile source;
+            check(source.Open(path));
 
             shaderc::Compiler compiler;
             shaderc::CompileOptions options;
@@ -365,7 +419,7 @@ namespace render
             }
 
             shaderc_shader_kind kind = GetShaderType(shaderType);
-            shaderc::PreprocessedSourceCompilationResult prepRes = compiler.PreprocessGlsl(source, s, kind, path, options);
+            shaderc::PreprocessedSourceCompilationResult prepRes = compiler.PreprocessGlsl(source.GetSize() ? source.GetText() : "", source.GetSize(), kind, path, options);
             if (!HandleError(prepRes, "preprocess"))
                 return CompiledBinary();
 
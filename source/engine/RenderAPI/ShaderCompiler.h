@@ -158,6 +158,9 @@ namespace render
         void FreeBinary(CompiledBinary& binary);
 
         CompiledBinary BuildShader(const char* filepath, ShaderType type, const CompilationOptions* additionalOptions = nullptr, bool forceCompilation = false);
+        // files included by the shader source, recursively, relative to the workspace and normalized
+        // with FileSystem::NormalizePath. The source itself is not listed.
+        void GetShaderDependencies(const char* filepath, Mist::tDynArray<Mist::String>& dependencies);
         bool BuildShaderParams(const CompiledBinary& bin, ShaderType type, ShaderReflectionProperties& outProperties);
     }
 }
\ No newline at end of file
@@ -32,7 +32,7 @@
 #define MESH_DUMP_LOAD_INFO
 #ifdef MESH_DUMP_LOAD_INFO
 #define loadmeshlabel "[loadmesh] "
-#define loadmeshlogf(fmt, ...) logfinfo(loadmeshlabel fmt, __VA_ARGS__)
+#define loadmeshlogf(fmt, ...) logfinfo(loadmeshlabel fmt, ##__VA_ARGS__)
 #define loadmeshlog(fmt, ...) loginfo(loadmeshlabel fmt)
 #else
 #define loadmeshlogf(fmt, ...) DUMMY_MACRO
@@ -8,10 +8,14 @@
 #include "ModelLoader.h"
 #include <imgui.h>
 #include "Utils/TimeUtils.h"
+#include "Core/SystemMemory.h"
 
 Mist::CIntVar CVar_ForceFrameSync("r_forceframesync", 0);
 Mist::CIntVar CVar_GpuProfiling("r_gpuProfiling", 0);
 Mist::CIntVar CVar_GpuProfilingRatio("r_gpuProfilingRatio", 0);
+// Number of frames to sample looking for general heap allocations between BeginFrame and EndFrame.
+// Reports the result and goes back to 0.
+Mist::CIntVar CVar_FrameHeapAllocCheck("r_frameHeapAllocCheck", 0);
 
 namespace rendersystem
 {
@@ -236,11 +240,17 @@ namespace rendersystem
         m_frame = 0;
         m_swapchainIndex = UINT32_MAX;
         m_memoryContextId = UINT32_MAX;
+        m_frameHeapAllocStart = 0;
+        m_frameHeapAllocs = 0;
+        Mist::InitFrameAllocator();
+        for (uint32_t i = 0; i < Mist::globals::MaxOverlappedFrames; ++i)
+            m_frameResources[i] = FrameResourceTrack(Mist::GetFrameAllocator(i));
         {
             render::DeviceDescription desc;
             desc.enableValidationLayer = true;
             desc.name = "lasjd";
             desc.windowHandle = window->GetWindowHandle();
+            desc.headless = !window->GetWindowNative();
             m_device = _new render::Device(desc);
         }
         const render::Device::Swapchain& swapchain = m_device->GetSwapchain();
@@ -335,6 +345,9 @@ namespace rendersystem
         m_computePsoMap.clear();
         m_cmd = nullptr;
         m_frameSyncronization.Destroy();
+        for (uint32_t i = 0; i < Mist::globals::MaxOverlappedFrames; ++i)
+            m_frameResources[i].Clear();
+        Mist::TerminateFrameAllocator();
         m_ldrRt = nullptr;
         m_depthTexture = nullptr;
         m_ldrTexture = nullptr;
@@ -365,6 +378,17 @@ namespace rendersystem
         m_graphicsPsoMap.clear();
     }
 
+    uint32_t RenderSystem::ReloadShadersDependingOn(const Mist::tStringId* files, uint32_t count)
+    {
+        // most saves touch files no shader uses, don't stall the gpu for them.
+        if (!m_shaderDb.AnyDependsOn(files, count))
+            return 0;
+        m_device->WaitIdle();
+        uint32_t reloaded = m_shaderDb.ReloadDependingOn(files, count);
+        m_graphicsPsoMap.clear();
+        return reloaded;
+    }
+
     render::GraphicsPipelineHandle RenderSystem::GetPso(const render::GraphicsPipelineDescription& psoDesc, render::RenderTargetHandle rt)
     {
         PROF_ZONE_SCOPED("GetGraphicsPso");
@@ -574,19 +598,15 @@ namespace rendersystem
 
         // reserve shader properties in current shader context memory
         ShaderMemoryContext* memoryContext = GetMemoryContext();
-        const render::shader_compiler::ShaderReflectionProperties& properties = *m_shaderContext.program->m_properties;
-        for (uint32_t i = 0; i < (uint32_t)properties.params.size(); ++i)
+        for (const auto& it : m_shaderContext.program->m_propertyMap)
         {
-            for (uint32_t j = 0; j < (uint32_t)properties.params[i].params.size(); ++j)
+            const render::shader_compiler::ShaderPropertyDescription& property = *it.second.property;
+            switch (property.type)
             {
-                const render::shader_compiler::ShaderPropertyDescription& property = properties.params[i].params[j];
-                switch (property.type)
-                {
-                case render::ResourceType_ConstantBuffer:
-                case render::ResourceType_VolatileConstantBuffer:
-                    memoryContext->ReserveProperty(property.name.c_str(), property.size);
-                    break;
-                }
+            case render::ResourceType_ConstantBuffer:
+            case render::ResourceType_VolatileConstantBuffer:
+                memoryContext->ReserveProperty(it.first, property.size);
+                break;
             }
         }
     }
@@ -599,7 +619,7 @@ namespace rendersystem
             : render::ImageLayout_ShaderReadOnly);
     }
 
-    void RenderSystem::SetTextureSlot(const char* id, const render::TextureHandle& texture)
+    void RenderSystem::SetTextureSlot(Mist::tStringId id, const render::TextureHandle& texture)
     {
         check(m_shaderContext.program);
         uint32_t setIndex;
@@ -609,6 +629,11 @@ namespace rendersystem
         SetTextureSlot(texture, setIndex, property->binding);
     }
 
+    void RenderSystem::SetTextureSlot(const char* id, const render::TextureHandle& texture)
+    {
+        SetTextureSlot(Mist::tStringId::Find(id), texture);
+    }
+
 	void RenderSystem::SetTextureSlot(const render::TextureHandle* textures, uint32_t count, uint32_t set, uint32_t binding /*= 0*/)
 	{
         check(count <= MaxTextureArrayCount);
@@ -618,7 +643,7 @@ namespace rendersystem
         m_shaderContext.MarkSetAsDirty(set);
 	}
 
-    void RenderSystem::SetTextureSlot(const char* id, const render::TextureHandle* textures, uint32_t count)
+    void RenderSystem::SetTextureSlot(Mist::tStringId id, const render::TextureHandle* textures, uint32_t count)
     {
         check(textures && count);
         if (count == 1)
@@ -636,6 +661,11 @@ namespace rendersystem
         }
     }
 
+    void RenderSystem::SetTextureSlot(const char* id, const render::TextureHandle* textures, uint32_t count)
+    {
+        SetTextureSlot(Mist::tStringId::Find(id), textures, count);
+    }
+
 	void RenderSystem::SetSampler(const render::SamplerHandle& sampler, uint32_t set, uint32_t binding, uint32_t samplerIndex)
     {
         check(samplerIndex < MaxTextureArrayCount);
@@ -643,22 +673,32 @@ namespace rendersystem
         m_shaderContext.samplerSlots[set][binding][samplerIndex] = sampler;
     }
 
-    void RenderSystem::SetSampler(const char* id, const render::SamplerHandle& sampler)
+    void RenderSystem::SetSampler(Mist::tStringId id, const render::SamplerHandle& sampler)
     {
         SetSampler(id, &sampler, 1);
     }
 
-    void RenderSystem::SetSampler(const char* id, render::Filter minFilter, render::Filter magFilter, render::Filter mipmapMode, render::SamplerAddressMode addressModeU, render::SamplerAddressMode addressModeV, render::SamplerAddressMode addressModeW, uint32_t samplerIndex)
+    void RenderSystem::SetSampler(const char* id, const render::SamplerHandle& sampler)
+    {
+        SetSampler(Mist::tStringId::Find(id), &sampler, 1);
+    }
+
+    void RenderSystem::SetSampler(Mist::tStringId id, render::Filter minFilter, render::Filter magFilter, render::Filter mipmapMode, render::SamplerAddressMode addressModeU, render::SamplerAddressMode addressModeV, render::SamplerAddressMode addressModeW, uint32_t samplerIndex)
     {
         SetSampler(id, GetSampler(minFilter, magFilter, mipmapMode, addressModeU, addressModeV, addressModeW));
     }
 
+    void RenderSystem::SetSampler(const char* id, render::Filter minFilter, render::Filter magFilter, render::Filter mipmapMode, render::SamplerAddressMode addressModeU, render::SamplerAddressMode addressModeV, render::SamplerAddressMode addressModeW, uint32_t samplerIndex)
+    {
+        SetSampler(Mist::tStringId::Find(id), GetSampler(minFilter, magFilter, mipmapMode, addressModeU, addressModeV, addressModeW));
+    }
+
     void RenderSystem::SetSampler(render::Filter minFilter, render::Filter magFilter, render::Filter mipmapMode, render::SamplerAddressMode addressModeU, render::SamplerAddressMode addressModeV, render::SamplerAddressMode addressModeW, uint32_t set, uint32_t binding, uint32_t samplerIndex)
     {
         SetSampler(GetSampler(minFilter, magFilter, mipmapMode, addressModeU, addressModeV, addressModeW), set, binding, samplerIndex);
     }
 
-	void RenderSystem::SetSampler(const char* id, const render::SamplerHandle* sampler, uint32_t count)
+	void RenderSystem::SetSampler(Mist::tStringId id, const render::SamplerHandle* sampler, uint32_t count)
 	{
         check(m_shaderContext.program);
         uint32_t setIndex;
@@ -668,16 +708,21 @@ namespace rendersystem
         SetSampler(sampler, count, setIndex, property->binding);
 	}
 
+	void RenderSystem::SetSampler(const char* id, const render::SamplerHandle* sampler, uint32_t count)
+	{
+        SetSampler(Mist::tStringId::Find(id), sampler, count);
+	}
+
 	void RenderSystem::SetSampler(const render::SamplerHandle* sampler, uint32_t count, uint32_t set, uint32_t binding /*= 0*/)
 	{
         for (uint32_t i = 0; i < count; ++i)
             SetSampler(sampler[i], set, binding, i);
 	}
 
-	void RenderSystem::SetShaderProperty(const char* id, const void* param, uint64_t size)
+	void RenderSystem::SetShaderProperty(Mist::tStringId id, const void* param, uint64_t size)
     {
         PROF_ZONE_SCOPED("SetShaderProperty");
-        check(id && *id && param && size);
+        check(id.IsValid() && param && size);
         ShaderMemoryContext* context = GetMemoryContext();
         context->WriteProperty(id, param, size);
         uint32_t setIndex = UINT32_MAX;
@@ -686,6 +731,12 @@ namespace rendersystem
         m_shaderContext.MarkSetAsDirty(setIndex);
     }
 
+    void RenderSystem::SetShaderProperty(const char* id, const void* param, uint64_t size)
+    {
+        check(id && *id);
+        SetShaderProperty(Mist::tStringId::Find(id), param, size);
+    }
+
     void RenderSystem::SetTextureLayout(const render::TextureHandle& texture, render::ImageLayout layout, render::TextureSubresourceRange range)
     {
         //check(!m_renderContext.cmd->IsInsideRenderPass());
@@ -708,9 +759,9 @@ namespace rendersystem
             SetTextureLayout(texture, render::ImageLayout_ColorAttachment);
     }
 
-    void RenderSystem::BindUAV(const char* id, const render::BufferHandle& buffer)
+    void RenderSystem::BindUAV(Mist::tStringId id, const render::BufferHandle& buffer)
     {
-        check(id && *id && buffer && m_shaderContext.program);
+        check(id.IsValid() && buffer && m_shaderContext.program);
         uint32_t setIndex = UINT32_MAX;
         const render::shader_compiler::ShaderPropertyDescription* property = m_shaderContext.program->GetPropertyDescription(id, &setIndex);
         check(property && setIndex != UINT32_MAX);
@@ -720,15 +771,26 @@ namespace rendersystem
         m_shaderContext.MarkSetAsDirty(setIndex);
     }
 
-    void RenderSystem::BindSRV(const char* id, const render::BufferHandle& buffer)
+    void RenderSystem::BindUAV(const char* id, const render::BufferHandle& buffer)
+    {
+        check(id && *id);
+        BindUAV(Mist::tStringId::Find(id), buffer);
+    }
+
+    void RenderSystem::BindSRV(Mist::tStringId id, const render::BufferHandle& buffer)
     {
         // todo??????????
         BindUAV(id, buffer);
     }
 
-    void RenderSystem::BindUAV(const char* id, const render::TextureHandle& texture)
+    void RenderSystem::BindSRV(const char* id, const render::BufferHandle& buffer)
+    {
+        BindSRV(Mist::tStringId::Find(id), buffer);
+    }
+
+    void RenderSystem::BindUAV(Mist::tStringId id, const render::TextureHandle& texture)
     {
-		check(id && *id && texture && m_shaderContext.program);
+		check(id.IsValid() && texture && m_shaderContext.program);
 		uint32_t setIndex = UINT32_MAX;
 		const render::shader_compiler::ShaderPropertyDescription* property = m_shaderContext.program->GetPropertyDescription(id, &setIndex);
 		check(property && property->type == render::ResourceType_TextureUAV);
@@ -737,6 +799,12 @@ namespace rendersystem
         SetTextureSlot(texture, setIndex, property->binding, 0, render::ImageLayout_General);
     }
 
+    void RenderSystem::BindUAV(const char* id, const render::TextureHandle& texture)
+    {
+        check(id && *id);
+        BindUAV(Mist::tStringId::Find(id), texture);
+    }
+
     void RenderSystem::SetRenderTarget(render::RenderTargetHandle rt)
     {
         m_graphicsContext.graphicsState.rt = rt;
@@ -891,7 +959,7 @@ namespace rendersystem
         SetDefaultGraphicsState();
         SetRenderTarget(GetPresentRt());
         SetShader(m_screenQuadCopy.shader);
-        SetTextureSlot("tex", texture);
+        SetTextureSlot(STRING_ID("tex"), texture);
         DrawFullscreenQuad();
         SetDefaultGraphicsState();
         ClearState();
@@ -907,6 +975,7 @@ namespace rendersystem
         ImGui::Text("Tris:              %7d", m_cmdStats.tris);
         ImGui::Text("DrawCalls:         %7d", m_cmdStats.drawCalls);
         ImGui::Text("Pipelines:         %7d", m_cmdStats.pipelines);
+        ImGui::Text("Binding sets:      %7d", m_cmdStats.bindingSets);
         ImGui::Text("Render targets:    %7d", m_cmdStats.rts);
         ImGui::Text("Swapchains (%d):   %1d %1d %1d %1d %1d %1d",
             m_frameSyncronization.count,
@@ -917,6 +986,11 @@ namespace rendersystem
             m_swapchainHistoric.Get(4),
             m_swapchainHistoric.Get(5));
 
+        ImGui::SeparatorText("Cpu memory");
+        const Mist::tLinearAllocator* frameArena = Mist::GetFrameAllocator();
+        ImGui::Text("Heap allocs/frame: %7d", m_frameHeapAllocs);
+        ImGui::Text("Frame arena:       %7lld kb (peak %lld kb/%lld kb)", frameArena->GetUsed() / 1024, frameArena->GetPeak() / 1024, frameArena->GetCapacity() / 1024);
+
         ImGui::SeparatorText("Gpu memory");
         const render::MemoryContext& memstats = m_device->GetContext().memoryContext;
         ImGui::Text("Buffers:           %7d (%9d b/%9d b)", memstats.bufferStats.allocationCounts,
@@ -1097,18 +1171,33 @@ namespace rendersystem
             GpuFrameProfiler::ImGuiDrawQueryTree("Gpu profiling", m_lastQueryTree);
     }
 
+    void RenderSystem::BeginUIFrame()
+    {
+        ui::BeginFrame();
+        // query tree of the last frame resolved by BeginFrame.
+        ImGuiDrawGpuProfiler();
+    }
+
+    void RenderSystem::EndUIFrame()
+    {
+        ui::EndFrame();
+    }
+
     void RenderSystem::BeginFrame()
     {
         CPU_PROFILE_SCOPE(RenderSystem_BeginFrame);
         check(m_swapchainIndex == UINT32_MAX);
+        m_frameHeapAllocStart = Mist::GetMemoryStats().TotalAllocationCount;
         m_frame++;
 
-        ui::BeginFrame();
-        
         SetDefaultGraphicsState();
         ClearState();
         m_cmdStats = GetCommandList()->GetStats();
         GetCommandList()->ResetStats();
+        Mist::Profiling::GRenderStats.TrianglesCount = m_cmdStats.tris;
+        Mist::Profiling::GRenderStats.DrawCalls = m_cmdStats.drawCalls;
+        Mist::Profiling::GRenderStats.SetBindingCount = m_cmdStats.bindingSets;
+        Mist::Profiling::GRenderStats.ShaderProgramCount = m_cmdStats.pipelines;
 
         if (CVar_ForceFrameSync.Get())
         {
@@ -1123,6 +1212,12 @@ namespace rendersystem
 			// wait for last frame before acquire swapchain image
 			if (GetPresentSubmissionId())
 				m_device->WaitForSubmissionId(GetPresentSubmissionId());
+            // swapchain can have more images than frame arenas, be sure the arena is retired too.
+            FrameResourceTrack& resources = GetFrameResources();
+            if (resources.submissionId)
+                m_device->WaitForSubmissionId(resources.submissionId);
+            resources.Clear();
+            Mist::FrameAllocator_BeginFrame(m_frame);
 		}
 
         {
@@ -1136,7 +1231,6 @@ namespace rendersystem
         m_gpuTime = GetFrameProfiler().GetTimestamp("Frame");
         if (CVar_GpuProfilingRatio.Get() == 0 || !(m_frame % CVar_GpuProfilingRatio.Get()))
             m_lastQueryTree = GetFrameProfiler().GetData();
-        ImGuiDrawGpuProfiler();
 
 		{
             CPU_PROFILE_SCOPE(RenderSystem_PrepareCmdQueue);
@@ -1146,7 +1240,6 @@ namespace rendersystem
 			m_memoryPool->ProcessInFlight();
 			commandQueue->AddWaitSemaphore(presentSemaphore, 0);
 			commandQueue->AddSignalSemaphore(renderSemaphore, 0);
-			GetFrameResources().Clear();
 		}
 
         CreateMemoryContext();
@@ -1158,12 +1251,12 @@ namespace rendersystem
     void RenderSystem::EndFrame()
     {
         CPU_PROFILE_SCOPE(RenderSystem_EndFrame);
-        ui::EndFrame(GetCommandList());
+        ui::Draw(GetCommandList());
 
         BeginMarker("CopyToPresent");
         CopyToPresentRt(m_ldrTexture);
         ClearState();
-        GetCommandList()->SetTextureState(render::TextureBarrier{ GetPresentRt()->m_description.colorAttachments[0].texture, render::ImageLayout_PresentSrc});
+        GetCommandList()->SetTextureState(render::TextureBarrier{ GetPresentRt()->m_description.colorAttachments[0].texture, m_device->GetSwapchain().presentLayout});
         EndMarker();
 
         EndMarker(); // frame marker
@@ -1180,8 +1273,30 @@ namespace rendersystem
 
         SubmitMemoryContext(submissionId);
         SetPresentSubmissionId(submissionId);
+        GetFrameResources().submissionId = submissionId;
         m_swapchainHistoric.Push(m_swapchainIndex);
         m_swapchainIndex = UINT32_MAX;
+        CheckFrameHeapAllocations();
+    }
+
+    void RenderSystem::CheckFrameHeapAllocations()
+    {
+        m_frameHeapAllocs = (uint32_t)(Mist::GetMemoryStats().TotalAllocationCount - m_frameHeapAllocStart);
+        if (CVar_FrameHeapAllocCheck.Get() <= 0)
+            return;
+        m_frameHeapAllocCheck.frames++;
+        m_frameHeapAllocCheck.maxAllocs = __max(m_frameHeapAllocCheck.maxAllocs, m_frameHeapAllocs);
+        m_frameHeapAllocCheck.totalAllocs += m_frameHeapAllocs;
+        if (m_frameHeapAllocCheck.frames >= (uint32_t)CVar_FrameHeapAllocCheck.Get())
+        {
+            if (m_frameHeapAllocCheck.maxAllocs)
+                logferror("Frame heap allocation check failed: %d frames, %lld allocations (max %d in a single frame).\n",
+                    m_frameHeapAllocCheck.frames, m_frameHeapAllocCheck.totalAllocs, m_frameHeapAllocCheck.maxAllocs);
+            else
+                logfok("Frame heap allocation check passed: %d frames without general heap allocations.\n", m_frameHeapAllocCheck.frames);
+            m_frameHeapAllocCheck = {};
+            CVar_FrameHeapAllocCheck.Set(0);
+        }
     }
 
     void RenderSystem::BeginMarker(const char* name, render::Color color)
@@ -1497,6 +1612,7 @@ namespace rendersystem
             break;
         }
         check(IsLoaded());
+        BuildDependencies();
     }
 
     bool ShaderProgram::IsLoaded() const
@@ -1518,26 +1634,75 @@ namespace rendersystem
         if (m_properties)
             delete m_properties;
         m_properties = nullptr;
+        m_propertyMap.clear();
+    }
+
+    const render::shader_compiler::ShaderPropertyDescription* ShaderProgram::GetPropertyDescription(Mist::tStringId id, uint32_t* setIndexOut) const
+    {
+        auto it = m_propertyMap.find(id);
+        if (it == m_propertyMap.end())
+        {
+            if (setIndexOut)
+                *setIndexOut = UINT32_MAX;
+            return nullptr;
+        }
+        if (setIndexOut)
+            *setIndexOut = it->second.setIndex;
+        return it->second.property;
     }
 
     const render::shader_compiler::ShaderPropertyDescription* ShaderProgram::GetPropertyDescription(const char* id, uint32_t* setIndexOut) const
     {
+        return GetPropertyDescription(Mist::tStringId::Find(id), setIndexOut);
+    }
+
+    void ShaderProgram::BuildPropertyMap()
+    {
+        check(m_properties);
+        m_propertyMap.clear();
         for (uint32_t i = 0; i < (uint32_t)m_properties->params.size(); ++i)
         {
             for (uint32_t j = 0; j < (uint32_t)m_properties->params[i].params.size(); ++j)
             {
-                const render::shader_compiler::ShaderPropertyDescription* property = &m_properties->params[i].params[j];
-                if (!strcmp(property->name.c_str(), id))
-                {
-                    if (setIndexOut)
-                        *setIndexOut = m_properties->params[i].setIndex;
-                    return property;
-                }
+                PropertyLocation location;
+                location.property = &m_properties->params[i].params[j];
+                location.setIndex = m_properties->params[i].setIndex;
+                // first declaration wins, same as the previous linear search.
+                m_propertyMap.try_emplace(Mist::tStringId(location.property->name.c_str()), location);
             }
         }
-        if (setIndexOut)
-            *setIndexOut = UINT32_MAX;
-        return nullptr;
+    }
+
+    bool ShaderProgram::DependsOn(const Mist::tStringId* files, uint32_t count) const
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            for (uint32_t j = 0; j < (uint32_t)m_dependencies.size(); ++j)
+            {
+                if (files[i] == m_dependencies[j])
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    void ShaderProgram::BuildDependencies()
+    {
+        m_dependencies.clear();
+        const ShaderFileDescription* stages[] = { &m_description->vsDesc, &m_description->fsDesc, &m_description->csDesc };
+        Mist::tDynArray<Mist::String> includes;
+        char normalized[256];
+        for (const ShaderFileDescription* stage : stages)
+        {
+            if (stage->filePath.empty())
+                continue;
+            check(Mist::FileSystem::NormalizePath(stage->filePath.c_str(), normalized, sizeof(normalized)));
+            m_dependencies.push_back(Mist::tStringId(normalized));
+            render::shader_compiler::GetShaderDependencies(stage->filePath.c_str(), includes);
+            // includes shared by the stages are listed twice, harmless for DependsOn.
+            for (const Mist::String& include : includes)
+                m_dependencies.push_back(Mist::tStringId(include.c_str()));
+        }
     }
 
     bool ShaderProgram::ReloadGraphics()
@@ -1574,6 +1739,7 @@ namespace rendersystem
         const render::shader_compiler::ShaderReflectionProperties& prop = compiler.GetReflectionProperties();
         m_properties->params = std::move(prop.params);
         m_properties->pushConstantMap = std::move(prop.pushConstantMap);
+        BuildPropertyMap();
         m_inputLayout = compiler.GetVertexInputLayout();
 
         m_vs = compiler.GetShader(render::ShaderType_Vertex);
@@ -1607,6 +1773,7 @@ namespace rendersystem
         const render::shader_compiler::ShaderReflectionProperties& prop = compiler.GetReflectionProperties();
         m_properties->params = std::move(prop.params);
         m_properties->pushConstantMap = std::move(prop.pushConstantMap);
+        BuildPropertyMap();
 
         m_cs = compiler.GetShader(render::ShaderType_Compute);
         return true;
@@ -1696,7 +1863,7 @@ namespace rendersystem
         return *this;
     }
 
-    void ShaderMemoryContext::ReserveProperty(const char* id, uint64_t size)
+    void ShaderMemoryContext::ReserveProperty(Mist::tStringId id, uint64_t size)
     {
         check(m_pointer == m_device->AlignUniformSize(m_pointer));
         check(size);
@@ -1729,7 +1896,7 @@ namespace rendersystem
         m_pointer += size;
     }
 
-    void ShaderMemoryContext::WriteProperty(const char* id, const void* data, uint64_t size)
+    void ShaderMemoryContext::WriteProperty(Mist::tStringId id, const void* data, uint64_t size)
     {
         size = m_device->AlignUniformSize(size);
         ReserveProperty(id, size);
@@ -1739,7 +1906,7 @@ namespace rendersystem
         Write(data, size, 0, property->offset);
     }
 
-    const ShaderMemoryContext::PropertyMemory* ShaderMemoryContext::GetProperty(const char* id) const
+    const ShaderMemoryContext::PropertyMemory* ShaderMemoryContext::GetProperty(Mist::tStringId id) const
     {
         auto it = m_properties.find(id);
         if (it == m_properties.end())
@@ -1946,7 +2113,6 @@ namespace rendersystem
         renderQueueSemaphores = (render::SemaphoreHandle*)_malloc(sizeof(render::SemaphoreHandle) * frameCount);
         presentSemaphores = (render::SemaphoreHandle*)_malloc(sizeof(render::SemaphoreHandle) * frameCount);
         presentSubmission = (uint64_t*)_malloc(sizeof(uint64_t) * frameCount);
-        frameResources = (FrameResourceTrack*)_malloc(sizeof(FrameResourceTrack) * frameCount);
         timestampQueries = (GpuFrameProfiler*)_malloc(sizeof(GpuFrameProfiler) * frameCount);
         
         char buff[32];
@@ -1963,8 +2129,6 @@ namespace rendersystem
 
 		    presentSubmission[i] = 0;
 
-            new (&frameResources[i]) FrameResourceTrack();
-
 		    sprintf_s(buff, "timestamp query %d", i);
             new (&timestampQueries[i]) GpuFrameProfiler(device);
 		    device->SetDebugName(timestampQueries[i].GetPool().GetPtr(), buff);
@@ -1978,14 +2142,12 @@ namespace rendersystem
 			renderQueueSemaphores[i] = nullptr;
 			presentSemaphores[i] = nullptr;
 			presentSubmission[i] = 0;
-            frameResources[i].Clear();
 			timestampQueries[i].~GpuFrameProfiler();
 		}
 
         Mist::Free(renderQueueSemaphores);
         Mist::Free(presentSemaphores);
         Mist::Free(presentSubmission);
-        Mist::Free(frameResources);
         Mist::Free(timestampQueries);
         memset(this, 0, sizeof(FrameSyncContext));
     }
@@ -5,6 +5,9 @@
 #include "RenderAPI/ShaderCompiler.h"
 #include <glm/glm.hpp>
 #include "Utils/FileSystem.h"
+#include "Core/FrameAllocator.h"
+#include "Core/StringId.h"
+#include "Render/Globals.h"
 
 namespace rendersystem
 {
@@ -128,7 +131,7 @@ namespace rendersystem
         render::BindingLayoutHandle GetCachedLayout(const render::BindingLayoutDescription& desc);
     private:
         render::Device* m_device;
-        Mist::tMap<render::BindingLayoutDescription, render::BindingLayoutHandle> m_cache;
+        Mist::tFlatMap<render::BindingLayoutDescription, render::BindingLayoutHandle> m_cache;
     };
 
     class BindingCache
@@ -142,7 +145,7 @@ namespace rendersystem
         float GetMaxLoadFactor() const { return m_cache.max_load_factor(); }
     private:
         render::Device* m_device;
-        Mist::tMap<render::BindingSetDescription, render::BindingSetHandle> m_cache;
+        Mist::tFlatMap<render::BindingSetDescription, render::BindingSetHandle> m_cache;
         BindingLayoutCache m_layoutCache;
     };
 
@@ -163,9 +166,9 @@ namespace rendersystem
         ShaderMemoryContext& operator=(const ShaderMemoryContext& other);
         ShaderMemoryContext& operator=(ShaderMemoryContext&& rvl);
 
-        void ReserveProperty(const char* id, uint64_t size);
-        void WriteProperty(const char* id, const void* data, uint64_t size);
-        const PropertyMemory* GetProperty(const char* id) const;
+        void ReserveProperty(Mist::tStringId id, uint64_t size);
+        void WriteProperty(Mist::tStringId id, const void* data, uint64_t size);
+        const PropertyMemory* GetProperty(Mist::tStringId id) const;
 
         void BeginFrame();
         void FlushMemory();
@@ -185,7 +188,7 @@ namespace rendersystem
         Mist::tDynArray<render::BufferHandle> m_buffers;
         Mist::tDynArray<uint32_t> m_freeBuffers;
         Mist::tDynArray<uint32_t> m_usedBuffers;
-        Mist::tMap<Mist::String, PropertyMemory> m_properties;
+        Mist::tFlatMap<Mist::tStringId, PropertyMemory> m_properties;
     };
 
     class ShaderMemoryPool
@@ -218,7 +221,7 @@ namespace rendersystem
         render::Device* m_device;
         HeapArray<render::TextureHandle> m_textures;
         uint32_t m_pushIndex;
-        Mist::tMap<Mist::String, uint32_t> m_map;
+        Mist::tFlatMap<Mist::String, uint32_t, Mist::tStringHash, Mist::tStringEqualTo> m_map;
     };
 
     class SamplerCache
@@ -232,7 +235,7 @@ namespace rendersystem
         float GetMaxLoadFactor() const { return m_samplers.max_load_factor(); }
     public:
         render::Device* m_device;
-        Mist::tMap<render::SamplerDescription, render::SamplerHandle> m_samplers;
+        Mist::tFlatMap<render::SamplerDescription, render::SamplerHandle> m_samplers;
     };
 
     struct ShaderFileDescription
@@ -293,16 +296,30 @@ namespace rendersystem
         void Reload();
         bool IsLoaded() const;
         void ReleaseResources();
+        // true if any of the files is a stage source or an include of them. Files are interned workspace
+        // paths normalized with FileSystem::NormalizePath.
+        bool DependsOn(const Mist::tStringId* files, uint32_t count) const;
 
         render::ShaderHandle GetVertexShader() const { return m_vs; }
         render::ShaderHandle GetFragmentShader() const { return m_fs; }
         render::ShaderHandle GetComputeShader() const { return m_cs; }
 
+        const render::shader_compiler::ShaderPropertyDescription* GetPropertyDescription(Mist::tStringId id, uint32_t* setIndexOut) const;
         const render::shader_compiler::ShaderPropertyDescription* GetPropertyDescription(const char* id, uint32_t* setIndexOut) const;
 
+        struct PropertyLocation
+        {
+            const render::shader_compiler::ShaderPropertyDescription* property = nullptr;
+            uint32_t setIndex = UINT32_MAX;
+        };
+
     private:
         bool ReloadGraphics();
         bool ReloadCompute();
+        // index reflection properties by interned name.
+        void BuildPropertyMap();
+        // stage sources and their includes, rebuilt on reload since includes may have changed.
+        void BuildDependencies();
 
         render::Device* m_device;
     public:
@@ -311,6 +328,8 @@ namespace rendersystem
         render::ShaderHandle m_cs;
         render::VertexInputLayout m_inputLayout;
         render::shader_compiler::ShaderReflectionProperties* m_properties;
+        Mist::tFlatMap<Mist::tStringId, PropertyLocation> m_propertyMap;
+        Mist::tDynArray<Mist::tStringId> m_dependencies;
         ShaderBuildDescription* m_description;
     };
 
@@ -362,6 +381,30 @@ namespace rendersystem
             }
         }
 
+        bool AnyDependsOn(const Mist::tStringId* files, uint32_t count) const
+        {
+            for (uint32_t i = 0; i < (uint32_t)m_programs.size(); ++i)
+            {
+                if (m_programs[i]->DependsOn(files, count))
+                    return true;
+            }
+            return false;
+        }
+
+        uint32_t ReloadDependingOn(const Mist::tStringId* files, uint32_t count)
+        {
+            uint32_t reloaded = 0;
+            for (uint32_t i = 0; i < (uint32_t)m_programs.size(); ++i)
+            {
+                if (!m_programs[i]->DependsOn(files, count))
+                    continue;
+                m_programs[i]->Reload();
+                check(m_programs[i]->IsLoaded());
+                ++reloaded;
+            }
+            return reloaded;
+        }
+
 
         Mist::tDynArray<ShaderProgram*> m_programs;
     };
@@ -453,17 +496,21 @@ namespace rendersystem
         };
 
         // Data struct for keeping tracking of resources used in each frame.
-        // Once the submission is completed, call Clear() method.
+        // Storage lives in the frame arena, once the submission is completed call Clear() before resetting the arena.
         struct FrameResourceTrack
         {
-            Mist::tDynArray<render::BufferHandle> buffers;
+            Mist::tFrameDynArray<render::BufferHandle> buffers;
+            // last submission recorded with this track.
+            uint64_t submissionId = 0;
 
-            FrameResourceTrack(uint32_t initialCapacity = 10)
-                : buffers(initialCapacity) { }
+            FrameResourceTrack(Mist::tLinearAllocator* arena = nullptr)
+                : buffers(Mist::tFrameStdAllocator<render::BufferHandle>(arena)) { }
 
             void Clear()
             {
+                // release refs and drop arena storage, it will be invalid after arena reset.
                 buffers.clear();
+                buffers = Mist::tFrameDynArray<render::BufferHandle>(buffers.get_allocator());
             }
         };
     public:
@@ -471,6 +518,9 @@ namespace rendersystem
         void Init(IWindow* window);
         void Destroy();
 
+        // ImGui frame, built while no frame is being recorded. EndFrame draws it.
+        void BeginUIFrame();
+        void EndUIFrame();
         void BeginFrame();
         void EndFrame();
 
@@ -492,6 +542,8 @@ namespace rendersystem
         ShaderProgram* CreateShader(const ShaderBuildDescription& desc);
         void DestroyShader(ShaderProgram** shader);
         void ReloadAllShaders();
+        // reloads only the programs using any of the files (see ShaderProgram::DependsOn). Returns the number of programs reloaded.
+        uint32_t ReloadShadersDependingOn(const Mist::tStringId* files, uint32_t count);
 
         inline uint64_t GetFrameIndex() const { return m_frame % m_device->GetSwapchain().images.size(); }
         render::BindingSetHandle GetBindingSet(const render::BindingSetDescription& desc);
@@ -568,13 +620,25 @@ namespace rendersystem
          */
         void SetShader(ShaderProgram* shader);
         void SetTextureSlot(const render::TextureHandle& texture, uint32_t set, uint32_t binding = 0, uint32_t textureIndex = 0);
+        // Property names can be passed as interned ids (STRING_ID("u_name") on hot paths) or as strings,
+        // string versions look up the id of the name without interning it.
+        void SetTextureSlot(Mist::tStringId id, const render::TextureHandle& texture);
         void SetTextureSlot(const char* id, const render::TextureHandle& texture);
         void SetTextureSlot(const render::TextureHandle* textures, uint32_t count, uint32_t set, uint32_t binding = 0);
+        void SetTextureSlot(Mist::tStringId id, const render::TextureHandle* textures, uint32_t count);
         void SetTextureSlot(const char* id, const render::TextureHandle* textures, uint32_t count);
         void SetSampler(const render::SamplerHandle& sampler, uint32_t set, uint32_t binding = 0, uint32_t samplerIndex = 0);
         void SetSampler(const render::SamplerHandle* sampler, uint32_t count, uint32_t set, uint32_t binding = 0);
+        void SetSampler(Mist::tStringId id, const render::SamplerHandle& sample);
         void SetSampler(const char* id, const render::SamplerHandle& sample);
+        void SetSampler(Mist::tStringId id, const render::SamplerHandle* sample, uint32_t count);
         void SetSampler(const char* id, const render::SamplerHandle* sample, uint32_t count);
+        void SetSampler(Mist::tStringId id, render::Filter minFilter, render::Filter magFilter,
+            render::Filter mipmapMode,
+            render::SamplerAddressMode addressModeU,
+            render::SamplerAddressMode addressModeV,
+            render::SamplerAddressMode addressModeW,
+            uint32_t samplerIndex = 0);
         void SetSampler(const char* id, render::Filter minFilter, render::Filter magFilter,
             render::Filter mipmapMode,
             render::SamplerAddressMode addressModeU,
@@ -587,14 +651,18 @@ namespace rendersystem
             render::SamplerAddressMode addressModeV,
             render::SamplerAddressMode addressModeW,
             uint32_t set, uint32_t binding = 0, uint32_t samplerIndex = 0);
+        void SetShaderProperty(Mist::tStringId id, const void* param, uint64_t size);
         void SetShaderProperty(const char* id, const void* param, uint64_t size);
         void SetTextureLayout(const render::TextureHandle& texture, render::ImageLayout layout, render::TextureSubresourceRange range = {0,1,0,1});
         void SetTextureAsResourceBinding(render::TextureHandle texture);
         void SetTextureAsRenderTargetAttachment(render::TextureHandle texture);
 
+        void BindUAV(Mist::tStringId id, const render::BufferHandle& buffer);
         void BindUAV(const char* id, const render::BufferHandle& buffer);
+        void BindSRV(Mist::tStringId id, const render::BufferHandle& buffer);
         void BindSRV(const char* id, const render::BufferHandle& buffer);
 
+        void BindUAV(Mist::tStringId id, const render::TextureHandle& texture);
         void BindUAV(const char* id, const render::TextureHandle& texture);
 
 
@@ -614,6 +682,9 @@ namespace rendersystem
         void DumpState();
 
         double GetGpuTimeUs() const { return m_gpuTime; }
+        const render::CommandStats& GetCommandStats() const { return m_cmdStats; }
+        // gpu zones of the last resolved frame.
+        const GpuFrameProfiler::QueryTree& GetGpuQueryTree() const { return m_lastQueryTree; }
 
         inline bool AllowsCommand(ShaderProgramType type) const { return m_shaderContext.program && m_shaderContext.program->m_description->type == type; }
         inline bool AllowsGraphicsCommand() const { return AllowsCommand(ShaderProgram_Graphics); }
@@ -660,6 +731,7 @@ namespace rendersystem
         }
         
         void ImGuiDrawGpuProfiler();
+        void CheckFrameHeapAllocations();
 
     private:
         // Device context. Communication with render api.
@@ -682,18 +754,28 @@ namespace rendersystem
             render::SemaphoreHandle* renderQueueSemaphores = nullptr;
             render::SemaphoreHandle* presentSemaphores = nullptr;
             uint64_t* presentSubmission = nullptr;
-            FrameResourceTrack* frameResources = nullptr;
             GpuFrameProfiler* timestampQueries = nullptr;
 
             void Init(render::Device* device, uint32_t frameCount);
             void Destroy();
 
         } m_frameSyncronization;
+        // One per frame arena (globals::MaxOverlappedFrames).
+        FrameResourceTrack m_frameResources[Mist::globals::MaxOverlappedFrames];
+        // General heap allocations done between BeginFrame and EndFrame.
+        uint64_t m_frameHeapAllocStart;
+        uint32_t m_frameHeapAllocs;
+        struct
+        {
+            uint32_t frames = 0;
+            uint32_t maxAllocs = 0;
+            uint64_t totalAllocs = 0;
+        } m_frameHeapAllocCheck;
         inline const render::SemaphoreHandle& GetPresentSemaphore() const { return m_frameSyncronization.presentSemaphores[m_frame % m_frameSyncronization.count]; }
         inline const render::SemaphoreHandle& GetRenderSemaphore() const { check(m_swapchainIndex < m_frameSyncronization.count); return m_frameSyncronization.renderQueueSemaphores[m_swapchainIndex]; }
         inline uint64_t GetPresentSubmissionId() const { return m_frameSyncronization.presentSubmission[m_frame % m_frameSyncronization.count]; }
         inline uint64_t SetPresentSubmissionId(uint64_t submission) { return m_frameSyncronization.presentSubmission[m_frame % m_frameSyncronization.count] = submission; }
-        inline FrameResourceTrack& GetFrameResources() { return m_frameSyncronization.frameResources[m_frame % m_frameSyncronization.count]; }
+        inline FrameResourceTrack& GetFrameResources() { return m_frameResources[m_frame % Mist::globals::MaxOverlappedFrames]; }
 		inline GpuFrameProfiler& GetFrameProfiler() { return m_frameSyncronization.timestampQueries[m_frame % m_frameSyncronization.count]; }
 
         // Command list with transfer, graphics and compute commands
@@ -721,8 +803,8 @@ namespace rendersystem
         } m_screenQuadCopy;
 
         // Memory and cache management.
-        Mist::tMap<render::GraphicsPipelineDescription, render::GraphicsPipelineHandle> m_graphicsPsoMap;
-        Mist::tMap<render::ComputePipelineDescription, render::ComputePipelineHandle> m_computePsoMap;
+        Mist::tFlatMap<render::GraphicsPipelineDescription, render::GraphicsPipelineHandle> m_graphicsPsoMap;
+        Mist::tFlatMap<render::ComputePipelineDescription, render::ComputePipelineHandle> m_computePsoMap;
         BindingCache* m_bindingCache;
         SamplerCache* m_samplerCache;
         ShaderMemoryPool* m_memoryPool;
@@ -747,8 +829,8 @@ namespace std
         size_t operator()(const render::shader_compiler::CompileMacroDefinition& options) const
         {
             size_t seed = 0;
-            Mist::HashCombine(seed, options.macro.CStr());
-            Mist::HashCombine(seed, options.value.CStr());
+            Mist::HashCombine(seed, options.macro);
+            Mist::HashCombine(seed, options.value);
             return seed;
         }
     };
@@ -759,7 +841,7 @@ namespace std
         size_t operator()(const render::shader_compiler::CompilationOptions& options) const
         {
             size_t seed = 0;
-            Mist::HashCombine(seed, string(options.entryPoint));
+            Mist::HashCombine(seed, options.entryPoint);
             for (uint32_t i = 0; i < (uint32_t)options.macroDefinitionArray.size(); ++i)
                 Mist::HashCombine(seed, options.macroDefinitionArray[i]);
             return seed;
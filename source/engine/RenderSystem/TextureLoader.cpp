@@ -10,9 +10,9 @@
 #ifdef TEXLOAD_DUMP_INFO
 #define texloadlabel "[texture loader] "
 #define texloadlog(fmt) loginfo(texloadlabel fmt)
-#define texloadlogf(fmt, ...) logfinfo(texloadlabel fmt, __VA_ARGS__)
+#define texloadlogf(fmt, ...) logfinfo(texloadlabel fmt, ##__VA_ARGS__)
 #define profile_texload_scope(scope_name, msg) PROFILE_SCOPE_LOG(scope_name, msg)
-#define profile_texload_scope_f(scope_name, fmt, ...) PROFILE_SCOPE_LOGF(scope_name, fmt, __VA_ARGS__)
+#define profile_texload_scope_f(scope_name, fmt, ...) PROFILE_SCOPE_LOGF(scope_name, fmt, ##__VA_ARGS__)
 #else
 #define texloadlog(fmt) DUMMY_MACRO
 #define texloadlogf(fmt, ...) DUMMY_MACRO
@@ -84,14 +84,19 @@ namespace rendersystem
 
     namespace textureloader
     {
-        bool LoadTextureData_u8(TextureData* out, const char* filepath, bool flipVertical)
+        bool DecodeTextureData_u8(TextureData* out, const void* encoded, size_t size, bool flipVertical)
         {
-            profile_texload_scope_f(LoadTextureData_u8, "LoadTexture_u8 (%s)", filepath);
             check(out);
-            Mist::cAssetPath assetPath(filepath);
-            stbi_set_flip_vertically_on_load(flipVertical);
+            if (!encoded || !size)
+            {
+                FreeTextureData(*out);
+                return false;
+            }
+            // per thread flag, textures are decoded from job threads.
+            stbi_set_flip_vertically_on_load_thread(flipVertical);
             int32_t width, height, channels;
-            stbi_uc* pixels = stbi_load(assetPath, &width, &height, &channels, STBI_rgb_alpha);
+            stbi_uc* pixels = stbi_load_from_memory(static_cast<const stbi_uc*>(encoded), Mist::limits_cast<int>(size),
+                &width, &height, &channels, STBI_rgb_alpha);
             if (!pixels)
             {
                 FreeTextureData(*out);
@@ -107,14 +112,15 @@ namespace rendersystem
             return true;
         }
 
-        bool LoadTextureData_f(TextureData* out, const char* filepath, bool flipVertical)
+        bool DecodeTextureData_f(TextureData* out, const void* encoded, size_t size, bool flipVertical)
         {
-            profile_texload_scope_f(LoadTextureData_f, "LoadTextureData_f (%s)", filepath);
             check(out);
-            Mist::cAssetPath assetPath(filepath);
-            stbi_set_flip_vertically_on_load(flipVertical);
+            if (!encoded || !size)
+                return false;
+            stbi_set_flip_vertically_on_load_thread(flipVertical);
             int32_t width, height, channels;
-			float* pixels = stbi_loadf(assetPath, &width, &height, &channels, STBI_rgb_alpha);
+			float* pixels = stbi_loadf_from_memory(static_cast<const stbi_uc*>(encoded), Mist::limits_cast<int>(size),
+				&width, &height, &channels, STBI_rgb_alpha);
 			if (!pixels)
 			{
 				return false;
@@ -129,6 +135,50 @@ namespace rendersystem
 			return true;
         }
 
+        bool LoadTextureData_u8(TextureData* out, const char* filepath, bool flipVertical)
+        {
+            profile_texload_scope_f(LoadTextureData_u8, "LoadTexture_u8 (%s)", filepath);
+            Mist::cAssetPath assetPath(filepath);
+            // decoded straight from the mapped file, no intermediate copy of the encoded image.
+            Mist::cMappedFile file;
+            file.Open(assetPath);
+            return DecodeTextureData_u8(out, file.GetData(), file.GetSize(), flipVertical);
+        }
+
+        bool LoadTextureData_f(TextureData* out, const char* filepath, bool flipVertical)
+        {
+            profile_texload_scope_f(LoadTextureData_f, "LoadTextureData_f (%s)", filepath);
+            Mist::cAssetPath assetPath(filepath);
+            Mist::cMappedFile file;
+            file.Open(assetPath);
+            return DecodeTextureData_f(out, file.GetData(), file.GetSize(), flipVertical);
+        }
+
+        struct tAsyncDecode
+        {
+            TextureData* Out;
+            bool FlipVertical;
+        };
+
+        void DecodeTextureRequest(Mist::tIORequest& request, void* userData)
+        {
+            tAsyncDecode* decode = static_cast<tAsyncDecode*>(userData);
+            profile_texload_scope_f(DecodeTextureRequest, "Decode texture (%s)", request.Path);
+            // failed or cancelled reads leave out zeroed.
+            if (request.IsDone())
+                DecodeTextureData_u8(decode->Out, request.GetData(), request.GetSize(), decode->FlipVertical);
+            delete decode;
+        }
+
+        Mist::tIORequest* LoadTextureDataAsync_u8(TextureData* out, const char* filepath, bool flipVertical, Mist::eIOPriority priority)
+        {
+            check(out);
+            memset(out, 0, sizeof(TextureData));
+            Mist::cAssetPath assetPath(filepath);
+            tAsyncDecode* decode = _new tAsyncDecode{ out, flipVertical };
+            return Mist::ReadFileAsync(assetPath, priority, &DecodeTextureRequest, decode);
+        }
+
         void FreeTextureData(TextureData& data)
         {
             if (data.u8data)
@@ -147,12 +197,19 @@ namespace rendersystem
                 logferror("Failed to load texture data from %s.\n", filepath);
                 return false;
             }
+            CreateTextureFromData(textureOut, device, data, filepath, calculateMipLevels, uploadContext);
+            FreeTextureData(data);
+            return true;
+        }
 
-            profile_texload_scope_f(CreateAndFillTexture, "Create and fill texture from file (%s)", filepath);
+        void CreateTextureFromData(render::TextureHandle* textureOut, render::Device* device, const TextureData& data, const char* debugName, bool calculateMipLevels, render::utils::UploadContext* uploadContext)
+        {
+            profile_texload_scope_f(CreateAndFillTexture, "Create and fill texture from data (%s)", debugName);
+            check(textureOut && device && data.u8data && data.channels == 4);
             render::TextureDescription desc;
             desc.extent = { data.width, data.height, 1 };
             desc.format = render::Format_R8G8B8A8_UNorm;
-            desc.debugName = filepath;
+            desc.debugName = debugName;
             desc.mipLevels = calculateMipLevels ? CalculateMipLevels(data.width, data.height) : 1;
             render::TextureHandle texture = device->CreateTexture(desc);
             (*textureOut) = texture;
@@ -167,9 +224,6 @@ namespace rendersystem
             uploadContext->SetTextureLayout(texture, render::ImageLayout_ShaderReadOnly, 0, 0);
             if (calculateMipLevels)
                 GenerateMipMaps(device, texture, uploadContext);
-
-            FreeTextureData(data);
-            return true;
         }
 
         bool LoadHDRTextureFromFile(render::TextureHandle* textureOut, render::Device* device, const char* filepath, bool flipVertical, render::utils::UploadContext* uploadContext)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "RenderAPI/Device.h"
+#include "Core/AsyncIO.h"
 
 namespace rendersystem
 {
@@ -27,7 +28,15 @@ namespace rendersystem
 
         bool LoadTextureData_u8(TextureData* out, const char* filepath, bool flipVertical = false);
         bool LoadTextureData_f(TextureData* out, const char* filepath, bool flipVertical = false);
+        // Decodes an encoded image (png, jpg...) already in memory.
+        bool DecodeTextureData_u8(TextureData* out, const void* encoded, size_t size, bool flipVertical = false);
+        bool DecodeTextureData_f(TextureData* out, const void* encoded, size_t size, bool flipVertical = false);
+        // File read by the io threads and decoded on a job worker. out is filled once the request is finished
+        // (zeroed on failure), release the request with Mist::ReleaseIORequest.
+        Mist::tIORequest* LoadTextureDataAsync_u8(TextureData* out, const char* filepath, bool flipVertical = false, Mist::eIOPriority priority = Mist::IOPriority_Normal);
         void FreeTextureData(TextureData& data);
+        // Creates and uploads a RGBA8 texture from decoded data. data is not released.
+        void CreateTextureFromData(render::TextureHandle* textureOut, render::Device* device, const TextureData& data, const char* debugName, bool calculateMipLevels = true, render::utils::UploadContext* uploadContext = nullptr);
 
         bool LoadTextureFromFile(render::TextureHandle* textureOut, render::Device* device, const char* filepath, bool flipVertical = false, bool calculateMipLevels = true, render::utils::UploadContext* uploadContext = nullptr);
         bool LoadHDRTextureFromFile(render::TextureHandle* textureOut, render::Device* device, const char* filepath, bool flipVertical = false, render::utils::UploadContext* uploadContext = nullptr);
@@ -216,13 +216,7 @@ namespace rendersystem
                 cmd->ClearState();
                 cmd->SetGraphicsState(state);
 
-                ImGui::Render();
                 ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd->GetCommandBuffer()->cmd);
-                if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
-                {
-                    ImGui::UpdatePlatformWindows();
-                    ImGui::RenderPlatformWindowsDefault();
-                }
                 cmd->ClearState();
                 cmd->EndMarker();
                 //EndGPUEvent(context, cmd);
@@ -243,6 +237,17 @@ namespace rendersystem
                 ImGui_ImplSDL2_NewFrame(/*(SDL_Window*)context.Window->WindowInstance*/);
                 ImGui::NewFrame();
             }
+
+            void EndFrame()
+            {
+                ImGui::Render();
+                // platform windows are SDL windows, they are updated from the thread owning the main window.
+                if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+                {
+                    ImGui::UpdatePlatformWindows();
+                    ImGui::RenderPlatformWindowsDefault();
+                }
+            }
         private:
             VkDescriptorPool m_imguiPool= VK_NULL_HANDLE;
             render::Device* m_device = nullptr;
@@ -250,30 +255,50 @@ namespace rendersystem
         };
 
         ImGuiInstance g_imgui;
+        bool g_enabled = false;
 
         void Init(render::Device* device, render::RenderTargetHandle rt, void* windowHandle)
         {
-            check(device && rt && windowHandle);
-            g_imgui.Init(device, rt, windowHandle);
+            check(device && rt);
+            // headless runs have no window to get input from nor to show the ui.
+            g_enabled = windowHandle != nullptr;
+            if (g_enabled)
+                g_imgui.Init(device, rt, windowHandle);
         }
 
         void Destroy()
         {
-            g_imgui.Destroy();
+            if (g_enabled)
+                g_imgui.Destroy();
+            g_enabled = false;
+        }
+
+        bool IsEnabled()
+        {
+            return g_enabled;
         }
 
         void BeginFrame()
         {
             CPU_PROFILE_SCOPE(UI_Begin);
+            check(g_enabled);
             g_imgui.BeginFrame();
         }
 
-        void EndFrame(render::CommandListHandle cmd)
+        void EndFrame()
         {
+            CPU_PROFILE_SCOPE(UI_End);
+            check(g_enabled);
             if (CVar_ShowImGuiDemo.Get())
                 ImGui::ShowDemoWindow();
 
-            g_imgui.Draw(cmd);
+            g_imgui.EndFrame();
+        }
+
+        void Draw(render::CommandListHandle cmd)
+        {
+            if (g_enabled)
+                g_imgui.Draw(cmd);
         }
 
         void Show()
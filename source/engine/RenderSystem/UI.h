@@ -9,10 +9,15 @@ namespace rendersystem
         typedef void(*ImGuiWindowCallback)(void*);
         typedef void(*ImGuiMenuCallback)();
 
+        // without window handle the ui is disabled.
         void Init(render::Device* device, render::RenderTargetHandle rt, void* windowHandle);
         void Destroy();
+        bool IsEnabled();
+        // BeginFrame/EndFrame build the ImGui frame on the game thread, Draw records the
+        // finished frame from the render thread.
         void BeginFrame();
-        void EndFrame(render::CommandListHandle cmd);
+        void EndFrame();
+        void Draw(render::CommandListHandle cmd);
 
         void Show();
 
@@ -6,6 +6,8 @@
 
 #include "RenderSystem/RenderSystem.h"
 #include "RenderSystem/TextureLoader.h"
+#include "Core/AsyncIO.h"
+#include "Core/JobSystem.h"
 
 
 
@@ -62,6 +64,12 @@ YAML::Emitter& operator<<(YAML::Emitter& e, const Mist::tAngles& a)
 	return e;
 }
 
+YAML::Emitter& operator<<(YAML::Emitter& e, const glm::quat& q)
+{
+	e << YAML::Flow << YAML::BeginSeq << q.x << q.y << q.z << q.w << YAML::EndSeq;
+	return e;
+}
+
 
 namespace YAML
 {
@@ -134,6 +142,32 @@ namespace YAML
 			return true;
 		}
 	};
+
+	template<>
+	struct convert<glm::quat>
+	{
+		static Node encode(const glm::quat& rhs)
+		{
+			Node node;
+			node.push_back(rhs.x);
+			node.push_back(rhs.y);
+			node.push_back(rhs.z);
+			node.push_back(rhs.w);
+			return node;
+		}
+
+		static bool decode(const Node& node, glm::quat& rhs)
+		{
+			if (!node.IsSequence() || node.size() != 4)
+				return false;
+
+			rhs.x = node[0].as<float>();
+			rhs.y = node[1].as<float>();
+			rhs.z = node[2].as<float>();
+			rhs.w = node[3].as<float>();
+			return true;
+		}
+	};
 }
 
 #endif
@@ -143,33 +177,6 @@ namespace Mist
 {
 	CIntVar CVar_DebugCubes("r_debugCubes", 0);
 
-	const char* LightTypeToStr(ELightType e)
-	{
-		switch (e)
-		{
-		case ELightType::Point: return "Point";
-		case ELightType::Directional: return "Directional";
-		case ELightType::Spot: return "Spot";
-		}
-		check(false);
-		return nullptr;
-	}
-
-	ELightType StrToLightType(const char* str)
-	{
-		if (!strcmp(str, "Point")) return ELightType::Point;
-		if (!strcmp(str, "Spot")) return ELightType::Spot;
-		if (!strcmp(str, "Directional")) return ELightType::Directional;
-		check(false);
-		return (ELightType)0xff;
-	}
-
-	void TransformComponentToMatrix(const TransformComponent* transforms, glm::mat4* matrices, uint32_t count)
-	{
-		for (uint32_t i = 0; i < count; ++i)
-			matrices[i] = math::ToMat4(transforms[i].Position, transforms[i].Rotation, transforms[i].Scale);
-	}
-
 	template <uint32_t N>
 	void GetResourceFileId(const char* file, const char* resname, char(&buff)[N])
 	{
@@ -223,15 +230,18 @@ namespace Mist
 
 	void Scene::Init()
 	{
-		m_globalTransforms.AllocateAndResize(globals::MaxRenderObjects);
-		m_localTransforms.AllocateAndResize(globals::MaxRenderObjects);
-		m_renderTransforms.AllocateAndResize(globals::MaxRenderObjects);
-		m_transformComponents.AllocateAndResize(globals::MaxRenderObjects);
-		m_materials.AllocateAndResize(globals::MaxMaterials);
-		m_names.Allocate(globals::MaxRenderObjects);
-		m_hierarchy.Allocate(globals::MaxRenderObjects);
-		for (uint32_t i = 0; i < MaxNodeLevel; ++i)
-			m_dirtyNodes[i].Allocate(globals::MaxRenderObjects);
+		for (uint32_t i = 0; i < CountOf(m_renderData); ++i)
+		{
+			m_renderData[i].RenderTransforms.AllocateAndResize(globals::MaxRenderObjects);
+			m_renderData[i].Materials.AllocateAndResize(globals::MaxMaterials);
+			m_renderData[i].DrawModels.Allocate(globals::MaxRenderObjects);
+		}
+		// initial capacity, the render objects grow past it. The render transforms of their meshes are
+		// bound to the render data arrays.
+		m_graph.Init(globals::MaxRenderObjects);
+		m_nameIndex.Init(globals::MaxRenderObjects);
+		m_transformPropagation.Init(globals::MaxRenderObjects);
+		ResizeNodeArrays(globals::MaxRenderObjects);
 
 		PushRenderPipeline(RenderFlags_Fixed);
 		PushRenderPipeline(RenderFlags_ShadowMap);
@@ -249,13 +259,26 @@ namespace Mist
 		for (uint32_t i = 0; i < m_models.GetSize(); ++i)
 			m_models[i].Destroy();
 		m_models.Clear();
-		m_localTransforms.Delete();
-		m_globalTransforms.Delete();
-		m_hierarchy.Delete();
-		m_names.Delete();
-		m_materials.Delete();
-		for (uint32_t i = 0; i < MaxNodeLevel; ++i)
-			m_dirtyNodes[i].Delete();
+		m_modelIndex.clear();
+		m_graph.Destroy();
+		m_nameIndex.Destroy();
+		m_names = {};
+		m_transformComponents = {};
+		m_localTransforms = {};
+		m_globalTransforms = {};
+		m_renderTransformOffsets = {};
+		m_meshComponents.Clear();
+		m_lightComponents.Clear();
+		m_cameraComponents.Clear();
+		for (uint32_t i = 0; i < CountOf(m_renderData); ++i)
+		{
+			m_renderData[i].RenderTransforms.Delete();
+			m_renderData[i].Materials.Delete();
+			m_renderData[i].DrawModels.Delete();
+			m_renderData[i].ShadowLights.Clear();
+		}
+		m_transformPropagation.Destroy();
+		m_renderLayoutDirty = 0;
 	}
 
 	void Scene::Tick(float deltaTime)
@@ -280,37 +303,25 @@ namespace Mist
 
 	sRenderObject Scene::CreateRenderObject(sRenderObject parent)
 	{
-		// Generate new node in all basics structures
-		sRenderObject node = m_hierarchy.GetSize();
+		check(!parent.IsValid() || IsValid(parent));
+		const sRenderObject renderObject = m_graph.Create(parent);
+		check(renderObject.IsValid());
+		const lindex_t node = m_graph.GetNode(renderObject);
+		check(m_graph.GetHierarchy(node).Level < tTransformPropagation::MaxNodeLevel);
+		if (node >= m_names.size())
+			ResizeNodeArrays(m_graph.GetCapacity());
 		m_localTransforms[node] = glm::mat4(1.f);
 		m_globalTransforms[node] = glm::mat4(1.f);
 		m_transformComponents[node] = { .Position = glm::vec3(0.f), .Rotation = tAngles(0.f), .Scale = glm::vec3(1.f) };
+		m_transformPropagation.ResetNode(node);
 		char buff[64];
-		sprintf_s(buff, "RenderObject_%u", node.Id);
-		m_names.Push(buff);
-		m_hierarchy.Push({ .Parent = parent });
-
-		// Connect siblings
-		if (parent.IsValid())
-		{
-			check(parent.Id < m_hierarchy.GetSize());
-			sRenderObject firstSibling = m_hierarchy[parent].Child;
-			if (firstSibling.IsValid())
-			{
-				sRenderObject sibling;
-				for (sibling = firstSibling; m_hierarchy[sibling].Sibling.IsValid(); sibling = m_hierarchy[sibling].Sibling);
-				m_hierarchy[sibling].Sibling = node;
-			}
-			else
-			{
-				m_hierarchy[parent].Child = node;
-			}
-		}
-
-		m_hierarchy[node].Level = parent.IsValid() ? m_hierarchy[parent].Level + 1 : 0;
-		m_hierarchy[node].Child = index_invalid;
-		m_hierarchy[node].Sibling = index_invalid;
-		return node;
+		sprintf_s(buff, "RenderObject_%u", renderObject.Id);
+		// nodes past the ones packed by a sort may keep an old name, not in the index.
+		m_names[node] = buff;
+		m_nameIndex.Insert(buff, renderObject);
+		// global transform has to be computed even if the transform is never set.
+		MarkNodeDirty(node);
+		return renderObject;
 	}
 
 	index_t Scene::LoadModel(const char* filepath)
@@ -321,6 +332,7 @@ namespace Mist
 			m_models.Push();
 			model = &m_models.GetBack();
 			check(model->LoadModel(g_device, filepath));
+			m_modelIndex[model->GetNameId()] = (index_t)(model - m_models.GetData());
 		}
 		check(model);
 		return (index_t)(model-m_models.GetData());
@@ -335,9 +347,8 @@ namespace Mist
 
 	void Scene::SetCamera(sRenderObject r, const CameraComponent& cc)
 	{
-		check(IsValid(r));
 		check(cc.CameraIndex < m_cameras.GetSize());
-		m_cameraComponentMap[r] = cc;
+		m_cameraComponents.Set(GetNode(r), cc);
 		if (cc.Main)
 			m_cameraIndex = cc.CameraIndex;
 	}
@@ -347,7 +358,7 @@ namespace Mist
 		const cMesh& mesh = model.m_meshes[meshIndex];
 		renderSystem->SetVertexBuffer(mesh.vb);
 		renderSystem->SetIndexBuffer(mesh.ib);
-		renderSystem->SetShaderProperty("u_model", &m_renderTransforms[transformOffset + model.m_meshNodeIndex[meshIndex]], sizeof(glm::mat4));
+		renderSystem->SetShaderProperty(STRING_ID("u_model"), &GetRenderData().RenderTransforms[transformOffset + model.m_meshNodeIndex[meshIndex]], sizeof(glm::mat4));
 	}
 
 	void Scene::LoadScene(const char* filepath)
@@ -356,17 +367,11 @@ namespace Mist
 
 		m_sceneFile = filepath;
 
-		cFile file;
-		check(file.OpenText(filepath, cFile::FileMode_Read) == cFile::Result_Ok);
-		size_t size = file.GetContentSize();
-		check(size);
-		char* content = _new char[size];
-		size_t contentReaded = file.Read(content, size, sizeof(char), size);
-		file.Close();
-		check(contentReaded <= size);
-		content[contentReaded == size ? size - 1 : contentReaded] = 0;
-
-		YAML::Node root = YAML::Load(content);
+		tIORequest* request = ReadFileAsync(cAssetPath(filepath), IOPriority_High);
+		WaitIORequest(request);
+		check(request->IsDone() && request->GetSize());
+		YAML::Node root = YAML::Load(std::string(static_cast<const char*>(request->GetData()), request->GetSize()));
+		ReleaseIORequest(request);
 		check(root);
 		YAML::Node envNode = root["Environment"];
 		check(envNode);
@@ -390,10 +395,15 @@ namespace Mist
 
 		YAML::Node renderObjectSeq = root["RenderObjects"];
 		check(renderObjectSeq);
+		// render object of each file entry. Parents are saved before their children, roots with an
+		// index out of the file (lindex_invalid).
+		tDynArray<sRenderObject> fileRenderObjects;
+		fileRenderObjects.reserve(renderObjectSeq.size());
 		for (const auto& it : renderObjectSeq)
 		{
 			uint32_t parent = it["Parent"].as<uint32_t>();
-			sRenderObject rb = CreateRenderObject(parent);
+			sRenderObject rb = CreateRenderObject(parent < fileRenderObjects.size() ? fileRenderObjects[parent] : sRenderObject());
+			fileRenderObjects.push_back(rb);
 			SetRenderObjectName(rb, it["Name"].as<std::string>().c_str());
 
 			TransformComponent t;
@@ -401,6 +411,12 @@ namespace Mist
 			t.Position = transformNode["Position"].as<glm::vec3>();
 			t.Rotation = transformNode["Rotation"].as<tAngles>();
 			t.Scale = transformNode["Scale"].as<glm::vec3>();
+			// only saved for quaternion rotations, Rotation is their euler approximation.
+			if (YAML::Node orientationNode = transformNode["Orientation"])
+			{
+				t.Orientation = orientationNode.as<glm::quat>();
+				t.RotationMode = ERotationMode::Quaternion;
+			}
 			SetTransform(rb, t);
 
 			YAML::Node lightNode = it["LightComponent"];
@@ -452,9 +468,8 @@ namespace Mist
 			cc.Main = true;
 			SetCamera(rb, cc);
 		}
-		delete[] content;
-
-		
+		// files keep creation order, usually depth first.
+		SortRenderObjects();
 		LoadIrradianceCube(*m_irradianceRequestInfo);
 	}
 
@@ -477,26 +492,30 @@ namespace Mist
 			emitter << YAML::EndMap;
 			emitter << YAML::EndMap;
 		}
+		// packed with parents first, file indices are the nodes.
+		SortRenderObjects();
 		emitter << YAML::Key << "RenderObjects";
 		emitter << YAML::BeginSeq;
-		for (uint32_t i = 0; i < GetRenderObjectCount(); ++i)
+		for (lindex_t i = 0; i < m_graph.GetNodeCount(); ++i)
 		{
-			const Hierarchy& h = m_hierarchy[i];
+			const Hierarchy& h = m_graph.GetHierarchy(i);
 			emitter << YAML::BeginMap;
 			emitter << YAML::Key << "RenderObject" << YAML::Value << i;
-			emitter << YAML::Key << "Name" << YAML::Value << GetRenderObjectName(i);
+			emitter << YAML::Key << "Name" << YAML::Value << m_names[i].c_str();
 			emitter << YAML::Key << "Parent" << YAML::Value << h.Parent;
 
 			const TransformComponent& t = m_transformComponents[i];
 			emitter << YAML::Key << "TransformComponent" << YAML::BeginMap;
 			emitter << YAML::Key << "Position" << YAML::Value << t.Position;
 			emitter << YAML::Key << "Rotation" << YAML::Value << t.Rotation;
+			if (t.RotationMode == ERotationMode::Quaternion)
+				emitter << YAML::Key << "Orientation" << YAML::Value << t.Orientation;
 			emitter << YAML::Key << "Scale" << YAML::Value << t.Scale;
 			emitter << YAML::EndMap;
 
-			if (m_lightComponentMap.contains(i))
+			if (const LightComponent* lightComponent = m_lightComponents.Find(i))
 			{
-				const LightComponent& light = m_lightComponentMap[i];
+				const LightComponent& light = *lightComponent;
 				emitter << YAML::Key << "LightComponent" << YAML::BeginMap;
 				emitter << YAML::Key << "Type" << YAML::Value << LightTypeToStr(light.Type);
 				emitter << YAML::Key << "Color" << YAML::Value << light.Color;
@@ -508,17 +527,16 @@ namespace Mist
 				emitter << YAML::EndMap;
 			}
 
-			if (m_meshComponentMap.contains(i))
+			if (const MeshComponent* mesh = m_meshComponents.Find(i))
 			{
 				emitter << YAML::Key << "MeshComponent" << YAML::BeginMap;
-				const MeshComponent& mesh = m_meshComponentMap[i];
-				emitter << YAML::Key << "MeshAssetPath" << YAML::Value << mesh.MeshAssetPath;
+				emitter << YAML::Key << "MeshAssetPath" << YAML::Value << mesh->MeshAssetPath;
 				emitter << YAML::EndMap;
 			}
 
-			if (m_cameraComponentMap.contains(i))
+			if (const CameraComponent* camera = m_cameraComponents.Find(i))
 			{
-				const CameraComponent& cc = m_cameraComponentMap.at(i);
+				const CameraComponent& cc = *camera;
 				emitter << YAML::Key << "CameraComponent" << YAML::BeginMap;
 				emitter << YAML::Key << "Main" << YAML::Value << cc.Main;
 				check(cc.CameraIndex < m_cameras.GetSize());
@@ -546,134 +564,199 @@ namespace Mist
 		logfok("--- Scene file saved in: %s (%d bytes) ---\n", filepath, size);
 	}
 
+	void Scene::SortRenderObjects()
+	{
+		CPU_PROFILE_SCOPE(SortRenderObjects);
+		const uint32_t nodeCount = m_graph.GetNodeCount();
+		tDynArray<lindex_t> remap;
+		if (!m_graph.Sort(remap))
+			return;
+
+		const lindex_t* nodes = remap.data();
+		RemapArray(m_names, nodes, nodeCount);
+		RemapArray(m_transformComponents, nodes, nodeCount);
+		RemapArray(m_localTransforms, nodes, nodeCount);
+		RemapArray(m_globalTransforms, nodes, nodeCount);
+		m_meshComponents.Remap(nodes, nodeCount);
+		m_lightComponents.Remap(nodes, nodeCount);
+		m_cameraComponents.Remap(nodes, nodeCount);
+		m_transformPropagation.Remap(nodes, nodeCount);
+		// draw order follows the mesh components, every render data is laid out again (and the render
+		// transform offsets with it).
+		m_renderLayoutDirty = (1 << CountOf(m_renderData)) - 1;
+	}
+
 	void Scene::DestroyRenderObject(sRenderObject object)
 	{
-		check(false && "not implemented yet" && __FUNCTION__ && __FILE__ && __LINE__);
+		check(IsValid(object));
+		bool meshRemoved = false;
+		// destroyed nodes may still be queued, RecalculateTransforms skips them and releases them for new
+		// render objects when it is done.
+		m_graph.Destroy(object, [this, &meshRemoved](lindex_t node)
+			{
+				EraseNodeName(node);
+				meshRemoved |= m_meshComponents.Remove(node);
+				m_lightComponents.Remove(node);
+				m_cameraComponents.Remove(node);
+			});
+		// render transform offsets change, rewrite them all in both render data.
+		if (meshRemoved)
+			m_renderLayoutDirty = (1 << CountOf(m_renderData)) - 1;
 	}
 
 	const MeshComponent* Scene::GetMesh(sRenderObject renderObject) const
 	{
-		check(IsValid(renderObject));
-		const MeshComponent* mesh = nullptr;
-		if (m_meshComponentMap.contains(renderObject))
-			mesh = &m_meshComponentMap.at(renderObject);
-		return mesh;
+		return m_meshComponents.Find(GetNode(renderObject));
 	}
 
 	void Scene::SetMesh(sRenderObject renderObject, const MeshComponent& meshComponent)
 	{
-		check(IsValid(renderObject));
-		m_meshComponentMap[renderObject] = meshComponent;
+		m_meshComponents.Set(GetNode(renderObject), meshComponent);
+		// render transform offsets may change, rewrite them all in both render data.
+		m_renderLayoutDirty = (1 << CountOf(m_renderData)) - 1;
 	}
 
 	const char* Scene::GetRenderObjectName(sRenderObject object) const
 	{
-		return IsValid(object) ? m_names[object.Id].c_str() : nullptr;
+		const lindex_t node = m_graph.GetNode(object);
+		return node != lindex_invalid ? m_names[node].c_str() : nullptr;
+	}
+
+	sRenderObject Scene::FindRenderObject(const char* name) const
+	{
+		// destroyed render objects leave the index, a found one is alive.
+		return m_nameIndex.Find(name);
 	}
 
 	bool Scene::IsValid(sRenderObject object) const
 	{
-		return object.Id < GetRenderObjectCount();
+		return m_graph.IsAlive(object);
 	}
 
 	uint32_t Scene::GetRenderObjectCount() const
 	{
-		return m_hierarchy.GetSize();
+		return m_graph.GetCount();
 	}
 
 	sRenderObject Scene::GetRoot() const
 	{
-		static sRenderObject root = 0;
-		//for (; m_hierarchy[root].Parent.IsValid(); root = m_hierarchy[root].Parent);
-		return root;
+		// node 0 while the scene is breadth first.
+		for (lindex_t node = 0; node < m_graph.GetNodeCount(); ++node)
+		{
+			if (m_graph.IsNodeAlive(node) && m_graph.GetHierarchy(node).Parent == lindex_invalid)
+				return m_graph.GetRenderObject(node);
+		}
+		return sRenderObject();
 	}
 
 	void Scene::SetRenderObjectName(sRenderObject renderObject, const char* name)
 	{
-		check(IsValid(renderObject));
-		m_names[renderObject] = name;
+		SetNodeName(GetNode(renderObject), name);
+	}
+
+	void Scene::SetNodeName(lindex_t node, const char* name)
+	{
+		// also keeps name valid, it may be the current one.
+		if (!strcmp(m_names[node].c_str(), name))
+			return;
+		EraseNodeName(node);
+		m_names[node] = name;
+		m_nameIndex.Insert(name, m_graph.GetRenderObject(node));
+	}
+
+	void Scene::EraseNodeName(lindex_t node)
+	{
+		m_nameIndex.Remove(m_names[node].c_str(), m_graph.GetRenderObject(node));
+		m_names[node] = "";
 	}
 
 	const TransformComponent& Scene::GetTransform(sRenderObject renderObject) const
 	{
-		check(IsValid(renderObject));
-		return m_transformComponents[renderObject];
+		return m_transformComponents[GetNode(renderObject)];
 	}
 
 	void Scene::SetTransform(sRenderObject renderObject, const TransformComponent& transform)
 	{
-		check(IsValid(renderObject));
-		m_transformComponents[renderObject] = transform;
-		MarkAsDirty(renderObject);
+		const lindex_t node = GetNode(renderObject);
+		m_transformComponents[node] = transform;
+		SyncTransformRotation(m_transformComponents[node]);
+		MarkNodeDirty(node);
 	}
 
 	const LightComponent* Scene::GetLight(sRenderObject renderObject) const
 	{
-		check(IsValid(renderObject));
-		const LightComponent* light = nullptr;
-		if (m_lightComponentMap.contains(renderObject))
-			light = &m_lightComponentMap.at(renderObject);
-		return light;
+		return m_lightComponents.Find(GetNode(renderObject));
 	}
 
 	void Scene::SetLight(sRenderObject renderObject, const LightComponent& light)
 	{
-		check(IsValid(renderObject));
-		m_lightComponentMap[renderObject] = light;
+		m_lightComponents.Set(GetNode(renderObject), light);
 	}
 
 	void Scene::MarkAsDirty(sRenderObject renderObject)
 	{
-		check(IsValid(renderObject));
-		int32_t level = m_hierarchy[renderObject].Level;
-		m_dirtyNodes[level].Push(renderObject);
-		for (sRenderObject child = m_hierarchy[renderObject].Child; child.IsValid(); child = m_hierarchy[child].Sibling)
-			MarkAsDirty(child);
+		MarkNodeDirty(GetNode(renderObject));
+	}
+
+	lindex_t Scene::GetNode(sRenderObject renderObject) const
+	{
+		const lindex_t node = m_graph.GetNode(renderObject);
+		check(node != lindex_invalid);
+		return node;
+	}
+
+	void Scene::ResizeNodeArrays(uint32_t nodeCount)
+	{
+		m_names.resize(nodeCount);
+		m_transformComponents.resize(nodeCount);
+		m_localTransforms.resize(nodeCount);
+		m_globalTransforms.resize(nodeCount);
+		m_renderTransformOffsets.resize(nodeCount);
 	}
 
+	void Scene::MarkNodeDirty(lindex_t node)
+	{
+		m_transformPropagation.MarkDirty(m_graph, node);
+	}
 
 	void Scene::RecalculateTransforms()
 	{
 		CPU_PROFILE_SCOPE(RecalculateTransforms);
-		check(m_localTransforms.GetSize() == m_transformComponents.GetSize());
-		check(m_globalTransforms.GetSize() == m_transformComponents.GetSize());
-		TransformComponentToMatrix(m_transformComponents.GetData(), m_localTransforms.GetData(), m_transformComponents.GetSize());
-		// Process root level first
-		if (!m_dirtyNodes[0].IsEmpty())
+		const uint32_t updateIndex = m_renderDataIndex ^ 1;
+		m_transformPropagation.Update(m_graph, m_transformComponents.data(), m_localTransforms.data(),
+			m_globalTransforms.data(), m_meshComponents, updateIndex);
+		// nothing queued refers to destroyed nodes now. Moved lists don't either: destroying a mesh
+		// lays out both render data again, and that doesn't read them.
+		m_graph.ReleaseNodes();
+
+		tSceneRenderData& renderData = GetUpdateRenderData();
+		if (m_renderLayoutDirty & (1 << updateIndex))
 		{
-			for (uint32_t i = 0; i < m_dirtyNodes[0].GetSize(); ++i)
-			{
-				uint32_t nodeIndex = m_dirtyNodes[0][i];
-				m_globalTransforms[nodeIndex] = m_localTransforms[nodeIndex];
-			}
-			m_dirtyNodes[0].Clear();
-		}
-		// Iterate over the deeper levels
-		for (uint32_t level = 1; level < MaxNodeLevel; ++level)
-		{
-			for (uint32_t nodeIndex = 0; nodeIndex < m_dirtyNodes[level].GetSize(); ++nodeIndex)
-			{
-				int32_t node = m_dirtyNodes[level][nodeIndex];
-				int32_t parentNode = m_hierarchy[node].Parent;
-				m_globalTransforms[node] = m_globalTransforms[parentNode] * m_localTransforms[node];
-			}
-			m_dirtyNodes[level].Clear();
+			m_renderLayoutDirty &= ~(1 << updateIndex);
+			CollectDrawModels(m_meshComponents, m_renderTransformOffsets.data(), renderData.DrawModels, [this, &renderData](lindex_t node, uint32_t meshIndex)
+				{
+					UpdateRenderTransforms(renderData, node);
+					return (uint32_t)m_models[meshIndex].GetTransformsCount();
+				});
 		}
-
-		index_t offset = 0;
-		for (index_t i = 0; i < m_hierarchy.GetSize(); ++i)
+		else
 		{
-			if (m_meshComponentMap.contains(i))
+			// this render data missed the nodes moved for the other one in the last update.
+			for (uint32_t i = 0; i < tTransformPropagation::MovedListCount; ++i)
 			{
-				index_t meshIndex = m_meshComponentMap[i].MeshIndex;
-				cModel& model = m_models[meshIndex];
-				uint32_t count = model.GetTransformsCount();
-				check(offset + count < m_renderTransforms.GetSize());
-				model.UpdateRenderTransforms(m_renderTransforms.GetData() + offset, m_globalTransforms[i]);
-				offset += count;
+				const tDynArray<lindex_t>& movedMeshNodes = m_transformPropagation.GetMovedMeshNodes(i);
+				for (uint32_t j = 0; j < movedMeshNodes.size(); ++j)
+					UpdateRenderTransforms(renderData, movedMeshNodes[j]);
 			}
 		}
+	}
 
+	void Scene::UpdateRenderTransforms(tSceneRenderData& renderData, lindex_t node) const
+	{
+		const cModel& model = m_models[m_meshComponents.Get(node).MeshIndex];
+		lindex_t offset = m_renderTransformOffsets[node];
+		check(offset + model.GetTransformsCount() < renderData.RenderTransforms.GetSize());
+		model.UpdateRenderTransforms(renderData.RenderTransforms.GetData() + offset, m_globalTransforms[node]);
 	}
 
 	bool Scene::LoadSkybox(Skybox& skybox, const char* front, const char* back, const char* left, const char* right, const char* top, const char* bottom)
@@ -687,12 +770,16 @@ namespace Mist
 		strcpy_s(skybox.CubemapFiles[Skybox::TOP], top);
 		strcpy_s(skybox.CubemapFiles[Skybox::BOTTOM], bottom);
 
-		// Load textures from files
+		// Load textures from files, faces read and decoded in parallel.
 		rendersystem::textureloader::TextureData textureData[Skybox::COUNT];
 		const uint8_t* pixelsArray[Skybox::COUNT];
+		tIORequest* requests[Skybox::COUNT];
+		for (uint32_t i = 0; i < Skybox::COUNT; ++i)
+			requests[i] = rendersystem::textureloader::LoadTextureDataAsync_u8(&textureData[i], skybox.CubemapFiles[i], false, IOPriority_High);
 		for (uint32_t i = 0; i < Skybox::COUNT; ++i)
 		{
-			check(rendersystem::textureloader::LoadTextureData_u8(&textureData[i], skybox.CubemapFiles[i]));
+			ReleaseIORequest(requests[i]);
+			check(textureData[i].u8data);
 			pixelsArray[i] = textureData[i].u8data;
 			if (i)
 				check(textureData[i - 1].width == textureData[i].width &&
@@ -716,6 +803,8 @@ namespace Mist
 			upload.SetTextureLayout(skybox.texture, render::ImageLayout_ShaderReadOnly, i);
 		}
 		upload.Submit();
+		for (uint32_t i = 0; i < Skybox::COUNT; ++i)
+			rendersystem::textureloader::FreeTextureData(textureData[i]);
 
 		return true;
 	}
@@ -741,62 +830,58 @@ namespace Mist
 
 	cModel* Scene::GetModel(const char* modelName)
 	{
-		for (uint32_t i = 0; i < m_models.GetSize(); ++i)
-		{
-			if (!strcmp(m_models[i].GetName(), modelName))
-				return &m_models[i];
-		}
-		return nullptr;
+		// a name that was never interned can't belong to any model.
+		return GetModel(tStringId::Find(modelName));
+	}
+
+	cModel* Scene::GetModel(tStringId modelName)
+	{
+		if (!modelName.IsValid())
+			return nullptr;
+		auto it = m_modelIndex.find(modelName);
+		return it != m_modelIndex.end() ? &m_models[it->second] : nullptr;
 	}
 
 	void Scene::Draw(rendersystem::RenderSystem* renderSystem, uint16_t renderFlags) const
 	{
 		CPU_PROFILE_SCOPE(Scene_Draw);
 		
-		// Iterate scene graph to render models.
-		const cMaterial* lastMaterial = nullptr;
-		const cMesh* lastMesh = nullptr;
-		uint32_t nodeCount = GetRenderObjectCount();
+		// Iterate published models, the scene graph belongs to the game thread.
+		const tSceneRenderData& renderData = GetRenderData();
 		index_t renderTransformOffset = 0;
 		index_t materialOffset = 0;
-		for (uint32_t i = 0; i < nodeCount; ++i)
+		for (uint32_t i = 0; i < renderData.DrawModels.GetSize(); ++i)
 		{
-			sRenderObject renderObject = i;
-			const MeshComponent* meshComponent = GetMesh(renderObject);
-			if (meshComponent)
+			PROF_ZONE_SCOPED("DrawMesh");
+			const cModel& model = m_models[renderData.DrawModels[i]];
+
+			// BaseOffset in buffer is already setted when descriptor was created.
+			index_t meshCount = model.m_meshes.GetSize();
+			for (index_t j = 0; j < meshCount; ++j)
 			{
-				PROF_ZONE_SCOPED("DrawMesh");
-				check(meshComponent->MeshIndex != index_invalid);
-				const cModel& model = m_models[meshComponent->MeshIndex];
+				PrepareMeshToDraw(renderSystem, model, j, renderTransformOffset);
+				const cMesh& mesh = model.m_meshes[j];
 
-				// BaseOffset in buffer is already setted when descriptor was created.
-				index_t meshCount = model.m_meshes.GetSize();
-				for (index_t j = 0; j < meshCount; ++j)
+				index_t primitiveCount = mesh.primitiveArray.GetSize();
+				for (index_t k = 0; k < primitiveCount; ++k)
 				{
-					PrepareMeshToDraw(renderSystem, model, j, renderTransformOffset);
-					const cMesh& mesh = model.m_meshes[j];
-
-					index_t primitiveCount = mesh.primitiveArray.GetSize();
-					for (index_t k = 0; k < primitiveCount; ++k)
+					const PrimitiveMeshData& primitive = mesh.primitiveArray[k];
+					if (primitive.RenderFlags & renderFlags)
 					{
-						const PrimitiveMeshData& primitive = mesh.primitiveArray[k];
-						if (primitive.RenderFlags & renderFlags)
-						{
-							check(primitive.Material);
-							index_t offset = limits_cast<index_t>(primitive.Material - model.m_materials.GetData());
-							check(materialOffset + offset < m_materials.GetSize());
-							primitive.Material->BindTextures(renderSystem);
-							sMaterialRenderData materialData = primitive.Material->GetRenderData();
-							renderSystem->SetShaderProperty("u_material", &materialData, sizeof(materialData));
-							renderSystem->DrawIndexed(primitive.Count, 1, primitive.FirstIndex);
-						}
+						check(primitive.Material);
+						index_t offset = limits_cast<index_t>(primitive.Material - model.m_materials.GetData());
+						check(materialOffset + offset < renderData.Materials.GetSize());
+						primitive.Material->BindTextures(renderSystem);
+						const sMaterialRenderData& materialData = renderData.Materials[materialOffset + offset];
+						renderSystem->SetShaderProperty(STRING_ID("u_material"), &materialData, sizeof(materialData));
+						renderSystem->DrawIndexed(primitive.Count, 1, primitive.FirstIndex);
 					}
 				}
-				renderTransformOffset += model.GetTransformsCount();
-				check(renderTransformOffset < m_renderTransforms.GetSize());
-				materialOffset += model.GetMaterialCount();
-				check(materialOffset < m_materials.GetSize());
 			}
+			renderTransformOffset += model.GetTransformsCount();
+			check(renderTransformOffset < renderData.RenderTransforms.GetSize());
+			materialOffset += model.GetMaterialCount();
+			check(materialOffset < renderData.Materials.GetSize());
 		}
 	}
 
@@ -804,28 +889,22 @@ namespace Mist
 	{
 		CPU_PROFILE_SCOPE(Scene_DrawGeometry);
 
-		// Iterate scene graph to render models.
-		uint32_t nodeCount = GetRenderObjectCount();
+		// Iterate published models, the scene graph belongs to the game thread.
+		const tSceneRenderData& renderData = GetRenderData();
 		index_t renderTransformOffset = 0;
-		for (uint32_t i = 0; i < nodeCount; ++i)
+		for (uint32_t i = 0; i < renderData.DrawModels.GetSize(); ++i)
 		{
-			sRenderObject renderObject = i;
-			const MeshComponent* meshComponent = GetMesh(renderObject);
-			if (meshComponent)
+			PROF_ZONE_SCOPED("DrawMeshGeometry");
+			const cModel& model = m_models[renderData.DrawModels[i]];
+			// BaseOffset in buffer is already setted when descriptor was created.
+			for (index_t j = 0; j < model.m_meshes.GetSize(); ++j)
 			{
-				PROF_ZONE_SCOPED("DrawMeshGeometry");
-				check(meshComponent->MeshIndex != index_invalid);
-				const cModel& model = m_models[meshComponent->MeshIndex];
-				// BaseOffset in buffer is already setted when descriptor was created.
-				for (index_t j = 0; j < model.m_meshes.GetSize(); ++j)
-				{
-					PrepareMeshToDraw(renderSystem, model, j, renderTransformOffset);
+				PrepareMeshToDraw(renderSystem, model, j, renderTransformOffset);
 
-					renderSystem->DrawIndexed(model.m_meshes[j].indexCount, 1, 0);
-				}
-				renderTransformOffset += model.GetTransformsCount();
-				check(renderTransformOffset < m_renderTransforms.GetSize());
+				renderSystem->DrawIndexed(model.m_meshes[j].indexCount, 1, 0);
 			}
+			renderTransformOffset += model.GetTransformsCount();
+			check(renderTransformOffset < renderData.RenderTransforms.GetSize());
 		}
 	}
 
@@ -862,6 +941,8 @@ namespace Mist
 		if (ImGui::InputText("Scene file", tempSceneFile, 256))
 			m_sceneFile = tempSceneFile;
 		ImGui::Columns();
+		if (!m_graph.IsBreadthFirst() && ImGui::Button("Sort render objects"))
+			SortRenderObjects();
 
 		ImGui::Separator();
 		ImGui::Text("Environment");
@@ -871,18 +952,24 @@ namespace Mist
 		ImGui::Separator();
 		if (ImGui::TreeNode("Scene tree"))
 		{
-			for (uint32_t i = 0; i < GetRenderObjectCount(); ++i)
+			sRenderObject destroyObject;
+			for (lindex_t i = 0; i < m_graph.GetNodeCount(); ++i)
 			{
-				char treeId[2];
+				if (!m_graph.IsNodeAlive(i))
+					continue;
+				char treeId[16];
 				sprintf_s(treeId, "%u", i);
-				if (ImGui::TreeNode(treeId, "%s", GetRenderObjectName(i)))
+				if (ImGui::TreeNode(treeId, "%s", m_names[i].c_str()))
 				{
 					glm::mat4 transform;
 					TransformComponentToMatrix(&m_transformComponents[i], &transform, 1);
 					DebugRender::DrawAxis(transform);
-					const Hierarchy& node = m_hierarchy[i];
-					ImGui::Text("Parent: %s", node.Parent != UINT32_MAX ? GetRenderObjectName(node.Parent) : "None");
+					const Hierarchy& node = m_graph.GetHierarchy(i);
+					ImGui::Text("Parent: %s", node.Parent != lindex_invalid ? m_names[node.Parent].c_str() : "None");
 					char buff[32];
+					sprintf_s(buff, "Destroy##Destroy%u", i);
+					if (ImGui::Button(buff))
+						destroyObject = m_graph.GetRenderObject(i);
 					sprintf_s(buff, "##TransformComponent%u", i);
 					if (ImGui::TreeNode(buff, "Transform component"))
 					{
@@ -893,8 +980,21 @@ namespace Mist
 						sprintf_s(buff, "##TransformPos%d", i);
 						bool dirty = ImGui::DragFloat3(buff, &t.Position[0], posStep);
 						ImGui::NextColumn();
+						ImGui::Text("Quaternion");
+						ImGui::NextColumn();
+						sprintf_s(buff, "##TransformQuat%d", i);
+						bool quaternion = t.RotationMode == ERotationMode::Quaternion;
+						if (ImGui::Checkbox(buff, &quaternion))
+						{
+							t.RotationMode = quaternion ? ERotationMode::Quaternion : ERotationMode::Euler;
+							dirty = true;
+						}
+						ImGui::NextColumn();
 						sprintf_s(buff, "TransformRot%d", i);
-						dirty |= ImGuiUtils::EditAngles(buff, "Rotation", t.Rotation);
+						if (t.RotationMode == ERotationMode::Euler)
+							dirty |= ImGuiUtils::EditAngles(buff, "Rotation", t.Rotation);
+						else
+							dirty |= ImGuiUtils::EditQuat(buff, "Orientation", t.Orientation);
 						ImGui::NextColumn();
 						ImGui::Text("Scale");
 						ImGui::NextColumn();
@@ -904,14 +1004,17 @@ namespace Mist
 						ImGui::TreePop();
 
 						if (dirty)
-							MarkAsDirty(i);
+						{
+							SyncTransformRotation(t);
+							MarkNodeDirty(i);
+						}
 					}
 					sprintf_s(buff, "##LightComponent%u", i);
-					if (m_lightComponentMap.contains(i))
+					if (LightComponent* lightComponent = m_lightComponents.Find(i))
 					{
 						if (ImGui::TreeNode(buff, "Light component"))
 						{
-							LightComponent& light = m_lightComponentMap[i];
+							LightComponent& light = *lightComponent;
 							static const char* lightTypes[] = { "Point", "Directional", "Spot" };
 							uint32_t lightCount = sizeof(lightTypes) / sizeof(const char*);
 							if (ImGui::BeginCombo("Type", lightTypes[(uint32_t)light.Type]))
@@ -959,12 +1062,12 @@ namespace Mist
 							ImGui::TreePop();
 						}
 					}
-					if (m_meshComponentMap.contains(i))
+					if (const MeshComponent* meshComponent = m_meshComponents.Find(i))
 					{
 						sprintf_s(buff, "##MeshComponent%u", i);
 						if (ImGui::TreeNode(buff, "Mesh component"))
 						{
-							const MeshComponent& meshComp = m_meshComponentMap.at(i);
+							const MeshComponent& meshComp = *meshComponent;
 							ImGui::Text("Model: [%u] %s", meshComp.MeshIndex, meshComp.MeshAssetPath);
 							ImGui::Text("Model name: %s", m_models[meshComp.MeshIndex].GetName());
 							ImGui::TreePop();
@@ -974,6 +1077,9 @@ namespace Mist
 					ImGui::TreePop();
 				}
 			}
+			// after the loop, it takes the subtree with it.
+			if (destroyObject.IsValid())
+				DestroyRenderObject(destroyObject);
 			ImGui::TreePop();
 		}
 		if (ImGui::TreeNode("Model list"))
@@ -1011,11 +1117,12 @@ namespace Mist
 		}
 		if (ImGui::TreeNode("Render transforms"))
 		{
-			for (uint32_t i = 0; i < m_renderTransforms.GetSize(); ++i)
+			const tFixedHeapArray<glm::mat4>& renderTransforms = GetRenderData().RenderTransforms;
+			for (uint32_t i = 0; i < renderTransforms.GetSize(); ++i)
 			{
 				ImGui::Text("%3d", i);
 				for (uint32_t row = 0; row < 4; ++row)
-					ImGui::Text("%6.3f, %6.3f, %6.3f, %6.3f", m_renderTransforms[i][0][row], m_renderTransforms[i][1][row], m_renderTransforms[i][2][row], m_renderTransforms[i][3][row]);
+					ImGui::Text("%6.3f, %6.3f, %6.3f, %6.3f", renderTransforms[i][0][row], renderTransforms[i][1][row], renderTransforms[i][2][row], renderTransforms[i][3][row]);
 			}
 			ImGui::TreePop();
 		}
@@ -1057,12 +1164,7 @@ namespace Mist
 
 	bool Scene::IsDirty() const
 	{
-		for (uint32_t i = 0; i < MaxNodeLevel; ++i)
-		{
-			if (!m_dirtyNodes[i].IsEmpty())
-				return true;
-		}
-		return false;
+		return m_transformPropagation.IsDirty();
 	}
 
 	void Scene::InitRenderPass()
@@ -1073,33 +1175,31 @@ namespace Mist
 
 		index_t transformGlobalIndex = 0;
 		index_t materialGlobalIndex = 0;
-		for (index_t i = 0; i < GetRenderObjectCount(); ++i)
+		// same order as RecalculateTransforms fills the render transforms.
+		for (uint32_t i = 0; i < m_meshComponents.GetCount(); ++i)
 		{
-			if (m_meshComponentMap.contains(i))
+			index_t meshIndex = m_meshComponents[i].MeshIndex;
+			const cModel& model = m_models[meshIndex];
+			for (index_t j = 0; j < model.m_nodes.GetSize(); ++j)
 			{
-				index_t meshIndex = m_meshComponentMap[i].MeshIndex;
-				const cModel& model = m_models[meshIndex];
-				for (index_t j = 0; j < model.m_nodes.GetSize(); ++j)
+				if (model.m_nodes[j].MeshId != index_invalid)
 				{
-					if (model.m_nodes[j].MeshId != index_invalid)
+					const cMesh& mesh = model.m_meshes[model.m_nodes[j].MeshId];
+					for (index_t k = 0; k < mesh.primitiveArray.GetSize(); ++k)
 					{
-						const cMesh& mesh = model.m_meshes[model.m_nodes[j].MeshId];
-						for (index_t k = 0; k < mesh.primitiveArray.GetSize(); ++k)
+						for (index_t m = 0; m < m_drawListArray.GetSize(); ++m)
 						{
-							for (index_t m = 0; m < m_drawListArray.GetSize(); ++m)
-							{
-								index_t materialIndex = limits_cast<index_t>(mesh.primitiveArray[k].Material - model.m_materials.GetData());
+							index_t materialIndex = limits_cast<index_t>(mesh.primitiveArray[k].Material - model.m_materials.GetData());
 
-								// the transform index match with the node index inside model node graph
-								m_drawListArray[m].SubmitRenderPrimitive(&mesh, k, transformGlobalIndex + j, materialIndex + materialGlobalIndex);
-							}
+							// the transform index match with the node index inside model node graph
+							m_drawListArray[m].SubmitRenderPrimitive(&mesh, k, transformGlobalIndex + j, materialIndex + materialGlobalIndex);
 						}
 					}
 				}
-				transformGlobalIndex += model.GetTransformsCount();
-				materialGlobalIndex += model.GetMaterialCount();
-				check(materialGlobalIndex < m_materials.GetSize() && transformGlobalIndex < m_renderTransforms.GetSize());
 			}
+			transformGlobalIndex += model.GetTransformsCount();
+			materialGlobalIndex += model.GetMaterialCount();
+			check(materialGlobalIndex < globals::MaxMaterials && transformGlobalIndex < globals::MaxRenderObjects);
 		}
 	}
 
@@ -1195,7 +1295,7 @@ namespace Mist
 				if (!program && shader != material->m_shaderProgram)
 				{
 					g_render->SetShader(shader);
-					g_render->SetShaderProperty("u_camera", &cameraData, sizeof(cameraData));
+					g_render->SetShaderProperty(STRING_ID("u_camera"), &cameraData, sizeof(cameraData));
 
 				}
 				//if (materialSetIndex != index_invalid)
@@ -1204,7 +1304,7 @@ namespace Mist
 				}
 			}
 			glm::mat4 m(1.f);
-			g_render->SetShaderProperty("u_model", &m, sizeof(m));
+			g_render->SetShaderProperty(STRING_ID("u_model"), &m, sizeof(m));
 			g_render->DrawIndexed(primitive.Count, 1, primitive.FirstIndex);
 		}
 #endif // 0
@@ -1214,20 +1314,34 @@ namespace Mist
 	void Scene::UpdateRenderData()
 	{
 		CPU_PROFILE_SCOPE(SceneUpdateRenderData);
-		if (GetRenderObjectCount())
+		tSceneRenderData& renderData = GetUpdateRenderData();
+		renderData.ShadowLights.Clear();
+		// with every render object destroyed the layout still has to drop their meshes.
+		if (GetRenderObjectCount() || m_renderLayoutDirty)
 		{
 			// Update geometry
 			RecalculateTransforms();
 			check(!IsDirty());
-			const glm::mat4& viewMat = GetCameraData()->View;
-			ProcessEnvironmentData(viewMat, m_environmentData);
+			// camera of the game thread, GetCameraData() is the one of the frame being drawn.
+			const glm::mat4 viewMat = GetCamera().GetCamera().GetView();
+			ProcessEnvironmentData(viewMat, renderData.Environment);
+
+			for (uint32_t i = 0; i < m_lightComponents.GetCount(); ++i)
+			{
+				const LightComponent& light = m_lightComponents[i];
+				if (light.Type != ELightType::Point && light.ProjectShadows && renderData.ShadowLights.GetSize() < globals::MaxShadowMapAttachments)
+				{
+					const TransformComponent& t = m_transformComponents[m_lightComponents.GetEntity(i)];
+					renderData.ShadowLights.Push({ .Type = light.Type, .Position = t.Position, .Rotation = t.Rotation, .OuterCutoff = light.OuterCutoff });
+				}
+			}
 
 			index_t offset = 0;
 			for (index_t i = 0; i < m_models.GetSize(); ++i)
 			{
 				index_t count = m_models[i].GetMaterialCount();
 				check(offset+count < globals::MaxMaterials);
-				m_models[i].UpdateMaterials(m_materials.GetData() + offset);
+				m_models[i].UpdateMaterials(renderData.Materials.GetData() + offset);
 				m_modelMaterialMap[i] = offset;
 				offset += count;
 			}
@@ -1243,10 +1357,15 @@ namespace Mist
 		}
 	}
 
+	void Scene::PublishRenderData()
+	{
+		m_renderDataIndex ^= 1;
+	}
+
 	const glm::mat4* Scene::GetRawGlobalTransforms() const
 	{
 		check(!IsDirty());
-		return m_globalTransforms.GetData();
+		return m_globalTransforms.data();
 	}
 
 
@@ -1258,54 +1377,51 @@ namespace Mist
 		environmentData.ActiveLightsCount = 0;
 		environmentData.ActiveSpotLightsCount = 0;
 		uint32_t shadowMapIndex = 0;
-		for (uint32_t i = 0; i < GetRenderObjectCount(); ++i)
+		for (uint32_t i = 0; i < m_lightComponents.GetCount(); ++i)
 		{
-			if (m_lightComponentMap.contains(i))
+			const glm::mat4& mat = m_globalTransforms[m_lightComponents.GetEntity(i)];
+			const glm::vec3 pos = math::GetPos(viewSpace * mat);
+			const glm::vec3 dir = -1.f*math::GetDir(viewSpace * mat);
+			const LightComponent& light = m_lightComponents[i];
+			switch (light.Type)
 			{
-				const glm::mat4& mat = m_globalTransforms[i];
-				const glm::vec3 pos = math::GetPos(viewSpace * mat);
-				const glm::vec3 dir = -1.f*math::GetDir(viewSpace * mat);
-				const LightComponent& light = m_lightComponentMap[i];
-				switch (light.Type)
-				{
-				case ELightType::Point:
+			case ELightType::Point:
+			{
+				if (environmentData.ActiveLightsCount < EnvironmentData::MaxLights)
 				{
-					if (environmentData.ActiveLightsCount < EnvironmentData::MaxLights)
-					{
-						LightData& data = environmentData.Lights[(uint32_t)environmentData.ActiveLightsCount++];
-						data.Color = light.Color;
-						data.Compression = light.Compression;
-						data.Position = pos;
-						data.Radius = light.Radius;
-					}
-					else
-						logferror("Too many point lights in scene. Current MaxLights is %d.\n", EnvironmentData::MaxLights);
+					LightData& data = environmentData.Lights[(uint32_t)environmentData.ActiveLightsCount++];
+					data.Color = light.Color;
+					data.Compression = light.Compression;
+					data.Position = pos;
+					data.Radius = light.Radius;
 				}
-					break;
-				case ELightType::Directional:
-					environmentData.DirectionalLight.Color = light.Color;
-					environmentData.DirectionalLight.ShadowMapIndex = light.ProjectShadows ? shadowMapIndex++ : -1;
-					environmentData.DirectionalLight.Direction = dir;
-					break;
-				case ELightType::Spot:
+				else
+					logferror("Too many point lights in scene. Current MaxLights is %d.\n", EnvironmentData::MaxLights);
+			}
+				break;
+			case ELightType::Directional:
+				environmentData.DirectionalLight.Color = light.Color;
+				environmentData.DirectionalLight.ShadowMapIndex = light.ProjectShadows ? shadowMapIndex++ : -1;
+				environmentData.DirectionalLight.Direction = dir;
+				break;
+			case ELightType::Spot:
+			{
+				if (environmentData.ActiveSpotLightsCount < EnvironmentData::MaxLights)
 				{
-					if (environmentData.ActiveSpotLightsCount < EnvironmentData::MaxLights)
-					{
-						LightData& data = environmentData.SpotLights[(uint32_t)environmentData.ActiveSpotLightsCount++];
-						data.Color = light.Color;
-						data.ShadowMapIndex = light.ProjectShadows ? shadowMapIndex++ : -1;
-						data.Position = pos;
-						data.Direction = dir;
-						data.CosCutoff.y = cosf(glm::radians(light.OuterCutoff));
-						data.CosCutoff.x = cosf(glm::radians(light.Cutoff));
-						data.Radius = light.Radius;
-						data.Compression = light.Compression;
-					}
-					else
-                        logferror("Too many spot lights in scene. Current MaxLights is %d.\n", EnvironmentData::MaxLights);
-				}
-					break;
+					LightData& data = environmentData.SpotLights[(uint32_t)environmentData.ActiveSpotLightsCount++];
+					data.Color = light.Color;
+					data.ShadowMapIndex = light.ProjectShadows ? shadowMapIndex++ : -1;
+					data.Position = pos;
+					data.Direction = dir;
+					data.CosCutoff.y = cosf(glm::radians(light.OuterCutoff));
+					data.CosCutoff.x = cosf(glm::radians(light.Cutoff));
+					data.Radius = light.Radius;
+					data.Compression = light.Compression;
 				}
+				else
+                        logferror("Too many spot lights in scene. Current MaxLights is %d.\n", EnvironmentData::MaxLights);
+			}
+				break;
 			}
 		}
 		check(shadowMapIndex <= globals::MaxShadowMapAttachments);
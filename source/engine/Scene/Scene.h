@@ -8,6 +8,7 @@
 #include "Utils/Angles.h"
 #include "Utils/FileSystem.h"
 #include "Render/Camera.h"
+#include "Scene/SceneComponents.h"
 
 #define MIST_MAX_MODELS 128
 #define MIST_MAX_CAMERAS 4
@@ -24,71 +25,6 @@ namespace Mist
 	class cModel;
 	struct PreprocessIrradianceInfo;
 
-	struct sRenderObject
-	{
-		index_t Id = index_invalid;
-		sRenderObject() {}
-		sRenderObject(index_t v) : Id(v) {}
-		operator index_t() const { return Id; }
-		inline bool IsValid() const { return Id != index_invalid; }
-	};
-
-
-	enum class ELightType
-	{
-		Point,
-		Directional,
-		Spot
-	};
-
-	const char* LightTypeToStr(ELightType);
-	ELightType StrToLightType(const char* str);
-
-	struct LightComponent
-	{
-		ELightType Type = ELightType::Point;
-		glm::vec3 Color = { 1.f, 1.f, 1.f };
-		float Radius = 10.f;
-		float Compression = 1.f;
-		float OuterCutoff = 30.f;	// Degrees
-		float Cutoff = 30.f;			// Degrees
-		bool ProjectShadows = false;
-	};
-
-	struct MeshComponent
-	{
-		char MeshAssetPath[256];
-		uint32_t MeshIndex;
-
-		MeshComponent() : MeshIndex(UINT32_MAX) { *MeshAssetPath = 0; }
-	};
-
-	struct CameraComponent
-	{
-		bool Main;
-		index_t CameraIndex;
-
-		CameraComponent() : Main(false), CameraIndex(index_invalid) {}
-		CameraComponent(index_t i) : Main(false), CameraIndex(i) {}
-	};
-
-	struct Hierarchy
-	{
-		sRenderObject Parent;
-		sRenderObject Sibling;
-		sRenderObject Child;
-		int32_t Level = 0;
-	};
-
-	struct TransformComponent
-	{
-		glm::vec3 Position;
-		tAngles Rotation;
-		glm::vec3 Scale;
-	};
-
-	void TransformComponentToMatrix(const TransformComponent* transforms, glm::mat4* matrices, uint32_t count);
-
 	struct LightData
 	{
 		glm::vec3 Color;
@@ -161,6 +97,30 @@ namespace Mist
 		uint16_t flags;
 	};
 
+	// shadow casting light copied for the render thread.
+	struct tShadowLightData
+	{
+		ELightType Type;
+		glm::vec3 Position;
+		tAngles Rotation;
+		float OuterCutoff;
+	};
+
+	/**
+	 * Render facing state of the scene for one frame. Scene keeps two of them: the game thread
+	 * fills one in UpdateRenderData while the render thread draws from the other one.
+	 * PublishRenderData swaps them at the frame sync point, when the render thread is idle.
+	 */
+	struct tSceneRenderData
+	{
+		tFixedHeapArray<glm::mat4> RenderTransforms;
+		tFixedHeapArray<sMaterialRenderData> Materials;
+		// model index of each render object with mesh, in draw order.
+		tFixedHeapArray<index_t> DrawModels;
+		tStaticArray<tShadowLightData, globals::MaxShadowMapAttachments> ShadowLights;
+		EnvironmentData Environment;
+	};
+
 	struct tDrawListItem
 	{
 		index_t TransformIndex = index_invalid;
@@ -232,17 +192,29 @@ namespace Mist
 		void SaveScene(const char* filepath);
 
 		sRenderObject CreateRenderObject(sRenderObject parent);
+		// destroys the render object with its subtree and components. Their handles stop being valid.
 		void DestroyRenderObject(sRenderObject object);
+		// the render object is alive, handles of destroyed ones are never valid again.
 		bool IsValid(sRenderObject object) const;
 		uint32_t GetRenderObjectCount() const;
 
+		// first root render object, invalid if the scene is empty.
 		sRenderObject GetRoot() const;
+		// Reorders the render objects breadth first: by hierarchy level, parents before their children and
+		// the children of a node contiguous, so transform updates walk the node arrays front to back.
+		// Also packs the holes left by destroyed render objects. Handles stay the same. Does nothing if the
+		// scene is already in that order.
+		void SortRenderObjects();
+		bool IsBreadthFirst() const { return m_graph.IsBreadthFirst(); }
 
 		const MeshComponent* GetMesh(sRenderObject renderObject) const;
 		void SetMesh(sRenderObject renderObject, const MeshComponent& meshComponent);
 
 		const char* GetRenderObjectName(sRenderObject object) const;
 		void SetRenderObjectName(sRenderObject renderObject, const char* name);
+		// hashed lookup, names don't need to be unique: finds the last render object given the name that
+		// still has it, nothing once all of them were renamed or destroyed.
+		sRenderObject FindRenderObject(const char* name) const;
 
 		const TransformComponent& GetTransform(sRenderObject renderObject) const;
 		void SetTransform(sRenderObject renderObject, const TransformComponent& transform);
@@ -254,7 +226,12 @@ namespace Mist
 
 		const glm::mat4* GetRawGlobalTransforms() const;
 
+		// Game thread: fills the render data not used by the render thread.
 		void UpdateRenderData();
+		// Sync point: makes the last updated render data visible to the render thread.
+		void PublishRenderData();
+		// Render thread: data published for the frame being drawn.
+		const tSceneRenderData& GetRenderData() const { return m_renderData[m_renderDataIndex]; }
 		
 		void Draw(rendersystem::RenderSystem* renderSystem, uint16_t renderFlags = 0) const;
 		void DrawGeometry(rendersystem::RenderSystem* renderSystem, uint16_t renderFlags = 0) const;
@@ -265,7 +242,7 @@ namespace Mist
 
 		void ImGuiDraw();
 		bool IsDirty() const;
-		const EnvironmentData& GetEnvironmentData() const { return m_environmentData; }
+		const EnvironmentData& GetEnvironmentData() const { return GetRenderData().Environment; }
 
 		void InitRenderPass();
 		void PushRenderPipeline(uint32_t pipelineFlags);
@@ -278,46 +255,67 @@ namespace Mist
 	protected:
 		void ProcessEnvironmentData(const glm::mat4& viewMatrix, EnvironmentData& environmentData);
 		void RecalculateTransforms();
+		// node of a live render object.
+		lindex_t GetNode(sRenderObject renderObject) const;
+		// the node arrays follow the scene graph as it grows.
+		void ResizeNodeArrays(uint32_t nodeCount);
+		void MarkNodeDirty(lindex_t node);
+		void UpdateRenderTransforms(tSceneRenderData& renderData, lindex_t node) const;
+		void SetNodeName(lindex_t node, const char* name);
+		// takes node out of the name index and clears its name.
+		void EraseNodeName(lindex_t node);
 		bool LoadSkybox(Skybox& skybox, const char* front, const char* back, const char* left, const char* right, const char* top, const char* bottom);
 		bool LoadIrradianceCube(const PreprocessIrradianceInfo& info);
 
 		const cModel* GetModel(const char* modelName) const { return const_cast<Scene*>(this)->GetModel(modelName); }
 		cModel* GetModel(const char* modelName);
+		const cModel* GetModel(tStringId modelName) const { return const_cast<Scene*>(this)->GetModel(modelName); }
+		cModel* GetModel(tStringId modelName);
 		index_t LoadModel(const char* filepath);
 
 		index_t NewCamera();
 		void SetCamera(sRenderObject r, const CameraComponent& cameraIndex);
 
 		void PrepareMeshToDraw(rendersystem::RenderSystem* renderSystem, const cModel& model, uint32_t meshIndex, uint32_t transformOffset) const;
+		tSceneRenderData& GetUpdateRenderData() { return m_renderData[m_renderDataIndex ^ 1]; }
 
 	private:
 		class VulkanRenderEngine* m_engine{nullptr};
-		static constexpr index_t MaxNodeLevel = 16;
 		cAssetPath m_sceneFile;
-		tFixedHeapArray<String> m_names;
-		tFixedHeapArray<Hierarchy> m_hierarchy;
-		tFixedHeapArray<TransformComponent> m_transformComponents;
-		tMap<index_t, MeshComponent> m_meshComponentMap;
-		tMap<index_t, LightComponent> m_lightComponentMap;
-		tMap<index_t, CameraComponent> m_cameraComponentMap;
+		// render object handles and hierarchy. The arrays and component arrays below are indexed by node.
+		tSceneGraph m_graph;
+		tDynArray<String> m_names;
+		tSceneNameIndex m_nameIndex;
+		tDynArray<TransformComponent> m_transformComponents;
+		// packed by component type, systems iterate only the render objects that have one.
+		tComponentArray<MeshComponent> m_meshComponents;
+		tComponentArray<LightComponent> m_lightComponents;
+		tComponentArray<CameraComponent> m_cameraComponents;
 
 		tStaticArray<cModel, MIST_MAX_MODELS> m_models;
+		// model by name, filled as models are loaded.
+		tFlatMap<tStringId, index_t> m_modelIndex;
 		tStaticArray<CameraController, MIST_MAX_CAMERAS> m_cameras;
 
-		tFixedHeapArray<glm::mat4> m_localTransforms;
-		tFixedHeapArray<glm::mat4> m_globalTransforms;
-		tFixedHeapArray<glm::mat4> m_renderTransforms;
-		tFixedHeapArray<sMaterialRenderData> m_materials;
-		tMap<index_t, index_t> m_modelMaterialMap;
+		tDynArray<glm::mat4> m_localTransforms;
+		tDynArray<glm::mat4> m_globalTransforms;
+		tFlatMap<index_t, index_t> m_modelMaterialMap;
+		tSceneRenderData m_renderData[2];
+		// published render data, the other one is being updated.
+		uint32_t m_renderDataIndex = 0;
 		index_t m_editingModel = index_invalid;
 		
-		tFixedHeapArray<index_t> m_dirtyNodes[MaxNodeLevel];
+		// dirty transforms, moved list per render data.
+		tTransformPropagation m_transformPropagation;
+		// first render transform of each render object with mesh.
+		tDynArray<lindex_t> m_renderTransformOffsets;
+		// bit per render data that needs all its render transforms rewritten, meshes changed.
+		uint32_t m_renderLayoutDirty = 0;
 
 		glm::vec3 m_ambientColor = {0.05f, 0.05f, 0.05f};
 
 		Skybox m_skybox;
 		IrradianceCube m_irradianceCube;
-		EnvironmentData m_environmentData;
 		tStaticArray<tDrawList, 4> m_drawListArray;
 
 		index_t m_cameraIndex = index_invalid;
@@ -0,0 +1,1666 @@
+#include "Scene/SceneComponents.h"
+#include "Core/Debug.h"
+#include "Core/Logger.h"
+#include "Core/Console.h"
+#include "Application/CmdParser.h"
+#include "Utils/GenericUtils.h"
+#include "Utils/TimeUtils.h"
+#include "Core/JobSystem.h"
+#include "Core/TestUtils.h"
+#include "Core/SystemMemory.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define MIST_TRANSFORM_SIMD
+#include <emmintrin.h>
+#endif // _M_X64 || _M_IX86 || __SSE2__
+
+namespace Mist
+{
+	CIntVar CVar_SceneBenchNodes("r_sceneBenchNodes", 100000);
+	CFloatVar CVar_TransformBenchMoving("r_transformBenchMoving", 1.f);
+	CIntVar CVar_SceneGraphStressCycles("r_sceneGraphStressCycles", 4000000);
+
+	const char* LightTypeToStr(ELightType e)
+	{
+		switch (e)
+		{
+		case ELightType::Point: return "Point";
+		case ELightType::Directional: return "Directional";
+		case ELightType::Spot: return "Spot";
+		}
+		check(false);
+		return nullptr;
+	}
+
+	ELightType StrToLightType(const char* str)
+	{
+		if (!strcmp(str, "Point")) return ELightType::Point;
+		if (!strcmp(str, "Spot")) return ELightType::Spot;
+		if (!strcmp(str, "Directional")) return ELightType::Directional;
+		check(false);
+		return (ELightType)0xff;
+	}
+
+	void SyncTransformRotation(TransformComponent& transform)
+	{
+		if (transform.RotationMode == ERotationMode::Euler)
+		{
+			transform.Orientation = transform.Rotation.ToQuat();
+		}
+		else
+		{
+			transform.Orientation = glm::normalize(transform.Orientation);
+			transform.Rotation = tAngles(transform.Orientation);
+		}
+	}
+
+	void TransformComponentToMatrix(const TransformComponent* transforms, glm::mat4* matrices, uint32_t count)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const TransformComponent& t = transforms[i];
+			const glm::quat& q = t.Orientation;
+			// glm::mat3_cast terms, in the order TransformComponentToMatrixSimd computes them.
+			const float x2 = q.x + q.x;
+			const float y2 = q.y + q.y;
+			const float z2 = q.z + q.z;
+			const float xx = q.x * x2;
+			const float yy = q.y * y2;
+			const float zz = q.z * z2;
+			const float xy = q.x * y2;
+			const float xz = q.x * z2;
+			const float yz = q.y * z2;
+			const float wx = q.w * x2;
+			const float wy = q.w * y2;
+			const float wz = q.w * z2;
+
+			glm::mat4& m = matrices[i];
+			m[0] = glm::vec4(1.f - yy - zz, xy + wz, xz - wy, 0.f) * t.Scale.x;
+			m[1] = glm::vec4(xy - wz, 1.f - xx - zz, yz + wx, 0.f) * t.Scale.y;
+			m[2] = glm::vec4(xz + wy, yz - wx, 1.f - xx - yy, 0.f) * t.Scale.z;
+			m[3] = glm::vec4(t.Position, 1.f);
+		}
+	}
+
+#ifdef MIST_TRANSFORM_SIMD
+	namespace transform_simd
+	{
+		inline __m128 Splat(__m128 v, int lane)
+		{
+			switch (lane)
+			{
+			case 0: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+			case 1: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+			case 2: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+			default: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+			}
+		}
+
+		static_assert(offsetof(glm::quat, x) == 0 && offsetof(glm::quat, w) == 3 * sizeof(float), "glm::quat stored as x, y, z, w");
+
+		inline __m128 Load(const glm::vec4& v) { return _mm_loadu_ps(&v.x); }
+		inline void Store(glm::vec4& v, __m128 value) { _mm_storeu_ps(&v.x, value); }
+	}
+#endif // MIST_TRANSFORM_SIMD
+
+	void TransformComponentToMatrixSimd(const TransformComponent* transforms, glm::mat4* matrices, uint32_t count)
+	{
+#ifdef MIST_TRANSFORM_SIMD
+		using namespace transform_simd;
+		const __m128 oneXYZ = _mm_set_ps(0.f, 1.f, 1.f, 1.f);
+		const __m128 maskXYZ = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+		const __m128 maskX = _mm_castsi128_ps(_mm_set_epi32(0, 0, 0, -1));
+		const __m128 maskY = _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, 0));
+		const __m128 maskZ = _mm_castsi128_ps(_mm_set_epi32(0, -1, 0, 0));
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const TransformComponent& t = transforms[i];
+			const glm::quat& q = t.Orientation;
+			const __m128 q0 = _mm_loadu_ps(&q.x);
+			const __m128 q2 = _mm_add_ps(q0, q0);											// x2, y2, z2, w2
+			const __m128 sq = _mm_mul_ps(q0, q2);											// xx, yy, zz, ww
+			// 1 - yy - zz, 1 - xx - zz, 1 - xx - yy, 0
+			const __m128 diag = _mm_sub_ps(_mm_sub_ps(oneXYZ,
+				_mm_and_ps(_mm_shuffle_ps(sq, sq, _MM_SHUFFLE(3, 0, 0, 1)), maskXYZ)),
+				_mm_and_ps(_mm_shuffle_ps(sq, sq, _MM_SHUFFLE(3, 1, 2, 2)), maskXYZ));
+			// xz, xy, yz, ww and wy, wz, wx, ww
+			const __m128 a = _mm_mul_ps(_mm_shuffle_ps(q0, q0, _MM_SHUFFLE(3, 1, 0, 0)), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 2, 1, 2)));
+			const __m128 b = _mm_mul_ps(Splat(q0, 3), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 0, 2, 1)));
+			const __m128 sum = _mm_add_ps(a, b);											// xz + wy, xy + wz, yz + wx, -
+			const __m128 dif = _mm_sub_ps(a, b);											// xz - wy, xy - wz, yz - wx, 0
+
+			// columns from lanes with zero w, diag and dif w are zero.
+			const __m128 d0 = _mm_shuffle_ps(diag, dif, _MM_SHUFFLE(3, 0, 3, 0));		// diag.x, 0, dif.x, 0
+			const __m128 col0 = _mm_or_ps(d0, _mm_and_ps(sum, maskY));
+			const __m128 d1 = _mm_shuffle_ps(dif, diag, _MM_SHUFFLE(3, 1, 3, 1));		// dif.y, 0, diag.y, 0
+			const __m128 col1 = _mm_or_ps(_mm_shuffle_ps(d1, d1, _MM_SHUFFLE(3, 1, 2, 0)), _mm_and_ps(sum, maskZ));
+			const __m128 d2 = _mm_shuffle_ps(dif, diag, _MM_SHUFFLE(3, 2, 3, 2));		// dif.z, 0, diag.z, 0
+			const __m128 col2 = _mm_or_ps(_mm_shuffle_ps(d2, d2, _MM_SHUFFLE(3, 2, 0, 1)), _mm_and_ps(sum, maskX));
+
+			glm::mat4& m = matrices[i];
+			Store(m[0], _mm_mul_ps(col0, _mm_set1_ps(t.Scale.x)));
+			Store(m[1], _mm_mul_ps(col1, _mm_set1_ps(t.Scale.y)));
+			Store(m[2], _mm_mul_ps(col2, _mm_set1_ps(t.Scale.z)));
+			Store(m[3], _mm_set_ps(1.f, t.Position.z, t.Position.y, t.Position.x));
+		}
+#else
+		TransformComponentToMatrix(transforms, matrices, count);
+#endif // MIST_TRANSFORM_SIMD
+	}
+
+	void MultiplyTransformSimd(const glm::mat4& parent, const glm::mat4& local, glm::mat4& global)
+	{
+#ifdef MIST_TRANSFORM_SIMD
+		using namespace transform_simd;
+		const __m128 a0 = Load(parent[0]);
+		const __m128 a1 = Load(parent[1]);
+		const __m128 a2 = Load(parent[2]);
+		const __m128 a3 = Load(parent[3]);
+		__m128 result[4];
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			const __m128 b = Load(local[i]);
+			__m128 r = _mm_add_ps(_mm_mul_ps(a0, Splat(b, 0)), _mm_mul_ps(a1, Splat(b, 1)));
+			r = _mm_add_ps(r, _mm_mul_ps(a2, Splat(b, 2)));
+			result[i] = _mm_add_ps(r, _mm_mul_ps(a3, Splat(b, 3)));
+		}
+		// global may alias parent or local.
+		for (uint32_t i = 0; i < 4; ++i)
+			Store(global[i], result[i]);
+#else
+		global = parent * local;
+#endif // MIST_TRANSFORM_SIMD
+	}
+
+	float GetMaxTransformError(const glm::mat4* a, const glm::mat4* b, uint32_t count)
+	{
+		float maxError = 0.f;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			for (uint32_t j = 0; j < 4; ++j)
+			{
+				// relative to the column, elements near zero come from cancelling products as large as it.
+				float magnitude = 1.f;
+				for (uint32_t k = 0; k < 4; ++k)
+					magnitude = __max(magnitude, fabsf(a[i][j][k]));
+				for (uint32_t k = 0; k < 4; ++k)
+				{
+					const float error = fabsf(a[i][j][k] - b[i][j][k]) / magnitude;
+					// NaN never compares greater, report it.
+					maxError = error > maxError || error != error ? error : maxError;
+				}
+			}
+		}
+		return maxError;
+	}
+
+	void tSceneGraph::Init(uint32_t capacity)
+	{
+		check(capacity < lindex_invalid);
+		m_handles.reserve(capacity);
+		m_freeHandles.reserve(capacity);
+		m_nodes.reserve(capacity);
+		m_nodeHandles.reserve(capacity);
+		m_freeNodes.reserve(capacity);
+		m_destroyedNodes.reserve(capacity);
+	}
+
+	void tSceneGraph::Destroy()
+	{
+		m_handles = {};
+		m_freeHandles = {};
+		m_nodes = {};
+		m_nodeHandles = {};
+		m_freeNodes = {};
+		m_destroyedNodes = {};
+		m_count = 0;
+		m_breadthFirst = true;
+	}
+
+	sRenderObject tSceneGraph::Create(sRenderObject parent)
+	{
+		lindex_t parentNode = lindex_invalid;
+		if (parent.IsValid())
+		{
+			parentNode = GetNode(parent);
+			check(parentNode != lindex_invalid);
+		}
+
+		lindex_t node;
+		if (!m_freeNodes.empty())
+		{
+			node = m_freeNodes.back();
+			m_freeNodes.pop_back();
+			m_breadthFirst = false;
+		}
+		// node and handle slot indices leave lindex_invalid out.
+		else if (m_nodes.size() < lindex_invalid)
+		{
+			node = (lindex_t)m_nodes.size();
+			// appending keeps breadth first order while parents don't go back: roots first, then children
+			// grouped by parent in parent order.
+			if (node)
+			{
+				const lindex_t lastParent = m_nodes[node - 1].Parent;
+				m_breadthFirst &= lastParent == lindex_invalid || (parentNode != lindex_invalid && parentNode >= lastParent);
+			}
+			m_nodes.emplace_back();
+			m_nodeHandles.push_back(lindex_invalid);
+		}
+		else
+		{
+			return sRenderObject();
+		}
+
+		lindex_t id;
+		if (!m_freeHandles.empty())
+		{
+			id = m_freeHandles.back();
+			m_freeHandles.pop_back();
+		}
+		else
+		{
+			// a handle slot per live render object at most, never more than nodes.
+			id = (lindex_t)m_handles.size();
+			m_handles.push_back({ .Node = lindex_invalid, .Generation = 0 });
+		}
+		m_handles[id].Node = node;
+		m_nodeHandles[node] = id;
+
+		Hierarchy& hierarchy = m_nodes[node];
+		hierarchy = Hierarchy();
+		hierarchy.Parent = parentNode;
+		if (parentNode != lindex_invalid)
+		{
+			Hierarchy& parentHierarchy = m_nodes[parentNode];
+			hierarchy.Level = parentHierarchy.Level + 1;
+			hierarchy.PrevSibling = parentHierarchy.LastChild;
+			if (parentHierarchy.LastChild != lindex_invalid)
+				m_nodes[parentHierarchy.LastChild].Sibling = node;
+			else
+				parentHierarchy.Child = node;
+			parentHierarchy.LastChild = node;
+		}
+		++m_count;
+		return sRenderObject(id, m_handles[id].Generation);
+	}
+
+	sRenderObject tSceneGraph::GetRenderObject(lindex_t node) const
+	{
+		check(IsNodeAlive(node));
+		const lindex_t id = m_nodeHandles[node];
+		return sRenderObject(id, m_handles[id].Generation);
+	}
+
+	void tSceneGraph::ReleaseNodes()
+	{
+		m_freeNodes.insert(m_freeNodes.end(), m_destroyedNodes.begin(), m_destroyedNodes.end());
+		m_destroyedNodes.clear();
+	}
+
+	bool tSceneGraph::Sort(tDynArray<lindex_t>& remap)
+	{
+		const uint32_t nodeCount = GetNodeCount();
+		// roots in node order, then the children of every visited node in sibling order.
+		tDynArray<lindex_t> order;
+		order.reserve(m_count);
+		for (uint32_t i = 0; i < nodeCount; ++i)
+		{
+			if (IsNodeAlive(i) && m_nodes[i].Parent == lindex_invalid)
+				order.push_back(i);
+		}
+		for (uint32_t i = 0; i < order.size(); ++i)
+		{
+			for (lindex_t child = m_nodes[order[i]].Child; child != lindex_invalid; child = m_nodes[child].Sibling)
+				order.push_back(child);
+		}
+		check(order.size() == m_count);
+
+		bool sorted = nodeCount == m_count;
+		for (uint32_t i = 0; sorted && i < m_count; ++i)
+			sorted = order[i] == i;
+		m_breadthFirst = true;
+		if (sorted)
+			return false;
+
+		remap.assign(nodeCount, lindex_invalid);
+		for (uint32_t i = 0; i < m_count; ++i)
+			remap[order[i]] = i;
+		tDynArray<Hierarchy> nodes;
+		tDynArray<lindex_t> nodeHandles;
+		nodes.reserve(m_count);
+		nodeHandles.reserve(m_count);
+		for (lindex_t node : order)
+		{
+			nodes.push_back(m_nodes[node]);
+			nodeHandles.push_back(m_nodeHandles[node]);
+		}
+		// live nodes only link to live nodes, destroyed ones were detached.
+		auto remapLink = [&remap](lindex_t& link) { link = link != lindex_invalid ? remap[link] : lindex_invalid; };
+		m_nodes.resize(m_count);
+		m_nodeHandles.resize(m_count);
+		for (uint32_t i = 0; i < m_count; ++i)
+		{
+			Hierarchy& hierarchy = m_nodes[i];
+			hierarchy = nodes[i];
+			remapLink(hierarchy.Parent);
+			remapLink(hierarchy.Child);
+			remapLink(hierarchy.LastChild);
+			remapLink(hierarchy.Sibling);
+			remapLink(hierarchy.PrevSibling);
+			m_nodeHandles[i] = nodeHandles[i];
+			m_handles[nodeHandles[i]].Node = i;
+		}
+		// holes are gone, destroyed nodes included.
+		m_freeNodes.clear();
+		m_destroyedNodes.clear();
+		return true;
+	}
+
+	void tSceneGraph::Detach(lindex_t node)
+	{
+		Hierarchy& hierarchy = m_nodes[node];
+		if (hierarchy.PrevSibling != lindex_invalid)
+			m_nodes[hierarchy.PrevSibling].Sibling = hierarchy.Sibling;
+		else if (hierarchy.Parent != lindex_invalid)
+			m_nodes[hierarchy.Parent].Child = hierarchy.Sibling;
+		if (hierarchy.Sibling != lindex_invalid)
+			m_nodes[hierarchy.Sibling].PrevSibling = hierarchy.PrevSibling;
+		else if (hierarchy.Parent != lindex_invalid)
+			m_nodes[hierarchy.Parent].LastChild = hierarchy.PrevSibling;
+		hierarchy.Parent = lindex_invalid;
+		hierarchy.Sibling = lindex_invalid;
+		hierarchy.PrevSibling = lindex_invalid;
+	}
+
+	void tSceneGraph::Release(lindex_t node)
+	{
+		const lindex_t id = m_nodeHandles[node];
+		tHandleSlot& slot = m_handles[id];
+		slot.Node = lindex_invalid;
+		// 32 bits, a slot would have to be reused 4G times for an old handle to match again.
+		++slot.Generation;
+		m_freeHandles.push_back(id);
+		m_nodeHandles[node] = lindex_invalid;
+		m_nodes[node] = Hierarchy();
+		m_destroyedNodes.push_back(node);
+		--m_count;
+	}
+
+	void tSceneNameIndex::Init(uint32_t capacity)
+	{
+		m_links.reserve(capacity);
+	}
+
+	void tSceneNameIndex::Destroy()
+	{
+		m_heads.clear();
+		m_links = {};
+	}
+
+	void tSceneNameIndex::Insert(const char* name, sRenderObject object)
+	{
+		check(name && object.IsValid());
+		if (!*name)
+			return;
+		// handle slots grow with the scene graph.
+		if (object.Id >= m_links.size())
+			m_links.resize(object.Id + 1);
+		sRenderObject& head = m_heads.try_emplace(name).first->second;
+		tLink& link = m_links[object.Id];
+		link.Previous = sRenderObject();
+		link.Next = head;
+		if (head.IsValid())
+			m_links[head.Id].Previous = object;
+		head = object;
+	}
+
+	void tSceneNameIndex::Remove(const char* name, sRenderObject object)
+	{
+		check(name && object.IsValid());
+		if (!*name)
+			return;
+		check(object.Id < m_links.size());
+		const tLink& link = m_links[object.Id];
+		if (link.Next.IsValid())
+			m_links[link.Next.Id].Previous = link.Previous;
+		if (link.Previous.IsValid())
+		{
+			m_links[link.Previous.Id].Next = link.Next;
+			return;
+		}
+		auto it = m_heads.find(name);
+		check(it != m_heads.end() && it->second == object);
+		if (link.Next.IsValid())
+			it->second = link.Next;
+		else
+			m_heads.erase(it);
+	}
+
+	sRenderObject tSceneNameIndex::Find(const char* name) const
+	{
+		check(name);
+		auto it = m_heads.find(name);
+		return it != m_heads.end() ? it->second : sRenderObject();
+	}
+
+	// remaps the nodes of a node list, dropping the ones remapped to lindex_invalid.
+	void RemapNodeList(tDynArray<lindex_t>& nodes, const lindex_t* remap)
+	{
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < nodes.size(); ++i)
+		{
+			if (remap[nodes[i]] != lindex_invalid)
+				nodes[count++] = remap[nodes[i]];
+		}
+		nodes.resize(count);
+	}
+
+	void tTransformPropagation::Init(uint32_t capacity)
+	{
+		m_dirtyFlags.resize(capacity);
+		for (uint32_t i = 0; i < MaxNodeLevel; ++i)
+			m_dirtyNodes[i].reserve(capacity);
+		for (uint32_t i = 0; i < MovedListCount; ++i)
+			m_movedMeshNodes[i].reserve(capacity);
+	}
+
+	void tTransformPropagation::Destroy()
+	{
+		m_dirtyFlags = {};
+		for (uint32_t i = 0; i < MaxNodeLevel; ++i)
+			m_dirtyNodes[i] = {};
+		for (uint32_t i = 0; i < MovedListCount; ++i)
+			m_movedMeshNodes[i] = {};
+	}
+
+	void tTransformPropagation::MarkDirty(const tSceneGraph& graph, lindex_t node)
+	{
+		MarkGlobalDirty(graph, node);
+		m_dirtyFlags[node] |= TransformDirty_Local;
+	}
+
+	void tTransformPropagation::MarkGlobalDirty(const tSceneGraph& graph, lindex_t node)
+	{
+		// already queued, and so is its subtree.
+		if (m_dirtyFlags[node])
+			return;
+		m_dirtyFlags[node] = TransformDirty_Global;
+		const Hierarchy& hierarchy = graph.GetHierarchy(node);
+		check(hierarchy.Level < MaxNodeLevel);
+		m_dirtyNodes[hierarchy.Level].push_back(node);
+		for (lindex_t child = hierarchy.Child; child != lindex_invalid; child = graph.GetHierarchy(child).Sibling)
+			MarkGlobalDirty(graph, child);
+	}
+
+	uint32_t tTransformPropagation::GetDirtyCount() const
+	{
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < MaxNodeLevel; ++i)
+			count += (uint32_t)m_dirtyNodes[i].size();
+		return count;
+	}
+
+	bool tTransformPropagation::IsDirty() const
+	{
+		for (uint32_t i = 0; i < MaxNodeLevel; ++i)
+		{
+			if (!m_dirtyNodes[i].empty())
+				return true;
+		}
+		return false;
+	}
+
+	void tTransformPropagation::Remap(const lindex_t* remap, uint32_t nodeCount)
+	{
+		RemapArray(m_dirtyFlags, remap, nodeCount);
+		for (uint32_t i = 0; i < MaxNodeLevel; ++i)
+			RemapNodeList(m_dirtyNodes[i], remap);
+		for (uint32_t i = 0; i < MovedListCount; ++i)
+			RemapNodeList(m_movedMeshNodes[i], remap);
+	}
+
+	void tTransformPropagation::Update(const tSceneGraph& graph, const TransformComponent* transforms, glm::mat4* localTransforms,
+		glm::mat4* globalTransforms, const tComponentArray<MeshComponent>& meshes, uint32_t movedIndex)
+	{
+		check(movedIndex < MovedListCount);
+		tDynArray<lindex_t>& movedMeshNodes = m_movedMeshNodes[movedIndex];
+		movedMeshNodes.clear();
+		for (uint32_t level = 0; level < MaxNodeLevel; ++level)
+		{
+			tDynArray<lindex_t>& dirtyNodes = m_dirtyNodes[level];
+			// by id: in breadth first order levels are contiguous ranges, so the whole update is a
+			// single walk front to back of the node arrays, parents included.
+			std::sort(dirtyNodes.begin(), dirtyNodes.end());
+			ParallelForRange((uint32_t)dirtyNodes.size(), BatchSize, [&](uint32_t begin, uint32_t end)
+				{
+					for (uint32_t i = begin; i < end; ++i)
+					{
+						const lindex_t node = dirtyNodes[i];
+						// destroyed after being queued.
+						if (!graph.IsNodeAlive(node))
+							continue;
+						if (m_dirtyFlags[node] & TransformDirty_Local)
+							TransformComponentToMatrixSimd(&transforms[node], &localTransforms[node], 1);
+						const lindex_t parent = graph.GetHierarchy(node).Parent;
+						if (parent != lindex_invalid)
+							MultiplyTransformSimd(globalTransforms[parent], localTransforms[node], globalTransforms[node]);
+						else
+							globalTransforms[node] = localTransforms[node];
+					}
+				});
+			for (uint32_t i = 0; i < dirtyNodes.size(); ++i)
+			{
+				const lindex_t node = dirtyNodes[i];
+				m_dirtyFlags[node] = 0;
+				if (meshes.Contains(node))
+					movedMeshNodes.push_back(node);
+			}
+			dirtyNodes.clear();
+		}
+	}
+
+	namespace scene_bench
+	{
+		static constexpr uint32_t MaxNodeLevel = tTransformPropagation::MaxNodeLevel;
+
+		// scene graph as Scene keeps it, with components both in per type maps (previous Scene layout)
+		// and in packed arrays.
+		struct tSyntheticScene
+		{
+			tSceneGraph Graph;
+			tTransformPropagation Propagation;
+			// Scene before dirty tracking, see MarkAsDirtyUntracked.
+			tDynArray<uint32_t> UntrackedNodes[MaxNodeLevel];
+			// render data double buffer, one transform per mesh at its dense index.
+			tDynArray<glm::mat4> RenderTransforms[tTransformPropagation::MovedListCount];
+			tDynArray<TransformComponent> Transforms;
+			tDynArray<glm::mat4> LocalTransforms;
+			tDynArray<glm::mat4> GlobalTransforms;
+			tFlatMap<uint32_t, MeshComponent> MeshMap;
+			tFlatMap<uint32_t, LightComponent> LightMap;
+			tComponentArray<MeshComponent> Meshes;
+			tComponentArray<LightComponent> Lights;
+
+			inline lindex_t GetParent(uint32_t node) const { return Graph.GetHierarchy(node).Parent; }
+		};
+
+		// what Scene fills for the render thread, one render transform per mesh.
+		struct tDrawCollection
+		{
+			tDynArray<glm::mat4> RenderTransforms;
+			tFixedHeapArray<index_t, uint32_t> DrawModels;
+			// first render transform of each node with mesh.
+			tDynArray<lindex_t> RenderTransformOffsets;
+			glm::vec3 LightPositions;
+
+			void Init(const tSyntheticScene& scene)
+			{
+				RenderTransforms.resize(scene.Meshes.GetCount());
+				DrawModels.Allocate(scene.Meshes.GetCount());
+				RenderTransformOffsets.resize(scene.Transforms.size());
+			}
+
+			void Reset()
+			{
+				DrawModels.Clear();
+				LightPositions = glm::vec3(0.f);
+			}
+
+			bool operator==(const tDrawCollection& other) const
+			{
+				return DrawModels.GetSize() == other.DrawModels.GetSize()
+					&& !memcmp(DrawModels.GetData(), other.DrawModels.GetData(), DrawModels.GetSize() * sizeof(index_t))
+					&& !memcmp(RenderTransforms.data(), other.RenderTransforms.data(), RenderTransforms.size() * sizeof(glm::mat4))
+					&& LightPositions == other.LightPositions;
+			}
+		};
+
+		// one in MeshRatio nodes has a mesh, one in LightRatio a light.
+		static constexpr uint32_t MeshRatio = 8;
+		static constexpr uint32_t LightRatio = 256;
+		static constexpr uint32_t ModelCount = 64;
+
+		// Wide and Balanced are trees with WideBranching and BalancedBranching children per node, Deep
+		// are chains of MaxNodeLevel - 1 nodes under a single root.
+		enum eSceneShape
+		{
+			SceneShape_Wide,
+			SceneShape_Balanced,
+			SceneShape_Deep,
+			SceneShape_Count
+		};
+		static constexpr const char* SceneShapeLabels[SceneShape_Count] = { "wide", "balanced", "deep" };
+		static constexpr uint32_t WideBranching = 64;
+		static constexpr uint32_t BalancedBranching = 4;
+
+		uint32_t GetBenchNodeCount()
+		{
+			return (uint32_t)__max(CVar_SceneBenchNodes.Get(), 1);
+		}
+
+		// parent of each node, nodes numbered breadth first.
+		void GetShapeParents(uint32_t nodeCount, eSceneShape shape, tDynArray<uint32_t>& parents)
+		{
+			const uint32_t chainCount = __max((nodeCount + MaxNodeLevel - 3) / (MaxNodeLevel - 1), 1u);
+			parents.resize(nodeCount);
+			parents[0] = UINT32_MAX;
+			for (uint32_t i = 1; i < nodeCount; ++i)
+			{
+				switch (shape)
+				{
+				case SceneShape_Wide: parents[i] = (i - 1) / WideBranching; break;
+				case SceneShape_Balanced: parents[i] = (i - 1) / BalancedBranching; break;
+				default: parents[i] = i > chainCount ? i - chainCount : 0; break;
+				}
+			}
+		}
+
+		void GetDepthFirstOrder(const tDynArray<uint32_t>& children, const tDynArray<uint32_t>& siblings, uint32_t node, tDynArray<uint32_t>& order)
+		{
+			order.push_back(node);
+			for (uint32_t child = children[node]; child != UINT32_MAX; child = siblings[child])
+				GetDepthFirstOrder(children, siblings, child, order);
+		}
+
+		// every node followed by its subtree, the order a scene saved while editing usually has.
+		void GetDepthFirstOrder(const tDynArray<uint32_t>& parents, tDynArray<uint32_t>& order)
+		{
+			const uint32_t nodeCount = (uint32_t)parents.size();
+			tDynArray<uint32_t> children(nodeCount, UINT32_MAX);
+			tDynArray<uint32_t> siblings(nodeCount, UINT32_MAX);
+			for (uint32_t i = nodeCount; i-- > 0;)
+			{
+				if (parents[i] != UINT32_MAX)
+				{
+					siblings[i] = children[parents[i]];
+					children[parents[i]] = i;
+				}
+			}
+			order.clear();
+			order.reserve(nodeCount);
+			for (uint32_t i = 0; i < nodeCount; ++i)
+			{
+				if (parents[i] == UINT32_MAX)
+					GetDepthFirstOrder(children, siblings, i, order);
+			}
+		}
+
+		// Render objects created breadth first, or depth first, as Scene creates them loading a file.
+		void BuildScene(tSyntheticScene& scene, uint32_t nodeCount, eSceneShape shape = SceneShape_Balanced, bool depthFirst = false)
+		{
+			tDynArray<uint32_t> parents;
+			GetShapeParents(nodeCount, shape, parents);
+			tDynArray<uint32_t> order;
+			if (depthFirst)
+				GetDepthFirstOrder(parents, order);
+			else
+			{
+				order.resize(nodeCount);
+				for (uint32_t i = 0; i < nodeCount; ++i)
+					order[i] = i;
+			}
+
+			tRandom random;
+			scene.Graph.Init(nodeCount);
+			scene.Propagation.Init(nodeCount);
+			scene.Transforms.resize(nodeCount);
+			scene.LocalTransforms.resize(nodeCount);
+			scene.GlobalTransforms.resize(nodeCount);
+			scene.Meshes.Reserve(nodeCount, nodeCount / MeshRatio * 2);
+			// render object of each node of the breadth first numbering.
+			tDynArray<sRenderObject> objects(nodeCount);
+			for (uint32_t i = 0; i < nodeCount; ++i)
+			{
+				// parents are always created before their children, as in LoadScene.
+				const uint32_t parent = parents[order[i]];
+				objects[order[i]] = scene.Graph.Create(parent != UINT32_MAX ? objects[parent] : sRenderObject());
+				// graph is empty, nodes are appended.
+				check(scene.Graph.GetNode(objects[order[i]]) == i);
+				check(scene.Graph.GetHierarchy(i).Level < (int32_t)MaxNodeLevel);
+				TransformComponent& t = scene.Transforms[i];
+				t.Position = glm::vec3(random.Range(-10.f, 10.f), random.Range(-10.f, 10.f), random.Range(-10.f, 10.f));
+				t.Rotation = tAngles(random.Range(-180.f, 180.f), random.Range(-180.f, 180.f), random.Range(-180.f, 180.f));
+				t.Scale = glm::vec3(random.Range(0.5f, 1.5f));
+				SyncTransformRotation(t);
+				if (!random.Range(MeshRatio))
+				{
+					MeshComponent mesh;
+					mesh.MeshIndex = random.Range(ModelCount);
+					scene.MeshMap[i] = mesh;
+					scene.Meshes.Set(i, mesh);
+				}
+				if (!random.Range(LightRatio))
+				{
+					LightComponent light;
+					light.Type = (ELightType)random.Range(3);
+					scene.LightMap[i] = light;
+					scene.Lights.Set(i, light);
+				}
+			}
+			for (uint32_t i = 0; i < CountOf(scene.RenderTransforms); ++i)
+				scene.RenderTransforms[i].resize(scene.Meshes.GetCount());
+		}
+
+		template <typename T>
+		void PermuteArray(tDynArray<T>& array, const tDynArray<lindex_t>& remap)
+		{
+			const tDynArray<T> old(array.begin(), array.end());
+			for (uint32_t i = 0; i < old.size(); ++i)
+				array[remap[i]] = old[i];
+		}
+
+		// breadth first, as Scene::SortRenderObjects. remap gets the new node of each old one. Render
+		// transforms have to be rewritten after it, as Scene does.
+		void SortScene(tSyntheticScene& scene, tDynArray<lindex_t>& remap)
+		{
+			const uint32_t nodeCount = scene.Graph.GetNodeCount();
+			if (!scene.Graph.Sort(remap))
+			{
+				remap.resize(nodeCount);
+				for (uint32_t i = 0; i < nodeCount; ++i)
+					remap[i] = (lindex_t)i;
+				return;
+			}
+			PermuteArray(scene.Transforms, remap);
+			PermuteArray(scene.LocalTransforms, remap);
+			PermuteArray(scene.GlobalTransforms, remap);
+			scene.Propagation.Remap(remap.data(), nodeCount);
+			scene.Meshes.Remap(remap.data(), nodeCount);
+			scene.Lights.Remap(remap.data(), nodeCount);
+			scene.MeshMap.clear();
+			for (uint32_t i = 0; i < scene.Meshes.GetCount(); ++i)
+				scene.MeshMap[scene.Meshes.GetEntity(i)] = scene.Meshes[i];
+			scene.LightMap.clear();
+			for (uint32_t i = 0; i < scene.Lights.GetCount(); ++i)
+				scene.LightMap[scene.Lights.GetEntity(i)] = scene.Lights[i];
+		}
+
+		// every node, parents are created before their children.
+		void UpdateTransforms(tSyntheticScene& scene)
+		{
+			const uint32_t count = (uint32_t)scene.Transforms.size();
+			TransformComponentToMatrix(scene.Transforms.data(), scene.LocalTransforms.data(), count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const lindex_t parent = scene.GetParent(i);
+				scene.GlobalTransforms[i] = parent != lindex_invalid ? scene.GlobalTransforms[parent] * scene.LocalTransforms[i] : scene.LocalTransforms[i];
+			}
+		}
+
+		// lookups per node, as Scene did with its component maps.
+		void CollectMapped(const tSyntheticScene& scene, tDrawCollection& collection)
+		{
+			collection.Reset();
+			const uint32_t count = (uint32_t)scene.Transforms.size();
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				if (scene.MeshMap.contains(i))
+				{
+					collection.RenderTransforms[collection.DrawModels.GetSize()] = scene.GlobalTransforms[i];
+					collection.DrawModels.Push((index_t)scene.MeshMap.at(i).MeshIndex);
+				}
+			}
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				if (scene.LightMap.contains(i) && scene.LightMap.at(i).Type != ELightType::Directional)
+					collection.LightPositions += math::GetPos(scene.GlobalTransforms[i]);
+			}
+		}
+
+		// Scene::RecalculateTransforms laying out a render data, and the lights as Scene::ProcessEnvironmentData
+		// walks them.
+		void CollectPacked(const tSyntheticScene& scene, tDrawCollection& collection)
+		{
+			collection.Reset();
+			glm::mat4* renderTransforms = collection.RenderTransforms.data();
+			const lindex_t* offsets = collection.RenderTransformOffsets.data();
+			CollectDrawModels(scene.Meshes, collection.RenderTransformOffsets.data(), collection.DrawModels, [&scene, renderTransforms, offsets](lindex_t node, uint32_t meshIndex)
+				{
+					renderTransforms[offsets[node]] = scene.GlobalTransforms[node];
+					return 1u;
+				});
+			for (uint32_t i = 0; i < scene.Lights.GetCount(); ++i)
+			{
+				if (scene.Lights[i].Type != ELightType::Directional)
+					collection.LightPositions += math::GetPos(scene.GlobalTransforms[scene.Lights.GetEntity(i)]);
+			}
+		}
+
+		// Scene before dirty tracking: the subtree is queued again for every mark, every local matrix
+		// is rebuilt and every render transform rewritten.
+		void MarkAsDirtyUntracked(tSyntheticScene& scene, uint32_t node)
+		{
+			const Hierarchy& hierarchy = scene.Graph.GetHierarchy(node);
+			scene.UntrackedNodes[hierarchy.Level].push_back(node);
+			for (lindex_t child = hierarchy.Child; child != lindex_invalid; child = scene.Graph.GetHierarchy(child).Sibling)
+				MarkAsDirtyUntracked(scene, child);
+		}
+
+		void RecalculateUntracked(tSyntheticScene& scene, uint32_t renderDataIndex)
+		{
+			TransformComponentToMatrix(scene.Transforms.data(), scene.LocalTransforms.data(), (uint32_t)scene.Transforms.size());
+			for (uint32_t level = 0; level < MaxNodeLevel; ++level)
+			{
+				for (uint32_t node : scene.UntrackedNodes[level])
+				{
+					const lindex_t parent = scene.GetParent(node);
+					scene.GlobalTransforms[node] = parent != lindex_invalid ? scene.GlobalTransforms[parent] * scene.LocalTransforms[node] : scene.LocalTransforms[node];
+				}
+				scene.UntrackedNodes[level].clear();
+			}
+			glm::mat4* renderTransforms = scene.RenderTransforms[renderDataIndex].data();
+			for (uint32_t i = 0; i < scene.Meshes.GetCount(); ++i)
+				renderTransforms[i] = scene.GlobalTransforms[scene.Meshes.GetEntity(i)];
+		}
+
+		// Scene::MarkNodeDirty.
+		void MarkAsDirty(tSyntheticScene& scene, uint32_t node)
+		{
+			scene.Propagation.MarkDirty(scene.Graph, (lindex_t)node);
+		}
+
+		// Scene::RecalculateTransforms with the render layout unchanged.
+		void RecalculateDirty(tSyntheticScene& scene, uint32_t renderDataIndex)
+		{
+			scene.Propagation.Update(scene.Graph, scene.Transforms.data(), scene.LocalTransforms.data(), scene.GlobalTransforms.data(), scene.Meshes, renderDataIndex);
+			// this render data missed the meshes moved for the other one in the last update.
+			glm::mat4* renderTransforms = scene.RenderTransforms[renderDataIndex].data();
+			for (uint32_t i = 0; i < tTransformPropagation::MovedListCount; ++i)
+			{
+				const tDynArray<lindex_t>& movedMeshNodes = scene.Propagation.GetMovedMeshNodes(i);
+				for (uint32_t j = 0; j < movedMeshNodes.size(); ++j)
+					renderTransforms[scene.Meshes.GetIndex(movedMeshNodes[j])] = scene.GlobalTransforms[movedMeshNodes[j]];
+			}
+		}
+
+		// moves count random nodes, same sequence for a given seed. With remap the same nodes are moved in
+		// a reordered copy of the scene.
+		template <typename MarkFn>
+		void MoveNodes(tSyntheticScene& scene, tRandom& random, uint32_t count, MarkFn&& mark, const lindex_t* remap = nullptr)
+		{
+			const uint32_t nodeCount = (uint32_t)scene.Transforms.size();
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const uint32_t index = random.Range(nodeCount);
+				const uint32_t node = remap ? remap[index] : index;
+				scene.Transforms[node].Position.y += random.Range(-0.1f, 0.1f);
+				mark(scene, node);
+			}
+		}
+
+	}
+
+	void BenchmarkSceneComponents()
+	{
+		using namespace scene_bench;
+		static constexpr uint32_t Rounds = 16;
+		const uint32_t nodeCount = GetBenchNodeCount();
+
+		tSyntheticScene scene;
+		BuildScene(scene, nodeCount);
+		tDrawCollection mapped;
+		tDrawCollection packed;
+		mapped.Init(scene);
+		packed.Init(scene);
+		// first pass sizes the outputs and warms the caches.
+		UpdateTransforms(scene);
+		CollectMapped(scene, mapped);
+		CollectPacked(scene, packed);
+
+		double updateMs = 0.0;
+		double mappedMs = 0.0;
+		double packedMs = 0.0;
+		Profiling::sProfilingTimer timer;
+		for (uint32_t r = 0; r < Rounds; ++r)
+		{
+			timer.Start();
+			UpdateTransforms(scene);
+			updateMs += timer.Stop();
+
+			timer.Start();
+			CollectMapped(scene, mapped);
+			mappedMs += timer.Stop();
+
+			timer.Start();
+			CollectPacked(scene, packed);
+			packedMs += timer.Stop();
+		}
+		updateMs /= Rounds;
+		mappedMs /= Rounds;
+		packedMs /= Rounds;
+
+		const double nsPerNode = 1e6 / (double)nodeCount;
+		loginfo("****************** Scene components benchmark ******************\n");
+		logfinfo("Nodes:			%8u (%u meshes, %u lights)\n", nodeCount, scene.Meshes.GetCount(), scene.Lights.GetCount());
+		logfinfo("Transform update:	%8.3f ms (%6.2f ns/node)\n", updateMs, updateMs * nsPerNode);
+		logfinfo("Collect maps:		%8.3f ms (%6.2f ns/node)\n", mappedMs, mappedMs * nsPerNode);
+		logfinfo("Collect packed:		%8.3f ms (%6.2f ns/node, %.1fx)\n", packedMs, packedMs * nsPerNode, mappedMs / __max(packedMs, 1e-6));
+		if (!(mapped == packed))
+			logferror("Scene components benchmark: packed collection doesn't match.\n");
+		loginfo("****************************************************************\n");
+	}
+
+	void BenchmarkTransformPropagation()
+	{
+		using namespace scene_bench;
+		static constexpr uint32_t Frames = 64;
+		const uint32_t nodeCount = GetBenchNodeCount();
+		const uint32_t moving = (uint32_t)__max((double)nodeCount * (double)CVar_TransformBenchMoving.Get() / 100.0, 1.0);
+
+		// same scene and same moves for both, results must match.
+		tSyntheticScene untracked;
+		tSyntheticScene tracked;
+		BuildScene(untracked, nodeCount);
+		BuildScene(tracked, nodeCount);
+		for (uint32_t i = 0; i < nodeCount; ++i)
+		{
+			MarkAsDirtyUntracked(untracked, i);
+			MarkAsDirty(tracked, i);
+		}
+		for (uint32_t i = 0; i < CountOf(untracked.RenderTransforms); ++i)
+		{
+			RecalculateUntracked(untracked, i);
+			RecalculateDirty(tracked, i);
+		}
+
+		tRandom untrackedRandom;
+		tRandom trackedRandom;
+		uint64_t untrackedQueued = 0;
+		uint64_t trackedQueued = 0;
+		double untrackedMs = 0.0;
+		double trackedMs = 0.0;
+		Profiling::sProfilingTimer timer;
+		for (uint32_t frame = 0; frame < Frames; ++frame)
+		{
+			const uint32_t renderDataIndex = frame & 1;
+			timer.Start();
+			MoveNodes(untracked, untrackedRandom, moving, &MarkAsDirtyUntracked);
+			for (uint32_t level = 0; level < MaxNodeLevel; ++level)
+				untrackedQueued += untracked.UntrackedNodes[level].size();
+			RecalculateUntracked(untracked, renderDataIndex);
+			untrackedMs += timer.Stop();
+
+			timer.Start();
+			MoveNodes(tracked, trackedRandom, moving, &MarkAsDirty);
+			trackedQueued += tracked.Propagation.GetDirtyCount();
+			RecalculateDirty(tracked, renderDataIndex);
+			trackedMs += timer.Stop();
+		}
+
+		// dirty update composes with SIMD, the previous scheme is scalar.
+		float maxError = GetMaxTransformError(untracked.GlobalTransforms.data(), tracked.GlobalTransforms.data(), nodeCount);
+		for (uint32_t i = 0; i < CountOf(untracked.RenderTransforms); ++i)
+			maxError = __max(maxError, GetMaxTransformError(untracked.RenderTransforms[i].data(), tracked.RenderTransforms[i].data(), (uint32_t)untracked.RenderTransforms[i].size()));
+		// error adds up once per hierarchy level.
+		const float tolerance = TransformSimdTolerance * MaxNodeLevel;
+		const bool valid = maxError <= tolerance;
+
+		loginfo("****************** Transform propagation benchmark ******************\n");
+		logfinfo("Nodes:			%8u (%u meshes, %u moving per frame)\n", nodeCount, tracked.Meshes.GetCount(), moving);
+		logfinfo("Recalculate all:	%8.3f ms/frame (%llu nodes queued/frame)\n", untrackedMs / Frames, untrackedQueued / Frames);
+		logfinfo("Recalculate dirty:	%8.3f ms/frame (%llu nodes queued/frame, %.1fx)\n", trackedMs / Frames, trackedQueued / Frames, untrackedMs / __max(trackedMs, 1e-6));
+		logfinfo("Max error:		%g (tolerance %g)\n", maxError, tolerance);
+		if (!valid)
+			logferror("Transform propagation benchmark: dirty update doesn't match full update.\n");
+		loginfo("*********************************************************************\n");
+	}
+
+	void BenchmarkTransformComposition()
+	{
+		using namespace scene_bench;
+		static constexpr uint32_t Rounds = 16;
+		const uint32_t nodeCount = GetBenchNodeCount();
+
+		tSyntheticScene scene;
+		BuildScene(scene, nodeCount);
+		// as Scene queues them with every node dirty.
+		tDynArray<uint32_t> levelNodes[MaxNodeLevel];
+		for (uint32_t i = 0; i < nodeCount; ++i)
+			levelNodes[scene.Graph.GetHierarchy(i).Level].push_back(i);
+		const TransformComponent* transforms = scene.Transforms.data();
+
+		enum { Scalar, Simd, Parallel, Count };
+		static constexpr const char* Labels[Count] = { "scalar", "SIMD", "SIMD parallel" };
+		tDynArray<glm::mat4> locals[Count];
+		tDynArray<glm::mat4> globals[Count];
+		for (uint32_t i = 0; i < Count; ++i)
+		{
+			locals[i].resize(nodeCount);
+			globals[i].resize(nodeCount);
+		}
+
+		auto composeLocals = [&](uint32_t mode)
+			{
+				glm::mat4* dst = locals[mode].data();
+				if (mode == Scalar)
+					TransformComponentToMatrix(transforms, dst, nodeCount);
+				else if (mode == Simd)
+					TransformComponentToMatrixSimd(transforms, dst, nodeCount);
+				else
+					ParallelForRange(nodeCount, tTransformPropagation::BatchSize, [transforms, dst](uint32_t begin, uint32_t end)
+						{
+							TransformComponentToMatrixSimd(transforms + begin, dst + begin, end - begin);
+						});
+			};
+		// from the scalar locals, so the multiplication alone can be compared bit for bit.
+		auto composeGlobals = [&](uint32_t mode)
+			{
+				const glm::mat4* src = locals[Scalar].data();
+				glm::mat4* dst = globals[mode].data();
+				for (uint32_t level = 0; level < MaxNodeLevel; ++level)
+				{
+					const uint32_t* nodes = levelNodes[level].data();
+					auto fn = [&scene, src, dst, nodes, mode](uint32_t begin, uint32_t end)
+						{
+							for (uint32_t i = begin; i < end; ++i)
+							{
+								const uint32_t node = nodes[i];
+								const lindex_t parent = scene.GetParent(node);
+								if (parent == lindex_invalid)
+									dst[node] = src[node];
+								else if (mode == Scalar)
+									dst[node] = dst[parent] * src[node];
+								else
+									MultiplyTransformSimd(dst[parent], src[node], dst[node]);
+							}
+						};
+					const uint32_t count = (uint32_t)levelNodes[level].size();
+					if (mode == Parallel)
+						ParallelForRange(count, tTransformPropagation::BatchSize, fn);
+					else
+						fn(0, count);
+				}
+			};
+
+		double localMs[Count] = {};
+		double globalMs[Count] = {};
+		Profiling::sProfilingTimer timer;
+		for (uint32_t r = 0; r <= Rounds; ++r)
+		{
+			for (uint32_t mode = 0; mode < Count; ++mode)
+			{
+				timer.Start();
+				composeLocals(mode);
+				const double ms = timer.Stop();
+				// first round warms the caches.
+				localMs[mode] += r ? ms : 0.0;
+			}
+			for (uint32_t mode = 0; mode < Count; ++mode)
+			{
+				timer.Start();
+				composeGlobals(mode);
+				const double ms = timer.Stop();
+				globalMs[mode] += r ? ms : 0.0;
+			}
+		}
+
+		float localError = 0.f;
+		bool globalsExact = true;
+		for (uint32_t mode = Simd; mode < Count; ++mode)
+		{
+			localError = __max(localError, GetMaxTransformError(locals[Scalar].data(), locals[mode].data(), nodeCount));
+			globalsExact &= !memcmp(globals[Scalar].data(), globals[mode].data(), nodeCount * sizeof(glm::mat4));
+		}
+
+		loginfo("****************** Transform composition benchmark ******************\n");
+		logfinfo("Nodes:			%8u (%u job threads)\n", nodeCount, GetJobThreadCount());
+		for (uint32_t mode = 0; mode < Count; ++mode)
+		{
+			const double local = localMs[mode] / Rounds;
+			const double global = globalMs[mode] / Rounds;
+			logfinfo("%-14s local %8.3f ms (%7.2f Mnodes/s) | global %8.3f ms (%7.2f Mnodes/s)\n", Labels[mode],
+				local, (double)nodeCount / (local * 1e3), global, (double)nodeCount / (global * 1e3));
+		}
+		logfinfo("Local max error:	%g (tolerance %g)\n", localError, TransformSimdTolerance);
+		if (localError > TransformSimdTolerance)
+			logferror("Transform composition benchmark: SIMD local transforms out of tolerance.\n");
+		if (!globalsExact)
+			logferror("Transform composition benchmark: SIMD global transforms don't match the scalar ones.\n");
+		loginfo("*********************************************************************\n");
+	}
+
+	void BenchmarkHierarchyOrder()
+	{
+		using namespace scene_bench;
+		static constexpr uint32_t Frames = 32;
+		const uint32_t nodeCount = GetBenchNodeCount();
+		const uint32_t moving = (uint32_t)__max((double)nodeCount * (double)CVar_TransformBenchMoving.Get() / 100.0, 1.0);
+
+		loginfo("****************** Hierarchy order benchmark ******************\n");
+		logfinfo("Nodes:			%8u (%u moving per frame, %u job threads)\n", nodeCount, moving, GetJobThreadCount());
+		bool valid = true;
+		for (uint32_t shape = 0; shape < SceneShape_Count; ++shape)
+		{
+			// same scene in creation order (depth first) and sorted, remap takes created ids to sorted ones.
+			enum { Created, Sorted, Count };
+			tSyntheticScene scenes[Count];
+			tDynArray<lindex_t> remap;
+			for (uint32_t i = 0; i < Count; ++i)
+				BuildScene(scenes[i], nodeCount, (eSceneShape)shape, true);
+			SortScene(scenes[Sorted], remap);
+			uint32_t levelCount = 0;
+			for (uint32_t node = 0; node < nodeCount; ++node)
+				levelCount = __max(levelCount, (uint32_t)scenes[Created].Graph.GetHierarchy(node).Level + 1);
+
+			double allMs[Count] = {};
+			double movingMs[Count] = {};
+			Profiling::sProfilingTimer timer;
+			for (uint32_t i = 0; i < Count; ++i)
+			{
+				tSyntheticScene& scene = scenes[i];
+				// first frame warms the caches.
+				for (uint32_t frame = 0; frame <= Frames; ++frame)
+				{
+					timer.Start();
+					for (uint32_t node = 0; node < nodeCount; ++node)
+						MarkAsDirty(scene, node);
+					RecalculateDirty(scene, frame & 1);
+					const double ms = timer.Stop();
+					allMs[i] += frame ? ms : 0.0;
+				}
+				tRandom random;
+				for (uint32_t frame = 0; frame < Frames; ++frame)
+				{
+					timer.Start();
+					MoveNodes(scene, random, moving, &MarkAsDirty, i == Sorted ? remap.data() : nullptr);
+					RecalculateDirty(scene, frame & 1);
+					movingMs[i] += timer.Stop();
+				}
+			}
+
+			// same operations on the same nodes, only the order changed.
+			for (uint32_t node = 0; node < nodeCount && valid; ++node)
+				valid = !memcmp(&scenes[Created].GlobalTransforms[node], &scenes[Sorted].GlobalTransforms[remap[node]], sizeof(glm::mat4));
+
+			logfinfo("%-9s %2u levels | all: creation %8.3f ms, breadth first %8.3f ms (%.2fx) | moving: creation %8.3f ms, breadth first %8.3f ms (%.2fx)\n",
+				SceneShapeLabels[shape], levelCount,
+				allMs[Created] / Frames, allMs[Sorted] / Frames, allMs[Created] / __max(allMs[Sorted], 1e-6),
+				movingMs[Created] / Frames, movingMs[Sorted] / Frames, movingMs[Created] / __max(movingMs[Sorted], 1e-6));
+		}
+		if (!valid)
+			logferror("Hierarchy order benchmark: breadth first transforms don't match creation order ones.\n");
+		loginfo("***************************************************************\n");
+	}
+
+	bool TestTransformRotation()
+	{
+		using namespace scene_bench;
+		static constexpr uint32_t Count = 65536;
+		static constexpr uint32_t Rounds = 16;
+		loginfo("****************** Transform rotation tests ******************\n");
+		bool result = true;
+		tRandom random;
+		tDynArray<TransformComponent> transforms(Count);
+		enum { Euler, Quat, Simd, MatrixCount };
+		tDynArray<glm::mat4> matrices[MatrixCount];
+		for (uint32_t i = 0; i < MatrixCount; ++i)
+			matrices[i].resize(Count);
+		// reference, TransformComponentToMatrix before quaternions.
+		auto buildEuler = [&]()
+			{
+				for (uint32_t i = 0; i < Count; ++i)
+					matrices[Euler][i] = math::ToMat4(transforms[i].Position, transforms[i].Rotation, transforms[i].Scale);
+			};
+		auto buildAll = [&]()
+			{
+				buildEuler();
+				TransformComponentToMatrix(transforms.data(), matrices[Quat].data(), Count);
+				TransformComponentToMatrixSimd(transforms.data(), matrices[Simd].data(), Count);
+			};
+		auto checkMatrices = [&](float& maxError)
+			{
+				maxError = GetMaxTransformError(matrices[Euler].data(), matrices[Quat].data(), Count);
+				return maxError <= TransformQuatTolerance
+					&& !memcmp(matrices[Quat].data(), matrices[Simd].data(), Count * sizeof(glm::mat4));
+			};
+
+		float eulerError = 0.f;
+		{
+			// yaw at gimbal lock in the first ones, angles out of [-180, 180] in the next.
+			for (uint32_t i = 0; i < Count; ++i)
+			{
+				TransformComponent& t = transforms[i];
+				t.Position = glm::vec3(random.Range(-10.f, 10.f), random.Range(-10.f, 10.f), random.Range(-10.f, 10.f));
+				t.Rotation = tAngles(random.Range(-180.f, 180.f), random.Range(-180.f, 180.f), random.Range(-180.f, 180.f));
+				t.Scale = glm::vec3(random.Range(0.5f, 1.5f), random.Range(0.5f, 1.5f), random.Range(0.5f, 1.5f));
+				t.RotationMode = ERotationMode::Euler;
+				if (i < 64)
+					t.Rotation.m_yaw = i & 1 ? 90.f : -90.f;
+				else if (i < 128)
+					t.Rotation *= 8.f;
+				SyncTransformRotation(t);
+			}
+			buildAll();
+			result &= TestResult(checkMatrices(eulerError), "Transform rotation", "euler mode");
+		}
+
+		float quatError = 0.f;
+		{
+			// euler angles follow the quaternion, both have to build the same matrix.
+			for (uint32_t i = 0; i < Count; ++i)
+			{
+				TransformComponent& t = transforms[i];
+				t.RotationMode = ERotationMode::Quaternion;
+				if (i < 64)
+					t.Orientation = tAngles(random.Range(-180.f, 180.f), i & 1 ? 90.f : -90.f, random.Range(-180.f, 180.f)).ToQuat();
+				else
+				{
+					do
+						t.Orientation = glm::quat(random.Range(-1.f, 1.f), random.Range(-1.f, 1.f), random.Range(-1.f, 1.f), random.Range(-1.f, 1.f));
+					while (glm::length(t.Orientation) < 0.1f);
+				}
+				SyncTransformRotation(t);
+			}
+			buildAll();
+			result &= TestResult(checkMatrices(quatError), "Transform rotation", "quaternion mode");
+		}
+
+		float switchError = 0.f;
+		{
+			// back to euler, the orientation is rebuilt from the angles.
+			const tDynArray<glm::mat4> previous(matrices[Quat].begin(), matrices[Quat].end());
+			for (TransformComponent& t : transforms)
+			{
+				t.RotationMode = ERotationMode::Euler;
+				SyncTransformRotation(t);
+			}
+			TransformComponentToMatrix(transforms.data(), matrices[Quat].data(), Count);
+			switchError = GetMaxTransformError(previous.data(), matrices[Quat].data(), Count);
+			result &= TestResult(switchError <= TransformQuatTolerance, "Transform rotation", "mode switch");
+		}
+
+		double ms[MatrixCount] = {};
+		Profiling::sProfilingTimer timer;
+		for (uint32_t r = 0; r <= Rounds; ++r)
+		{
+			// first round warms the caches.
+			timer.Start();
+			buildEuler();
+			ms[Euler] += r ? timer.Stop() : 0.0;
+			timer.Start();
+			TransformComponentToMatrix(transforms.data(), matrices[Quat].data(), Count);
+			ms[Quat] += r ? timer.Stop() : 0.0;
+			timer.Start();
+			TransformComponentToMatrixSimd(transforms.data(), matrices[Simd].data(), Count);
+			ms[Simd] += r ? timer.Stop() : 0.0;
+		}
+
+		const double nsPerTransform = 1e6 / (double)Count / Rounds;
+		logfinfo("Max error:		euler mode %g, quaternion mode %g, mode switch %g (tolerance %g)\n", eulerError, quatError, switchError, TransformQuatTolerance);
+		logfinfo("Euler matrices:		%8.3f ms (%6.2f ns/transform)\n", ms[Euler] / Rounds, ms[Euler] * nsPerTransform);
+		logfinfo("Quaternion matrices:	%8.3f ms (%6.2f ns/transform, %.1fx)\n", ms[Quat] / Rounds, ms[Quat] * nsPerTransform, ms[Euler] / __max(ms[Quat], 1e-6));
+		logfinfo("Quaternion SIMD:	%8.3f ms (%6.2f ns/transform, %.1fx)\n", ms[Simd] / Rounds, ms[Simd] * nsPerTransform, ms[Euler] / __max(ms[Simd], 1e-6));
+		loginfo("**************************************************************\n");
+		return result;
+	}
+
+	bool TestSceneGraph()
+	{
+		using namespace scene_bench;
+		// live render objects at most, past what 16 bit indices reach. The graph starts with a quarter of
+		// it and grows.
+		static constexpr uint32_t Capacity = 1 << 17;
+		// render objects created between checks, and between ReleaseNodes as a scene update would do.
+		static constexpr uint32_t RoundCreations = 1 << 18;
+		static constexpr uint32_t FrameOperations = 1024;
+		static constexpr uint32_t DestroyedHistory = 4096;
+		const uint32_t cycles = (uint32_t)__max(CVar_SceneGraphStressCycles.Get(), 1);
+		loginfo("****************** Scene graph tests ******************\n");
+		bool result = true;
+		tRandom random;
+		tSceneGraph graph;
+		graph.Init(Capacity / 4);
+		// creation serial of each render object, checks handles still reach their own node after sorts.
+		tComponentArray<uint32_t> serials;
+		tComponentArray<LightComponent> lights;
+		struct tLiveObject
+		{
+			sRenderObject Handle;
+			uint32_t Serial;
+		};
+		tDynArray<tLiveObject> live;
+		// position in live by handle slot.
+		tDynArray<uint32_t> liveIndex(Capacity, UINT32_MAX);
+		tDynArray<sRenderObject> destroyed(DestroyedHistory);
+		uint32_t created = 0;
+		uint32_t destroyedCount = 0;
+		live.reserve(Capacity);
+		serials.Reserve(Capacity, Capacity);
+		lights.Reserve(Capacity, Capacity);
+		// a few names shared by many render objects, as loaded scenes have.
+		static const char* Names[] = { "Mesh", "Light", "Camera", "Node" };
+		static constexpr uint32_t NoName = UINT32_MAX;
+		tSceneNameIndex names;
+		names.Init(Capacity / 4);
+		// name and naming serial by handle slot.
+		tDynArray<uint32_t> nameOf(Capacity, NoName);
+		tDynArray<uint32_t> nameSerial(Capacity, 0);
+		uint32_t namings = 0;
+		auto setName = [&](sRenderObject object, uint32_t name)
+			{
+				if (nameOf[object.Id] != NoName)
+					names.Remove(Names[nameOf[object.Id]], object);
+				nameOf[object.Id] = name;
+				if (name != NoName)
+				{
+					names.Insert(Names[name], object);
+					nameSerial[object.Id] = namings++;
+				}
+			};
+		auto randomName = [&]()
+			{
+				const uint32_t name = random.Range(CountOf(Names) + 1);
+				return name < CountOf(Names) ? name : NoName;
+			};
+
+		// child of a random render object most of the times, with the levels a scene allows.
+		auto createObject = [&]()
+			{
+				sRenderObject parent;
+				if (!live.empty() && random.Range(8u))
+				{
+					parent = live[random.Range((uint32_t)live.size())].Handle;
+					if (graph.GetHierarchy(graph.GetNode(parent)).Level >= (int32_t)MaxNodeLevel - 1)
+						parent = sRenderObject();
+				}
+				const sRenderObject object = graph.Create(parent);
+				if (object.IsValid())
+				{
+					const lindex_t node = graph.GetNode(object);
+					liveIndex[object.Id] = (uint32_t)live.size();
+					live.push_back({ object, created });
+					serials.Set(node, created);
+					if (!random.Range(4u))
+						lights.Set(node, LightComponent());
+					setName(object, randomName());
+					++created;
+				}
+				return object;
+			};
+		auto onDestroy = [&](lindex_t node)
+			{
+				const sRenderObject object = graph.GetRenderObject(node);
+				setName(object, NoName);
+				const uint32_t index = liveIndex[object.Id];
+				live[index] = live.back();
+				liveIndex[live[index].Handle.Id] = index;
+				live.pop_back();
+				liveIndex[object.Id] = UINT32_MAX;
+				serials.Remove(node);
+				lights.Remove(node);
+				destroyed[destroyedCount++ % DestroyedHistory] = object;
+			};
+		auto destroyObject = [&](sRenderObject object) { return graph.Destroy(object, onDestroy); };
+
+		// links both ways, levels, breadth first order when the graph says so, and components of live
+		// nodes only.
+		auto checkHierarchy = [&]()
+			{
+				bool ok = live.size() == graph.GetCount();
+				uint32_t linked = 0;
+				for (lindex_t node = 0; node < graph.GetNodeCount(); ++node)
+				{
+					if (!graph.IsNodeAlive(node))
+					{
+						ok &= !serials.Contains(node) && !lights.Contains(node);
+						continue;
+					}
+					const Hierarchy& hierarchy = graph.GetHierarchy(node);
+					if (hierarchy.Parent == lindex_invalid)
+						ok &= hierarchy.Level == 0 && hierarchy.PrevSibling == lindex_invalid && hierarchy.Sibling == lindex_invalid;
+					else
+						ok &= graph.IsNodeAlive(hierarchy.Parent) && hierarchy.Level == graph.GetHierarchy(hierarchy.Parent).Level + 1;
+					linked += hierarchy.Parent == lindex_invalid;
+					lindex_t previous = lindex_invalid;
+					for (lindex_t child = hierarchy.Child; ok && child != lindex_invalid; child = graph.GetHierarchy(child).Sibling)
+					{
+						ok &= graph.IsNodeAlive(child) && graph.GetHierarchy(child).Parent == node && graph.GetHierarchy(child).PrevSibling == previous;
+						previous = child;
+						++linked;
+					}
+					ok &= hierarchy.LastChild == previous;
+					if (graph.IsBreadthFirst() && node)
+					{
+						const Hierarchy& prevHierarchy = graph.GetHierarchy(node - 1);
+						ok &= hierarchy.Level >= prevHierarchy.Level;
+						ok &= hierarchy.Parent == lindex_invalid || prevHierarchy.Parent == lindex_invalid || hierarchy.Parent >= prevHierarchy.Parent;
+					}
+				}
+				ok &= !graph.IsBreadthFirst() || graph.GetNodeCount() == graph.GetCount();
+				return ok && linked == graph.GetCount();
+			};
+		// live handles reach their node, destroyed ones nothing.
+		auto checkHandles = [&]()
+			{
+				bool ok = serials.GetCount() == live.size();
+				for (const tLiveObject& object : live)
+				{
+					const lindex_t node = graph.GetNode(object.Handle);
+					ok &= node != lindex_invalid && graph.GetRenderObject(node) == object.Handle
+						&& serials.Contains(node) && serials.Get(node) == object.Serial;
+				}
+				for (uint32_t i = 0; i < __min(destroyedCount, DestroyedHistory); ++i)
+					ok &= !graph.IsAlive(destroyed[i]);
+				return ok;
+			};
+		// every name finds the live render object that got it last.
+		auto checkNames = [&]()
+			{
+				sRenderObject newest[CountOf(Names)];
+				for (const tLiveObject& object : live)
+				{
+					const uint32_t name = nameOf[object.Handle.Id];
+					if (name != NoName && (!newest[name].IsValid() || nameSerial[object.Handle.Id] > nameSerial[newest[name].Id]))
+						newest[name] = object.Handle;
+				}
+				bool ok = true;
+				for (uint32_t i = 0; i < CountOf(Names); ++i)
+					ok &= names.Find(Names[i]) == newest[i];
+				return ok && names.GetCount() <= CountOf(Names);
+			};
+
+		{
+			// the name keeps finding the other render objects with it as the last named ones go away.
+			const sRenderObject root = graph.Create(sRenderObject());
+			const sRenderObject child = graph.Create(root);
+			const sRenderObject other = graph.Create(sRenderObject());
+			const sRenderObject renamed = graph.Create(root);
+			names.Insert("Duplicate", root);
+			names.Insert("Duplicate", child);
+			names.Insert("Duplicate", renamed);
+			names.Insert("Duplicate", other);
+			bool ok = names.Find("Duplicate") == other;
+			names.Remove("Duplicate", other);
+			graph.Destroy(other, [](lindex_t) {});
+			ok &= names.Find("Duplicate") == renamed;
+			names.Remove("Duplicate", renamed);
+			names.Insert("Renamed", renamed);
+			ok &= names.Find("Duplicate") == child && names.Find("Renamed") == renamed;
+			names.Remove("Duplicate", root);
+			ok &= names.Find("Duplicate") == child;
+			graph.Destroy(root, [&](lindex_t node)
+				{
+					const sRenderObject object = graph.GetRenderObject(node);
+					names.Remove(object == renamed ? "Renamed" : object == child ? "Duplicate" : "", object);
+				});
+			ok &= !names.Find("Duplicate").IsValid() && !names.Find("Renamed").IsValid() && !names.GetCount();
+			graph.ReleaseNodes();
+			ok &= !graph.GetCount();
+			result &= TestResult(ok, "Scene graph", "duplicate names");
+		}
+
+		{
+			bool ok = true;
+			for (uint32_t i = 0; i < Capacity; ++i)
+				ok &= createObject().IsValid();
+			ok &= graph.GetCount() == Capacity && graph.GetNodeCount() == Capacity && graph.GetCapacity() >= Capacity;
+			ok &= checkHierarchy() && checkHandles() && checkNames();
+			result &= TestResult(ok, "Scene graph", "growth");
+		}
+
+		{
+			// roots take their subtrees with them.
+			bool ok = true;
+			while (ok && !live.empty())
+				ok &= destroyObject(live[random.Range((uint32_t)live.size())].Handle);
+			ok &= !destroyObject(destroyed[0]);
+			ok &= graph.GetCount() == 0 && serials.IsEmpty() && lights.IsEmpty() && !names.GetCount() && checkHandles();
+			// nodes are reused after the release only, before it the graph appends a new one.
+			const sRenderObject appended = createObject();
+			ok &= appended.IsValid() && graph.GetNode(appended) == Capacity && destroyObject(appended);
+			graph.ReleaseNodes();
+			for (uint32_t i = 0; i < Capacity; ++i)
+				ok &= createObject().IsValid();
+			ok &= graph.GetNodeCount() == Capacity + 1 && checkHierarchy() && checkHandles() && checkNames();
+			result &= TestResult(ok, "Scene graph", "destroy and reuse");
+		}
+
+		{
+			bool hierarchyOk = true;
+			bool handlesOk = true;
+			bool sortOk = true;
+			bool namesOk = true;
+			double ms = 0.0;
+			uint32_t operations = 0;
+			uint32_t rounds = 0;
+			const uint32_t createdBefore = created;
+			const uint32_t destroyedBefore = destroyedCount;
+			Profiling::sProfilingTimer timer;
+			while (created - createdBefore < cycles)
+			{
+				const uint32_t roundEnd = __min(created - createdBefore + RoundCreations, cycles) + createdBefore;
+				timer.Start();
+				while (created < roundEnd)
+				{
+					// around half the capacity: mostly creates below it, mostly destroys (of whole subtrees) above.
+					const bool create = live.size() < Capacity / 2 ? random.Range(8u) != 0 : !random.Range(8u);
+					if (live.empty() || (create && live.size() < Capacity))
+						createObject();
+					else
+						destroyObject(live[random.Range((uint32_t)live.size())].Handle);
+					if (!random.Range(8u))
+						setName(live[random.Range((uint32_t)live.size())].Handle, randomName());
+					if (!(++operations % FrameOperations))
+						graph.ReleaseNodes();
+				}
+				ms += timer.Stop();
+				hierarchyOk &= checkHierarchy();
+				handlesOk &= checkHandles();
+				namesOk &= checkNames();
+				// every other round, the next one starts from packed nodes.
+				if (rounds++ & 1)
+				{
+					const uint32_t nodeCount = graph.GetNodeCount();
+					tDynArray<lindex_t> remap;
+					if (graph.Sort(remap))
+					{
+						sortOk &= remap.size() == nodeCount;
+						serials.Remap(remap.data(), nodeCount);
+						lights.Remap(remap.data(), nodeCount);
+					}
+					sortOk &= graph.IsBreadthFirst() && checkHierarchy() && checkHandles();
+				}
+			}
+			result &= TestResult(hierarchyOk, "Scene graph", "hierarchy");
+			result &= TestResult(handlesOk, "Scene graph", "handles");
+			result &= TestResult(sortOk, "Scene graph", "sort");
+			result &= TestResult(namesOk, "Scene graph", "names");
+
+			const uint32_t createdCount = created - createdBefore;
+			const uint32_t destroyedTotal = destroyedCount - destroyedBefore;
+			logfinfo("%u render objects created and %u destroyed, %u live (at most %u), %u checks\n",
+				createdCount, destroyedTotal, graph.GetCount(), Capacity, rounds);
+			logfinfo("Create and destroy:	%8.3f ms (%6.2f ns/render object)\n", ms, ms * 1e6 / (double)__max(createdCount + destroyedTotal, 1u));
+		}
+		names.Destroy();
+		graph.Destroy();
+		loginfo("**************************************************************\n");
+		return result;
+	}
+
+	bool TestFrameHeapAllocations()
+	{
+		using namespace scene_bench;
+		static constexpr uint32_t NodeCount = 1 << 16;
+		static constexpr uint32_t Frames = 64;
+		const uint32_t moving = (uint32_t)__max((double)NodeCount * (double)CVar_TransformBenchMoving.Get() / 100.0, 1.0);
+		loginfo("****************** Frame heap allocation tests ******************\n");
+
+		tSyntheticScene scene;
+		BuildScene(scene, NodeCount);
+		tDrawCollection collection;
+		collection.Init(scene);
+		// first frames with every node dirty size the dirty lists and fill both render datas.
+		for (uint32_t i = 0; i < NodeCount; ++i)
+			MarkAsDirty(scene, i);
+		for (uint32_t i = 0; i < CountOf(scene.RenderTransforms); ++i)
+		{
+			RecalculateDirty(scene, i);
+			CollectPacked(scene, collection);
+		}
+
+		// steady state frames, as Scene moves, recalculates and collects the draws every frame.
+		tRandom random;
+		const size_t allocsBefore = GetMemoryStats().TotalAllocationCount;
+		for (uint32_t frame = 0; frame < Frames; ++frame)
+		{
+			MoveNodes(scene, random, moving, &MarkAsDirty);
+			RecalculateDirty(scene, frame & 1);
+			CollectPacked(scene, collection);
+		}
+		const size_t allocs = GetMemoryStats().TotalAllocationCount - allocsBefore;
+
+		logfinfo("%u frames, %u nodes, %u moving per frame: %llu general heap allocations\n",
+			Frames, NodeCount, moving, (unsigned long long)allocs);
+		const bool result = TestResult(!allocs, "Frame heap", "steady state frames");
+		loginfo("*****************************************************************\n");
+		return result;
+	}
+
+	void ExecCommand_BenchmarkSceneComponents(const char* command)
+	{
+		BenchmarkSceneComponents();
+	}
+
+	void ExecCommand_BenchmarkTransformPropagation(const char* command)
+	{
+		BenchmarkTransformPropagation();
+	}
+
+	void ExecCommand_BenchmarkTransformComposition(const char* command)
+	{
+		BenchmarkTransformComposition();
+	}
+
+	void ExecCommand_BenchmarkHierarchyOrder(const char* command)
+	{
+		BenchmarkHierarchyOrder();
+	}
+
+	void ExecCommand_TestTransformRotation(const char* command)
+	{
+		TestTransformRotation();
+	}
+
+	void ExecCommand_TestSceneGraph(const char* command)
+	{
+		TestSceneGraph();
+	}
+
+	void ExecCommand_TestFrameHeapAllocations(const char* command)
+	{
+		TestFrameHeapAllocations();
+	}
+
+	void InitSceneComponents()
+	{
+		AddConsoleCommand("r_scenebench", &ExecCommand_BenchmarkSceneComponents);
+		AddConsoleCommand("r_transformbench", &ExecCommand_BenchmarkTransformPropagation);
+		AddConsoleCommand("r_transformsimdbench", &ExecCommand_BenchmarkTransformComposition);
+		AddConsoleCommand("r_hierarchybench", &ExecCommand_BenchmarkHierarchyOrder);
+		AddConsoleCommand("r_transformrotationtest", &ExecCommand_TestTransformRotation);
+		AddConsoleCommand("r_scenegraphtest", &ExecCommand_TestSceneGraph);
+		AddConsoleCommand("r_frameheaptest", &ExecCommand_TestFrameHeapAllocations);
+	}
+}
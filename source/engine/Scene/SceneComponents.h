@@ -0,0 +1,480 @@
+#pragma once
+
+#include "Core/Types.h"
+#include "Utils/Angles.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+
+namespace Mist
+{
+	// Render object handle. Id is a slot of the scene handle table and Generation tells apart the render
+	// objects that used that slot, so the handle of a destroyed render object never reaches the one that
+	// reuses the slot. IsValid only checks for the null handle, the scene tells if it is still alive.
+	struct sRenderObject
+	{
+		lindex_t Id = lindex_invalid;
+		uint32_t Generation = 0;
+		sRenderObject() {}
+		sRenderObject(lindex_t id, uint32_t generation) : Id(id), Generation(generation) {}
+		inline bool IsValid() const { return Id != lindex_invalid; }
+		inline bool operator==(const sRenderObject& other) const { return Id == other.Id && Generation == other.Generation; }
+		inline bool operator!=(const sRenderObject& other) const { return !(*this == other); }
+	};
+
+
+	enum class ELightType
+	{
+		Point,
+		Directional,
+		Spot
+	};
+
+	const char* LightTypeToStr(ELightType);
+	ELightType StrToLightType(const char* str);
+
+	struct LightComponent
+	{
+		ELightType Type = ELightType::Point;
+		glm::vec3 Color = { 1.f, 1.f, 1.f };
+		float Radius = 10.f;
+		float Compression = 1.f;
+		float OuterCutoff = 30.f;	// Degrees
+		float Cutoff = 30.f;			// Degrees
+		bool ProjectShadows = false;
+	};
+
+	struct MeshComponent
+	{
+		char MeshAssetPath[256];
+		uint32_t MeshIndex;
+
+		MeshComponent() : MeshIndex(UINT32_MAX) { *MeshAssetPath = 0; }
+	};
+
+	struct CameraComponent
+	{
+		bool Main;
+		index_t CameraIndex;
+
+		CameraComponent() : Main(false), CameraIndex(index_invalid) {}
+		CameraComponent(index_t i) : Main(false), CameraIndex(i) {}
+	};
+
+	// links of a scene graph node, node indices or lindex_invalid. Siblings are a doubly linked list and
+	// the parent knows its last child, so nodes are appended and detached in O(1).
+	struct Hierarchy
+	{
+		lindex_t Parent = lindex_invalid;
+		lindex_t Child = lindex_invalid;
+		lindex_t LastChild = lindex_invalid;
+		lindex_t Sibling = lindex_invalid;
+		lindex_t PrevSibling = lindex_invalid;
+		int32_t Level = 0;
+	};
+
+	/**
+	 * Render objects of a scene: the handle table, the node each live render object uses in the scene
+	 * arrays and the hierarchy of those nodes. Create, handle lookup and destroy (per node of the destroyed
+	 * subtree) are O(1).
+	 * A handle keeps its render object for its whole life, the node moves when the graph is sorted.
+	 * Destroyed handle slots are reused right away with the next generation. Destroyed nodes wait for
+	 * ReleaseNodes, the scene may still have them queued (dirty transforms) until its next update.
+	 * Nodes and handle slots are 32 bit indices and the arrays grow as needed, capacity is only what
+	 * Init reserves.
+	 */
+	class tSceneGraph
+	{
+	public:
+		void Init(uint32_t capacity);
+		void Destroy();
+
+		// new render object, last child of parent or a root with an invalid parent. Reuses a released node
+		// or appends one, growing the node arrays. Returns an invalid handle only when node indices run out.
+		sRenderObject Create(sRenderObject parent);
+		// destroys object and its subtree, calling fn(node) for each destroyed node (children before their
+		// parent) while the node still has its render object. Returns false for a dead handle.
+		template <typename Fn>
+		bool Destroy(sRenderObject object, Fn&& fn)
+		{
+			const lindex_t node = GetNode(object);
+			if (node == lindex_invalid)
+				return false;
+			Detach(node);
+			DestroySubtree(node, fn);
+			// holes in the node arrays, a sort packs them again.
+			m_breadthFirst = false;
+			return true;
+		}
+
+		inline bool IsAlive(sRenderObject object) const { return GetNode(object) != lindex_invalid; }
+		// node of a live render object, lindex_invalid for dead handles.
+		inline lindex_t GetNode(sRenderObject object) const
+		{
+			if (object.Id >= m_handles.size() || m_handles[object.Id].Generation != object.Generation)
+				return lindex_invalid;
+			return m_handles[object.Id].Node;
+		}
+		sRenderObject GetRenderObject(lindex_t node) const;
+		inline bool IsNodeAlive(lindex_t node) const { return node < m_nodeHandles.size() && m_nodeHandles[node] != lindex_invalid; }
+		inline const Hierarchy& GetHierarchy(lindex_t node) const { return m_nodes[node]; }
+
+		// live render objects.
+		inline uint32_t GetCount() const { return m_count; }
+		// nodes ever used since the last sort, live or destroyed. Node indices are below it.
+		inline uint32_t GetNodeCount() const { return (uint32_t)m_nodes.size(); }
+		// nodes allocated, the graph grows past it.
+		inline uint32_t GetCapacity() const { return (uint32_t)m_nodes.capacity(); }
+
+		// nodes destroyed until now can be used by new render objects.
+		void ReleaseNodes();
+
+		// Reorders the live nodes breadth first (by level, parents before their children and the children
+		// of a node contiguous) and packs them at the front. remap gets the new node of each old one, one
+		// entry per node before the sort, lindex_invalid for destroyed ones. Returns false, with no changes
+		// and remap untouched, if the nodes are already in that order with no holes.
+		bool Sort(tDynArray<lindex_t>& remap);
+		// live nodes in breadth first order with no holes. Kept while new render objects are created in
+		// that order.
+		inline bool IsBreadthFirst() const { return m_breadthFirst; }
+
+	private:
+		void Detach(lindex_t node);
+		// frees the handle slot and queues the node for ReleaseNodes.
+		void Release(lindex_t node);
+
+		template <typename Fn>
+		void DestroySubtree(lindex_t node, Fn& fn)
+		{
+			for (lindex_t child = m_nodes[node].Child; child != lindex_invalid;)
+			{
+				const lindex_t sibling = m_nodes[child].Sibling;
+				DestroySubtree(child, fn);
+				child = sibling;
+			}
+			fn(node);
+			Release(node);
+		}
+
+		struct tHandleSlot
+		{
+			lindex_t Node;
+			uint32_t Generation;
+		};
+		tDynArray<tHandleSlot> m_handles;
+		tDynArray<lindex_t> m_freeHandles;
+		tDynArray<Hierarchy> m_nodes;
+		// handle slot of each node, lindex_invalid for destroyed nodes.
+		tDynArray<lindex_t> m_nodeHandles;
+		tDynArray<lindex_t> m_freeNodes;
+		// destroyed since the last ReleaseNodes.
+		tDynArray<lindex_t> m_destroyedNodes;
+		uint32_t m_count = 0;
+		bool m_breadthFirst = true;
+	};
+
+	/**
+	 * Render objects by name. Names don't need to be unique: the render objects sharing a name are linked
+	 * in a list, newest first, so the name is found while any of them is in the index. Lists are linked by
+	 * handle slot, node sorts don't touch them.
+	 */
+	class tSceneNameIndex
+	{
+	public:
+		// capacity of the scene graph giving the handles, grows with them.
+		void Init(uint32_t capacity);
+		void Destroy();
+
+		// object must not be in the index. Empty names are not indexed.
+		void Insert(const char* name, sRenderObject object);
+		// object must be in the index with name, or name empty.
+		void Remove(const char* name, sRenderObject object);
+		// newest render object in the index with name, invalid if none.
+		sRenderObject Find(const char* name) const;
+		// distinct names.
+		inline uint32_t GetCount() const { return (uint32_t)m_heads.size(); }
+
+	private:
+		struct tLink
+		{
+			sRenderObject Previous;
+			sRenderObject Next;
+		};
+		// newest render object of each name.
+		tFlatMap<String, sRenderObject, tStringHash, tStringEqualTo> m_heads;
+		// by handle slot.
+		tDynArray<tLink> m_links;
+	};
+
+	enum class ERotationMode : uint8_t
+	{
+		Euler,
+		Quaternion
+	};
+
+	struct TransformComponent
+	{
+		glm::vec3 Position;
+		tAngles Rotation;
+		glm::vec3 Scale;
+		// rotation the matrix is built from. With Euler mode it follows Rotation, with Quaternion mode it is
+		// the rotation itself (composed by scripts or animation) and Rotation follows it.
+		glm::quat Orientation = glm::quat(1.f, 0.f, 0.f, 0.f);
+		ERotationMode RotationMode = ERotationMode::Euler;
+	};
+
+	// updates Rotation or Orientation from the other, as RotationMode says. Call after writing either.
+	void SyncTransformRotation(TransformComponent& transform);
+
+	// matrix from Orientation, no trigonometry.
+	void TransformComponentToMatrix(const TransformComponent* transforms, glm::mat4* matrices, uint32_t count);
+
+	// max error of the SIMD transform functions against the scalar ones, relative to the column magnitude.
+	inline constexpr float TransformSimdTolerance = 1e-5f;
+	// max error of the matrices built from Orientation against the ones built from the euler angles
+	// (math::ToMat4), relative to the column magnitude.
+	inline constexpr float TransformQuatTolerance = 1e-5f;
+	// SSE version of TransformComponentToMatrix, same operation order so the result is bit exact.
+	void TransformComponentToMatrixSimd(const TransformComponent* transforms, glm::mat4* matrices, uint32_t count);
+	// global = parent * local with SSE. Same operation order as glm, the result is bit exact.
+	void MultiplyTransformSimd(const glm::mat4& parent, const glm::mat4& local, glm::mat4& global);
+	// max element difference between two transform arrays, relative to the column magnitude.
+	float GetMaxTransformError(const glm::mat4* a, const glm::mat4* b, uint32_t count);
+
+	/**
+	 * Sparse set storage for one component type. Components are packed in a dense array, with the
+	 * owner entity of each one in a parallel array, and a sparse array indexed by entity gives the
+	 * dense position. Lookup, insert and remove are O(1), and systems iterate the dense arrays
+	 * touching only the entities that have the component.
+	 * Remove moves the last component to the hole, so dense order is insertion order until something
+	 * is removed or the entities remapped. Pointers to components are invalidated by Set, Remove and Remap.
+	 */
+	template <typename Component_t>
+	class tComponentArray
+	{
+	public:
+		static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+		inline bool Contains(uint32_t entity) const { return entity < m_sparse.size() && m_sparse[entity] != InvalidIndex; }
+
+		Component_t* Find(uint32_t entity) { return Contains(entity) ? &m_components[m_sparse[entity]] : nullptr; }
+		const Component_t* Find(uint32_t entity) const { return const_cast<tComponentArray*>(this)->Find(entity); }
+
+		Component_t& Get(uint32_t entity)
+		{
+			check(Contains(entity));
+			return m_components[m_sparse[entity]];
+		}
+		const Component_t& Get(uint32_t entity) const { return const_cast<tComponentArray*>(this)->Get(entity); }
+
+		// adds the component to entity or overwrites the one it had.
+		Component_t& Set(uint32_t entity, const Component_t& component)
+		{
+			check(entity != InvalidIndex);
+			if (Contains(entity))
+				return m_components[m_sparse[entity]] = component;
+			if (entity >= m_sparse.size())
+				m_sparse.resize(entity + 1, InvalidIndex);
+			m_sparse[entity] = (uint32_t)m_components.size();
+			m_entities.push_back(entity);
+			m_components.push_back(component);
+			return m_components.back();
+		}
+
+		// returns false if entity had no component.
+		bool Remove(uint32_t entity)
+		{
+			if (!Contains(entity))
+				return false;
+			const uint32_t index = m_sparse[entity];
+			const uint32_t last = (uint32_t)m_components.size() - 1;
+			if (index != last)
+			{
+				m_components[index] = std::move(m_components[last]);
+				m_entities[index] = m_entities[last];
+				m_sparse[m_entities[index]] = index;
+			}
+			m_components.pop_back();
+			m_entities.pop_back();
+			m_sparse[entity] = InvalidIndex;
+			return true;
+		}
+
+		void Reserve(uint32_t entityCount, uint32_t componentCount)
+		{
+			m_sparse.reserve(entityCount);
+			m_entities.reserve(componentCount);
+			m_components.reserve(componentCount);
+		}
+
+		void Clear()
+		{
+			m_sparse.clear();
+			m_entities.clear();
+			m_components.clear();
+		}
+
+		// renumbers the entities in [0, entityCount) to remap[entity]. Dense order follows the new entity
+		// order, so iterating the components walks the entity arrays front to back.
+		template <typename Index_t>
+		void Remap(const Index_t* remap, uint32_t entityCount)
+		{
+			const uint32_t count = GetCount();
+			tDynArray<uint32_t> order(count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				check(m_entities[i] < entityCount);
+				m_entities[i] = remap[m_entities[i]];
+				order[i] = i;
+			}
+			std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return m_entities[a] < m_entities[b]; });
+			tDynArray<uint32_t> entities;
+			tDynArray<Component_t> components;
+			entities.reserve(count);
+			components.reserve(count);
+			for (uint32_t index : order)
+			{
+				entities.push_back(m_entities[index]);
+				components.push_back(std::move(m_components[index]));
+			}
+			m_entities.assign(entities.begin(), entities.end());
+			m_components.assign(std::make_move_iterator(components.begin()), std::make_move_iterator(components.end()));
+			m_sparse.assign(__max((uint32_t)m_sparse.size(), entityCount), InvalidIndex);
+			for (uint32_t i = 0; i < count; ++i)
+				m_sparse[m_entities[i]] = i;
+		}
+
+		// dense index of the entity component, InvalidIndex if it has none.
+		inline uint32_t GetIndex(uint32_t entity) const { return entity < m_sparse.size() ? m_sparse[entity] : InvalidIndex; }
+
+		// dense access, index in [0, GetCount()).
+		inline uint32_t GetCount() const { return (uint32_t)m_components.size(); }
+		inline bool IsEmpty() const { return m_components.empty(); }
+		inline uint32_t GetEntity(uint32_t index) const { check(index < m_entities.size()); return m_entities[index]; }
+		inline Component_t& operator[](uint32_t index) { check(index < m_components.size()); return m_components[index]; }
+		inline const Component_t& operator[](uint32_t index) const { check(index < m_components.size()); return m_components[index]; }
+		inline const uint32_t* GetEntities() const { return m_entities.data(); }
+		inline Component_t* GetData() { return m_components.data(); }
+		inline const Component_t* GetData() const { return m_components.data(); }
+
+	private:
+		tDynArray<uint32_t> m_sparse;
+		tDynArray<uint32_t> m_entities;
+		tDynArray<Component_t> m_components;
+	};
+
+	// moves element i of the first count ones to remap[i], drops the ones remapped to lindex_invalid.
+	template <typename T>
+	void RemapArray(tDynArray<T>& array, const lindex_t* remap, uint32_t count)
+	{
+		tDynArray<T> old;
+		old.reserve(count);
+		for (uint32_t i = 0; i < count; ++i)
+			old.push_back(std::move(array[i]));
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (remap[i] != lindex_invalid)
+				array[remap[i]] = std::move(old[i]);
+		}
+	}
+
+	/**
+	 * Dirty tracking of the transforms of a scene graph. A marked node is queued in the list of its level
+	 * together with its whole subtree, once per update, and Update recomputes only the queued nodes,
+	 * level by level so parents are updated before their children.
+	 * Nodes with mesh updated go to a moved list, one per render data: the render data updated next has
+	 * to catch up with the meshes moved for the other one.
+	 */
+	class tTransformPropagation
+	{
+	public:
+		static constexpr index_t MaxNodeLevel = 16;
+		// dirty nodes of a level per transform job.
+		static constexpr uint32_t BatchSize = 256;
+		static constexpr uint32_t MovedListCount = 2;
+
+		// capacity of the scene graph giving the nodes, grows with them.
+		void Init(uint32_t capacity);
+		void Destroy();
+
+		// transform component of node changed: its local transform and the global ones of its subtree.
+		void MarkDirty(const tSceneGraph& graph, lindex_t node);
+		// queues the global transform of node and its subtree, once per update.
+		void MarkGlobalDirty(const tSceneGraph& graph, lindex_t node);
+		// new node, nodes past the ones packed by a sort keep old flags.
+		inline void ResetNode(lindex_t node)
+		{
+			if (node >= m_dirtyFlags.size())
+				m_dirtyFlags.resize(node + 1);
+			m_dirtyFlags[node] = 0;
+		}
+		bool IsDirty() const;
+		// queued nodes, every level.
+		uint32_t GetDirtyCount() const;
+		// nodes renumbered by tSceneGraph::Sort, destroyed nodes still queued are dropped.
+		void Remap(const lindex_t* remap, uint32_t nodeCount);
+
+		// Recomputes the queued nodes and clears the queues. Destroyed nodes still queued are skipped, the
+		// graph can release them after it. Nodes of the same level are independent, batches of them run in
+		// parallel. Queued nodes with mesh go to moved list movedIndex.
+		void Update(const tSceneGraph& graph, const TransformComponent* transforms, glm::mat4* localTransforms,
+			glm::mat4* globalTransforms, const tComponentArray<MeshComponent>& meshes, uint32_t movedIndex);
+		// nodes with mesh moved in the last update of a moved list.
+		inline const tDynArray<lindex_t>& GetMovedMeshNodes(uint32_t movedIndex) const { return m_movedMeshNodes[movedIndex]; }
+
+	private:
+		enum : uint8_t
+		{
+			TransformDirty_Local = 1 << 0,
+			TransformDirty_Global = 1 << 1,
+		};
+		// TransformDirty flags of each node. A flagged node is already queued in m_dirtyNodes together
+		// with its whole subtree.
+		tDynArray<uint8_t> m_dirtyFlags;
+		tDynArray<lindex_t> m_dirtyNodes[MaxNodeLevel];
+		tDynArray<lindex_t> m_movedMeshNodes[MovedListCount];
+	};
+
+	// Draw collection: the meshes in dense order, which is the draw order. Each one pushes its model to
+	// drawModels and gets the first of its render transforms in offsets[node], then fn(node, meshIndex)
+	// writes them and returns how many it wrote. Returns the render transforms used.
+	template <typename DrawIndex_t, typename Fn>
+	uint32_t CollectDrawModels(const tComponentArray<MeshComponent>& meshes, lindex_t* offsets, tFixedHeapArray<index_t, DrawIndex_t>& drawModels, Fn&& fn)
+	{
+		drawModels.Clear();
+		uint32_t offset = 0;
+		for (uint32_t i = 0; i < meshes.GetCount(); ++i)
+		{
+			const lindex_t node = meshes.GetEntity(i);
+			const uint32_t meshIndex = meshes[i].MeshIndex;
+			offsets[node] = offset;
+			drawModels.Push((index_t)meshIndex);
+			offset += fn(node, meshIndex);
+		}
+		return offset;
+	}
+
+	// registers console commands.
+	void InitSceneComponents();
+	// Matrices built from quaternions against the ones built from euler angles, in both rotation modes,
+	// and euler against quaternion matrix building times.
+	bool TestTransformRotation();
+	// Transform update and draw collection on a synthetic scene of r_sceneBenchNodes nodes, component maps
+	// against packed arrays.
+	void BenchmarkSceneComponents();
+	// Dirty only transform propagation against recomputing every node, r_transformBenchMoving percent of
+	// the nodes moving per frame.
+	void BenchmarkTransformPropagation();
+	// Scalar against SIMD against SIMD in parallel per hierarchy level, for local and global transforms.
+	// Checks the SIMD results against the scalar ones.
+	void BenchmarkTransformComposition();
+	// Transform updates with the nodes in creation (depth first) order against breadth first order, on
+	// wide, balanced and deep hierarchies.
+	void BenchmarkHierarchyOrder();
+	// Creates and destroys r_sceneGraphStressCycles render objects in a tSceneGraph with components, grown
+	// past 16 bit node indices, checking the hierarchy, the handles of destroyed objects and the components
+	// left after each round.
+	bool TestSceneGraph();
+	// Counts the general heap allocations of steady state frames on a synthetic scene: moving nodes,
+	// dirty transform propagation and draw collection. Passes with none.
+	bool TestFrameHeapAllocations();
+}
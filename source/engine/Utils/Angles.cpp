@@ -26,4 +26,34 @@ namespace Mist
 	{
 		return ToMat3();
 	}
+
+	glm::quat tAngles::ToQuat() const
+	{
+		// ToMat3 is Rz(pitch) * Ry(yaw) * Rx(roll).
+		float sz = glm::sin(glm::radians(m_pitch) * 0.5f);
+		float cz = glm::cos(glm::radians(m_pitch) * 0.5f);
+		float sy = glm::sin(glm::radians(m_yaw) * 0.5f);
+		float cy = glm::cos(glm::radians(m_yaw) * 0.5f);
+		float sx = glm::sin(glm::radians(m_roll) * 0.5f);
+		float cx = glm::cos(glm::radians(m_roll) * 0.5f);
+
+		return glm::normalize(glm::quat(
+			cz * cy * cx + sz * sy * sx,
+			cz * cy * sx - sz * sy * cx,
+			cz * sy * cx + sz * cy * sx,
+			sz * cy * cx - cz * sy * sx));
+	}
+
+	tAngles::tAngles(const glm::quat& q)
+	{
+		// ToMat3 is Rz(pitch) * Ry(yaw) * Rx(roll). Roll is taken from Rz(-pitch) * mat, so the three
+		// angles agree even near gimbal lock, where pitch alone is undefined.
+		glm::mat3 mat = glm::mat3_cast(glm::normalize(q));
+		float pitch = glm::atan(mat[0][1], mat[0][0]);
+		float yaw = glm::atan(-mat[0][2], glm::sqrt(mat[0][0] * mat[0][0] + mat[0][1] * mat[0][1]));
+		float sp = glm::sin(pitch);
+		float cp = glm::cos(pitch);
+		float roll = glm::atan(sp * mat[2][0] - cp * mat[2][1], cp * mat[1][1] - sp * mat[1][0]);
+		Set(glm::degrees(pitch), glm::degrees(yaw), glm::degrees(roll));
+	}
 }
\ No newline at end of file
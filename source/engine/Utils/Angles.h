@@ -2,6 +2,7 @@
 
 #include "Core/Types.h"
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 namespace Mist
 {
@@ -15,6 +16,8 @@ namespace Mist
 			: m_roll(roll), m_pitch(pitch), m_yaw(yaw) {}
 		explicit tAngles(const glm::vec3& v)
 			: m_roll(v[2]), m_pitch(v[0]), m_yaw(v[1]) {}
+		// angles of the rotation q, yaw in [-90, 90].
+		explicit tAngles(const glm::quat& q);
 
 		void Set(float pitch, float yaw, float roll)
 		{
@@ -67,6 +70,8 @@ namespace Mist
 
 		glm::mat3 ToMat3() const;
 		glm::mat4 ToMat4() const;
+		// same rotation as ToMat3, normalized.
+		glm::quat ToQuat() const;
 		const float* ToFloat() const { return m_angles; }
 		float* ToFloat() { return m_angles; }
 
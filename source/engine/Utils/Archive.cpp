@@ -0,0 +1,334 @@
+#include "Utils/Archive.h"
+#include "Utils/FileSystem.h"
+#include "Utils/Compression.h"
+#include "Core/Logger.h"
+#include "Core/SystemMemory.h"
+#include <sys/stat.h>
+#include <algorithm>
+
+namespace Mist
+{
+	cArchive::~cArchive()
+	{
+		Close();
+	}
+
+	bool cArchive::Open(const char* filepath)
+	{
+		check(filepath && *filepath && !IsOpen());
+		if (!Platform::MapFile(filepath, m_mapping))
+		{
+			logferror("Failed to open archive: %s\n", filepath);
+			return false;
+		}
+
+		const uint8_t* data = static_cast<const uint8_t*>(m_mapping.Data);
+		const size_t size = m_mapping.Size;
+		const tArchiveHeader* header = reinterpret_cast<const tArchiveHeader*>(data);
+		const char* error = nullptr;
+		if (size < sizeof(tArchiveHeader) || header->Magic != tArchiveHeader::FileMagic)
+			error = "not an archive";
+		else if (header->Version != tArchiveHeader::CurrentVersion)
+			error = "unsupported version";
+		else if (!header->Alignment || header->TocOffset % alignof(tArchiveEntry)
+			|| header->TocOffset > size || header->EntryCount > (size - header->TocOffset) / sizeof(tArchiveEntry))
+			error = "toc out of bounds";
+		else if (!header->NamesSize || header->NamesOffset > size || header->NamesSize > size - header->NamesOffset
+			|| data[header->NamesOffset + header->NamesSize - 1])
+			error = "names out of bounds";
+
+		const tArchiveEntry* entries = error ? nullptr : reinterpret_cast<const tArchiveEntry*>(data + header->TocOffset);
+		for (uint32_t i = 0; !error && i < header->EntryCount; ++i)
+		{
+			const tArchiveEntry& entry = entries[i];
+			if (entry.Offset > size || entry.StoredSize > size - entry.Offset || entry.NameOffset >= header->NamesSize)
+				error = "entry out of bounds";
+			else if (entry.Compression >= ArchiveCompression_Count
+				|| (entry.Compression == ArchiveCompression_None && entry.StoredSize != entry.Size)
+				|| (entry.Compression == ArchiveCompression_Lz && entry.StoredSize < sizeof(tCompressedHeader)))
+				error = "unsupported entry compression";
+			else if (i && entries[i - 1].PathHash > entry.PathHash)
+				error = "toc not sorted";
+		}
+		if (error)
+		{
+			logferror("Invalid archive %s: %s\n", filepath, error);
+			Platform::UnmapFile(m_mapping);
+			return false;
+		}
+
+		m_header = header;
+		m_entries = entries;
+		m_names = reinterpret_cast<const char*>(data + header->NamesOffset);
+		strcpy_s(m_path, filepath);
+		logfinfo("Archive opened: %s (%u entries, %.2f MB)\n", filepath, header->EntryCount, (double)size / (1024.0 * 1024.0));
+		return true;
+	}
+
+	void cArchive::Close()
+	{
+		if (m_mapping.IsMapped())
+			Platform::UnmapFile(m_mapping);
+		m_header = nullptr;
+		m_entries = nullptr;
+		m_names = nullptr;
+	}
+
+	const tArchiveEntry* cArchive::Find(const char* path) const
+	{
+		if (!IsOpen())
+			return nullptr;
+		char normalized[256];
+		if (!FileSystem::NormalizePath(path, normalized, sizeof(normalized)))
+			return nullptr;
+		const uint64_t hash = HashArchivePath(normalized);
+		const tArchiveEntry* end = m_entries + m_header->EntryCount;
+		const tArchiveEntry* it = std::lower_bound(m_entries, end, hash,
+			[](const tArchiveEntry& entry, uint64_t value) { return entry.PathHash < value; });
+		for (; it != end && it->PathHash == hash; ++it)
+		{
+			if (!strcmp(GetEntryName(*it), normalized))
+				return it;
+		}
+		return nullptr;
+	}
+
+	namespace archive_builder
+	{
+		struct tSourceFile
+		{
+			// root joined with the relative path, to open the file.
+			char Path[256];
+			char Name[256];
+			uint64_t Hash;
+			uint64_t Size;
+			uint64_t ModificationTime;
+		};
+
+		struct tBuildContext
+		{
+			const char* RootDirectory;
+			const tArchiveBuildOptions* Options;
+			tDynArray<tSourceFile> Files;
+			bool Failed;
+		};
+
+		void CollectFile(const char* path, void* userData)
+		{
+			tBuildContext& context = *static_cast<tBuildContext*>(userData);
+			const tArchiveBuildOptions& options = *context.Options;
+			char relative[256];
+			if (options.Subdirectory)
+				sprintf_s(relative, "%s/%s", options.Subdirectory, path);
+			else
+				strcpy_s(relative, path);
+			for (uint32_t i = 0; i < options.ExcludeCount; ++i)
+			{
+				if (WildStricmp(options.Excludes[i], relative))
+					return;
+			}
+
+			tSourceFile file;
+			sprintf_s(file.Path, "%s/%s", context.RootDirectory, relative);
+			struct stat info;
+			if (!FileSystem::NormalizePath(relative, file.Name, sizeof(file.Name)) || stat(file.Path, &info))
+			{
+				logferror("Can't pack file: %s\n", file.Path);
+				context.Failed = true;
+				return;
+			}
+			file.Hash = HashArchivePath(file.Name);
+			file.Size = (uint64_t)info.st_size;
+			file.ModificationTime = (uint64_t)info.st_mtime;
+			context.Files.push_back(file);
+		}
+
+		bool WritePadding(FILE* f, uint64_t& offset, uint64_t alignment)
+		{
+			static const uint8_t zeros[4096] = {};
+			uint64_t padding = (alignment - offset % alignment) % alignment;
+			while (padding)
+			{
+				size_t chunk = (size_t)__min(padding, (uint64_t)sizeof(zeros));
+				if (fwrite(zeros, 1, chunk, f) != chunk)
+					return false;
+				padding -= chunk;
+				offset += chunk;
+			}
+			return true;
+		}
+
+		bool WriteFileData(FILE* f, const tSourceFile& file, void* buffer, size_t bufferSize)
+		{
+			FILE* src = nullptr;
+			if (fopen_s(&src, file.Path, "rb"))
+				return false;
+			uint64_t copied = 0;
+			while (copied < file.Size)
+			{
+				size_t chunk = (size_t)__min(file.Size - copied, (uint64_t)bufferSize);
+				size_t read = fread_s(buffer, bufferSize, 1, chunk, src);
+				if (read != chunk || fwrite(buffer, 1, chunk, f) != chunk)
+					break;
+				copied += chunk;
+			}
+			fclose(src);
+			// a file that changed its size while packing fails too.
+			return copied == file.Size;
+		}
+
+		// whole file compressed in memory, stored as is when it doesn't shrink enough to pay the decode.
+		bool WriteCompressedFileData(FILE* f, const tSourceFile& file, void*& scratch, size_t& scratchSize, tArchiveEntry& entry)
+		{
+			Platform::tMappedFile source;
+			if (!Platform::MapFile(file.Path, source))
+				return false;
+			bool ok = source.Size == file.Size;
+			const size_t bound = GetCompressBound(source.Size);
+			if (ok && scratchSize < bound)
+			{
+				if (scratch)
+					Mist::Free(scratch);
+				scratch = _malloc(bound);
+				scratchSize = bound;
+			}
+			const size_t compressed = ok ? Compress(source.Data, source.Size, scratch, scratchSize) : 0;
+			if (compressed && compressed < file.Size - file.Size / 8)
+			{
+				entry.StoredSize = compressed;
+				entry.Compression = ArchiveCompression_Lz;
+				ok = fwrite(scratch, 1, compressed, f) == compressed;
+			}
+			else if (ok)
+			{
+				ok = fwrite(source.Data, 1, source.Size, f) == source.Size;
+			}
+			Platform::UnmapFile(source);
+			return ok;
+		}
+	}
+
+	bool BuildArchive(const char* rootDirectory, const char* archivePath, const tArchiveBuildOptions& options, tArchiveBuildStats* stats)
+	{
+		using namespace archive_builder;
+		check(rootDirectory && *rootDirectory && archivePath && *archivePath);
+		tBuildContext context;
+		context.RootDirectory = rootDirectory;
+		context.Options = &options;
+		context.Failed = false;
+		char directory[256];
+		if (options.Subdirectory)
+			sprintf_s(directory, "%s/%s", rootDirectory, options.Subdirectory);
+		else
+			strcpy_s(directory, rootDirectory);
+		Platform::VisitDirectoryFiles(directory, true, &CollectFile, &context);
+		if (context.Failed)
+			return false;
+
+		tDynArray<tSourceFile>& files = context.Files;
+		std::sort(files.begin(), files.end(), [](const tSourceFile& a, const tSourceFile& b)
+			{
+				return a.Hash != b.Hash ? a.Hash < b.Hash : strcmp(a.Name, b.Name) < 0;
+			});
+		for (size_t i = 1; i < files.size(); ++i)
+		{
+			if (files[i].Hash == files[i - 1].Hash && !strcmp(files[i].Name, files[i - 1].Name))
+			{
+				logferror("Archive paths are case insensitive, duplicated file: %s and %s\n", files[i - 1].Path, files[i].Path);
+				return false;
+			}
+		}
+
+		char tempPath[260];
+		sprintf_s(tempPath, "%s.tmp", archivePath);
+		FILE* f = nullptr;
+		if (fopen_s(&f, tempPath, "wb"))
+		{
+			logferror("Failed to create archive: %s\n", tempPath);
+			return false;
+		}
+
+		tArchiveHeader header;
+		memset(&header, 0, sizeof(header));
+		header.Magic = tArchiveHeader::FileMagic;
+		header.Version = tArchiveHeader::CurrentVersion;
+		header.EntryCount = (uint32_t)files.size();
+		header.Alignment = 4096;
+
+		tDynArray<tArchiveEntry> entries(files.size());
+		tDynArray<char> names;
+		const size_t bufferSize = 1 << 20;
+		void* buffer = _malloc(bufferSize);
+		void* scratch = nullptr;
+		size_t scratchSize = 0;
+		uint32_t compressedFiles = 0;
+		bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+		uint64_t offset = sizeof(header);
+		for (size_t i = 0; ok && i < files.size(); ++i)
+		{
+			const tSourceFile& file = files[i];
+			ok = WritePadding(f, offset, header.Alignment);
+			tArchiveEntry& entry = entries[i];
+			entry.PathHash = file.Hash;
+			entry.Offset = offset;
+			entry.StoredSize = file.Size;
+			entry.Size = file.Size;
+			entry.ModificationTime = file.ModificationTime;
+			entry.NameOffset = (uint32_t)names.size();
+			entry.Compression = ArchiveCompression_None;
+			names.insert(names.end(), file.Name, file.Name + strlen(file.Name) + 1);
+			if (ok && !(options.Compress && file.Size ? WriteCompressedFileData(f, file, scratch, scratchSize, entry) : WriteFileData(f, file, buffer, bufferSize)))
+			{
+				logferror("Failed to pack file: %s\n", file.Path);
+				ok = false;
+			}
+			compressedFiles += entry.Compression == ArchiveCompression_Lz ? 1 : 0;
+			offset += entry.StoredSize;
+		}
+		Mist::Free(buffer);
+		if (scratch)
+			Mist::Free(scratch);
+
+		if (ok)
+		{
+			ok = WritePadding(f, offset, alignof(tArchiveEntry));
+			header.TocOffset = offset;
+			header.NamesOffset = offset + entries.size() * sizeof(tArchiveEntry);
+			header.NamesSize = names.size();
+			offset = header.NamesOffset + header.NamesSize;
+			ok = ok && (entries.empty() || fwrite(entries.data(), sizeof(tArchiveEntry), entries.size(), f) == entries.size());
+			// an empty archive still has a null name blob, so the names range is never empty.
+			if (names.empty())
+			{
+				names.push_back(0);
+				header.NamesSize = 1;
+				++offset;
+			}
+			ok = ok && fwrite(names.data(), 1, names.size(), f) == names.size();
+			ok = ok && !fseek(f, 0L, SEEK_SET) && fwrite(&header, sizeof(header), 1, f) == 1;
+		}
+		ok = !fclose(f) && ok;
+		if (ok)
+		{
+			remove(archivePath);
+			ok = !rename(tempPath, archivePath);
+		}
+		if (!ok)
+		{
+			logferror("Failed to write archive: %s\n", archivePath);
+			remove(tempPath);
+			return false;
+		}
+
+		if (stats)
+		{
+			stats->Files = header.EntryCount;
+			stats->CompressedFiles = compressedFiles;
+			stats->Bytes = 0;
+			for (size_t i = 0; i < files.size(); ++i)
+				stats->Bytes += files[i].Size;
+			stats->ArchiveBytes = offset;
+		}
+		return true;
+	}
+}
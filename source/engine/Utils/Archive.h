@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Core/Types.h"
+#include "Core/Platform.h"
+#include "Core/StringId.h"
+
+/**
+ * Packed asset archive (.mpak). All the files of an asset tree in one file:
+ *
+ *   header | entry data... | toc | names
+ *
+ * Entry data starts at a multiple of the header alignment (page size), so a mapped archive hands out
+ * views of the entries directly with the same alignment a mapped loose file would have, compressed
+ * entries are decoded to the heap instead. The toc is
+ * sorted by the hash of the entry path for a binary search, the names resolve hash collisions. Paths
+ * are stored relative to the packed directory, lowercase and '/' separated, so lookups are case and
+ * separator insensitive.
+ */
+
+namespace Mist
+{
+	enum eArchiveCompression : uint32_t
+	{
+		// entry data stored as is, the view points into the archive mapping.
+		ArchiveCompression_None,
+		// compressed stream (Utils/Compression.h), decoded to the heap when opened.
+		ArchiveCompression_Lz,
+		ArchiveCompression_Count
+	};
+
+	struct tArchiveHeader
+	{
+		// "MPAK"
+		static constexpr uint32_t FileMagic = 0x4b41504d;
+		static constexpr uint32_t CurrentVersion = 1;
+
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t EntryCount;
+		uint32_t Alignment;
+		uint64_t TocOffset;
+		uint64_t NamesOffset;
+		uint64_t NamesSize;
+	};
+
+	struct tArchiveEntry
+	{
+		uint64_t PathHash;
+		uint64_t Offset;
+		// bytes stored in the archive.
+		uint64_t StoredSize;
+		// bytes of the original file.
+		uint64_t Size;
+		// of the source file when packed, seconds since epoch.
+		uint64_t ModificationTime;
+		uint32_t NameOffset;
+		uint32_t Compression;
+	};
+
+	// hash of a path normalized with FileSystem::NormalizePath. Plain fnv-1a, stored in the archive so
+	// it can't change with the engine hash functions.
+	constexpr uint64_t HashArchivePath(const char* normalizedPath) { return HashFnv1a64(normalizedPath); }
+
+	class cArchive
+	{
+	public:
+		cArchive() = default;
+		~cArchive();
+		cArchive(const cArchive&) = delete;
+		cArchive& operator=(const cArchive&) = delete;
+
+		// maps the archive and validates header, toc and entry ranges.
+		bool Open(const char* filepath);
+		void Close();
+		inline bool IsOpen() const { return m_header != nullptr; }
+
+		// path relative to the packed directory. Null if not found.
+		const tArchiveEntry* Find(const char* path) const;
+
+		inline uint32_t GetEntryCount() const { return m_header ? m_header->EntryCount : 0; }
+		inline const tArchiveEntry& GetEntry(uint32_t index) const { check(index < GetEntryCount()); return m_entries[index]; }
+		inline const char* GetEntryName(const tArchiveEntry& entry) const { return m_names + entry.NameOffset; }
+		// stored bytes of the entry, inside the archive mapping.
+		inline const void* GetEntryData(const tArchiveEntry& entry) const { return static_cast<const uint8_t*>(m_mapping.Data) + entry.Offset; }
+		inline const Platform::tMappedFile& GetMapping() const { return m_mapping; }
+		inline const char* GetPath() const { return m_path; }
+
+	private:
+		Platform::tMappedFile m_mapping;
+		const tArchiveHeader* m_header = nullptr;
+		const tArchiveEntry* m_entries = nullptr;
+		const char* m_names = nullptr;
+		char m_path[256];
+	};
+
+	struct tArchiveBuildOptions
+	{
+		// only the files under this directory of the root are packed, with paths still relative to the root. Null packs everything.
+		const char* Subdirectory = nullptr;
+		// relative paths matching any of these (WildStricmp) are skipped.
+		const char* const* Excludes = nullptr;
+		uint32_t ExcludeCount = 0;
+		// entries that shrink at least an eighth are stored compressed, the rest as is.
+		bool Compress = false;
+	};
+
+	struct tArchiveBuildStats
+	{
+		uint32_t Files;
+		uint32_t CompressedFiles;
+		uint64_t Bytes;
+		// archive file size, with header, padding and toc.
+		uint64_t ArchiveBytes;
+	};
+
+	// Packs the files under rootDirectory (recursive) in archivePath. Written to a temporary file and renamed when complete.
+	bool BuildArchive(const char* rootDirectory, const char* archivePath, const tArchiveBuildOptions& options = tArchiveBuildOptions(), tArchiveBuildStats* stats = nullptr);
+}
@@ -0,0 +1,865 @@
+#include "Utils/Compression.h"
+#include "Utils/FileSystem.h"
+#include "Core/Debug.h"
+#include "Core/Logger.h"
+#include "Core/Console.h"
+#include "Core/JobSystem.h"
+#include "Core/SystemMemory.h"
+#include "Application/CmdParser.h"
+#include "Utils/TimeUtils.h"
+#include "Core/TestUtils.h"
+#include <atomic>
+#include <bit>
+#include <cfloat>
+
+namespace Mist
+{
+	CIntVar CVar_LzTestIterations("fs_lzTestIterations", 200);
+	CStrVar CVar_LzBenchDirectory("fs_lzBenchDirectory", "models");
+	CStrVar CVar_LzBenchFilter("fs_lzBenchFilter", "*.bin");
+
+	namespace compression
+	{
+		static constexpr size_t MinMatch = 4;
+		static constexpr size_t MaxOffset = 65535;
+		// matches don't start in the last bytes, the hash reads 4 bytes ahead.
+		static constexpr size_t MatchSafeDistance = 8;
+		static constexpr uint32_t HashLog = 14;
+
+		// little endian loads, unaligned.
+		MIST_FORCEINLINE uint32_t Read32(const uint8_t* p)
+		{
+			uint32_t value;
+			memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		MIST_FORCEINLINE uint64_t Read64(const uint8_t* p)
+		{
+			uint64_t value;
+			memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		MIST_FORCEINLINE uint32_t Hash(uint32_t sequence)
+		{
+			return (sequence * 2654435761u) >> (32 - HashLog);
+		}
+
+		// equal bytes of ip and ref (ref behind ip) up to end.
+		MIST_FORCEINLINE size_t MatchLength(const uint8_t* ip, const uint8_t* ref, const uint8_t* end)
+		{
+			const uint8_t* start = ip;
+			while (ip + sizeof(uint64_t) <= end)
+			{
+				uint64_t diff = Read64(ip) ^ Read64(ref);
+				if (diff)
+					return (size_t)(ip - start) + (std::countr_zero(diff) >> 3);
+				ip += sizeof(uint64_t);
+				ref += sizeof(uint64_t);
+			}
+			while (ip < end && *ip == *ref)
+			{
+				++ip;
+				++ref;
+			}
+			return (size_t)(ip - start);
+		}
+
+		// lengths from 15 on continue in bytes of 255 and a last byte below it.
+		MIST_FORCEINLINE uint8_t* WriteLength(uint8_t* op, size_t length)
+		{
+			for (; length >= 255; length -= 255)
+				*op++ = 255;
+			*op++ = (uint8_t)length;
+			return op;
+		}
+
+		MIST_FORCEINLINE bool ReadLength(const uint8_t*& ip, const uint8_t* end, size_t& length)
+		{
+			uint8_t value;
+			do
+			{
+				if (ip == end)
+					return false;
+				value = *ip++;
+				length += value;
+			} while (value == 255);
+			return true;
+		}
+
+		// token (literal length << 4 | match length - MinMatch), literals, 16 bit offset. Without match
+		// for the last sequence of the block. Short literals are copied in one chunk when both buffers have room.
+		MIST_FORCEINLINE uint8_t* WriteSequence(uint8_t* op, const uint8_t* opEnd, const uint8_t* literals, const uint8_t* srcEnd,
+			size_t literalLength, size_t offset, size_t matchLength)
+		{
+			uint8_t* token = op++;
+			*token = (uint8_t)(__min(literalLength, (size_t)15) << 4);
+			if (literalLength >= 15)
+				op = WriteLength(op, literalLength - 15);
+			if (literalLength <= 16 && srcEnd - literals >= 16 && opEnd - op >= 16)
+				memcpy(op, literals, 16);
+			else
+				memcpy(op, literals, literalLength);
+			op += literalLength;
+			if (!matchLength)
+				return op;
+			op[0] = (uint8_t)offset;
+			op[1] = (uint8_t)(offset >> 8);
+			op += 2;
+			matchLength -= MinMatch;
+			*token |= (uint8_t)__min(matchLength, (size_t)15);
+			if (matchLength >= 15)
+				op = WriteLength(op, matchLength - 15);
+			return op;
+		}
+
+		struct tStreamView
+		{
+			tCompressedHeader Header;
+			const uint8_t* BlockTable;
+			const uint8_t* Blocks;
+			uint32_t BlockCount;
+		};
+
+		MIST_FORCEINLINE uint32_t GetBlockEntry(const uint8_t* table, uint32_t block)
+		{
+			return Read32(table + block * sizeof(uint32_t));
+		}
+
+		MIST_FORCEINLINE size_t GetBlockSize(const tCompressedHeader& header, uint32_t block)
+		{
+			return (size_t)__min((uint64_t)header.BlockSize, header.Size - (uint64_t)block * header.BlockSize);
+		}
+
+		bool ReadStream(const void* src, size_t srcSize, tStreamView& view)
+		{
+			if (!src || srcSize < sizeof(tCompressedHeader))
+				return false;
+			const uint8_t* data = static_cast<const uint8_t*>(src);
+			memcpy(&view.Header, data, sizeof(tCompressedHeader));
+			const tCompressedHeader& header = view.Header;
+			if (header.Magic != tCompressedHeader::StreamMagic || !header.BlockSize || header.BlockSize > tCompressedHeader::MaxBlockSize)
+				return false;
+			const uint64_t blockCount = (header.Size + header.BlockSize - 1) / header.BlockSize;
+			const size_t available = srcSize - sizeof(tCompressedHeader);
+			if (blockCount > available / sizeof(uint32_t))
+				return false;
+			view.BlockCount = (uint32_t)blockCount;
+			view.BlockTable = data + sizeof(tCompressedHeader);
+			view.Blocks = view.BlockTable + blockCount * sizeof(uint32_t);
+
+			// blocks fill the rest of the stream exactly.
+			uint64_t remaining = available - blockCount * sizeof(uint32_t);
+			for (uint32_t i = 0; i < view.BlockCount; ++i)
+			{
+				const uint32_t entry = GetBlockEntry(view.BlockTable, i);
+				const size_t stored = entry & ~tCompressedHeader::StoredBlockFlag;
+				const size_t size = GetBlockSize(header, i);
+				if ((entry & tCompressedHeader::StoredBlockFlag) ? stored != size : (!stored || stored > GetCompressBlockBound(size)))
+					return false;
+				if (stored > remaining)
+					return false;
+				remaining -= stored;
+			}
+			return !remaining;
+		}
+
+		MIST_FORCEINLINE bool DecodeBlock(uint32_t entry, const uint8_t* src, void* dst, size_t size)
+		{
+			if (entry & tCompressedHeader::StoredBlockFlag)
+			{
+				memcpy(dst, src, size);
+				return true;
+			}
+			return DecompressBlock(src, entry, dst, size);
+		}
+	}
+
+	size_t GetCompressBlockBound(size_t size)
+	{
+		// incompressible data pays a length byte per 255 literals and the last token.
+		return size + size / 255 + 16;
+	}
+
+	size_t CompressBlock(const void* src, size_t size, void* dst, size_t capacity)
+	{
+		using namespace compression;
+		check(src || !size);
+		check(size <= UINT32_MAX);
+		if (!dst || capacity < GetCompressBlockBound(size))
+			return 0;
+
+		const uint8_t* base = static_cast<const uint8_t*>(src);
+		const uint8_t* end = base + size;
+		const uint8_t* anchor = base;
+		uint8_t* op = static_cast<uint8_t*>(dst);
+		const uint8_t* const opEnd = op + capacity;
+		if (size > MatchSafeDistance)
+		{
+			// positions relative to base. Stale or zero entries are only candidates, the bytes are compared.
+			uint32_t table[1 << HashLog];
+			memset(table, 0, sizeof(table));
+			const uint8_t* matchLimit = end - MatchSafeDistance;
+			const uint8_t* ip = base + 1;
+			// skips faster over data without matches.
+			uint32_t misses = 0;
+			while (ip <= matchLimit)
+			{
+				const uint32_t sequence = Read32(ip);
+				const uint32_t hash = Hash(sequence);
+				const uint8_t* ref = base + table[hash];
+				table[hash] = (uint32_t)(ip - base);
+				if (ref >= ip || (size_t)(ip - ref) > MaxOffset || Read32(ref) != sequence)
+				{
+					ip += 1 + (misses++ >> 5);
+					continue;
+				}
+
+				while (ip > anchor && ref > base && ip[-1] == ref[-1])
+				{
+					--ip;
+					--ref;
+				}
+				const size_t matchLength = MinMatch + MatchLength(ip + MinMatch, ref + MinMatch, end);
+				op = WriteSequence(op, opEnd, anchor, end, (size_t)(ip - anchor), (size_t)(ip - ref), matchLength);
+				ip += matchLength;
+				anchor = ip;
+				misses = 0;
+				if (ip <= matchLimit)
+					table[Hash(Read32(ip - 2))] = (uint32_t)(ip - 2 - base);
+			}
+		}
+		op = WriteSequence(op, opEnd, anchor, end, (size_t)(end - anchor), 0, 0);
+		return (size_t)(op - static_cast<uint8_t*>(dst));
+	}
+
+	bool DecompressBlock(const void* src, size_t srcSize, void* dst, size_t size)
+	{
+		using namespace compression;
+		// distance with the same phase as a short offset and at least 8 bytes, for chunk copies of a repeated pattern.
+		static constexpr uint8_t PatternDistance[8] = { 0, 8, 8, 9, 8, 10, 12, 14 };
+		if (!src || (!dst && size))
+			return false;
+		const uint8_t* ip = static_cast<const uint8_t*>(src);
+		const uint8_t* const ipEnd = ip + srcSize;
+		uint8_t* op = static_cast<uint8_t*>(dst);
+		uint8_t* const opStart = op;
+		uint8_t* const opEnd = op + size;
+		while (ip < ipEnd)
+		{
+			const uint32_t token = *ip++;
+			size_t literalLength = token >> 4;
+			if (literalLength == 15 && !ReadLength(ip, ipEnd, literalLength))
+				return false;
+			if (literalLength > (size_t)(ipEnd - ip) || literalLength > (size_t)(opEnd - op))
+				return false;
+			if ((size_t)(ipEnd - ip) >= literalLength + 16 && (size_t)(opEnd - op) >= literalLength + 16)
+			{
+				// may copy up to 15 bytes more, overwritten by the next sequence.
+				uint8_t* copy = op;
+				const uint8_t* literals = ip;
+				do
+				{
+					memcpy(copy, literals, 16);
+					copy += 16;
+					literals += 16;
+				} while (copy < op + literalLength);
+			}
+			else
+			{
+				memcpy(op, ip, literalLength);
+			}
+			ip += literalLength;
+			op += literalLength;
+			// last sequence, literals only.
+			if (ip == ipEnd)
+				return op == opEnd;
+
+			if (ipEnd - ip < 2)
+				return false;
+			const size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+			ip += 2;
+			if (!offset || offset > (size_t)(op - opStart))
+				return false;
+			size_t matchLength = token & 15;
+			if (matchLength == 15 && !ReadLength(ip, ipEnd, matchLength))
+				return false;
+			matchLength += MinMatch;
+			if (matchLength > (size_t)(opEnd - op))
+				return false;
+
+			const uint8_t* match = op - offset;
+			uint8_t* const copyEnd = op + matchLength;
+			if (offset >= 16 && (size_t)(opEnd - copyEnd) >= 16)
+			{
+				// chunks may write up to 15 bytes past the match, overwritten by the next sequence.
+				do
+				{
+					memcpy(op, match, 16);
+					op += 16;
+					match += 16;
+				} while (op < copyEnd);
+				op = copyEnd;
+			}
+			else if ((size_t)(opEnd - copyEnd) >= 8)
+			{
+				if (offset < 8)
+				{
+					// the head builds the pattern byte by byte, the rest copies it from a wider distance.
+					const size_t head = __min(matchLength, (size_t)16);
+					for (size_t i = 0; i < head; ++i)
+						op[i] = match[i];
+					op += head;
+					match = op - PatternDistance[offset];
+				}
+				// chunks may write up to 7 bytes past the match.
+				for (; op < copyEnd; op += 8, match += 8)
+					memcpy(op, match, 8);
+				op = copyEnd;
+			}
+			else
+			{
+				for (; op < copyEnd; ++op, ++match)
+					*op = *match;
+			}
+		}
+		// a block has at least the last token.
+		return false;
+	}
+
+	size_t GetCompressBound(size_t size, uint32_t blockSize)
+	{
+		check(blockSize && blockSize <= tCompressedHeader::MaxBlockSize);
+		const size_t blockCount = (size + blockSize - 1) / blockSize;
+		return sizeof(tCompressedHeader) + blockCount * sizeof(uint32_t) + size;
+	}
+
+	size_t Compress(const void* src, size_t size, void* dst, size_t capacity, uint32_t blockSize)
+	{
+		using namespace compression;
+		check(src || !size);
+		if (!dst || capacity < GetCompressBound(size, blockSize))
+			return 0;
+
+		const uint8_t* source = static_cast<const uint8_t*>(src);
+		uint8_t* out = static_cast<uint8_t*>(dst);
+		tCompressedHeader header;
+		header.Magic = tCompressedHeader::StreamMagic;
+		header.BlockSize = blockSize;
+		header.Size = size;
+		memcpy(out, &header, sizeof(header));
+		const uint64_t blockCount = (size + blockSize - 1) / blockSize;
+		check(blockCount <= UINT32_MAX);
+		uint8_t* table = out + sizeof(header);
+		uint8_t* op = table + blockCount * sizeof(uint32_t);
+		if (!blockCount)
+			return (size_t)(op - out);
+
+		// a group of blocks is compressed in parallel to scratch buffers, then appended in order.
+		const size_t blockBound = GetCompressBlockBound(blockSize);
+		const uint32_t groupSize = (uint32_t)__min((uint64_t)GetJobThreadCount() * 4, blockCount);
+		uint8_t* scratch = static_cast<uint8_t*>(_malloc(blockBound * groupSize));
+		tDynArray<uint32_t> entries(groupSize);
+		for (uint32_t first = 0; first < (uint32_t)blockCount; first += groupSize)
+		{
+			const uint32_t count = (uint32_t)__min((uint64_t)groupSize, blockCount - first);
+			ParallelFor(count, 1, [&](uint32_t i)
+				{
+					const size_t blockOffset = (size_t)(first + i) * blockSize;
+					const size_t length = __min((size_t)blockSize, size - blockOffset);
+					const size_t compressed = CompressBlock(source + blockOffset, length, scratch + i * blockBound, blockBound);
+					check(compressed);
+					entries[i] = compressed < length ? (uint32_t)compressed : (uint32_t)length | tCompressedHeader::StoredBlockFlag;
+				});
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const uint32_t entry = entries[i];
+				const size_t stored = entry & ~tCompressedHeader::StoredBlockFlag;
+				const uint8_t* data = entry & tCompressedHeader::StoredBlockFlag ? source + (size_t)(first + i) * blockSize : scratch + i * blockBound;
+				memcpy(table + (first + i) * sizeof(uint32_t), &entry, sizeof(entry));
+				memcpy(op, data, stored);
+				op += stored;
+			}
+		}
+		Mist::Free(scratch);
+		return (size_t)(op - out);
+	}
+
+	bool GetDecompressedSize(const void* src, size_t srcSize, uint64_t& size)
+	{
+		compression::tStreamView view;
+		if (!compression::ReadStream(src, srcSize, view))
+			return false;
+		size = view.Header.Size;
+		return true;
+	}
+
+	bool Decompress(const void* src, size_t srcSize, void* dst, size_t size, bool parallel)
+	{
+		using namespace compression;
+		tStreamView view;
+		if (!ReadStream(src, srcSize, view) || view.Header.Size != size || (!dst && size))
+			return false;
+		if (!view.BlockCount)
+			return true;
+
+		// block offsets from the sizes, validated by ReadStream.
+		tDynArray<const uint8_t*> blocks(view.BlockCount);
+		const uint8_t* it = view.Blocks;
+		for (uint32_t i = 0; i < view.BlockCount; ++i)
+		{
+			blocks[i] = it;
+			it += GetBlockEntry(view.BlockTable, i) & ~tCompressedHeader::StoredBlockFlag;
+		}
+		std::atomic<bool> failed = false;
+		uint8_t* out = static_cast<uint8_t*>(dst);
+		ParallelFor(view.BlockCount, parallel ? 0 : view.BlockCount, [&](uint32_t i)
+			{
+				const size_t blockOffset = (size_t)i * view.Header.BlockSize;
+				if (!DecodeBlock(GetBlockEntry(view.BlockTable, i), blocks[i], out + blockOffset, GetBlockSize(view.Header, i)))
+					failed.store(true, std::memory_order_relaxed);
+			});
+		return !failed.load(std::memory_order_relaxed);
+	}
+
+	cDecompressStream::~cDecompressStream()
+	{
+		End();
+	}
+
+	bool cDecompressStream::Begin(const void* src, size_t srcSize)
+	{
+		check(!m_blockTable);
+		compression::tStreamView view;
+		if (!compression::ReadStream(src, srcSize, view))
+			return false;
+		m_blockTable = view.BlockTable;
+		m_blockData = view.Blocks;
+		m_blockCount = view.BlockCount;
+		m_blockSize = view.Header.BlockSize;
+		m_block = 0;
+		m_size = view.Header.Size;
+		m_position = 0;
+		m_bufferOffset = 0;
+		m_bufferSize = 0;
+		m_failed = false;
+		return true;
+	}
+
+	void cDecompressStream::End()
+	{
+		if (m_buffer)
+			Mist::Free(m_buffer);
+		m_buffer = nullptr;
+		m_blockTable = nullptr;
+		m_blockData = nullptr;
+		m_blockCount = 0;
+		m_size = 0;
+		m_position = 0;
+		m_bufferOffset = 0;
+		m_bufferSize = 0;
+	}
+
+	bool cDecompressStream::DecodeNextBlock(void* dst, size_t size)
+	{
+		check(m_block < m_blockCount);
+		const uint32_t entry = compression::GetBlockEntry(m_blockTable, m_block);
+		if (!compression::DecodeBlock(entry, m_blockData, dst, size))
+		{
+			m_failed = true;
+			return false;
+		}
+		m_blockData += entry & ~tCompressedHeader::StoredBlockFlag;
+		++m_block;
+		return true;
+	}
+
+	size_t cDecompressStream::Read(void* dst, size_t size)
+	{
+		check(dst || !size);
+		uint8_t* out = static_cast<uint8_t*>(dst);
+		size_t written = 0;
+		while (!m_failed && written < size && m_position < m_size)
+		{
+			if (m_bufferOffset < m_bufferSize)
+			{
+				const size_t count = __min(size - written, m_bufferSize - m_bufferOffset);
+				memcpy(out + written, m_buffer + m_bufferOffset, count);
+				m_bufferOffset += count;
+				written += count;
+				m_position += count;
+				continue;
+			}
+
+			const size_t blockSize = (size_t)__min((uint64_t)m_blockSize, m_size - m_position);
+			if (size - written >= blockSize)
+			{
+				if (!DecodeNextBlock(out + written, blockSize))
+					break;
+				written += blockSize;
+				m_position += blockSize;
+			}
+			else
+			{
+				if (!m_buffer)
+					m_buffer = static_cast<uint8_t*>(_malloc(m_blockSize));
+				if (!DecodeNextBlock(m_buffer, blockSize))
+					break;
+				m_bufferOffset = 0;
+				m_bufferSize = blockSize;
+			}
+		}
+		return m_failed ? 0 : written;
+	}
+
+	namespace compression_test
+	{
+		// bytes after the output capacity, the decoder must never touch them.
+		static constexpr size_t GuardSize = 64;
+		static constexpr uint8_t GuardValue = 0xcd;
+
+		void SetGuard(tDynArray<uint8_t>& buffer, size_t capacity)
+		{
+			check(buffer.size() >= capacity + GuardSize);
+			memset(buffer.data() + capacity, GuardValue, GuardSize);
+		}
+
+		bool CheckGuard(const tDynArray<uint8_t>& buffer, size_t capacity)
+		{
+			for (size_t i = capacity; i < capacity + GuardSize; ++i)
+			{
+				if (buffer[i] != GuardValue)
+					return false;
+			}
+			return true;
+		}
+
+		// runs of random bytes, repeated bytes, small alphabet text and copies from behind, some
+		// beyond the match window.
+		void GenerateMixed(uint8_t* data, size_t size, tRandom& random)
+		{
+			size_t i = 0;
+			while (i < size)
+			{
+				const uint32_t kind = random.Range(4);
+				// __min evaluates its arguments twice.
+				const size_t run = 1 + random.Range(kind ? 300 : 64);
+				size_t length = __min(run, size - i);
+				switch (kind)
+				{
+				case 0:
+					for (size_t j = 0; j < length; ++j)
+						data[i + j] = (uint8_t)random.Next();
+					break;
+				case 1:
+					memset(data + i, (int)random.Range(256), length);
+					break;
+				case 2:
+					for (size_t j = 0; j < length; ++j)
+						data[i + j] = (uint8_t)('a' + random.Range(4));
+					break;
+				case 3:
+					if (!i)
+						length = 0;
+					else
+					{
+						// overlapped copies with short distances make runs of a pattern.
+						const size_t distance = 1 + random.Range((uint32_t)__min(i, (size_t)70000));
+						for (size_t j = 0; j < length; ++j)
+							data[i + j] = data[i + j - distance];
+					}
+					break;
+				}
+				i += length;
+			}
+		}
+
+		// compressed, decoded in parallel and serial, sizes and bytes compared.
+		bool RoundTrip(const uint8_t* data, size_t size, uint32_t blockSize, tDynArray<uint8_t>& compressed, tDynArray<uint8_t>& decoded)
+		{
+			compressed.resize(GetCompressBound(size, blockSize));
+			const size_t compressedSize = Compress(data, size, compressed.data(), compressed.size(), blockSize);
+			if (!compressedSize || compressedSize > compressed.size())
+				return false;
+			compressed.resize(compressedSize);
+			uint64_t decodedSize = 0;
+			if (!GetDecompressedSize(compressed.data(), compressed.size(), decodedSize) || decodedSize != size)
+				return false;
+			decoded.assign(size + GuardSize, GuardValue);
+			bool result = Decompress(compressed.data(), compressed.size(), decoded.data(), size, true)
+				&& (!size || !memcmp(decoded.data(), data, size)) && CheckGuard(decoded, size);
+			decoded.assign(size + GuardSize, GuardValue);
+			result = result && Decompress(compressed.data(), compressed.size(), decoded.data(), size, false)
+				&& (!size || !memcmp(decoded.data(), data, size)) && CheckGuard(decoded, size);
+			return result;
+		}
+
+		// random read sizes through cDecompressStream, from a byte to several blocks.
+		bool StreamRoundTrip(const uint8_t* data, size_t size, const tDynArray<uint8_t>& compressed, uint32_t blockSize, tRandom& random)
+		{
+			cDecompressStream stream;
+			if (!stream.Begin(compressed.data(), compressed.size()) || stream.GetSize() != size)
+				return false;
+			tDynArray<uint8_t> decoded(size + 1);
+			size_t position = 0;
+			while (!stream.IsEnd())
+			{
+				const size_t wanted = 1 + random.Range(blockSize * 3);
+				const size_t request = __min(wanted, size + 1 - position);
+				const size_t read = stream.Read(decoded.data() + position, request);
+				if (!read || read > request)
+					return false;
+				position += read;
+			}
+			return position == size && !stream.HasFailed() && !stream.Read(decoded.data(), 1) && (!size || !memcmp(decoded.data(), data, size));
+		}
+	}
+
+	bool TestCompression()
+	{
+		using namespace compression_test;
+		loginfo("****************** Compression tests ******************\n");
+		bool result = true;
+		tRandom random;
+		tDynArray<uint8_t> data;
+		tDynArray<uint8_t> compressed;
+		tDynArray<uint8_t> decoded;
+		// small blocks put many block edges in short inputs.
+		const uint32_t smallBlock = 4096;
+
+		{
+			bool ok = RoundTrip(nullptr, 0, tCompressedHeader::DefaultBlockSize, compressed, decoded)
+				&& compressed.size() == sizeof(tCompressedHeader);
+			for (size_t size = 1; size <= 64 && ok; ++size)
+			{
+				data.resize(size);
+				GenerateMixed(data.data(), size, random);
+				ok = RoundTrip(data.data(), size, tCompressedHeader::DefaultBlockSize, compressed, decoded);
+			}
+			result &= TestResult(ok, "Compression", "tiny");
+		}
+
+		{
+			const size_t size = 4 * 1024 * 1024 + 13;
+			data.assign(size, 0);
+			bool ok = RoundTrip(data.data(), size, tCompressedHeader::DefaultBlockSize, compressed, decoded)
+				&& compressed.size() < size / 100;
+			result &= TestResult(ok, "Compression", "zeros");
+		}
+
+		{
+			const size_t size = 1024 * 1024 + 7;
+			data.resize(size);
+			for (size_t i = 0; i < size; ++i)
+				data[i] = (uint8_t)random.Next();
+			// stored blocks, only the header and block table over the input.
+			bool ok = RoundTrip(data.data(), size, tCompressedHeader::DefaultBlockSize, compressed, decoded)
+				&& compressed.size() <= GetCompressBound(size);
+			result &= TestResult(ok, "Compression", "random");
+		}
+
+		{
+			bool ok = true;
+			const uint32_t blockSize = tCompressedHeader::DefaultBlockSize;
+			const size_t sizes[] = { blockSize - 1, blockSize, blockSize + 1, 3 * (size_t)blockSize + 17 };
+			for (size_t size : sizes)
+			{
+				data.resize(size);
+				GenerateMixed(data.data(), size, random);
+				ok &= RoundTrip(data.data(), size, blockSize, compressed, decoded);
+				ok &= StreamRoundTrip(data.data(), size, compressed, blockSize, random);
+			}
+			result &= TestResult(ok, "Compression", "block edges");
+		}
+
+		const uint32_t iterations = (uint32_t)__max(CVar_LzTestIterations.Get(), 1);
+		{
+			bool ok = true;
+			for (uint32_t i = 0; i < iterations && ok; ++i)
+			{
+				const size_t size = random.Range(64 * 1024);
+				const uint32_t blockSize = random.Range(2) ? smallBlock : tCompressedHeader::DefaultBlockSize;
+				data.resize(size);
+				GenerateMixed(data.data(), size, random);
+				ok = RoundTrip(data.data(), size, blockSize, compressed, decoded)
+					&& StreamRoundTrip(data.data(), size, compressed, blockSize, random);
+				if (!ok)
+					logferror("Round trip failed: iteration %u, %zu bytes, block size %u\n", i, size, blockSize);
+			}
+			result &= TestResult(ok, "Compression", "fuzz round trip");
+		}
+
+		{
+			// decoding garbage and damaged streams has to stay inside the buffers, the result doesn't matter.
+			const size_t size = 64 * 1024;
+			data.resize(size);
+			GenerateMixed(data.data(), size, random);
+			check(RoundTrip(data.data(), size, smallBlock, compressed, decoded));
+			const tDynArray<uint8_t> original = compressed;
+			decoded.resize(size + GuardSize);
+			uint32_t rejected = 0;
+			uint32_t overruns = 0;
+			for (uint32_t i = 0; i < iterations; ++i)
+			{
+				compressed.assign(original.begin(), original.end());
+				const uint32_t flips = 1 + random.Range(4);
+				for (uint32_t j = 0; j < flips; ++j)
+					compressed[random.Range((uint32_t)compressed.size())] ^= (uint8_t)(1 + random.Range(255));
+				SetGuard(decoded, size);
+				rejected += Decompress(compressed.data(), compressed.size(), decoded.data(), size) ? 0 : 1;
+				overruns += CheckGuard(decoded, size) ? 0 : 1;
+
+				uint8_t garbage[512];
+				for (uint8_t& value : garbage)
+					value = (uint8_t)random.Next();
+				const size_t capacity = 1 + random.Range(smallBlock);
+				SetGuard(decoded, capacity);
+				DecompressBlock(garbage, 1 + random.Range(sizeof(garbage)), decoded.data(), capacity);
+				overruns += CheckGuard(decoded, capacity) ? 0 : 1;
+			}
+			bool truncated = true;
+			for (size_t cut = 1; cut < 64; ++cut)
+			{
+				SetGuard(decoded, size);
+				truncated &= !Decompress(original.data(), original.size() - cut, decoded.data(), size) && CheckGuard(decoded, size);
+			}
+			SetGuard(decoded, size - 1);
+			truncated &= !Decompress(original.data(), original.size(), decoded.data(), size - 1) && CheckGuard(decoded, size - 1);
+			result &= TestResult(truncated, "Compression", "truncated streams");
+			result &= TestResult(!overruns, "Compression", "corrupted streams");
+			logfinfo("Corrupted streams rejected: %u/%u, writes past the output: %u\n", rejected, iterations, overruns);
+		}
+		loginfo("*******************************************************\n");
+		return result;
+	}
+
+	namespace compression_benchmark
+	{
+		struct tBenchCollector
+		{
+			const char* Directory;
+			const char* Filter;
+			tDynArray<cAssetPath>* Files;
+		};
+
+		void CollectFile(const char* path, void* userData)
+		{
+			tBenchCollector& collector = *static_cast<tBenchCollector*>(userData);
+			if (!WildStricmp(collector.Filter, path))
+				return;
+			char relative[256];
+			sprintf_s(relative, "%s/%s", collector.Directory, path);
+			collector.Files->push_back(cAssetPath(relative));
+		}
+
+		struct tBenchFile
+		{
+			const uint8_t* Data;
+			size_t Size;
+			tDynArray<uint8_t> Compressed;
+		};
+
+		double MBps(uint64_t bytes, double ms)
+		{
+			return (double)bytes / (1024.0 * 1024.0) * 1000.0 / __max(ms, 1e-3);
+		}
+	}
+
+	void BenchmarkCompression()
+	{
+		using namespace compression_benchmark;
+		tDynArray<cAssetPath> paths;
+		tBenchCollector collector = { CVar_LzBenchDirectory.Get(), CVar_LzBenchFilter.Get(), &paths };
+		Platform::VisitDirectoryFiles(cAssetPath(collector.Directory), true, &CollectFile, &collector);
+		if (paths.empty())
+		{
+			logfwarn("No %s files found in %s\n", collector.Filter, collector.Directory);
+			return;
+		}
+
+		// whole files in memory, the benchmark measures the codec and not the disk.
+		tDynArray<cMappedFile> mapped(paths.size());
+		tDynArray<tBenchFile> files;
+		uint64_t totalBytes = 0;
+		size_t largest = 0;
+		for (size_t i = 0; i < paths.size(); ++i)
+		{
+			if (!mapped[i].Open(paths[i]) || !mapped[i].GetSize())
+				continue;
+			tBenchFile file;
+			file.Data = static_cast<const uint8_t*>(mapped[i].GetData());
+			file.Size = mapped[i].GetSize();
+			totalBytes += file.Size;
+			largest = __max(largest, file.Size);
+			files.push_back(std::move(file));
+		}
+		uint8_t* buffer = static_cast<uint8_t*>(_malloc(__max(largest, (size_t)1)));
+		for (tBenchFile& file : files)
+			memcpy(buffer, file.Data, file.Size);
+
+		Profiling::sProfilingTimer timer;
+		timer.Start();
+		for (tBenchFile& file : files)
+			memcpy(buffer, file.Data, file.Size);
+		const double copyMs = timer.Stop();
+
+		uint64_t compressedBytes = 0;
+		timer.Start();
+		for (tBenchFile& file : files)
+		{
+			file.Compressed.resize(GetCompressBound(file.Size));
+			file.Compressed.resize(Compress(file.Data, file.Size, file.Compressed.data(), file.Compressed.size()));
+			compressedBytes += file.Compressed.size();
+		}
+		const double compressMs = timer.Stop();
+
+		// best of a few passes, the first one also warms the caches.
+		static constexpr uint32_t Passes = 3;
+		double decompressMs[2] = { DBL_MAX, DBL_MAX };
+		bool valid = true;
+		for (uint32_t pass = 0; pass < Passes; ++pass)
+		{
+			for (uint32_t parallel = 0; parallel < 2; ++parallel)
+			{
+				timer.Start();
+				for (const tBenchFile& file : files)
+					valid &= Decompress(file.Compressed.data(), file.Compressed.size(), buffer, file.Size, parallel != 0);
+				decompressMs[parallel] = __min(decompressMs[parallel], timer.Stop());
+			}
+		}
+		for (const tBenchFile& file : files)
+		{
+			valid &= Decompress(file.Compressed.data(), file.Compressed.size(), buffer, file.Size)
+				&& !memcmp(buffer, file.Data, file.Size);
+		}
+		Mist::Free(buffer);
+
+		loginfo("****************** Compression benchmark ******************\n");
+		logfinfo("Files:			%8zu %s (%.2f MB)\n", files.size(), collector.Filter, (double)totalBytes / (1024.0 * 1024.0));
+		logfinfo("Compressed:		%8.2f MB (ratio %.3f)\n", (double)compressedBytes / (1024.0 * 1024.0), (double)compressedBytes / (double)__max(totalBytes, (uint64_t)1));
+		logfinfo("Copy:			%8.2f ms (%8.2f MB/s)\n", copyMs, MBps(totalBytes, copyMs));
+		logfinfo("Compress:		%8.2f ms (%8.2f MB/s)\n", compressMs, MBps(totalBytes, compressMs));
+		logfinfo("Decompress 1 thread:	%8.2f ms (%8.2f MB/s)\n", decompressMs[0], MBps(totalBytes, decompressMs[0]));
+		logfinfo("Decompress %u threads:	%8.2f ms (%8.2f MB/s)\n", GetJobThreadCount(), decompressMs[1], MBps(totalBytes, decompressMs[1]));
+		if (!valid)
+			logferror("Compression benchmark: decoded data doesn't match.\n");
+		loginfo("***********************************************************\n");
+	}
+
+	void ExecCommand_TestCompression(const char* command)
+	{
+		TestCompression();
+	}
+
+	void ExecCommand_BenchmarkCompression(const char* command)
+	{
+		BenchmarkCompression();
+	}
+
+	void InitCompression()
+	{
+		AddConsoleCommand("fs_lztest", &ExecCommand_TestCompression);
+		AddConsoleCommand("fs_lzbench", &ExecCommand_BenchmarkCompression);
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Core/Types.h"
+
+/**
+ * LZ codec for cooked data, no external dependencies. Byte oriented LZ77 (lz4 class): sequences of
+ * literals and a match of at least 4 bytes up to 64 KB back, no entropy coding, so decoding is mostly
+ * copies and runs near memory bandwidth.
+ *
+ * A compressed stream splits the data in independent blocks:
+ *
+ *   header | block sizes | blocks...
+ *
+ * Blocks decode on their own, in parallel through the job system or one after the other with
+ * cDecompressStream. A block that doesn't shrink is stored as is. Decoding validates every length and
+ * offset against both buffers, corrupted data fails instead of reading or writing out of them.
+ */
+
+namespace Mist
+{
+	struct tCompressedHeader
+	{
+		// "MLZ1"
+		static constexpr uint32_t StreamMagic = 0x315a4c4d;
+		static constexpr uint32_t DefaultBlockSize = 256 * 1024;
+		static constexpr uint32_t MaxBlockSize = 4 * 1024 * 1024;
+		// block size flag of blocks stored uncompressed.
+		static constexpr uint32_t StoredBlockFlag = 0x80000000;
+
+		uint32_t Magic;
+		uint32_t BlockSize;
+		// decompressed bytes.
+		uint64_t Size;
+	};
+
+	// worst case CompressBlock output for size bytes.
+	size_t GetCompressBlockBound(size_t size);
+	// returns the compressed size, 0 if capacity is below GetCompressBlockBound(size).
+	size_t CompressBlock(const void* src, size_t size, void* dst, size_t capacity);
+	// false if src is not a block of exactly size decompressed bytes.
+	bool DecompressBlock(const void* src, size_t srcSize, void* dst, size_t size);
+
+	// worst case Compress output, never more than the header and block table over size.
+	size_t GetCompressBound(size_t size, uint32_t blockSize = tCompressedHeader::DefaultBlockSize);
+	// compressed stream of src. Blocks are compressed in parallel when the job system runs.
+	// Returns the stream size, 0 if capacity is below GetCompressBound.
+	size_t Compress(const void* src, size_t size, void* dst, size_t capacity, uint32_t blockSize = tCompressedHeader::DefaultBlockSize);
+	// decompressed size of a stream, false if src is not one.
+	bool GetDecompressedSize(const void* src, size_t srcSize, uint64_t& size);
+	// decodes the whole stream, size must be the decompressed size. Parallel spreads the blocks over the job system.
+	bool Decompress(const void* src, size_t srcSize, void* dst, size_t size, bool parallel = true);
+
+	// Decodes a stream block by block in the caller buffers, for data consumed front to back without
+	// the whole decompressed copy. Reads of whole blocks decode in place, the rest goes through a
+	// block sized buffer.
+	class cDecompressStream
+	{
+	public:
+		cDecompressStream() = default;
+		~cDecompressStream();
+		cDecompressStream(const cDecompressStream&) = delete;
+		cDecompressStream& operator=(const cDecompressStream&) = delete;
+
+		// validates header and block table, src must live until End.
+		bool Begin(const void* src, size_t srcSize);
+		void End();
+		// decodes up to size bytes in dst. Returns the bytes written, 0 at the end or on a corrupted block.
+		size_t Read(void* dst, size_t size);
+
+		inline uint64_t GetSize() const { return m_size; }
+		inline uint64_t GetPosition() const { return m_position; }
+		inline bool IsEnd() const { return m_position == m_size; }
+		inline bool HasFailed() const { return m_failed; }
+
+	private:
+		bool DecodeNextBlock(void* dst, size_t size);
+
+	private:
+		const uint8_t* m_blockTable = nullptr;
+		const uint8_t* m_blockData = nullptr;
+		uint32_t m_blockCount = 0;
+		uint32_t m_blockSize = 0;
+		// next block to decode.
+		uint32_t m_block = 0;
+		uint64_t m_size = 0;
+		uint64_t m_position = 0;
+		// decoded block not read completely yet.
+		uint8_t* m_buffer = nullptr;
+		size_t m_bufferOffset = 0;
+		size_t m_bufferSize = 0;
+		bool m_failed = false;
+	};
+
+	// registers console commands.
+	void InitCompression();
+	// Round trip of generated and fuzzed data, corrupted streams must fail cleanly. Logs results.
+	bool TestCompression();
+	// Compression ratio and throughput on the files of fs_lzBenchDirectory against a plain copy.
+	void BenchmarkCompression();
+}
@@ -1,26 +1,134 @@
 #include "FileSystem.h"
+#include "Utils/Archive.h"
+#include "Utils/Compression.h"
 #include "Core/Logger.h"
+#include "Core/Platform.h"
+#include "Core/Console.h"
+#if defined(_WIN32)
 #include <direct.h>
+#endif
+#include <sys/stat.h>
 #include "Application/CmdParser.h"
-#include <fstream>
+#include "Core/TestUtils.h"
 
 namespace Mist
 {
 	CStrVar CVar_Workspace("Workspace", "../../assets/", CVarFlag_SetOnlyByCmd);
+	CBoolVar CVar_MapFiles("fs_mapFiles", true);
+
+	// workspace relative. Mounted by the application on init.
+	CStrVar CVar_Archive("Archive", "", CVarFlag_SetOnlyByCmd);
+	CStrVar CVar_ArchiveTestDirectory("fs_archiveTestDirectory", "models/sponza");
+	CBoolVar CVar_ArchiveTestCompress("fs_archiveTestCompress", false);
+
+	cArchive* GMountedArchive = nullptr;
+
+	bool FileSystem::MountArchive(const char* archivePath)
+	{
+		check(!GMountedArchive);
+		cArchive* archive = _new cArchive();
+		if (!archive->Open(archivePath))
+		{
+			delete archive;
+			return false;
+		}
+		GMountedArchive = archive;
+		return true;
+	}
+
+	void FileSystem::UnmountArchive()
+	{
+		delete GMountedArchive;
+		GMountedArchive = nullptr;
+	}
+
+	const cArchive* FileSystem::GetMountedArchive()
+	{
+		return GMountedArchive;
+	}
+
+	const tArchiveEntry* FileSystem::FindArchiveEntry(const char* filepath)
+	{
+		if (!GMountedArchive)
+			return nullptr;
+		// archive paths are workspace relative, files outside the workspace are always loose.
+		const char* workspace = CVar_Workspace.Get();
+		size_t len = strlen(workspace);
+		while (len && (workspace[len - 1] == '/' || workspace[len - 1] == '\\'))
+			--len;
+		if (_strnicmp(workspace, filepath, len) || (filepath[len] != '/' && filepath[len] != '\\'))
+			return nullptr;
+		return GMountedArchive->Find(filepath + len);
+	}
+
+	bool FileSystem::NormalizePath(const char* path, char* out, size_t size)
+	{
+		check(path && out && size);
+		size_t len = 0;
+		const char* it = path;
+		while (*it)
+		{
+			// one segment per iteration, separators skipped.
+			while (*it == '/' || *it == '\\')
+				++it;
+			const char* begin = it;
+			while (*it && *it != '/' && *it != '\\')
+				++it;
+			size_t segment = static_cast<size_t>(it - begin);
+			if (!segment || (segment == 1 && *begin == '.'))
+				continue;
+			if (segment == 2 && begin[0] == '.' && begin[1] == '.')
+			{
+				if (!len)
+					return false;
+				while (len && out[len - 1] != '/')
+					--len;
+				// drop the separator too, unless it was the first segment.
+				if (len)
+					--len;
+				continue;
+			}
+			if (len + (len ? 1 : 0) + segment >= size)
+				return false;
+			if (len)
+				out[len++] = '/';
+			for (size_t i = 0; i < segment; ++i)
+				out[len++] = static_cast<char>(tolower(static_cast<unsigned char>(begin[i])));
+		}
+		out[len] = 0;
+		return len > 0;
+	}
+
+	bool FileSystem::GetModificationTime(const char* filename, uint64_t& time)
+	{
+		if (const tArchiveEntry* entry = FindArchiveEntry(filename))
+		{
+			time = entry->ModificationTime;
+			return true;
+		}
+		struct stat info;
+		if (stat(filename, &info))
+			return false;
+		// stat.st_mtime: The most recent time that the file's contents were modified.
+		time = (uint64_t)info.st_mtime;
+		return true;
+	}
 
 	bool FileSystem::IsFileNewerThanOther(const char* file, const char* other)
 	{
 		check(file && *file && other && *other);
-		struct stat statsFile;
-		stat(file, &statsFile);
-		struct stat statsOther;
-		stat(other, &statsOther);
-		// stat.st_mtime: The most recent time that the file's contents were modified.
-		return statsFile.st_mtime > statsOther.st_mtime;
+		// a missing file is the oldest one.
+		uint64_t fileTime = 0;
+		uint64_t otherTime = 0;
+		GetModificationTime(file, fileTime);
+		GetModificationTime(other, otherTime);
+		return fileTime > otherTime;
 	}
 
 	bool FileSystem::FileExists(const char* filename)
 	{
+		if (FindArchiveEntry(filename))
+			return true;
 		FILE* f = nullptr;
 		if (!fopen_s(&f, filename, "r"))
         {
@@ -46,98 +154,61 @@ namespace Mist
 		return _mkdir(directory) != 0;
 	}
 
-	bool FileSystem::ReadFile(const char* filename, tDynArray<uint32_t>& data)
+	// heap copy of the file plus extraBytes, through cMappedFile so archived files are found too.
+	bool ReadFileCopy(const char* filename, size_t extraBytes, char** out, size_t& size)
 	{
-		data.clear();
-		// Open file with std::ios::ate -> with cursor at the end of the file
-		std::ifstream file(filename, std::ios::ate | std::ios::binary);
-		if (!file.is_open())
+		cMappedFile file;
+		if (!file.Open(filename))
 		{
 			logferror("File not found: %s.\n", filename);
 			return false;
 		}
-		// Tell size (remember cursor at the end of the file)
-		size_t fileSize = (size_t)file.tellg();
-		// SpirV expects a uint32 buffer
-		data.resize(fileSize / sizeof(uint32_t));
-		// Move cursor file to the beginning
-		file.seekg(0);
-		// Read the entire file to the buffer
-		file.read((char*)data.data(), fileSize);
-		// Terminated with file stream
-		file.close();
+		size = file.GetSize();
+		*out = (char*)malloc(size + extraBytes);
+		if (size)
+			memcpy(*out, file.GetData(), size);
 		return true;
 	}
 
-	bool FileSystem::ReadFile(const char* filename, uint32_t** data, size_t& size)
+	bool FileSystem::ReadFile(const char* filename, tDynArray<uint32_t>& data)
 	{
-		// Open file with std::ios::ate -> with cursor at the end of the file
-		std::ifstream file(filename, std::ios::ate | std::ios::binary);
-		if (!file.is_open())
+		data.clear();
+		cMappedFile file;
+		if (!file.Open(filename))
 		{
 			logferror("File not found: %s.\n", filename);
 			return false;
 		}
-		// Tell size (remember cursor at the end of the file)
-		size_t bytes = (size_t)file.tellg();
 		// SpirV expects a uint32 buffer
-		*data = (uint32_t*)malloc(bytes);
-		// Move cursor file to the beginning
-		file.seekg(0);
-		// Read the entire file to the buffer
-		file.read((char*)*data, bytes);
-		// Terminated with file stream
-		file.close();
-
-		size = bytes / sizeof(uint32_t);
+		data.resize(file.GetSize() / sizeof(uint32_t));
+		if (!data.empty())
+			memcpy(data.data(), file.GetData(), data.size() * sizeof(uint32_t));
 		return true;
 	}
 
-	bool FileSystem::ReadFile(const char* filename, char** out, size_t& size)
+	bool FileSystem::ReadFile(const char* filename, uint32_t** data, size_t& size)
 	{
-		// Open file with std::ios::ate -> with cursor at the end of the file
-		std::ifstream file(filename, std::ios::ate | std::ios::binary);
-		if (!file.is_open())
-		{
-			logferror("File not found: %s.\n", filename);
+		char* bytes = nullptr;
+		size_t byteCount = 0;
+		if (!ReadFileCopy(filename, 0, &bytes, byteCount))
 			return false;
-		}
-		// Tell size (remember cursor at the end of the file)
-		size = (size_t)file.tellg();
 		// SpirV expects a uint32 buffer
-		*out = (char*)malloc(size);
-		// Move cursor file to the beginning
-		file.seekg(0);
-		// Read the entire file to the buffer
-		file.read(*out, size);
-		// Terminated with file stream
-		file.close();
-
+		*data = (uint32_t*)bytes;
+		size = byteCount / sizeof(uint32_t);
 		return true;
 	}
 
+	bool FileSystem::ReadFile(const char* filename, char** out, size_t& size)
+	{
+		return ReadFileCopy(filename, 0, out, size);
+	}
+
 	bool FileSystem::ReadTextFile(const char* filename, char** out, size_t& size)
 	{
-		// Open file with std::ios::ate -> with cursor at the end of the file
-		std::ifstream file(filename, std::ios::ate | std::ios::binary);
-		if (!file.is_open())
-		{
-			logferror("File not found: %s.\n", filename);
+		if (!ReadFileCopy(filename, 1, out, size))
 			return false;
-		}
-		// Tell size (remember cursor at the end of the file)
-		size = (size_t)file.tellg() + 1;
-		// SpirV expects a uint32 buffer
-		*out = (char*)malloc(size);
-		// Move cursor file to the beginning
-		file.seekg(0);
-		// Read the entire file to the buffer
-		file.read(*out, size);
-		// Terminated with file stream
-		file.close();
-
-		(*out)[size - 1] = 0;
-
+		// size counts the null terminator.
+		(*out)[size++] = 0;
 		return true;
 	}
 
@@ -232,6 +303,116 @@ namespace Mist
 		return fwrite(data, 1, bufferSize, f);
 	}
 
+	cMappedFile::~cMappedFile()
+	{
+		Close();
+	}
+
+	bool cMappedFile::Open(const char* filepath, eAccess access)
+	{
+		check(filepath && *filepath && !m_open);
+		if (const tArchiveEntry* entry = FileSystem::FindArchiveEntry(filepath))
+			return OpenArchived(*GMountedArchive, *entry, access);
+
+		if (CVar_MapFiles.Get() && Platform::MapFile(filepath, m_mapping))
+		{
+			m_view = &m_mapping;
+			m_data = m_mapping.Data;
+			m_size = m_mapping.Size;
+			m_open = true;
+			Platform::AdviseMappedFile(m_mapping, 0, m_size,
+				access == Access_Sequential ? Platform::MappedFileAdvice_Sequential : Platform::MappedFileAdvice_Random);
+			return true;
+		}
+
+		FILE* f = nullptr;
+		if (fopen_s(&f, filepath, "rb"))
+			return false;
+		check(f);
+		fseek(f, 0L, SEEK_END);
+		long size = ftell(f);
+		fseek(f, 0L, SEEK_SET);
+		if (size < 0)
+		{
+			fclose(f);
+			return false;
+		}
+		m_size = (size_t)size;
+		if (m_size)
+		{
+			m_buffer = _malloc(m_size);
+			size_t read = fread_s(m_buffer, m_size, 1, m_size, f);
+			if (read != m_size)
+			{
+				logferror("Failed to read file: %s (%zu/%zu bytes).\n", filepath, read, m_size);
+				fclose(f);
+				Close();
+				return false;
+			}
+		}
+		fclose(f);
+		m_data = m_buffer;
+		m_open = true;
+		return true;
+	}
+
+	bool cMappedFile::OpenArchived(const cArchive& archive, const tArchiveEntry& entry, eAccess access)
+	{
+		// compression and ranges validated when the archive is opened.
+		if (entry.Compression == ArchiveCompression_Lz)
+		{
+			// read once front to back by the decoder, blocks in parallel through the job system.
+			Platform::AdviseMappedFile(archive.GetMapping(), (size_t)entry.Offset, (size_t)entry.StoredSize, Platform::MappedFileAdvice_Sequential);
+			m_size = (size_t)entry.Size;
+			m_buffer = m_size ? _malloc(m_size) : nullptr;
+			if (!Decompress(archive.GetEntryData(entry), (size_t)entry.StoredSize, m_buffer, m_size))
+			{
+				logferror("Corrupted archive entry: %s (%s)\n", archive.GetEntryName(entry), archive.GetPath());
+				Close();
+				return false;
+			}
+			m_data = m_buffer;
+			m_archived = true;
+			m_open = true;
+			return true;
+		}
+
+		check(entry.Compression == ArchiveCompression_None);
+		m_view = &archive.GetMapping();
+		m_viewOffset = (size_t)entry.Offset;
+		m_size = (size_t)entry.Size;
+		m_data = m_size ? archive.GetEntryData(entry) : nullptr;
+		m_archived = true;
+		m_open = true;
+		if (m_size)
+		{
+			Platform::AdviseMappedFile(*m_view, m_viewOffset, m_size,
+				access == Access_Sequential ? Platform::MappedFileAdvice_Sequential : Platform::MappedFileAdvice_Random);
+		}
+		return true;
+	}
+
+	void cMappedFile::Close()
+	{
+		if (m_mapping.IsMapped())
+			Platform::UnmapFile(m_mapping);
+		if (m_buffer)
+			Mist::Free(m_buffer);
+		m_view = nullptr;
+		m_viewOffset = 0;
+		m_buffer = nullptr;
+		m_data = nullptr;
+		m_size = 0;
+		m_archived = false;
+		m_open = false;
+	}
+
+	void cMappedFile::Prefetch(size_t offset, size_t size) const
+	{
+		if (m_view)
+			Platform::AdviseMappedFile(*m_view, m_viewOffset + offset, size, Platform::MappedFileAdvice_WillNeed);
+	}
+
 	size_t cFile::GetContentSize() const
 	{
 		check(m_id);
@@ -412,4 +593,281 @@ namespace Mist
 		check(*s);
 		return s;
 	}
+
+	namespace filesystem_benchmark
+	{
+		// touches every byte, so both paths pay for reading the whole file.
+		uint64_t Checksum(const void* data, size_t size)
+		{
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			uint64_t sum = 0;
+			size_t i = 0;
+			for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+			{
+				uint64_t word;
+				memcpy(&word, bytes + i, sizeof(uint64_t));
+				sum += word;
+			}
+			for (; i < size; ++i)
+				sum += bytes[i];
+			return sum;
+		}
+
+		// old ReadFile path: full heap copy of the file.
+		bool ReadBuffered(const char* filepath, uint64_t& checksum, size_t& bytes)
+		{
+			FILE* f = nullptr;
+			if (fopen_s(&f, filepath, "rb"))
+				return false;
+			fseek(f, 0L, SEEK_END);
+			size_t size = (size_t)ftell(f);
+			fseek(f, 0L, SEEK_SET);
+			void* buffer = size ? _malloc(size) : nullptr;
+			size_t read = size ? fread_s(buffer, size, 1, size, f) : 0;
+			fclose(f);
+			checksum += Checksum(buffer, read);
+			bytes += read;
+			if (buffer)
+				Mist::Free(buffer);
+			return read == size;
+		}
+
+		bool ReadMapped(const char* filepath, uint64_t& checksum, size_t& bytes)
+		{
+			cMappedFile file;
+			if (!file.Open(filepath))
+				return false;
+			checksum += Checksum(file.GetData(), file.GetSize());
+			bytes += file.GetSize();
+			return true;
+		}
+
+		void CollectFile(const char* path, void* userData)
+		{
+			static_cast<tDynArray<cAssetPath>*>(userData)->push_back(cAssetPath(path));
+		}
+
+		/**
+		 * Reads every file in the workspace buffered and mapped. Files are read once before timing,
+		 * so both passes read from the os page cache and the difference is the copy and allocation.
+		 */
+		void Run()
+		{
+			tDynArray<cAssetPath> files;
+			Platform::VisitDirectoryFiles(CVar_Workspace.Get(), true, &CollectFile, &files);
+			if (files.empty())
+			{
+				logfwarn("No files found in workspace: %s\n", CVar_Workspace.Get());
+				return;
+			}
+
+			uint64_t warmChecksum = 0;
+			size_t totalBytes = 0;
+			for (size_t i = 0; i < files.size(); ++i)
+				ReadMapped(files[i], warmChecksum, totalBytes);
+
+			Profiling::sProfilingTimer timer;
+			uint64_t bufferedChecksum = 0;
+			size_t bufferedBytes = 0;
+			timer.Start();
+			for (size_t i = 0; i < files.size(); ++i)
+				ReadBuffered(files[i], bufferedChecksum, bufferedBytes);
+			double bufferedMs = timer.Stop();
+
+			uint64_t mappedChecksum = 0;
+			size_t mappedBytes = 0;
+			timer.Start();
+			for (size_t i = 0; i < files.size(); ++i)
+				ReadMapped(files[i], mappedChecksum, mappedBytes);
+			double mappedMs = timer.Stop();
+
+			check(bufferedChecksum == mappedChecksum && bufferedBytes == mappedBytes);
+			double mb = (double)totalBytes / (1024.0 * 1024.0);
+			loginfo("****************** File read benchmark ******************\n");
+			logfinfo("Files:		%8zu (%.2f MB)%s\n", files.size(), mb, CVar_MapFiles.Get() ? "" : " [fs_mapFiles disabled]");
+			logfinfo("Buffered:	%8.2f ms (%8.2f MB/s)\n", bufferedMs, mb * 1000.0 / __max(bufferedMs, 1e-3));
+			logfinfo("Mapped:		%8.2f ms (%8.2f MB/s)\n", mappedMs, mb * 1000.0 / __max(mappedMs, 1e-3));
+			loginfo("*********************************************************\n");
+		}
+	}
+
+	namespace archive_test
+	{
+		struct tTestCollector
+		{
+			const char* Directory;
+			tDynArray<cAssetPath>* Files;
+		};
+
+		void CollectTestFile(const char* path, void* userData)
+		{
+			tTestCollector& collector = *static_cast<tTestCollector*>(userData);
+			char relative[256];
+			sprintf_s(relative, "%s/%s", collector.Directory, path);
+			collector.Files->push_back(cAssetPath(relative));
+		}
+
+		// entry bytes, decoded when compressed, against the loose file.
+		bool EntryMatches(const cArchive& archive, const tArchiveEntry& entry, const Platform::tMappedFile& loose)
+		{
+			if (entry.Size != loose.Size)
+				return false;
+			if (!loose.Size)
+				return true;
+			if (entry.Compression == ArchiveCompression_None)
+				return !memcmp(archive.GetEntryData(entry), loose.Data, loose.Size);
+			void* decoded = _malloc(loose.Size);
+			bool result = Decompress(archive.GetEntryData(entry), (size_t)entry.StoredSize, decoded, loose.Size)
+				&& !memcmp(decoded, loose.Data, loose.Size);
+			Mist::Free(decoded);
+			return result;
+		}
+
+		// open and close only, what the archive saves are the os calls per file.
+		double TimeOpen(const tDynArray<cAssetPath>& files, uint32_t& archived)
+		{
+			Profiling::sProfilingTimer timer;
+			archived = 0;
+			timer.Start();
+			for (size_t i = 0; i < files.size(); ++i)
+			{
+				cMappedFile file;
+				if (file.Open(files[i]))
+					archived += file.IsArchived() ? 1 : 0;
+			}
+			return timer.Stop();
+		}
+
+		double TimeRead(const tDynArray<cAssetPath>& files, uint64_t& checksum)
+		{
+			Profiling::sProfilingTimer timer;
+			checksum = 0;
+			timer.Start();
+			for (size_t i = 0; i < files.size(); ++i)
+			{
+				cMappedFile file;
+				if (file.Open(files[i]))
+					checksum += filesystem_benchmark::Checksum(file.GetData(), file.GetSize());
+			}
+			return timer.Stop();
+		}
+	}
+
+	bool TestArchive()
+	{
+		using namespace archive_test;
+		const char* directory = CVar_ArchiveTestDirectory.Get();
+		tDynArray<cAssetPath> files;
+		tTestCollector collector = { directory, &files };
+		Platform::VisitDirectoryFiles(cAssetPath(directory), true, &CollectTestFile, &collector);
+		if (files.empty())
+		{
+			logferror("Archive test without files: %s\n", directory);
+			return false;
+		}
+
+		loginfo("****************** Archive tests ******************\n");
+		bool result = true;
+		cAssetPath archivePath("fs_archivetest.mpak");
+		tArchiveBuildOptions options;
+		options.Subdirectory = directory;
+		options.Compress = CVar_ArchiveTestCompress.Get();
+		tArchiveBuildStats stats;
+		Profiling::sProfilingTimer timer;
+		timer.Start();
+		bool built = BuildArchive(CVar_Workspace.Get(), archivePath, options, &stats);
+		double buildMs = timer.Stop();
+		cArchive archive;
+		if (!TestResult(built && archive.Open(archivePath) && archive.GetEntryCount() == (uint32_t)files.size(), "Archive", "build"))
+		{
+			remove(archivePath);
+			return false;
+		}
+
+		// every loose file has its entry with the same bytes and time, also looked up with other case and separators.
+		bool entries[2] = { true, true };
+		for (size_t i = 0; i < files.size(); ++i)
+		{
+			const char* relative = files[i].GetAssetPath();
+			const tArchiveEntry* entry = archive.Find(relative);
+			char variant[260];
+			sprintf_s(variant, "./%s", relative);
+			for (char* it = variant; *it; ++it)
+				*it = *it == '/' ? '\\' : (char)toupper((unsigned char)*it);
+			entries[0] &= entry && archive.Find(variant) == entry;
+
+			Platform::tMappedFile loose;
+			uint64_t time = 0;
+			if (!entry || !Platform::MapFile(files[i], loose))
+			{
+				entries[1] = false;
+				continue;
+			}
+			entries[1] &= EntryMatches(archive, *entry, loose)
+				&& entry->Offset % 4096 == 0 && FileSystem::GetModificationTime(files[i], time) && time == entry->ModificationTime;
+			Platform::UnmapFile(loose);
+		}
+		result &= TestResult(entries[0], "Archive", "lookup");
+		result &= TestResult(entries[1], "Archive", "entry data");
+		char missing[256];
+		sprintf_s(missing, "%s/missing_file.bin", directory);
+		result &= TestResult(!archive.Find(missing) && !archive.Find("../outside.bin") && !archive.Find(""), "Archive", "missing lookup");
+		archive.Close();
+
+		double mb = (double)stats.Bytes / (1024.0 * 1024.0);
+		logfinfo("Files: %u (%.2f MB, %u compressed), archive %.2f MB, packed in %.2f ms\n",
+			stats.Files, mb, stats.CompressedFiles, (double)stats.ArchiveBytes / (1024.0 * 1024.0), buildMs);
+		if (FileSystem::GetMountedArchive())
+		{
+			logfwarn("Archive %s already mounted, mount tests skipped.\n", FileSystem::GetMountedArchive()->GetPath());
+		}
+		else
+		{
+			// both passes read from the os cache, the entry checks above already read every file.
+			uint32_t archived[2];
+			uint64_t checksum[2];
+			double openMs[2];
+			double readMs[2];
+			openMs[0] = TimeOpen(files, archived[0]);
+			readMs[0] = TimeRead(files, checksum[0]);
+			timer.Start();
+			bool mounted = FileSystem::MountArchive(archivePath);
+			double mountMs = timer.Stop();
+			openMs[1] = TimeOpen(files, archived[1]);
+			readMs[1] = TimeRead(files, checksum[1]);
+			bool exists = FileSystem::FileExists(files[0]);
+			if (mounted)
+				FileSystem::UnmountArchive();
+			result &= TestResult(mounted && !archived[0] && archived[1] == (uint32_t)files.size() && checksum[0] == checksum[1] && exists, "Archive", "mounted reads");
+			logfinfo("Mount:			%8.2f ms\n", mountMs);
+			logfinfo("Open loose:		%8.2f ms\n", openMs[0]);
+			logfinfo("Open archive:	%8.2f ms\n", openMs[1]);
+			logfinfo("Read loose:		%8.2f ms (%8.2f MB/s)\n", readMs[0], mb * 1000.0 / __max(readMs[0], 1e-3));
+			logfinfo("Read archive:	%8.2f ms (%8.2f MB/s)\n", readMs[1], mb * 1000.0 / __max(readMs[1], 1e-3));
+		}
+		loginfo("***************************************************\n");
+		remove(archivePath);
+		return result;
+	}
+
+	void BenchmarkFileRead()
+	{
+		filesystem_benchmark::Run();
+	}
+
+	void ExecCommand_BenchmarkFileRead(const char* command)
+	{
+		BenchmarkFileRead();
+	}
+
+	void ExecCommand_TestArchive(const char* command)
+	{
+		TestArchive();
+	}
+
+	void InitFileSystem()
+	{
+		AddConsoleCommand("fs_readbench", &ExecCommand_BenchmarkFileRead);
+		AddConsoleCommand("fs_archivetest", &ExecCommand_TestArchive);
+	}
 }
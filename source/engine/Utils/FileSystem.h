@@ -1,14 +1,36 @@
 #pragma once
 
 #include "Core/Types.h"
+#include "Core/Platform.h"
 #include "Application/CmdParser.h"
 
 namespace Mist
 {
 	extern CStrVar CVar_Workspace;
 
+	class cArchive;
+	struct tArchiveEntry;
+
 	namespace FileSystem
 	{
+		/**
+		 * Virtual file layer: with an archive mounted, workspace files are looked up in the archive first
+		 * and the loose files are the fallback. cMappedFile reads, FileExists and modification times go
+		 * through it, cFile streams always use loose files. Mount before any read and unmount after the
+		 * last one, views of archived files point into the archive mapping.
+		 */
+		bool MountArchive(const char* archivePath);
+		void UnmountArchive();
+		const cArchive* GetMountedArchive();
+		// entry of a workspace path (workspace prefix included) in the mounted archive, null otherwise.
+		const tArchiveEntry* FindArchiveEntry(const char* filepath);
+
+		// key to compare relative paths: lowercase, '/' separated, without "." and ".." segments.
+		// False if empty, too long or above the root.
+		bool NormalizePath(const char* path, char* out, size_t size);
+
+		// seconds since epoch. Archived files report the time of the source file when packed.
+		bool GetModificationTime(const char* filename, uint64_t& time);
 		bool IsFileNewerThanOther(const char* file, const char* other);
         bool FileExists(const char* filename);
 		bool DirExists(const char* directory);
@@ -31,6 +53,15 @@ namespace Mist
 		}
 	}
 
+	// registers file system console commands.
+	void InitFileSystem();
+	// reads every file of the workspace buffered and mapped, compares both times.
+	void BenchmarkFileRead();
+
+	// Packs CVar fs_archiveTestDirectory in a temporary archive, checks every entry and lookup against
+	// the loose files and compares open and read times, loose against mounted archive.
+	bool TestArchive();
+
 	class cAssetPath
 	{
 	public:
@@ -107,6 +138,57 @@ namespace Mist
 		void* m_id{ nullptr };
 	};
 
+	/**
+	 * Read only view of a whole file. The file is memory mapped, so there is no heap copy and the pages
+	 * are read by the os on first access. Files that can't be mapped (or with fs_mapFiles disabled) fall
+	 * back to a buffered read into heap memory. Path is used as given, like the FileSystem functions.
+	 * Files in the mounted archive are views of the archive mapping.
+	 */
+	class cMappedFile
+	{
+	public:
+		enum eAccess
+		{
+			// read front to back once, the os reads ahead.
+			Access_Sequential,
+			// parsed in any order, only the touched pages are read.
+			Access_Random,
+		};
+
+		cMappedFile() = default;
+		~cMappedFile();
+		cMappedFile(const cMappedFile&) = delete;
+		cMappedFile& operator=(const cMappedFile&) = delete;
+
+		bool Open(const char* filepath, eAccess access = Access_Sequential);
+		void Close();
+		// asks the os to start reading the range before it is accessed. Nothing to do with buffered files.
+		void Prefetch(size_t offset, size_t size) const;
+
+		inline bool IsOpen() const { return m_open; }
+		inline bool IsMapped() const { return m_view != nullptr; }
+		inline bool IsArchived() const { return m_archived; }
+		// null for empty files.
+		inline const void* GetData() const { return m_data; }
+		inline const char* GetText() const { return static_cast<const char*>(m_data); }
+		inline size_t GetSize() const { return m_size; }
+
+	private:
+		bool OpenArchived(const cArchive& archive, const tArchiveEntry& entry, eAccess access);
+
+	private:
+		Platform::tMappedFile m_mapping;
+		// mapping the data lives in: m_mapping or the archive one, at m_viewOffset.
+		const Platform::tMappedFile* m_view = nullptr;
+		size_t m_viewOffset = 0;
+		const void* m_data = nullptr;
+		size_t m_size = 0;
+		// heap copy when the file could not be mapped, or decoded compressed entry.
+		void* m_buffer = nullptr;
+		bool m_archived = false;
+		bool m_open = false;
+	};
+
 	class cCfgFile
 	{
 	public:
@@ -9,7 +9,6 @@
 #include "glm/gtx/euler_angles.inl"
 #include "glm/gtx/matrix_decompose.hpp"
 #include "Render/Globals.h"
-#include <imgui/imgui.h>
 #include "FileSystem.h"
 
 namespace Mist
@@ -92,105 +91,3 @@ namespace Mist
 		}
 	}
 }
-
-bool Mist::ImGuiUtils::CheckboxBitField(const char* id, int32_t* bitfield, int32_t bitflag)
-{
-	bool v = (*bitfield) & bitflag;
-	if (ImGui::Checkbox(id, &v))
-	{
-		v ? (*bitfield) |= bitflag : (*bitfield) &= ~bitflag;
-		return true;
-	}
-	return false;
-}
-
-bool Mist::ImGuiUtils::EditAngles(const char* id, const char* label, tAngles& a, float speed, float min, float max, const char* fmt)
-{
-	int col = ImGui::GetColumnsCount();
-	ImGui::Columns(2);
-	ImGui::Text("%s", label);
-	ImGui::NextColumn();
-	char buff[256];
-	sprintf_s(buff, "##%s", id);
-	bool ret = ImGui::DragFloat3(buff, a.ToFloat(), speed, min, max, fmt);
-	ImGui::Columns(col);
-	return ret;
-}
-
-bool Mist::ImGuiUtils::CheckboxCBoolVar(CBoolVar& var)
-{
-	bool b = var.Get();
-	if (ImGui::Checkbox(var.GetName(), &b) && !(var.GetFlags() & (CVarFlag_Const | CVarFlag_SetOnlyByCmd)))
-	{
-		var.Set(b);
-		return true;
-	}
-	return false;
-}
-
-bool Mist::ImGuiUtils::EditCIntVar(CIntVar& var)
-{
-	int v = var.Get();
-	if (ImGui::InputInt(var.GetName(), &v) && !(var.GetFlags() & (CVarFlag_Const | CVarFlag_SetOnlyByCmd)))
-	{
-		var.Set(v);
-		return true;
-	}
-	return false;
-}
-
-bool Mist::ImGuiUtils::EditCFloatVar(CFloatVar& var)
-{
-	float v = var.Get();
-	if (ImGui::InputFloat(var.GetName(), &v) && !(var.GetFlags() & (CVarFlag_Const | CVarFlag_SetOnlyByCmd)))
-	{
-		var.Set(v);
-		return true;
-	}
-	return false;
-}
-
-bool Mist::ImGuiUtils::EditCStrVar(CStrVar& var)
-{
-	char buff[64];
-	strcpy_s(buff, var.Get());
-	if (ImGui::InputText(var.GetName(), buff, 64, ImGuiInputTextFlags_EnterReturnsTrue) && !(var.GetFlags() & (CVarFlag_Const | CVarFlag_SetOnlyByCmd)))
-	{
-		var.Set(buff);
-		return true;
-	}
-	return false;
-}
-
-bool Mist::ImGuiUtils::EditCVar(CVar& cvar)
-{
-	switch (cvar.GetType())
-	{
-	case CVar::CVarType::Int: return EditCIntVar(*(CIntVar*)(&cvar));
-	case CVar::CVarType::Float: return EditCFloatVar(*(CFloatVar*)(&cvar));
-	case CVar::CVarType::Bool: return CheckboxCBoolVar(*(CBoolVar*)(&cvar));
-	case CVar::CVarType::String: return EditCStrVar(*(CStrVar*)(&cvar));
-	default:
-		check(false && "Unreachable");
-	}
-	return false;
-}
-
-bool Mist::ImGuiUtils::ComboBox(const char* title, int* currentSelection, const char** values, int valueCount)
-{
-	check(currentSelection && *currentSelection >= 0 && *currentSelection < valueCount);
-	bool res = false;
-	if (ImGui::BeginCombo(title, values[*currentSelection]))
-	{
-		for (int i = 0; i < valueCount; ++i)
-		{
-			if (ImGui::Selectable(values[i], *currentSelection == i))
-			{
-				*currentSelection = i;
-				res = true;
-			}
-		}
-		ImGui::EndCombo();
-	}
-	return res;
-}
@@ -35,6 +35,8 @@ namespace Mist
 	{
 		bool CheckboxBitField(const char* id, int32_t* bitfield, int32_t bitflag);
 		bool EditAngles(const char* id, const char* label, tAngles& a, float speed = 0.5f, float min=0.f, float max= 0.f, const char* fmt = "%5.3f");
+		// x, y, z, w. Not normalized, the caller decides when.
+		bool EditQuat(const char* id, const char* label, glm::quat& q, float speed = 0.01f, const char* fmt = "%5.3f");
 		bool CheckboxCBoolVar(CBoolVar& var);
 		bool EditCIntVar(CIntVar& var);
 		bool EditCFloatVar(CFloatVar& var);
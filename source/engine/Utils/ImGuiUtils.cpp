@@ -0,0 +1,140 @@
+#include "Utils/GenericUtils.h"
+#include "Core/Debug.h"
+#include "Application/CmdParser.h"
+#include "glm/gtx/quaternion.hpp"
+#include <imgui/imgui.h>
+
+// ImGui widgets, kept out of GenericUtils.cpp so the core library builds without ImGui.
+
+namespace Mist
+{
+	void ImGuiDrawCVars()
+	{
+		uint32_t count = GetCVarCount();
+		CVar** cvarArray = GetCVarArray();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			CVar* cvar = cvarArray[i];
+			if (!(cvar->GetFlags() & CVarFlag_Private))
+				ImGuiUtils::EditCVar(*cvar);
+		}
+	}
+}
+
+bool Mist::ImGuiUtils::CheckboxBitField(const char* id, int32_t* bitfield, int32_t bitflag)
+{
+	bool v = (*bitfield) & bitflag;
+	if (ImGui::Checkbox(id, &v))
+	{
+		v ? (*bitfield) |= bitflag : (*bitfield) &= ~bitflag;
+		return true;
+	}
+	return false;
+}
+
+bool Mist::ImGuiUtils::EditAngles(const char* id, const char* label, tAngles& a, float speed, float min, float max, const char* fmt)
+{
+	int col = ImGui::GetColumnsCount();
+	ImGui::Columns(2);
+	ImGui::Text("%s", label);
+	ImGui::NextColumn();
+	char buff[256];
+	sprintf_s(buff, "##%s", id);
+	bool ret = ImGui::DragFloat3(buff, a.ToFloat(), speed, min, max, fmt);
+	ImGui::Columns(col);
+	return ret;
+}
+
+bool Mist::ImGuiUtils::EditQuat(const char* id, const char* label, glm::quat& q, float speed, const char* fmt)
+{
+	int col = ImGui::GetColumnsCount();
+	ImGui::Columns(2);
+	ImGui::Text("%s", label);
+	ImGui::NextColumn();
+	char buff[256];
+	sprintf_s(buff, "##%s", id);
+	float v[4] = { q.x, q.y, q.z, q.w };
+	bool ret = ImGui::DragFloat4(buff, v, speed, -1.f, 1.f, fmt);
+	if (ret)
+		q = glm::quat(v[3], v[0], v[1], v[2]);
+	ImGui::Columns(col);
+	return ret;
+}
+
+bool Mist::ImGuiUtils::CheckboxCBoolVar(CBoolVar& var)
+{
+	bool b = var.Get();
+	if (ImGui::Checkbox(var.GetName(), &b) && !(var.GetFlags() & (CVarFlag_Const | CVarFlag_SetOnlyByCmd)))
+	{
+		var.Set(b);
+		return true;
+	}
+	return false;
+}
+
+bool Mist::ImGuiUtils::EditCIntVar(CIntVar& var)
+{
+	int v = var.Get();
+	if (ImGui::InputInt(var.GetName(), &v) && !(var.GetFlags() & (CVarFlag_Const | CVarFlag_SetOnlyByCmd)))
+	{
+		var.Set(v);
+		return true;
+	}
+	return false;
+}
+
+bool Mist::ImGuiUtils::EditCFloatVar(CFloatVar& var)
+{
+	float v = var.Get();
+	if (ImGui::InputFloat(var.GetName(), &v) && !(var.GetFlags() & (CVarFlag_Const | CVarFlag_SetOnlyByCmd)))
+	{
+		var.Set(v);
+		return true;
+	}
+	return false;
+}
+
+bool Mist::ImGuiUtils::EditCStrVar(CStrVar& var)
+{
+	char buff[64];
+	strcpy_s(buff, var.Get());
+	if (ImGui::InputText(var.GetName(), buff, 64, ImGuiInputTextFlags_EnterReturnsTrue) && !(var.GetFlags() & (CVarFlag_Const | CVarFlag_SetOnlyByCmd)))
+	{
+		var.Set(buff);
+		return true;
+	}
+	return false;
+}
+
+bool Mist::ImGuiUtils::EditCVar(CVar& cvar)
+{
+	switch (cvar.GetType())
+	{
+	case CVar::CVarType::Int: return EditCIntVar(*(CIntVar*)(&cvar));
+	case CVar::CVarType::Float: return EditCFloatVar(*(CFloatVar*)(&cvar));
+	case CVar::CVarType::Bool: return CheckboxCBoolVar(*(CBoolVar*)(&cvar));
+	case CVar::CVarType::String: return EditCStrVar(*(CStrVar*)(&cvar));
+	default:
+		check(false && "Unreachable");
+	}
+	return false;
+}
+
+bool Mist::ImGuiUtils::ComboBox(const char* title, int* currentSelection, const char** values, int valueCount)
+{
+	check(currentSelection && *currentSelection >= 0 && *currentSelection < valueCount);
+	bool res = false;
+	if (ImGui::BeginCombo(title, values[*currentSelection]))
+	{
+		for (int i = 0; i < valueCount; ++i)
+		{
+			if (ImGui::Selectable(values[i], *currentSelection == i))
+			{
+				*currentSelection = i;
+				res = true;
+			}
+		}
+		ImGui::EndCombo();
+	}
+	return res;
+}
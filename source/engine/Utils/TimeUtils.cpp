@@ -1,15 +1,6 @@
 #include "Utils/TimeUtils.h"
 #include "Core/Debug.h"
-
-
-
-#if defined(_WIN32)
-#include <windows.h>
-#include <winnt.h>
-#include <profileapi.h> 
-#else
-#error SO not supported
-#endif
+#include "Core/Platform.h"
 #include "Core/Logger.h"
 #include "GenericUtils.h"
 #include "Application/CmdParser.h"
@@ -19,28 +10,16 @@ namespace Mist
 {
 	CIntVar CVar_LogProfileScopes("s_logprofilescopes", 1);
 
+	uint64_t GFrameCount = 0;
+
 	int64_t cpufreq(bool force = false)
 	{
-#if defined(_WIN32)
-		LARGE_INTEGER f;
-		BOOL b = QueryPerformanceFrequency(&f);
-		check(b && f.QuadPart);
-		return f.QuadPart;
-#else 
-		return 0.f;
-#endif // 0
+		return (int64_t)Platform::GetTickFrequency();
 	}
 
 	tTimePoint GetTimePoint()
 	{
-#if defined(_WIN32)
-		LARGE_INTEGER t;
-		BOOL b = QueryPerformanceCounter(&t);
-		check(b);
-		return t.QuadPart;
-#else
-		return 0;
-#endif // defined(_WIN32)
+		return (tTimePoint)Platform::GetTicks();
 	}
 
 	float GetMiliseconds(tTimePoint point)
@@ -48,6 +27,16 @@ namespace Mist
 		return (float)point / (float)cpufreq() * 1e3f;
 	}
 
+	uint64_t GetFrameCount()
+	{
+		return GFrameCount;
+	}
+
+	void AdvanceFrameCount()
+	{
+		++GFrameCount;
+	}
+
 	tScopeProfiler::tScopeProfiler()
 	{}
 
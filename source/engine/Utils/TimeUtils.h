@@ -3,7 +3,7 @@
 #include "Core/Types.h"
 
 #define PROFILE_SCOPE_LOG(id, msg) Mist::tScopeProfiler __scopeprof_##id(msg)
-#define PROFILE_SCOPE_LOGF(id, fmt, ...) Mist::tScopeProfiler __scopeprof_##id##; __scopeprof_##id##.m_msg.Fmt(fmt, __VA_ARGS__); __scopeprof_##id##.m_start = Mist::GetTimePoint()
+#define PROFILE_SCOPE_LOGF(id, fmt, ...) Mist::tScopeProfiler __scopeprof_##id; __scopeprof_##id.m_msg.Fmt(fmt, ##__VA_ARGS__); __scopeprof_##id.m_start = Mist::GetTimePoint()
 
 namespace Mist
 {
@@ -11,6 +11,10 @@ namespace Mist
 	tTimePoint GetTimePoint();
 	float GetMiliseconds(tTimePoint point);
 
+	// frames run by the application loop, stays 0 in tools without one.
+	uint64_t GetFrameCount();
+	void AdvanceFrameCount();
+
 	class tScopeProfiler
 	{
 	public:
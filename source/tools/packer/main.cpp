@@ -0,0 +1,91 @@
+#include <cstdint>
+#include <stdio.h>
+#include <string.h>
+
+#include "Core/Types.h"
+#include "Core/Debug.h"
+#include "Core/Logger.h"
+#include "Core/SystemMemory.h"
+#include "Core/JobSystem.h"
+#include "Utils/Archive.h"
+
+/**
+ * Packs an asset tree in a .mpak archive, mounted by the engine with -Archive:<file>.
+ *
+ *   MistPacker <directory> <archive> [-only:<subdirectory>] [-exclude:<pattern>]... [-compress]
+ *
+ * Paths inside the archive are relative to directory, so pack the workspace root. Compiled shader
+ * binaries and other archives are always excluded. With -compress the entries that shrink are stored
+ * compressed, blocks compressed in parallel.
+ */
+
+namespace
+{
+	const char* const DefaultExcludes[] =
+	{
+		"*shaderbin/*",
+		"*.mpak",
+		"*.mpak.tmp",
+	};
+	const uint32_t MaxExcludes = 32;
+
+	const char* GetArgValue(const char* arg, const char* name)
+	{
+		size_t len = strlen(name);
+		return !_strnicmp(arg, name, len) ? arg + len : nullptr;
+	}
+
+	void PrintUsage()
+	{
+		printf("usage: MistPacker <directory> <archive> [-only:<subdirectory>] [-exclude:<pattern>]... [-compress]\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const char* excludes[MaxExcludes];
+	Mist::tArchiveBuildOptions options;
+	options.Excludes = excludes;
+	for (const char* exclude : DefaultExcludes)
+		excludes[options.ExcludeCount++] = exclude;
+	for (int i = 3; i < argc; ++i)
+	{
+		if (const char* value = GetArgValue(argv[i], "-only:"))
+			options.Subdirectory = value;
+		else if (const char* value = GetArgValue(argv[i], "-exclude:"); value && options.ExcludeCount < MaxExcludes)
+			excludes[options.ExcludeCount++] = value;
+		else if (!_stricmp(argv[i], "-compress"))
+			options.Compress = true;
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	Mist::InitSytemMemory();
+	Mist::InitLog("packer_log.html");
+	if (options.Compress)
+		Mist::InitJobSystem();
+	Mist::tArchiveBuildStats stats;
+	Mist::Profiling::sProfilingTimer timer;
+	timer.Start();
+	bool result = Mist::BuildArchive(argv[1], argv[2], options, &stats);
+	double ms = timer.Stop();
+	if (result)
+	{
+		logfok("Packed %u files (%.2f MB, %u compressed) in %s: %.2f MB, %.2f ms\n", stats.Files, (double)stats.Bytes / (1024.0 * 1024.0),
+			stats.CompressedFiles, argv[2], (double)stats.ArchiveBytes / (1024.0 * 1024.0), ms);
+	}
+	if (Mist::IsJobSystemRunning())
+		Mist::TerminateJobSystem();
+	Mist::TerminateLog();
+	Mist::TerminateSystemMemory();
+	return result ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+#include <cstdint>
+#include <stdio.h>
+#include <string.h>
+
+#include "Core/Types.h"
+#include "Core/Debug.h"
+#include "Core/Logger.h"
+#include "Core/SystemMemory.h"
+#include "Core/StringId.h"
+#include "Core/Hash.h"
+#include "Core/PoolAllocator.h"
+#include "Core/JobSystem.h"
+#include "Core/AsyncIO.h"
+#include "Core/FileWatch.h"
+#include "Application/CmdParser.h"
+#include "Utils/FileSystem.h"
+#include "Utils/Compression.h"
+#include "Scene/SceneComponents.h"
+
+/**
+ * Runs the tests and benchmarks of the engine core without window, render device nor console.
+ *
+ *   MistRunner <command>... [-<cvar>:<value>]...
+ *
+ * Commands are named as their console commands (fs_lztest, c_jobbench...), -list prints them.
+ * CVars are set as in the engine command line, before the job system and async io start, so
+ * JobWorkerCount and IOThreadCount apply too. Exits with 1 if any test failed.
+ */
+
+namespace
+{
+	struct tRunnerCommand
+	{
+		const char* Name;
+		bool (*Test)();
+		void (*Benchmark)();
+	};
+
+	const tRunnerCommand Commands[] =
+	{
+		{ "c_jobtest", &Mist::TestJobSystem, nullptr },
+		{ "io_test", &Mist::TestAsyncIO, nullptr },
+		{ "fs_watchtest", &Mist::TestFileWatch, nullptr },
+		{ "fs_lztest", &Mist::TestCompression, nullptr },
+		{ "fs_archivetest", &Mist::TestArchive, nullptr },
+		{ "r_transformrotationtest", &Mist::TestTransformRotation, nullptr },
+		{ "r_scenegraphtest", &Mist::TestSceneGraph, nullptr },
+		{ "r_frameheaptest", &Mist::TestFrameHeapAllocations, nullptr },
+		{ "c_jobbench", nullptr, &Mist::BenchmarkJobSystem },
+		{ "c_memorybench", nullptr, &Mist::BenchmarkMemoryTrace },
+		{ "c_poolbench", nullptr, &Mist::BenchmarkPoolAllocator },
+		{ "c_hashbench", nullptr, &Mist::BenchmarkHash },
+		{ "c_mapbench", nullptr, &Mist::BenchmarkFlatMap },
+		{ "c_stringidbench", nullptr, &Mist::BenchmarkStringIds },
+		{ "c_cvarbench", nullptr, &Mist::BenchmarkCVarLookup },
+		{ "s_logbench", nullptr, &Mist::BenchmarkLog },
+		{ "fs_readbench", nullptr, &Mist::BenchmarkFileRead },
+		{ "fs_lzbench", nullptr, &Mist::BenchmarkCompression },
+		{ "r_scenebench", nullptr, &Mist::BenchmarkSceneComponents },
+		{ "r_transformbench", nullptr, &Mist::BenchmarkTransformPropagation },
+		{ "r_transformsimdbench", nullptr, &Mist::BenchmarkTransformComposition },
+		{ "r_hierarchybench", nullptr, &Mist::BenchmarkHierarchyOrder },
+	};
+
+	const tRunnerCommand* FindCommand(const char* name)
+	{
+		for (const tRunnerCommand& command : Commands)
+		{
+			if (!_stricmp(command.Name, name))
+				return &command;
+		}
+		return nullptr;
+	}
+
+	void PrintUsage()
+	{
+		printf("usage: MistRunner <command>... [-<cvar>:<value>]...\n");
+		printf("commands:\n");
+		for (const tRunnerCommand& command : Commands)
+			printf("  %-28s %s\n", command.Name, command.Test ? "test" : "benchmark");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2 || !_stricmp(argv[1], "-list"))
+	{
+		PrintUsage();
+		return argc < 2 ? 1 : 0;
+	}
+
+	// same order as the engine entry point, cvars and commands registered before parsing the args.
+	Mist::InitSytemMemory();
+	Mist::InitLog("runner_log.html");
+	Mist::InitStringIds();
+	Mist::InitHash();
+	Mist::InitTypes();
+	Mist::InitCVars();
+	Mist::InitFileSystem();
+	Mist::InitCompression();
+	Mist::InitSceneComponents();
+
+	bool valid = true;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (*argv[i] != '-')
+		{
+			if (!FindCommand(argv[i]))
+			{
+				logferror("Unknown command: %s\n", argv[i]);
+				valid = false;
+			}
+			continue;
+		}
+		const char* value = strchr(argv[i], ':');
+		char name[Mist::CVar::MaxNameSize];
+		size_t nameLength = value ? (size_t)(value - argv[i] - 1) : 0;
+		if (!value || !nameLength || nameLength >= sizeof(name))
+		{
+			logferror("Invalid argument, expected -<cvar>:<value>: %s\n", argv[i]);
+			valid = false;
+			continue;
+		}
+		strncpy_s(name, argv[i] + 1, nameLength);
+		if (!Mist::SetCVar(name, value + 1))
+			valid = false;
+	}
+
+	bool result = valid;
+	if (valid)
+	{
+		Mist::InitJobSystem();
+		Mist::InitAsyncIO();
+		for (int i = 1; i < argc; ++i)
+		{
+			if (*argv[i] == '-')
+				continue;
+			const tRunnerCommand* command = FindCommand(argv[i]);
+			if (command->Test)
+			{
+				bool passed = command->Test();
+				if (passed)
+					logfok("%s passed\n", command->Name);
+				else
+					logferror("%s failed\n", command->Name);
+				result &= passed;
+			}
+			else
+				command->Benchmark();
+		}
+		// completions run as jobs.
+		Mist::TerminateAsyncIO();
+		Mist::TerminateJobSystem();
+	}
+	else
+		PrintUsage();
+
+	Mist::TerminateLog();
+	Mist::TerminateSystemMemory();
+	return result ? 0 : 1;
+}